@@ -0,0 +1,8 @@
+gp_version="6.0.0-beta.1+9e4bbe8 build dev"
+
+print_version ()
+{
+	progname="$(basename $0)"
+	echo "${progname} ${gp_version}"
+	exit 0
+}
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+#
+# Generates the Parquet files used by the gp_parquet regression tests.
+#
+# The files are checked in, so this only needs to be rerun when the test
+# data changes. It writes the format directly (Thrift compact protocol
+# footer, PLAIN and dictionary encoded pages) so that it does not depend
+# on pyarrow or any other Parquet library.
+#
+#     cd gpcontrib/gp_parquet/data && python3 gen_test_data.py
+#
+import os
+import struct
+import zlib
+
+# --- thrift compact encoder ---
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7f; n >>= 7
+        if n: out.append(b | 0x80)
+        else:
+            out.append(b); return bytes(out)
+def zz(n): return varint((n << 1) ^ (n >> 63))
+class S:
+    """struct: list of (id, type, value)"""
+    def __init__(self, *fields): self.fields = [f for f in fields if f is not None]
+I32, I64, BIN, LST, STR, BOOL, BYTE = 5, 6, 8, 9, 12, 1, 3
+def enc_val(t, v):
+    if t in (I32, I64): return zz(v)
+    if t == BYTE: return bytes([v & 0xff])
+    if t == BIN:
+        if isinstance(v, str): v = v.encode()
+        return varint(len(v)) + v
+    if t == STR: return enc_struct(v)
+    if t == LST:
+        et, items = v
+        n = len(items)
+        h = bytes([(n << 4) | et]) if n < 15 else bytes([0xf0 | et]) + varint(n)
+        return h + b''.join(enc_val(et, i) for i in items)
+    raise Exception(t)
+def enc_struct(s):
+    out = bytearray(); last = 0
+    for fid, t, v in s.fields:
+        wt = t
+        if t == BOOL: wt = 1 if v else 2
+        d = fid - last
+        if 0 < d <= 15: out.append((d << 4) | wt)
+        else: out.append(wt); out += zz(fid)
+        if t != BOOL: out += enc_val(t, v)
+        last = fid
+    out.append(0)
+    return bytes(out)
+
+# --- encodings ---
+def rle_hybrid(values, bw):
+    # emit alternating rle and bitpacked runs for coverage
+    out = bytearray(); i = 0; nb = (bw + 7) // 8
+    toggle = 0
+    while i < len(values):
+        j = i
+        while j < len(values) and values[j] == values[i]: j += 1
+        if j - i >= 8 or len(values) - i < 8:
+            run = j - i
+            out += varint(run << 1) + values[i].to_bytes(nb, 'little') if nb else varint(run << 1)
+            i = j
+        else:
+            grp = values[i:i+8]
+            bits = 0
+            for k, v in enumerate(grp): bits |= v << (k * bw)
+            out += varint((1 << 1) | 1) + bits.to_bytes(bw, 'little')
+            i += 8
+    return bytes(out)
+
+def plain(ptype, vals, tl=0):
+    if ptype == 0:
+        out = bytearray((len(vals) + 7) // 8)
+        for i, v in enumerate(vals):
+            if v: out[i // 8] |= 1 << (i % 8)
+        return bytes(out)
+    if ptype == 1: return b''.join(struct.pack('<i', v) for v in vals)
+    if ptype == 2: return b''.join(struct.pack('<q', v) for v in vals)
+    if ptype == 3: return b''.join(struct.pack('<qi', *v) for v in vals)
+    if ptype == 4: return b''.join(struct.pack('<f', v) for v in vals)
+    if ptype == 5: return b''.join(struct.pack('<d', v) for v in vals)
+    if ptype == 6:
+        vals = [v.encode() if isinstance(v, str) else v for v in vals]
+        return b''.join(struct.pack('<I', len(v)) + v for v in vals)
+    if ptype == 7: return b''.join(vals)
+
+def snappy_lit(data):
+    # literal-only snappy with one back-reference when possible
+    out = bytearray(varint(len(data)))
+    i = 0
+    while i < len(data):
+        # try a copy of len 4..11 with offset <2048 (1-byte-offset form)
+        if i >= 4:
+            best = None
+            for off in range(1, min(i, 2047) + 1):
+                l = 0
+                while l < 11 and i + l < len(data) and data[i + l - off] == data[i + l]: l += 1
+                if l >= 4: best = (off, l); break
+            if best:
+                off, l = best
+                out.append(((off >> 8) << 5) | ((l - 4) << 2) | 1); out.append(off & 0xff)
+                i += l; continue
+        n = min(60, len(data) - i)
+        # extend literal until a copy would be possible (simple: just chunks of up to 60)
+        out.append(((n - 1) << 2)); out += data[i:i+n]; i += n
+    return bytes(out)
+
+def compress(codec, data):
+    if codec == 0: return data
+    if codec == 1: return snappy_lit(data)
+    if codec == 2:
+        c = zlib.compressobj(6, zlib.DEFLATED, 31); return c.compress(data) + c.flush()
+    raise Exception(codec)
+
+# --- column spec ---
+class Col:
+    def __init__(self, name, ptype, values, optional=True, conv=None, logical=None, tl=0,
+                 scale=None, precision=None, dict_enc=False, v2=False, codec=0, page_rows=None, stats=None,
+                 v2_levels=None):
+        self.__dict__.update(locals()); del self.__dict__['self']
+
+def write_file(path, cols, rowgroups):
+    """rowgroups: list of row counts; col.values covers all rows"""
+    f = bytearray(b'PAR1')
+    rgs = []
+    start = 0
+    for nrows in rowgroups:
+        chunks = []
+        for c in cols:
+            vals = c.values[start:start+nrows]
+            chunk_start = len(f)
+            dict_off = None
+            nonnull = [v for v in vals if v is not None]
+            if c.dict_enc:
+                uniq = []
+                for v in nonnull:
+                    if v not in uniq: uniq.append(v)
+                dpage = plain(c.ptype, uniq)
+                comp = compress(c.codec, dpage)
+                hdr = enc_struct(S((1, I32, 2), (2, I32, len(dpage)), (3, I32, len(comp)),
+                                   (7, STR, S((1, I32, len(uniq)), (2, I32, 0)))))
+                dict_off = len(f)
+                f += hdr + comp
+            data_off = len(f)
+            pr = c.page_rows or nrows
+            for p in range(0, nrows, pr):
+                pv = vals[p:p+pr]
+                pnn = [v for v in pv if v is not None]
+                defs = b''
+                if c.optional:
+                    defs = rle_hybrid([0 if v is None else 1 for v in pv], 1)
+                if c.dict_enc:
+                    bw = max(1, (len(uniq) - 1).bit_length())
+                    body = bytes([bw]) + rle_hybrid([uniq.index(v) for v in pnn], bw)
+                    enc = 8
+                else:
+                    body = plain(c.ptype, pnn); enc = 0
+                if c.v2:
+                    comp = compress(c.codec, body)
+                    hdr = enc_struct(S((1, I32, 3), (2, I32, len(defs) + len(body)), (3, I32, len(defs) + len(comp)),
+                                       (8, STR, S((1, I32, len(pv)), (2, I32, len(pv) - len(pnn)), (3, I32, len(pv)),
+                                                  (4, I32, enc), (5, I32, len(defs)), (6, I32, 0)))))
+                    if c.v2_levels:
+                        # override (def, rep) level lengths to produce a corrupt page
+                        hdr = enc_struct(S((1, I32, 3), (2, I32, len(defs) + len(body)), (3, I32, len(defs) + len(comp)),
+                                           (8, STR, S((1, I32, len(pv)), (2, I32, len(pv) - len(pnn)), (3, I32, len(pv)),
+                                                      (4, I32, enc), (5, I32, c.v2_levels[0]),
+                                                      (6, I32, c.v2_levels[1])))))
+                    f += hdr + defs + comp
+                else:
+                    raw = (struct.pack('<I', len(defs)) + defs if c.optional else b'') + body
+                    comp = compress(c.codec, raw)
+                    hdr = enc_struct(S((1, I32, 0), (2, I32, len(raw)), (3, I32, len(comp)),
+                                       (5, STR, S((1, I32, len(pv)), (2, I32, enc), (3, I32, 3), (4, I32, 3)))))
+                    f += hdr + comp
+            total = len(f) - chunk_start
+            st = None
+            if nonnull and c.ptype in (1, 2, 6):
+                mn, mx = min(nonnull), max(nonnull)
+                st = S((3, I64, len(vals) - len(nonnull)), (5, BIN, plain(c.ptype, [mx])[4 if c.ptype == 6 else 0:]),
+                       (6, BIN, plain(c.ptype, [mn])[4 if c.ptype == 6 else 0:]))
+            elif not nonnull:
+                st = S((3, I64, len(vals)))
+            md = S((1, I32, c.ptype), (2, LST, (I32, [0, 3])), (3, LST, (BIN, [c.name])), (4, I32, c.codec),
+                   (5, I64, len(vals)), (6, I64, total), (7, I64, total), (9, I64, data_off),
+                   (11, I64, dict_off) if dict_off is not None else None,
+                   (12, STR, st) if st else None)
+            chunks.append(S((2, I64, chunk_start), (3, STR, md)))
+        rgs.append(S((1, LST, (STR, chunks)), (2, I64, 0), (3, I64, nrows)))
+        start += nrows
+    schema = [S((4, BIN, 'schema'), (5, I32, len(cols)))]
+    for c in cols:
+        schema.append(S((1, I32, c.ptype), (2, I32, c.tl) if c.tl else None, (3, I32, 1 if c.optional else 0),
+                        (4, BIN, c.name), (6, I32, c.conv) if c.conv is not None else None,
+                        (7, I32, c.scale) if c.scale is not None else None,
+                        (8, I32, c.precision) if c.precision is not None else None,
+                        (10, STR, c.logical) if c.logical else None))
+    meta = enc_struct(S((1, I32, 1), (2, LST, (STR, schema)), (3, I64, sum(rowgroups)), (4, LST, (STR, rgs)),
+                        (6, BIN, 'gen.py')))
+    f += meta + struct.pack('<I', len(meta)) + b'PAR1'
+    open(path, 'wb').write(bytes(f))
+
+
+if __name__ == '__main__':
+    N = 10
+    ts_type = S((8, STR, S((1, BOOL, False), (2, STR, S((2, STR, S()))))))
+    string_type = S((1, STR, S()))
+
+    ids = list(range(1, N + 1))
+    names = [None if i % 4 == 3 else ['apple', 'banana', 'cherry'][i % 3] for i in range(N)]
+    amounts = [i * 1250 - 3000 for i in range(N)]           # DECIMAL(9,2)
+    created = [1600000000000000 + i * 86400000000 for i in range(N)]
+    flags = [i % 2 == 0 for i in range(N)]
+    days = [18000 + i for i in range(N)]                    # 2019-04-14 onwards
+
+    cols = [Col('id', 1, ids, optional=False, codec=1),
+            Col('name', 6, names, logical=string_type, dict_enc=True, codec=1, page_rows=3),
+            Col('amount', 1, amounts, conv=5, scale=2, precision=9, codec=1),
+            Col('created', 2, created, logical=ts_type, codec=2, v2=True),
+            Col('flag', 0, flags, optional=False, codec=1),
+            Col('day', 1, days, conv=6, codec=0)]
+    write_file('types.parquet', cols, [5, 5])
+
+    # a directory of part files, as written by Spark or Hive
+    os.makedirs('parts', exist_ok=True)
+    for part in range(2):
+        ids = list(range(part * 100 + 1, part * 100 + 9))
+        cols = [Col('id', 2, ids, optional=False),
+                Col('label', 6, ['p%d-%d' % (part, i) for i in ids], conv=0)]
+        write_file('parts/part-%05d.parquet' % part, cols, [4, 4])
+    open('parts/_SUCCESS', 'w').close()
+
+    # a v2 page whose level lengths overflow a 32-bit int when added up
+    cols = [Col('id', 1, [1, 2, 3], optional=False, v2=True, v2_levels=(0x7fffffff, 0x7fffffff))]
+    write_file('corrupt_v2_levels.parquet', cols, [3])
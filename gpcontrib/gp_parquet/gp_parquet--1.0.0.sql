@@ -0,0 +1,48 @@
+---------------------------------------------------------------------------
+--
+-- gp_parquet--1.0.0.sql-
+--    This file creates the parquet protocol and the parquet_in and
+--    parquet_out formatters, for reading and writing Parquet files with
+--    external tables:
+--
+--    CREATE EXTERNAL TABLE t (...)
+--        LOCATION ('parquet:///path/to/files')
+--        FORMAT 'CUSTOM' (formatter = 'parquet_in');
+--
+--    CREATE WRITABLE EXTERNAL TABLE t_out (...)
+--        LOCATION ('parquet:///path/to/directory')
+--        FORMAT 'CUSTOM' (formatter = 'parquet_out');
+--
+---------------------------------------------------------------------------
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION gp_parquet" to load this file. \quit
+
+CREATE FUNCTION parquet_import() RETURNS integer
+AS 'MODULE_PATHNAME'
+LANGUAGE C STABLE;
+
+CREATE FUNCTION parquet_export() RETURNS integer
+AS 'MODULE_PATHNAME'
+LANGUAGE C STABLE;
+
+CREATE FUNCTION parquet_validate_urls() RETURNS void
+AS 'MODULE_PATHNAME'
+LANGUAGE C STABLE;
+
+CREATE FUNCTION parquet_in() RETURNS record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STABLE;
+
+CREATE FUNCTION parquet_out(record) RETURNS bytea
+AS 'MODULE_PATHNAME'
+LANGUAGE C STABLE;
+
+-- The protocol reads and writes files on the segment hosts, like file://
+-- locations, so it is not trusted: only superusers can create tables that use
+-- it, unless they grant it to others.
+CREATE PROTOCOL parquet (
+    readfunc = parquet_import,
+    writefunc = parquet_export,
+    validatorfunc = parquet_validate_urls
+);
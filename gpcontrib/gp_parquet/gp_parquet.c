@@ -0,0 +1,1468 @@
+/*-------------------------------------------------------------------------
+ *
+ * gp_parquet.c
+ *	  External table protocol and formatters for reading and writing
+ *	  Parquet files.
+ *
+ *	  CREATE EXTERNAL TABLE t (...)
+ *	    LOCATION ('parquet:///path/to/dir_or_file_or_glob')
+ *	    FORMAT 'CUSTOM' (formatter = 'parquet_in');
+ *
+ *	  CREATE WRITABLE EXTERNAL TABLE t (...)
+ *	    LOCATION ('parquet:///path/to/dir')
+ *	    FORMAT 'CUSTOM' (formatter = 'parquet_out' [, compression = 'snappy']
+ *	                     [, rowgroup_size = '64'] [, file_size = '1024']);
+ *
+ * The files are read directly by the segments, so the path must refer to
+ * the same files on every segment host, e.g. on a shared filesystem. Every
+ * segment reads the footers of all files, and takes every N'th row group,
+ * N being the number of segments.
+ *
+ * Only the columns the query needs are decoded, and row groups whose
+ * column statistics show that no row can satisfy the pushed-down quals are
+ * skipped without reading their data.
+ *
+ * The protocol does all the decoding and hands complete heap tuples to the
+ * parquet_in formatter, which only has to unpack them. The two are bound
+ * to each other with a per-backend token, so that parquet_in never
+ * interprets data that came from anywhere else as tuples.
+ *
+ * Writing works the other way around: parquet_out passes the tuples to the
+ * protocol, which buffers a row group at a time and encodes it column by
+ * column. Each segment writes its own files, named after the segment,
+ * session and command, into the directory.
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/gp_parquet/gp_parquet.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <glob.h>
+#include <sys/stat.h>
+
+#include "access/extprotocol.h"
+#include "access/fileam.h"
+#include "access/formatter.h"
+#include "access/htup_details.h"
+#include "access/nbtree.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbutil.h"
+#include "cdb/cdbvars.h"
+#include "commands/defrem.h"
+#include "funcapi.h"
+#include "nodes/execnodes.h"
+#include "nodes/nodeFuncs.h"
+#include "storage/fd.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/pg_locale.h"
+#include "utils/timestamp.h"
+
+#include "parquet.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(parquet_import);
+PG_FUNCTION_INFO_V1(parquet_export);
+PG_FUNCTION_INFO_V1(parquet_validate_urls);
+PG_FUNCTION_INFO_V1(parquet_in);
+PG_FUNCTION_INFO_V1(parquet_out);
+
+extern Datum parquet_import(PG_FUNCTION_ARGS);
+extern Datum parquet_export(PG_FUNCTION_ARGS);
+extern Datum parquet_validate_urls(PG_FUNCTION_ARGS);
+extern Datum parquet_in(PG_FUNCTION_ARGS);
+extern Datum parquet_out(PG_FUNCTION_ARGS);
+
+#define PARQUET_URL_PREFIX		"parquet://"
+
+/*
+ * The protocol sends a header, then each tuple as its length followed by
+ * the HeapTupleHeader and data.
+ */
+#define PARQUET_STREAM_MAGIC	"GPPQ"
+#define PARQUET_STREAM_HDRLEN	(4 + sizeof(uint64))
+
+static uint64 parquet_stream_token = 0;
+
+/*
+ * The header parquet_out sends ahead of its tuples carries the options of
+ * the writer after the magic and token.
+ */
+typedef struct ParquetWriteOptions
+{
+	int32		codec;			/* ParquetCodec */
+	int32		rowgroup_size;	/* in MB */
+	int32		file_size;		/* in MB, 0 for no limit */
+} ParquetWriteOptions;
+
+#define PARQUET_OUT_HDRLEN		(PARQUET_STREAM_HDRLEN + sizeof(ParquetWriteOptions))
+
+/*
+ * Temporary files written by the current transaction. Complete files are
+ * renamed to their final name just before the transaction commits; all
+ * others, and every file of an aborted (sub)transaction, are removed.
+ */
+typedef struct ParquetPendingFile
+{
+	char	   *path;
+	char	   *final_path;		/* NULL while the file is being written */
+	SubTransactionId subid;
+	struct ParquetPendingFile *next;
+} ParquetPendingFile;
+
+static ParquetPendingFile *pending_files = NULL;
+static bool xact_callbacks_registered = false;
+
+/* A qual of the form "column op constant" usable for row group pruning */
+typedef struct PruneQual
+{
+	AttrNumber	attno;
+	Oid			cmptype;		/* type the operator takes for the column */
+	int			strategy;		/* btree strategy, with the column on the left */
+	bool		var_on_left;
+	Datum		value;
+	Oid			collation;
+	FmgrInfo	cmp;			/* btree comparison proc of the operator */
+} PruneQual;
+
+typedef struct ParquetScanState
+{
+	MemoryContext filecxt;		/* current file: its metadata */
+	MemoryContext rgcxt;		/* current row group: readers and pages */
+	MemoryContext rowcxt;		/* current row */
+
+	Relation	rel;			/* only valid during the first call */
+	TupleDesc	tupdesc;
+	int			natts;
+	bool	   *needed;			/* needed[attno - 1]: decode this column */
+	List	   *quals;			/* PruneQuals */
+
+	char	  **files;
+	int			nfiles;
+	int			segid;
+	int			segnum;
+
+	/* position in the files */
+	int			fileno;			/* current file, -1 before the first */
+	ParquetFile *pf;
+	int		   *att_leaf;		/* leaf of each attribute in pf, -1 if none */
+	int			rowgroup;		/* next row group of pf to consider */
+	int64		unitno;			/* row groups seen so far in all files */
+
+	ParquetColumnReader **readers;	/* per attribute, NULL if not read */
+	int64		rows_left;		/* in the current row group */
+	Datum	   *values;
+	bool	   *nulls;
+
+	StringInfoData out;			/* encoded tuples not yet returned */
+	bool		eof;
+} ParquetScanState;
+
+/* ----------------------------------------------------------------
+ * Setup
+ * ----------------------------------------------------------------
+ */
+
+static uint64
+parquet_get_stream_token(void)
+{
+	if (parquet_stream_token == 0)
+		parquet_stream_token = (((uint64) random() << 32) ^ (uint64) random() ^
+								(uint64) GetCurrentTimestamp() ^ (uint64) MyProcPid) | 1;
+	return parquet_stream_token;
+}
+
+static const char *
+parquet_url_path(const char *url)
+{
+	if (pg_strncasecmp(url, PARQUET_URL_PREFIX, strlen(PARQUET_URL_PREFIX)) != 0 ||
+		url[strlen(PARQUET_URL_PREFIX)] != '/')
+		ereport(ERROR,
+				(errcode(ERRCODE_SYNTAX_ERROR),
+				 errmsg("invalid parquet URL \"%s\"", url),
+				 errhint("The URL must have the form parquet:///absolute/path.")));
+	return url + strlen(PARQUET_URL_PREFIX);
+}
+
+static int
+compare_filenames(const void *a, const void *b)
+{
+	return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+static bool
+is_regular_file(const char *path)
+{
+	struct stat st;
+
+	return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+/*
+ * Expand the path of the URL into a sorted list of files. A directory
+ * stands for the files in it, skipping hidden files and files starting with
+ * an underscore, like the _SUCCESS markers of Spark and Hive jobs.
+ */
+static void
+list_files(ParquetScanState *st, const char *path)
+{
+	struct stat stbuf;
+	int			nalloc = 16;
+
+	st->files = palloc(sizeof(char *) * nalloc);
+	st->nfiles = 0;
+
+	if (stat(path, &stbuf) == 0 && S_ISDIR(stbuf.st_mode))
+	{
+		DIR		   *dir = AllocateDir(path);
+		struct dirent *de;
+
+		while ((de = ReadDir(dir, path)) != NULL)
+		{
+			char	   *file;
+
+			if (de->d_name[0] == '.' || de->d_name[0] == '_')
+				continue;
+			file = psprintf("%s/%s", path, de->d_name);
+			if (!is_regular_file(file))
+			{
+				pfree(file);
+				continue;
+			}
+			if (st->nfiles == nalloc)
+			{
+				nalloc *= 2;
+				st->files = repalloc(st->files, sizeof(char *) * nalloc);
+			}
+			st->files[st->nfiles++] = file;
+		}
+		FreeDir(dir);
+	}
+	else if (strpbrk(path, "*?[") != NULL)
+	{
+		glob_t		g;
+		size_t		i;
+		int			rc = glob(path, 0, NULL, &g);
+
+		if (rc != 0 && rc != GLOB_NOMATCH)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not expand file pattern \"%s\"", path)));
+		for (i = 0; rc == 0 && i < g.gl_pathc; i++)
+		{
+			if (!is_regular_file(g.gl_pathv[i]))
+				continue;
+			if (st->nfiles == nalloc)
+			{
+				nalloc *= 2;
+				st->files = repalloc(st->files, sizeof(char *) * nalloc);
+			}
+			st->files[st->nfiles++] = pstrdup(g.gl_pathv[i]);
+		}
+		globfree(&g);
+
+		if (st->nfiles == 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FILE),
+					 errmsg("no files match \"%s\"", path)));
+	}
+	else
+		st->files[st->nfiles++] = pstrdup(path);
+
+	qsort(st->files, st->nfiles, sizeof(char *), compare_filenames);
+}
+
+typedef struct VarCollector
+{
+	bool	   *needed;
+	int			natts;
+	bool		whole_row;
+} VarCollector;
+
+static bool
+collect_vars_walker(Node *node, VarCollector *ctx)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Var))
+	{
+		Var		   *var = (Var *) node;
+
+		if (var->varattno == InvalidAttrNumber)
+			ctx->whole_row = true;
+		else if (var->varattno > 0 && var->varattno <= ctx->natts)
+			ctx->needed[var->varattno - 1] = true;
+		return false;
+	}
+	return expression_tree_walker(node, collect_vars_walker, (void *) ctx);
+}
+
+/*
+ * Work out which columns the scan needs. When we can't tell, e.g. because
+ * the quals were not passed down to us or the table has CHECK constraints
+ * that the executor evaluates on the scan tuple, read all of them.
+ */
+static void
+set_needed_columns(ParquetScanState *st, ExternalSelectDesc desc)
+{
+	ProjectionInfo *proj = desc ? desc->projInfo : NULL;
+	TupleConstr *constr = st->tupdesc->constr;
+	VarCollector ctx;
+	ListCell   *lc;
+	int			i;
+
+	st->needed = palloc0(sizeof(bool) * Max(st->natts, 1));
+
+	if (proj == NULL || !gp_external_enable_filter_pushdown ||
+		(constr && constr->num_check > 0))
+	{
+		for (i = 0; i < st->natts; i++)
+			st->needed[i] = true;
+		return;
+	}
+
+	ctx.needed = st->needed;
+	ctx.natts = st->natts;
+	ctx.whole_row = false;
+
+	for (i = 0; i < proj->pi_numSimpleVars; i++)
+	{
+		int			attno = proj->pi_varNumbers[i];
+
+		if (attno > 0 && attno <= st->natts)
+			st->needed[attno - 1] = true;
+	}
+	foreach(lc, proj->pi_targetlist)
+	{
+		GenericExprState *gstate = (GenericExprState *) lfirst(lc);
+
+		collect_vars_walker((Node *) gstate->arg->expr, &ctx);
+	}
+	collect_vars_walker((Node *) desc->filter_quals, &ctx);
+
+	if (ctx.whole_row)
+	{
+		for (i = 0; i < st->natts; i++)
+			st->needed[i] = true;
+	}
+}
+
+/*
+ * Pick the quals of the form "column op constant", with a btree operator,
+ * that row group statistics can refute.
+ */
+static void
+set_prune_quals(ParquetScanState *st, List *quals)
+{
+	ListCell   *lc;
+
+	foreach(lc, quals)
+	{
+		OpExpr	   *op = (OpExpr *) lfirst(lc);
+		Node	   *left;
+		Node	   *right;
+		Var		   *var;
+		Const	   *con;
+		bool		var_on_left;
+		Oid			cmptype;
+		Oid			opclass;
+		Oid			opfamily;
+		Oid			cmpproc;
+		int			strategy;
+		PruneQual  *pq;
+
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+			continue;
+
+		left = (Node *) linitial(op->args);
+		right = (Node *) lsecond(op->args);
+		var_on_left = !IsA(left, Const);
+		cmptype = exprType(var_on_left ? left : right);
+
+		while (IsA(left, RelabelType))
+			left = (Node *) ((RelabelType *) left)->arg;
+		while (IsA(right, RelabelType))
+			right = (Node *) ((RelabelType *) right)->arg;
+
+		if (var_on_left && IsA(left, Var) && IsA(right, Const))
+		{
+			var = (Var *) left;
+			con = (Const *) right;
+		}
+		else if (!var_on_left && IsA(right, Var) && IsA(left, Const))
+		{
+			var = (Var *) right;
+			con = (Const *) left;
+		}
+		else
+			continue;
+
+		if (var->varattno <= 0 || var->varattno > st->natts || con->constisnull)
+			continue;
+
+		/* NaNs make the min/max of floating point columns unreliable */
+		if (cmptype == FLOAT4OID || cmptype == FLOAT8OID)
+			continue;
+
+		/* Parquet orders strings by their bytes */
+		if (type_is_collatable(cmptype) && !lc_collate_is_c(op->inputcollid))
+			continue;
+
+		opclass = GetDefaultOpClass(cmptype, BTREE_AM_OID);
+		if (!OidIsValid(opclass))
+			continue;
+		opfamily = get_opclass_family(opclass);
+		strategy = get_op_opfamily_strategy(op->opno, opfamily);
+		if (strategy == 0)
+			continue;
+		cmpproc = get_opfamily_proc(opfamily,
+									exprType(linitial(op->args)),
+									exprType(lsecond(op->args)),
+									BTORDER_PROC);
+		if (!OidIsValid(cmpproc))
+			continue;
+
+		pq = palloc(sizeof(PruneQual));
+		pq->attno = var->varattno;
+		pq->cmptype = cmptype;
+		pq->var_on_left = var_on_left;
+		pq->value = datumCopy(con->constvalue, con->constbyval, con->constlen);
+		pq->collation = op->inputcollid;
+		fmgr_info(cmpproc, &pq->cmp);
+
+		/* normalize to "column op constant" */
+		if (!var_on_left)
+		{
+			switch (strategy)
+			{
+				case BTLessStrategyNumber:
+					strategy = BTGreaterStrategyNumber;
+					break;
+				case BTLessEqualStrategyNumber:
+					strategy = BTGreaterEqualStrategyNumber;
+					break;
+				case BTGreaterEqualStrategyNumber:
+					strategy = BTLessEqualStrategyNumber;
+					break;
+				case BTGreaterStrategyNumber:
+					strategy = BTLessStrategyNumber;
+					break;
+			}
+		}
+		pq->strategy = strategy;
+
+		st->quals = lappend(st->quals, pq);
+	}
+}
+
+static ParquetScanState *
+create_scan_state(FunctionCallInfo fcinfo)
+{
+	ParquetScanState *st;
+	ExternalSelectDesc desc = EXTPROTOCOL_GET_EXTERNAL_SELECT_DESC(fcinfo);
+	uint64		token;
+
+	st = palloc0(sizeof(ParquetScanState));
+	st->rel = EXTPROTOCOL_GET_RELATION(fcinfo);
+	st->tupdesc = CreateTupleDescCopyConstr(RelationGetDescr(st->rel));
+	st->natts = st->tupdesc->natts;
+	st->filecxt = AllocSetContextCreate(CurrentMemoryContext,
+										"ParquetFileContext",
+										ALLOCSET_DEFAULT_MINSIZE,
+										ALLOCSET_DEFAULT_INITSIZE,
+										ALLOCSET_DEFAULT_MAXSIZE);
+	st->rgcxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "ParquetRowGroupContext",
+									  ALLOCSET_DEFAULT_MINSIZE,
+									  ALLOCSET_DEFAULT_INITSIZE,
+									  ALLOCSET_DEFAULT_MAXSIZE);
+	st->rowcxt = AllocSetContextCreate(CurrentMemoryContext,
+									   "ParquetRowContext",
+									   ALLOCSET_DEFAULT_MINSIZE,
+									   ALLOCSET_DEFAULT_INITSIZE,
+									   ALLOCSET_DEFAULT_MAXSIZE);
+
+	/* same convention as gpcloud: the master reads everything by itself */
+	if (GpIdentity.segindex < 0)
+	{
+		st->segid = 0;
+		st->segnum = 1;
+	}
+	else
+	{
+		st->segid = GpIdentity.segindex;
+		st->segnum = getgpsegmentCount();
+	}
+
+	/*
+	 * The select desc is only valid during this call; the executor builds a
+	 * new one for every tuple.
+	 */
+	set_needed_columns(st, desc);
+	if (desc && gp_external_enable_filter_pushdown)
+		set_prune_quals(st, desc->filter_quals);
+
+	list_files(st, parquet_url_path(EXTPROTOCOL_GET_URL(fcinfo)));
+
+	st->fileno = -1;
+	st->readers = palloc0(sizeof(ParquetColumnReader *) * Max(st->natts, 1));
+	st->values = palloc0(sizeof(Datum) * Max(st->natts, 1));
+	st->nulls = palloc0(sizeof(bool) * Max(st->natts, 1));
+	initStringInfo(&st->out);
+
+	/* stream header, see parquet_in */
+	token = parquet_get_stream_token();
+	appendBinaryStringInfo(&st->out, PARQUET_STREAM_MAGIC, 4);
+	appendBinaryStringInfo(&st->out, (char *) &token, sizeof(uint64));
+
+	return st;
+}
+
+/* ----------------------------------------------------------------
+ * Scanning
+ * ----------------------------------------------------------------
+ */
+
+static int
+skip_subtree(ParquetFileMetaData *meta, int idx)
+{
+	int			nchildren = meta->schema[idx].num_children;
+	int			i;
+
+	idx++;
+	for (i = 0; i < nchildren && idx < meta->nschema; i++)
+		idx = skip_subtree(meta, idx);
+	return idx;
+}
+
+/*
+ * Map the needed table columns to the leaf columns of the current file, by
+ * name. Table columns that the file doesn't have read as NULL, so that
+ * files written before a column was added can be read along newer ones.
+ */
+static void
+map_columns(ParquetScanState *st)
+{
+	ParquetFileMetaData *meta = st->pf->meta;
+	int			i;
+
+	if (st->att_leaf == NULL)
+		st->att_leaf = palloc(sizeof(int) * Max(st->natts, 1));
+
+	for (i = 0; i < st->natts; i++)
+	{
+		Form_pg_attribute attr = st->tupdesc->attrs[i];
+		const char *attname = NameStr(attr->attname);
+		int			leaf = -1;
+		int			pass;
+		int			j;
+
+		st->att_leaf[i] = -1;
+		if (attr->attisdropped || !st->needed[i])
+			continue;
+
+		/* exact match first, then case-insensitive */
+		for (pass = 0; pass < 2 && leaf < 0; pass++)
+		{
+			for (j = 0; j < meta->nleaves; j++)
+			{
+				const char *name = meta->schema[meta->leaf_schema[j]].name;
+
+				if (!meta->leaf_flat[j])
+					continue;
+				if (pass == 0 ? strcmp(name, attname) == 0 :
+					pg_strcasecmp(name, attname) == 0)
+				{
+					leaf = j;
+					break;
+				}
+			}
+		}
+
+		if (leaf < 0)
+		{
+			/* don't silently read a nested field as NULL */
+			int			idx = 1;
+
+			for (j = 0; j < meta->schema[0].num_children && idx < meta->nschema; j++)
+			{
+				if (pg_strcasecmp(meta->schema[idx].name, attname) == 0)
+					ereport(ERROR,
+							(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+							 errmsg("column \"%s\" in Parquet file \"%s\" is a nested or repeated field, which is not supported",
+									meta->schema[idx].name, st->pf->filename)));
+				idx = skip_subtree(meta, idx);
+			}
+		}
+
+		st->att_leaf[i] = leaf;
+	}
+}
+
+/*
+ * Can the statistics of the row group prove that no row satisfies the
+ * quals?
+ */
+static bool
+rowgroup_refuted(ParquetScanState *st, ParquetRowGroup *rg)
+{
+	ParquetFileMetaData *meta = st->pf->meta;
+	MemoryContext oldcxt;
+	bool		refuted = false;
+	ListCell   *lc;
+
+	if (st->quals == NIL)
+		return false;
+
+	oldcxt = MemoryContextSwitchTo(st->rowcxt);
+
+	foreach(lc, st->quals)
+	{
+		PruneQual  *pq = (PruneQual *) lfirst(lc);
+		Form_pg_attribute attr = st->tupdesc->attrs[pq->attno - 1];
+		int			leaf = st->att_leaf[pq->attno - 1];
+		ParquetColumnChunk *cc;
+		const ParquetSchemaElement *el;
+		Datum		min;
+		Datum		max;
+		int			cmin;
+		int			cmax;
+
+		if (leaf < 0)
+		{
+			/* the column is all NULL in this file, so no row qualifies */
+			refuted = true;
+			break;
+		}
+
+		cc = &rg->columns[leaf];
+		el = &meta->schema[meta->leaf_schema[leaf]];
+
+		/* btree operators are strict */
+		if (cc->stats.has_null_count && rg->num_rows > 0 &&
+			cc->stats.null_count >= rg->num_rows)
+		{
+			refuted = true;
+			break;
+		}
+
+		if (!cc->stats.has_min || !cc->stats.has_max)
+			continue;
+		if (parquet_column_pg_type(el, attr->atttypid) != pq->cmptype)
+			continue;
+		if (el->type == PQT_INT96)
+			continue;
+		/* the deprecated fields were sorted as signed bytes or integers */
+		if (cc->stats.legacy &&
+			(!(el->type == PQT_INT32 || el->type == PQT_INT64) ||
+			 (el->logical == PQL_INTEGER && !el->int_signed)))
+			continue;
+
+		min = parquet_value_to_datum(el, pq->cmptype, cc->stats.min, cc->stats.min_len);
+		max = parquet_value_to_datum(el, pq->cmptype, cc->stats.max, cc->stats.max_len);
+
+		if (pq->var_on_left)
+		{
+			cmin = DatumGetInt32(FunctionCall2Coll(&pq->cmp, pq->collation, min, pq->value));
+			cmax = DatumGetInt32(FunctionCall2Coll(&pq->cmp, pq->collation, max, pq->value));
+		}
+		else
+		{
+			/* the comparison proc takes the constant first */
+			cmin = DatumGetInt32(FunctionCall2Coll(&pq->cmp, pq->collation, pq->value, min));
+			cmax = DatumGetInt32(FunctionCall2Coll(&pq->cmp, pq->collation, pq->value, max));
+			cmin = (cmin < 0) ? 1 : (cmin > 0) ? -1 : 0;
+			cmax = (cmax < 0) ? 1 : (cmax > 0) ? -1 : 0;
+		}
+
+		switch (pq->strategy)
+		{
+			case BTLessStrategyNumber:
+				refuted = (cmin >= 0);
+				break;
+			case BTLessEqualStrategyNumber:
+				refuted = (cmin > 0);
+				break;
+			case BTEqualStrategyNumber:
+				refuted = (cmin > 0 || cmax < 0);
+				break;
+			case BTGreaterEqualStrategyNumber:
+				refuted = (cmax < 0);
+				break;
+			case BTGreaterStrategyNumber:
+				refuted = (cmax <= 0);
+				break;
+		}
+		if (refuted)
+			break;
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextReset(st->rowcxt);
+
+	return refuted;
+}
+
+/*
+ * Position the column readers on the next row group this segment should
+ * read. Returns false when there are none left.
+ */
+static bool
+next_rowgroup(ParquetScanState *st)
+{
+	MemoryContext oldcxt;
+
+	MemoryContextReset(st->rgcxt);
+	memset(st->readers, 0, sizeof(ParquetColumnReader *) * st->natts);
+
+	for (;;)
+	{
+		ParquetRowGroup *rg;
+		int			i;
+
+		if (st->pf == NULL || st->rowgroup >= st->pf->meta->nrowgroups)
+		{
+			if (st->pf)
+			{
+				parquet_close_file(st->pf);
+				st->pf = NULL;
+				MemoryContextReset(st->filecxt);
+			}
+			if (++st->fileno >= st->nfiles)
+				return false;
+
+			oldcxt = MemoryContextSwitchTo(st->filecxt);
+			st->pf = parquet_open_file(st->files[st->fileno]);
+			MemoryContextSwitchTo(oldcxt);
+			st->rowgroup = 0;
+			map_columns(st);
+			continue;
+		}
+
+		rg = &st->pf->meta->rowgroups[st->rowgroup++];
+		if (st->unitno++ % st->segnum != st->segid)
+			continue;
+		if (rg->num_rows <= 0 || rowgroup_refuted(st, rg))
+			continue;
+
+		oldcxt = MemoryContextSwitchTo(st->rgcxt);
+		for (i = 0; i < st->natts; i++)
+		{
+			Form_pg_attribute attr = st->tupdesc->attrs[i];
+
+			if (st->att_leaf[i] >= 0)
+				st->readers[i] = parquet_column_reader_create(st->pf, st->rowgroup - 1,
+															  st->att_leaf[i],
+															  attr->atttypid,
+															  attr->atttypmod);
+		}
+		MemoryContextSwitchTo(oldcxt);
+
+		st->rows_left = rg->num_rows;
+		return true;
+	}
+}
+
+/*
+ * Decode the next row and append it to the output buffer. Returns false at
+ * the end of the scan.
+ */
+static bool
+emit_row(ParquetScanState *st)
+{
+	MemoryContext oldcxt;
+	HeapTuple	tuple;
+	uint32		len;
+	int			i;
+
+	if (st->rows_left == 0 && !next_rowgroup(st))
+		return false;
+	st->rows_left--;
+
+	oldcxt = MemoryContextSwitchTo(st->rowcxt);
+	for (i = 0; i < st->natts; i++)
+	{
+		if (st->readers[i])
+			parquet_column_reader_next(st->readers[i], &st->values[i], &st->nulls[i]);
+		else
+		{
+			st->values[i] = (Datum) 0;
+			st->nulls[i] = true;
+		}
+	}
+	tuple = heap_form_tuple(st->tupdesc, st->values, st->nulls);
+	MemoryContextSwitchTo(oldcxt);
+
+	len = tuple->t_len;
+	appendBinaryStringInfo(&st->out, (char *) &len, sizeof(len));
+	appendBinaryStringInfo(&st->out, (char *) tuple->t_data, len);
+
+	MemoryContextReset(st->rowcxt);
+	return true;
+}
+
+/*
+ * Read data from Parquet files. The "data" we return is the stream of
+ * tuples that parquet_in unpacks.
+ */
+Datum
+parquet_import(PG_FUNCTION_ARGS)
+{
+	ParquetScanState *st;
+	char	   *databuf;
+	int			datlen;
+	int			nbytes;
+
+	if (!CALLED_AS_EXTPROTOCOL(fcinfo))
+		elog(ERROR, "parquet_import: not called by external protocol manager");
+
+	st = (ParquetScanState *) EXTPROTOCOL_GET_USER_CTX(fcinfo);
+
+	if (EXTPROTOCOL_IS_LAST_CALL(fcinfo))
+	{
+		if (st && st->pf)
+			parquet_close_file(st->pf);
+		PG_RETURN_INT32(0);
+	}
+
+	if (st == NULL)
+	{
+		st = create_scan_state(fcinfo);
+		EXTPROTOCOL_SET_USER_CTX(fcinfo, st);
+	}
+
+	databuf = EXTPROTOCOL_GET_DATABUF(fcinfo);
+	datlen = EXTPROTOCOL_GET_DATALEN(fcinfo);
+
+	while (!st->eof && st->out.len - st->out.cursor < datlen)
+	{
+		if (!emit_row(st))
+			st->eof = true;
+	}
+
+	nbytes = Min(datlen, st->out.len - st->out.cursor);
+	memcpy(databuf, st->out.data + st->out.cursor, nbytes);
+	st->out.cursor += nbytes;
+	if (st->out.cursor == st->out.len)
+		resetStringInfo(&st->out);
+	else if (st->out.cursor > st->out.len / 2)
+	{
+		/* keep the buffer from growing */
+		memmove(st->out.data, st->out.data + st->out.cursor,
+				st->out.len - st->out.cursor);
+		st->out.len -= st->out.cursor;
+		st->out.data[st->out.len] = '\0';
+		st->out.cursor = 0;
+	}
+
+	PG_RETURN_INT32(nbytes);
+}
+
+/* ----------------------------------------------------------------
+ * Writing
+ * ----------------------------------------------------------------
+ */
+
+typedef struct ParquetExportState
+{
+	char	   *dir;
+	TupleDesc	tupdesc;
+	ParquetWriteOptions opts;
+	ParquetWriter *pw;
+
+	bool		header_seen;
+	StringInfoData in;			/* data from parquet_out not yet consumed */
+	char	   *tupbuf;			/* aligned copy of the current tuple */
+	int			tupbuf_size;
+	Datum	   *values;
+	bool	   *nulls;
+
+	/* the file being written, if any */
+	int			fileno;
+	FILE	   *fp;
+	char	   *tmpname;
+	char	   *filename;
+} ParquetExportState;
+
+static void
+complete_pending_file(const char *path, const char *final_path)
+{
+	ParquetPendingFile *pf;
+
+	for (pf = pending_files; pf != NULL; pf = pf->next)
+	{
+		if (strcmp(pf->path, path) == 0)
+		{
+			pf->final_path = MemoryContextStrdup(TopMemoryContext, final_path);
+			return;
+		}
+	}
+}
+
+static void
+free_pending_file(ParquetPendingFile *pf)
+{
+	pfree(pf->path);
+	if (pf->final_path)
+		pfree(pf->final_path);
+	pfree(pf);
+}
+
+/*
+ * Move the complete files into place. This runs before commit, so a
+ * failure here still aborts the transaction.
+ */
+static void
+rename_pending_files(void)
+{
+	ParquetPendingFile **prev = &pending_files;
+	ParquetPendingFile *pf = pending_files;
+
+	while (pf != NULL)
+	{
+		ParquetPendingFile *next = pf->next;
+
+		if (pf->final_path != NULL)
+		{
+			if (rename(pf->path, pf->final_path) != 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not rename file \"%s\" to \"%s\": %m",
+								pf->path, pf->final_path)));
+			*prev = next;
+			free_pending_file(pf);
+		}
+		else
+			prev = &pf->next;
+		pf = next;
+	}
+}
+
+static void
+remove_pending_files(SubTransactionId subid)
+{
+	ParquetPendingFile **prev = &pending_files;
+	ParquetPendingFile *pf = pending_files;
+
+	while (pf != NULL)
+	{
+		ParquetPendingFile *next = pf->next;
+
+		if (subid == InvalidSubTransactionId || pf->subid == subid)
+		{
+			if (unlink(pf->path) != 0 && errno != ENOENT)
+				ereport(WARNING,
+						(errcode_for_file_access(),
+						 errmsg("could not remove file \"%s\": %m", pf->path)));
+			*prev = next;
+			free_pending_file(pf);
+		}
+		else
+			prev = &pf->next;
+		pf = next;
+	}
+}
+
+static void
+parquet_xact_callback(XactEvent event, void *arg)
+{
+	if (event == XACT_EVENT_PRE_COMMIT || event == XACT_EVENT_PRE_PREPARE)
+		rename_pending_files();
+
+	/*
+	 * A file still pending at the end of the transaction was never
+	 * completed, or the transaction aborted.
+	 */
+	else if (event == XACT_EVENT_ABORT || event == XACT_EVENT_COMMIT ||
+			 event == XACT_EVENT_PREPARE)
+		remove_pending_files(InvalidSubTransactionId);
+}
+
+static void
+parquet_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
+						 SubTransactionId parentSubid, void *arg)
+{
+	ParquetPendingFile *pf;
+
+	if (event == SUBXACT_EVENT_ABORT_SUB)
+		remove_pending_files(mySubid);
+	else if (event == SUBXACT_EVENT_COMMIT_SUB)
+	{
+		for (pf = pending_files; pf != NULL; pf = pf->next)
+		{
+			if (pf->subid == mySubid)
+				pf->subid = parentSubid;
+		}
+	}
+}
+
+static void
+remember_pending_file(const char *path)
+{
+	ParquetPendingFile *pf;
+
+	if (!xact_callbacks_registered)
+	{
+		RegisterXactCallback(parquet_xact_callback, NULL);
+		RegisterSubXactCallback(parquet_subxact_callback, NULL);
+		xact_callbacks_registered = true;
+	}
+
+	pf = MemoryContextAlloc(TopMemoryContext, sizeof(ParquetPendingFile));
+	pf->path = MemoryContextStrdup(TopMemoryContext, path);
+	pf->final_path = NULL;
+	pf->subid = GetCurrentSubTransactionId();
+	pf->next = pending_files;
+	pending_files = pf;
+}
+
+/*
+ * Start the next output file. It is written under a temporary name that
+ * starts with a dot, so that readers skip it until it is complete.
+ */
+static void
+open_output_file(ParquetExportState *st)
+{
+	char	   *dir = pstrdup(st->dir);
+	struct stat sb;
+
+	if (pg_mkdir_p(dir, S_IRWXU) != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create directory \"%s\": %m", st->dir)));
+	pfree(dir);
+
+	/* don't overwrite the output of an earlier statement */
+	for (;;)
+	{
+		st->filename = psprintf("%s/part-seg%d-%d-%d-%03d.parquet", st->dir,
+								GpIdentity.segindex, gp_session_id,
+								gp_command_count, st->fileno);
+		if (stat(st->filename, &sb) != 0 && errno == ENOENT)
+			break;
+		pfree(st->filename);
+		st->fileno++;
+	}
+	st->tmpname = psprintf("%s/.part-seg%d-%d-%d-%03d.parquet.tmp", st->dir,
+						   GpIdentity.segindex, gp_session_id,
+						   gp_command_count, st->fileno);
+
+	remember_pending_file(st->tmpname);
+	st->fp = AllocateFile(st->tmpname, PG_BINARY_W);
+	if (st->fp == NULL)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create file \"%s\": %m", st->tmpname)));
+}
+
+/*
+ * Write the footer of the current file. It is moved into place when the
+ * transaction commits.
+ */
+static void
+finish_output_file(ParquetExportState *st)
+{
+	parquet_writer_finish_file(st->pw, st->fp, st->tmpname);
+
+	if (FreeFile(st->fp) != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to file \"%s\": %m", st->tmpname)));
+	st->fp = NULL;
+
+	complete_pending_file(st->tmpname, st->filename);
+
+	pfree(st->tmpname);
+	pfree(st->filename);
+	st->tmpname = st->filename = NULL;
+	st->fileno++;
+}
+
+static void
+consume_header(ParquetExportState *st)
+{
+	uint64		token;
+
+	memcpy(&token, st->in.data + 4, sizeof(uint64));
+	if (memcmp(st->in.data, PARQUET_STREAM_MAGIC, 4) != 0 ||
+		token != parquet_get_stream_token())
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("the parquet protocol can only write data formatted by parquet_out")));
+	memcpy(&st->opts, st->in.data + PARQUET_STREAM_HDRLEN, sizeof(ParquetWriteOptions));
+	st->in.cursor = PARQUET_OUT_HDRLEN;
+	st->header_seen = true;
+
+	st->pw = parquet_writer_create(st->tupdesc, st->opts.codec,
+								   (int64) st->opts.rowgroup_size * 1024 * 1024);
+}
+
+/*
+ * Add one tuple, as sent by parquet_out, to the current row group.
+ */
+static void
+consume_tuple(ParquetExportState *st, const char *data, uint32 tlen)
+{
+	HeapTupleData tuple;
+
+	if (tlen > (uint32) st->tupbuf_size)
+	{
+		if (st->tupbuf)
+			pfree(st->tupbuf);
+		st->tupbuf_size = Max(tlen, 1024);
+		st->tupbuf = palloc(st->tupbuf_size);
+	}
+	memcpy(st->tupbuf, data, tlen);
+
+	tuple.t_len = tlen;
+	ItemPointerSetInvalid(&tuple.t_self);
+	tuple.t_data = (HeapTupleHeader) st->tupbuf;
+	if (tlen < offsetof(HeapTupleHeaderData, t_bits) ||
+		tuple.t_data->t_hoff > tlen ||
+		HeapTupleHeaderGetNatts(tuple.t_data) > st->tupdesc->natts)
+		elog(ERROR, "parquet_export: invalid tuple in input stream");
+
+	heap_deform_tuple(&tuple, st->tupdesc, st->values, st->nulls);
+
+	if (parquet_writer_add_row(st->pw, st->values, st->nulls))
+	{
+		int64		size;
+
+		if (st->fp == NULL)
+			open_output_file(st);
+		size = parquet_writer_flush_rowgroup(st->pw, st->fp, st->tmpname);
+		if (st->opts.file_size > 0 &&
+			size >= (int64) st->opts.file_size * 1024 * 1024)
+			finish_output_file(st);
+	}
+}
+
+/*
+ * Write rows to Parquet files. Each segment writes its own files into the
+ * directory of the location, rolling over to a new file when one reaches
+ * the file_size option of parquet_out.
+ */
+Datum
+parquet_export(PG_FUNCTION_ARGS)
+{
+	ParquetExportState *st;
+	char	   *databuf;
+	int			datlen;
+
+	if (!CALLED_AS_EXTPROTOCOL(fcinfo))
+		elog(ERROR, "parquet_export: not called by external protocol manager");
+
+	st = (ParquetExportState *) EXTPROTOCOL_GET_USER_CTX(fcinfo);
+
+	if (EXTPROTOCOL_IS_LAST_CALL(fcinfo))
+	{
+		if (st && st->pw &&
+			(st->fp != NULL || parquet_writer_pending_rows(st->pw) > 0))
+		{
+			if (st->fp == NULL)
+				open_output_file(st);
+			finish_output_file(st);
+		}
+		PG_RETURN_INT32(0);
+	}
+
+	if (st == NULL)
+	{
+		Relation	rel = EXTPROTOCOL_GET_RELATION(fcinfo);
+
+		st = palloc0(sizeof(ParquetExportState));
+		st->dir = pstrdup(parquet_url_path(EXTPROTOCOL_GET_URL(fcinfo)));
+		st->tupdesc = CreateTupleDescCopy(RelationGetDescr(rel));
+		st->values = palloc(sizeof(Datum) * Max(st->tupdesc->natts, 1));
+		st->nulls = palloc(sizeof(bool) * Max(st->tupdesc->natts, 1));
+		initStringInfo(&st->in);
+		EXTPROTOCOL_SET_USER_CTX(fcinfo, st);
+	}
+
+	databuf = EXTPROTOCOL_GET_DATABUF(fcinfo);
+	datlen = EXTPROTOCOL_GET_DATALEN(fcinfo);
+	appendBinaryStringInfo(&st->in, databuf, datlen);
+
+	if (!st->header_seen)
+	{
+		if (st->in.len < (int) PARQUET_OUT_HDRLEN)
+			PG_RETURN_INT32(datlen);
+		consume_header(st);
+	}
+
+	for (;;)
+	{
+		uint32		tlen;
+
+		if (st->in.len - st->in.cursor < (int) sizeof(uint32))
+			break;
+		memcpy(&tlen, st->in.data + st->in.cursor, sizeof(uint32));
+		if (st->in.len - st->in.cursor - (int) sizeof(uint32) < (int64) tlen)
+			break;
+		consume_tuple(st, st->in.data + st->in.cursor + sizeof(uint32), tlen);
+		st->in.cursor += sizeof(uint32) + tlen;
+	}
+
+	/* keep whatever is left of an incomplete tuple */
+	if (st->in.cursor == st->in.len)
+		resetStringInfo(&st->in);
+	else if (st->in.cursor > 0)
+	{
+		memmove(st->in.data, st->in.data + st->in.cursor,
+				st->in.len - st->in.cursor);
+		st->in.len -= st->in.cursor;
+		st->in.data[st->in.len] = '\0';
+		st->in.cursor = 0;
+	}
+
+	PG_RETURN_INT32(datlen);
+}
+
+Datum
+parquet_validate_urls(PG_FUNCTION_ARGS)
+{
+	int			nurls;
+	int			i;
+
+	if (!CALLED_AS_EXTPROTOCOL_VALIDATOR(fcinfo))
+		elog(ERROR, "parquet_validate_urls: not called by external protocol manager");
+
+	nurls = EXTPROTOCOL_VALIDATOR_GET_NUM_URLS(fcinfo);
+	if (nurls != 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("the parquet protocol takes exactly one location"),
+				 errhint("Use a directory or a file name pattern to read several files.")));
+
+	for (i = 1; i <= nurls; i++)
+	{
+		const char *path = parquet_url_path(EXTPROTOCOL_VALIDATOR_GET_NTH_URL(fcinfo, i));
+
+		/* each segment writes its own files into the directory */
+		if (EXTPROTOCOL_VALIDATOR_GET_DIRECTION(fcinfo) == EXT_VALIDATE_WRITE &&
+			strpbrk(path, "*?[") != NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("the location of a writable parquet table must be a directory"),
+					 errhint("The segments write their files into the directory, which is created if needed.")));
+	}
+
+	PG_RETURN_VOID();
+}
+
+/* ----------------------------------------------------------------
+ * Formatter
+ * ----------------------------------------------------------------
+ */
+
+typedef struct ParquetFormatState
+{
+	bool		header_seen;
+} ParquetFormatState;
+
+/*
+ * Unpack the tuples produced by parquet_import.
+ */
+Datum
+parquet_in(PG_FUNCTION_ARGS)
+{
+	ParquetFormatState *fs;
+	TupleDesc	tupdesc;
+	HeapTuple	tuple;
+	char	   *data;
+	int			len;
+	int			cur;
+	uint32		tlen;
+
+	if (!CALLED_AS_FORMATTER(fcinfo))
+		elog(ERROR, "parquet_in: not called by format manager");
+
+	tupdesc = FORMATTER_GET_TUPDESC(fcinfo);
+	fs = (ParquetFormatState *) FORMATTER_GET_USER_CTX(fcinfo);
+	if (fs == NULL)
+	{
+		fs = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(ParquetFormatState));
+		FORMATTER_SET_USER_CTX(fcinfo, fs);
+	}
+
+	data = FORMATTER_GET_DATABUF(fcinfo);
+	len = FORMATTER_GET_DATALEN(fcinfo);
+	cur = FORMATTER_GET_DATACURSOR(fcinfo);
+
+	if (!fs->header_seen)
+	{
+		uint64		token;
+
+		if (len - cur < (int) PARQUET_STREAM_HDRLEN)
+			FORMATTER_RETURN_NOTIFICATION(fcinfo, FMT_NEED_MORE_DATA);
+
+		memcpy(&token, data + cur + 4, sizeof(uint64));
+		if (memcmp(data + cur, PARQUET_STREAM_MAGIC, 4) != 0 ||
+			parquet_stream_token == 0 || token != parquet_stream_token)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("the parquet_in formatter can only be used with the parquet protocol")));
+		cur += PARQUET_STREAM_HDRLEN;
+		FORMATTER_SET_DATACURSOR(fcinfo, cur);
+		fs->header_seen = true;
+	}
+
+	if (len - cur < (int) sizeof(uint32))
+		FORMATTER_RETURN_NOTIFICATION(fcinfo, FMT_NEED_MORE_DATA);
+	memcpy(&tlen, data + cur, sizeof(uint32));
+	if (len - cur - (int) sizeof(uint32) < (int64) tlen)
+		FORMATTER_RETURN_NOTIFICATION(fcinfo, FMT_NEED_MORE_DATA);
+
+	tuple = (HeapTuple) palloc(HEAPTUPLESIZE + tlen);
+	tuple->t_len = tlen;
+	ItemPointerSetInvalid(&tuple->t_self);
+	tuple->t_data = (HeapTupleHeader) ((char *) tuple + HEAPTUPLESIZE);
+	memcpy(tuple->t_data, data + cur + sizeof(uint32), tlen);
+
+	if (tlen < offsetof(HeapTupleHeaderData, t_bits) ||
+		tuple->t_data->t_hoff > tlen ||
+		HeapTupleHeaderGetNatts(tuple->t_data) != tupdesc->natts)
+		elog(ERROR, "parquet_in: invalid tuple in input stream");
+
+	cur += sizeof(uint32) + tlen;
+	FORMATTER_SET_DATACURSOR(fcinfo, cur);
+	FORMATTER_SET_BYTE_NUMBER(fcinfo, sizeof(uint32) + tlen);
+
+	FORMATTER_SET_TUPLE(fcinfo, tuple);
+	FORMATTER_RETURN_TUPLE(tuple);
+}
+
+typedef struct ParquetOutState
+{
+	ParquetWriteOptions opts;
+	bool		header_sent;
+	bytea	   *buf;			/* result, reused for every row */
+	int			bufsize;
+} ParquetOutState;
+
+static int32
+parse_size_option(const char *key, const char *val, int32 min, int32 max)
+{
+	char	   *end;
+	long		v;
+
+	errno = 0;
+	v = strtol(val, &end, 10);
+	if (errno != 0 || end == val || *end != '\0' || v < min || v > max)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for parquet_out option \"%s\": \"%s\"", key, val),
+				 errdetail("Valid values are between %d and %d (megabytes).", min, max)));
+	return (int32) v;
+}
+
+static void
+parse_write_options(FunctionCallInfo fcinfo, ParquetWriteOptions *opts)
+{
+	int			nargs = FORMATTER_GET_NUM_ARGS(fcinfo);
+	int			i;
+
+	opts->codec = PQZ_SNAPPY;
+	opts->rowgroup_size = 64;
+	opts->file_size = 1024;
+
+	for (i = 1; i <= nargs; i++)
+	{
+		char	   *key = FORMATTER_GET_NTH_ARG_KEY(fcinfo, i);
+		char	   *val = FORMATTER_GET_NTH_ARG_VAL(fcinfo, i);
+
+		if (pg_strcasecmp(key, "compression") == 0)
+		{
+			if (pg_strcasecmp(val, "none") == 0 ||
+				pg_strcasecmp(val, "uncompressed") == 0)
+				opts->codec = PQZ_UNCOMPRESSED;
+			else if (pg_strcasecmp(val, "snappy") == 0)
+				opts->codec = PQZ_SNAPPY;
+#ifdef HAVE_LIBZ
+			else if (pg_strcasecmp(val, "gzip") == 0)
+				opts->codec = PQZ_GZIP;
+#endif
+#ifdef HAVE_LIBZSTD
+			else if (pg_strcasecmp(val, "zstd") == 0)
+				opts->codec = PQZ_ZSTD;
+#endif
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("unsupported parquet_out compression \"%s\"", val)));
+		}
+		else if (pg_strcasecmp(key, "rowgroup_size") == 0)
+			opts->rowgroup_size = parse_size_option(key, val, 1, 1024);
+		else if (pg_strcasecmp(key, "file_size") == 0)
+			opts->file_size = parse_size_option(key, val, 0, 1024 * 1024);
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("unrecognized parquet_out option \"%s\"", key)));
+	}
+}
+
+/*
+ * Pass the tuples of a writable table on to parquet_export, which does the
+ * encoding. The first row is preceded by a header with the writer options.
+ */
+Datum
+parquet_out(PG_FUNCTION_ARGS)
+{
+	HeapTupleHeader rec;
+	ParquetOutState *fs;
+	uint32		tlen;
+	int			len;
+	char	   *p;
+
+	if (!CALLED_AS_FORMATTER(fcinfo))
+		elog(ERROR, "parquet_out: not called by format manager");
+
+	rec = PG_GETARG_HEAPTUPLEHEADER(0);
+
+	fs = (ParquetOutState *) FORMATTER_GET_USER_CTX(fcinfo);
+	if (fs == NULL)
+	{
+		fs = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(ParquetOutState));
+		parse_write_options(fcinfo, &fs->opts);
+		FORMATTER_SET_USER_CTX(fcinfo, fs);
+	}
+
+	tlen = HeapTupleHeaderGetDatumLength(rec);
+	len = VARHDRSZ + sizeof(uint32) + tlen;
+	if (!fs->header_sent)
+		len += PARQUET_OUT_HDRLEN;
+
+	if (len > fs->bufsize)
+	{
+		if (fs->buf)
+			pfree(fs->buf);
+		fs->bufsize = Max(len, 1024);
+		fs->buf = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, fs->bufsize);
+	}
+
+	p = VARDATA(fs->buf);
+	if (!fs->header_sent)
+	{
+		uint64		token = parquet_get_stream_token();
+
+		memcpy(p, PARQUET_STREAM_MAGIC, 4);
+		memcpy(p + 4, &token, sizeof(uint64));
+		memcpy(p + PARQUET_STREAM_HDRLEN, &fs->opts, sizeof(ParquetWriteOptions));
+		p += PARQUET_OUT_HDRLEN;
+		fs->header_sent = true;
+	}
+	memcpy(p, &tlen, sizeof(uint32));
+	memcpy(p + sizeof(uint32), rec, tlen);
+	SET_VARSIZE(fs->buf, len);
+
+	PG_RETURN_BYTEA_P(fs->buf);
+}
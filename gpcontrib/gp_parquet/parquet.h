@@ -0,0 +1,303 @@
+/*-------------------------------------------------------------------------
+ *
+ * parquet.h
+ *	  Parquet file format definitions shared by the gp_parquet reader and
+ *	  writer and their Thrift metadata coder.
+ *
+ * Only the parts of the format that gp_parquet understands are modeled
+ * here: flat schemas of primitive columns, PLAIN and dictionary encoded
+ * data pages (v1 and v2), and the UNCOMPRESSED, SNAPPY, GZIP and ZSTD
+ * codecs. The writer produces a subset of that: PLAIN encoded v1 pages.
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/gp_parquet/parquet.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef GP_PARQUET_H
+#define GP_PARQUET_H
+
+#include "access/tupdesc.h"
+#include "lib/stringinfo.h"
+
+#define PARQUET_MAGIC			"PAR1"
+#define PARQUET_MAGIC_LEN		4
+#define PARQUET_FOOTER_LEN		8		/* metadata length + magic */
+
+/*
+ * Days between the Unix epoch, which Parquet dates and timestamps count
+ * from, and the PostgreSQL epoch (needs datatype/timestamp.h)
+ */
+#define PARQUET_EPOCH_SHIFT_DAYS	(POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE)
+
+/* parquet.thrift: Type */
+typedef enum ParquetPhysicalType
+{
+	PQT_BOOLEAN = 0,
+	PQT_INT32 = 1,
+	PQT_INT64 = 2,
+	PQT_INT96 = 3,
+	PQT_FLOAT = 4,
+	PQT_DOUBLE = 5,
+	PQT_BYTE_ARRAY = 6,
+	PQT_FIXED_LEN_BYTE_ARRAY = 7
+} ParquetPhysicalType;
+
+/* parquet.thrift: ConvertedType */
+typedef enum ParquetConvertedType
+{
+	PQC_NONE = -1,
+	PQC_UTF8 = 0,
+	PQC_MAP = 1,
+	PQC_MAP_KEY_VALUE = 2,
+	PQC_LIST = 3,
+	PQC_ENUM = 4,
+	PQC_DECIMAL = 5,
+	PQC_DATE = 6,
+	PQC_TIME_MILLIS = 7,
+	PQC_TIME_MICROS = 8,
+	PQC_TIMESTAMP_MILLIS = 9,
+	PQC_TIMESTAMP_MICROS = 10,
+	PQC_UINT_8 = 11,
+	PQC_UINT_16 = 12,
+	PQC_UINT_32 = 13,
+	PQC_UINT_64 = 14,
+	PQC_INT_8 = 15,
+	PQC_INT_16 = 16,
+	PQC_INT_32 = 17,
+	PQC_INT_64 = 18,
+	PQC_JSON = 19,
+	PQC_BSON = 20,
+	PQC_INTERVAL = 21
+} ParquetConvertedType;
+
+/* parquet.thrift: FieldRepetitionType */
+typedef enum ParquetRepetition
+{
+	PQR_REQUIRED = 0,
+	PQR_OPTIONAL = 1,
+	PQR_REPEATED = 2
+} ParquetRepetition;
+
+/* parquet.thrift: Encoding */
+typedef enum ParquetEncoding
+{
+	PQE_PLAIN = 0,
+	PQE_PLAIN_DICTIONARY = 2,
+	PQE_RLE = 3,
+	PQE_BIT_PACKED = 4,
+	PQE_DELTA_BINARY_PACKED = 5,
+	PQE_DELTA_LENGTH_BYTE_ARRAY = 6,
+	PQE_DELTA_BYTE_ARRAY = 7,
+	PQE_RLE_DICTIONARY = 8,
+	PQE_BYTE_STREAM_SPLIT = 9
+} ParquetEncoding;
+
+/* parquet.thrift: CompressionCodec */
+typedef enum ParquetCodec
+{
+	PQZ_UNCOMPRESSED = 0,
+	PQZ_SNAPPY = 1,
+	PQZ_GZIP = 2,
+	PQZ_LZO = 3,
+	PQZ_BROTLI = 4,
+	PQZ_LZ4 = 5,
+	PQZ_ZSTD = 6,
+	PQZ_LZ4_RAW = 7
+} ParquetCodec;
+
+/* parquet.thrift: PageType */
+typedef enum ParquetPageType
+{
+	PQP_DATA_PAGE = 0,
+	PQP_INDEX_PAGE = 1,
+	PQP_DICTIONARY_PAGE = 2,
+	PQP_DATA_PAGE_V2 = 3
+} ParquetPageType;
+
+/*
+ * The logical type annotation of a column, folded from either the
+ * LogicalType union or the legacy ConvertedType.
+ */
+typedef enum ParquetLogicalKind
+{
+	PQL_NONE = 0,
+	PQL_STRING,
+	PQL_DECIMAL,
+	PQL_DATE,
+	PQL_TIME,
+	PQL_TIMESTAMP,
+	PQL_INTEGER,
+	PQL_JSON,
+	PQL_UUID,
+	PQL_OTHER
+} ParquetLogicalKind;
+
+typedef enum ParquetTimeUnit
+{
+	PQU_MILLIS = 0,
+	PQU_MICROS,
+	PQU_NANOS
+} ParquetTimeUnit;
+
+typedef struct ParquetSchemaElement
+{
+	char	   *name;
+	int			type;			/* ParquetPhysicalType, -1 for groups */
+	int			type_length;	/* for FIXED_LEN_BYTE_ARRAY */
+	int			repetition;		/* ParquetRepetition */
+	int			num_children;
+	int			converted_type; /* ParquetConvertedType */
+	int			scale;
+	int			precision;
+
+	ParquetLogicalKind logical;
+	ParquetTimeUnit time_unit;	/* for PQL_TIME and PQL_TIMESTAMP */
+	bool		utc_adjusted;	/* for PQL_TIMESTAMP */
+	int			int_bits;		/* for PQL_INTEGER */
+	bool		int_signed;		/* for PQL_INTEGER */
+} ParquetSchemaElement;
+
+typedef struct ParquetStatistics
+{
+	bool		has_min;
+	bool		has_max;
+	bool		has_null_count;
+	bool		legacy;			/* min/max are read from, or also written to,
+								 * the deprecated fields */
+	int64		null_count;
+	char	   *min;
+	int			min_len;
+	char	   *max;
+	int			max_len;
+} ParquetStatistics;
+
+typedef struct ParquetColumnChunk
+{
+	int			type;			/* ParquetPhysicalType */
+	int			codec;			/* ParquetCodec */
+	int64		num_values;
+	int64		total_uncompressed_size;
+	int64		total_compressed_size;
+	int64		data_page_offset;
+	int64		dictionary_page_offset; /* -1 if none */
+	ParquetStatistics stats;
+} ParquetColumnChunk;
+
+typedef struct ParquetRowGroup
+{
+	int64		num_rows;
+	int64		total_byte_size;	/* uncompressed size of all columns */
+	int			ncolumns;
+	ParquetColumnChunk *columns;	/* one per leaf column */
+} ParquetRowGroup;
+
+typedef struct ParquetFileMetaData
+{
+	int64		num_rows;
+	int			nschema;
+	ParquetSchemaElement *schema;	/* depth-first, schema[0] is the root */
+	int			nrowgroups;
+	ParquetRowGroup *rowgroups;
+
+	/*
+	 * Leaf columns in column chunk order. leaf_flat[i] is true when the
+	 * leaf is a direct, non-repeated child of the root, i.e. a column that
+	 * maps onto a table column.
+	 */
+	int			nleaves;
+	int		   *leaf_schema;	/* index into schema[] */
+	bool	   *leaf_flat;
+} ParquetFileMetaData;
+
+typedef struct ParquetDataPageHeader
+{
+	int32		num_values;
+	int32		encoding;
+	int32		def_level_encoding;
+	int32		rep_level_encoding;
+} ParquetDataPageHeader;
+
+typedef struct ParquetDataPageHeaderV2
+{
+	int32		num_values;
+	int32		num_nulls;
+	int32		num_rows;
+	int32		encoding;
+	int32		def_levels_byte_length;
+	int32		rep_levels_byte_length;
+	bool		is_compressed;
+} ParquetDataPageHeaderV2;
+
+typedef struct ParquetDictionaryPageHeader
+{
+	int32		num_values;
+	int32		encoding;
+} ParquetDictionaryPageHeader;
+
+typedef struct ParquetPageHeader
+{
+	int32		type;			/* ParquetPageType */
+	int32		uncompressed_page_size;
+	int32		compressed_page_size;
+	ParquetDataPageHeader data;
+	ParquetDataPageHeaderV2 data_v2;
+	ParquetDictionaryPageHeader dict;
+} ParquetPageHeader;
+
+/* An open Parquet file and its decoded footer */
+typedef struct ParquetFile
+{
+	char	   *filename;
+	FILE	   *fp;
+	int64		file_size;
+	ParquetFileMetaData *meta;
+} ParquetFile;
+
+/* Decodes the values of one column chunk, row by row; see parquet_reader.c */
+typedef struct ParquetColumnReader ParquetColumnReader;
+
+/* Buffers rows and writes them out as row groups; see parquet_writer.c */
+typedef struct ParquetWriter ParquetWriter;
+
+/* parquet_thrift.c */
+extern ParquetFileMetaData *parquet_parse_file_metadata(const char *buf, int len,
+							const char *filename);
+extern int	parquet_parse_page_header(const char *buf, int len,
+						  ParquetPageHeader *hdr);
+extern void parquet_write_file_metadata(StringInfo buf,
+							const ParquetFileMetaData *meta,
+							const char *created_by);
+extern void parquet_write_page_header(StringInfo buf,
+						  const ParquetPageHeader *hdr);
+
+/* parquet_codec.c */
+extern void parquet_decompress(int codec, const char *src, int srclen,
+				   char *dst, int dstlen);
+extern void parquet_compress(int codec, const char *src, int srclen,
+				 StringInfo dst);
+
+/* parquet_reader.c */
+extern ParquetFile *parquet_open_file(const char *filename);
+extern void parquet_close_file(ParquetFile *pf);
+extern Oid	parquet_column_pg_type(const ParquetSchemaElement *el, Oid atttypid);
+extern Datum parquet_value_to_datum(const ParquetSchemaElement *el, Oid pgtype,
+					   const char *raw, int len);
+extern ParquetColumnReader *parquet_column_reader_create(ParquetFile *pf,
+							 int rowgroup, int leaf,
+							 Oid atttypid, int32 atttypmod);
+extern void parquet_column_reader_next(ParquetColumnReader *cr,
+						   Datum *value, bool *isnull);
+
+/* parquet_writer.c */
+extern ParquetWriter *parquet_writer_create(TupleDesc tupdesc, int codec,
+					  int64 rowgroup_size);
+extern bool parquet_writer_add_row(ParquetWriter *pw, Datum *values,
+					   bool *isnull);
+extern int64 parquet_writer_pending_rows(ParquetWriter *pw);
+extern int64 parquet_writer_flush_rowgroup(ParquetWriter *pw, FILE *fp,
+							  const char *filename);
+extern void parquet_writer_finish_file(ParquetWriter *pw, FILE *fp,
+						   const char *filename);
+
+#endif   /* GP_PARQUET_H */
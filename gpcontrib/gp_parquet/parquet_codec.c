@@ -0,0 +1,413 @@
+/*-------------------------------------------------------------------------
+ *
+ * parquet_codec.c
+ *	  Page compression and decompression for gp_parquet.
+ *
+ * SNAPPY is what most Parquet writers use by default. The raw snappy format
+ * is simple enough that we encode and decode it ourselves instead of adding
+ * a library dependency. GZIP and ZSTD use the libraries the server is
+ * already built with, when available.
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/gp_parquet/parquet_codec.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+#include "parquet.h"
+
+static void corrupt_page(const char *codec) pg_attribute_noreturn();
+
+static void
+corrupt_page(const char *codec)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_DATA_CORRUPTED),
+			 errmsg("could not decompress %s compressed Parquet page", codec)));
+}
+
+/*
+ * Decode a raw snappy block. dst must be exactly the uncompressed size.
+ */
+static void
+snappy_decompress(const uint8 *src, int srclen, uint8 *dst, int dstlen)
+{
+	const uint8 *sp = src;
+	const uint8 *send = src + srclen;
+	uint8	   *dp = dst;
+	uint8	   *dend = dst + dstlen;
+	uint32		ulen = 0;
+	int			shift = 0;
+
+	/* preamble: uncompressed length as a varint */
+	for (;;)
+	{
+		if (sp >= send || shift > 28)
+			corrupt_page("SNAPPY");
+		ulen |= (uint32) (*sp & 0x7F) << shift;
+		if ((*sp++ & 0x80) == 0)
+			break;
+		shift += 7;
+	}
+	if (ulen != (uint32) dstlen)
+		corrupt_page("SNAPPY");
+
+	while (sp < send)
+	{
+		uint8		tag = *sp++;
+		uint32		len;
+		uint32		offset;
+
+		switch (tag & 0x03)
+		{
+			case 0:				/* literal */
+				len = tag >> 2;
+				if (len >= 60)
+				{
+					int			nbytes = len - 59;
+					int			i;
+
+					if (send - sp < nbytes)
+						corrupt_page("SNAPPY");
+					len = 0;
+					for (i = 0; i < nbytes; i++)
+						len |= (uint32) sp[i] << (8 * i);
+					sp += nbytes;
+				}
+				len += 1;
+				if ((uint32) (send - sp) < len || (uint32) (dend - dp) < len)
+					corrupt_page("SNAPPY");
+				memcpy(dp, sp, len);
+				sp += len;
+				dp += len;
+				continue;
+
+			case 1:				/* copy with 1-byte offset */
+				if (sp >= send)
+					corrupt_page("SNAPPY");
+				len = 4 + ((tag >> 2) & 0x07);
+				offset = ((uint32) (tag >> 5) << 8) | *sp++;
+				break;
+
+			case 2:				/* copy with 2-byte offset */
+				if (send - sp < 2)
+					corrupt_page("SNAPPY");
+				len = (tag >> 2) + 1;
+				offset = sp[0] | ((uint32) sp[1] << 8);
+				sp += 2;
+				break;
+
+			default:			/* copy with 4-byte offset */
+				if (send - sp < 4)
+					corrupt_page("SNAPPY");
+				len = (tag >> 2) + 1;
+				offset = sp[0] | ((uint32) sp[1] << 8) |
+					((uint32) sp[2] << 16) | ((uint32) sp[3] << 24);
+				sp += 4;
+				break;
+		}
+
+		if (offset == 0 || offset > (uint32) (dp - dst) ||
+			(uint32) (dend - dp) < len)
+			corrupt_page("SNAPPY");
+
+		if (offset >= len)
+			memcpy(dp, dp - offset, len);
+		else
+		{
+			/* overlapping copy repeats the last 'offset' bytes */
+			const uint8 *from = dp - offset;
+			uint32		i;
+
+			for (i = 0; i < len; i++)
+				dp[i] = from[i];
+		}
+		dp += len;
+	}
+
+	if (dp != dend)
+		corrupt_page("SNAPPY");
+}
+
+#ifdef HAVE_LIBZ
+static void
+gzip_decompress(const char *src, int srclen, char *dst, int dstlen)
+{
+	z_stream	zs;
+	int			ret;
+
+	memset(&zs, 0, sizeof(zs));
+	/* 32 + MAX_WBITS: accept both gzip and zlib headers */
+	if (inflateInit2(&zs, 32 + MAX_WBITS) != Z_OK)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("could not initialize zlib decompressor")));
+
+	zs.next_in = (Bytef *) src;
+	zs.avail_in = srclen;
+	zs.next_out = (Bytef *) dst;
+	zs.avail_out = dstlen;
+
+	ret = inflate(&zs, Z_FINISH);
+	inflateEnd(&zs);
+
+	if (ret != Z_STREAM_END || zs.total_out != (uLong) dstlen)
+		corrupt_page("GZIP");
+}
+#endif
+
+/*
+ * Decompress one Parquet page. dstlen is the uncompressed page size from
+ * the page header, and the output must fill it exactly.
+ */
+void
+parquet_decompress(int codec, const char *src, int srclen,
+				   char *dst, int dstlen)
+{
+	switch (codec)
+	{
+		case PQZ_UNCOMPRESSED:
+			if (srclen != dstlen)
+				corrupt_page("UNCOMPRESSED");
+			memcpy(dst, src, srclen);
+			return;
+
+		case PQZ_SNAPPY:
+			snappy_decompress((const uint8 *) src, srclen, (uint8 *) dst, dstlen);
+			return;
+
+		case PQZ_GZIP:
+#ifdef HAVE_LIBZ
+			gzip_decompress(src, srclen, dst, dstlen);
+			return;
+#else
+			break;
+#endif
+
+		case PQZ_ZSTD:
+#ifdef HAVE_LIBZSTD
+			{
+				size_t		ret = ZSTD_decompress(dst, dstlen, src, srclen);
+
+				if (ZSTD_isError(ret) || ret != (size_t) dstlen)
+					corrupt_page("ZSTD");
+				return;
+			}
+#else
+			break;
+#endif
+
+		default:
+			break;
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("Parquet compression codec %d is not supported", codec)));
+}
+
+/*
+ * Snappy compression: a greedy match finder over a hash table of 4-byte
+ * sequences. It does not compress as well as the reference implementation,
+ * but the output is valid snappy that any reader can decode.
+ */
+#define SNAPPY_HASH_BITS	14
+#define SNAPPY_MAX_OFFSET	65535
+
+static inline uint32
+snappy_load32(const uint8 *p)
+{
+	uint32		v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static void
+snappy_put_literal(StringInfo dst, const uint8 *lit, uint32 len)
+{
+	uint32		n = len - 1;
+
+	if (len == 0)
+		return;
+	if (n < 60)
+		appendStringInfoCharMacro(dst, (char) (n << 2));
+	else
+	{
+		int			nbytes = (n < (1 << 8)) ? 1 : (n < (1 << 16)) ? 2 :
+		(n < (1 << 24)) ? 3 : 4;
+		int			i;
+
+		appendStringInfoCharMacro(dst, (char) ((59 + nbytes) << 2));
+		for (i = 0; i < nbytes; i++)
+			appendStringInfoCharMacro(dst, (char) ((n >> (8 * i)) & 0xFF));
+	}
+	appendBinaryStringInfo(dst, (const char *) lit, len);
+}
+
+static void
+snappy_put_copy(StringInfo dst, uint32 offset, uint32 len)
+{
+	/* a 2-byte offset copy holds up to 64 bytes; keep the tail >= 4 */
+	while (len >= 68)
+	{
+		appendStringInfoCharMacro(dst, (char) (((64 - 1) << 2) | 2));
+		appendStringInfoCharMacro(dst, (char) (offset & 0xFF));
+		appendStringInfoCharMacro(dst, (char) (offset >> 8));
+		len -= 64;
+	}
+	if (len > 64)
+	{
+		appendStringInfoCharMacro(dst, (char) (((60 - 1) << 2) | 2));
+		appendStringInfoCharMacro(dst, (char) (offset & 0xFF));
+		appendStringInfoCharMacro(dst, (char) (offset >> 8));
+		len -= 60;
+	}
+
+	if (len < 12 && offset < 2048)
+	{
+		appendStringInfoCharMacro(dst, (char) (((offset >> 8) << 5) | ((len - 4) << 2) | 1));
+		appendStringInfoCharMacro(dst, (char) (offset & 0xFF));
+	}
+	else
+	{
+		appendStringInfoCharMacro(dst, (char) (((len - 1) << 2) | 2));
+		appendStringInfoCharMacro(dst, (char) (offset & 0xFF));
+		appendStringInfoCharMacro(dst, (char) (offset >> 8));
+	}
+}
+
+static void
+snappy_compress(const uint8 *src, int srclen, StringInfo dst)
+{
+	int32	   *table;
+	uint32		ulen = srclen;
+	int			ip = 0;
+	int			lit = 0;
+
+	/* preamble: uncompressed length as a varint */
+	while (ulen >= 0x80)
+	{
+		appendStringInfoCharMacro(dst, (char) ((ulen & 0x7F) | 0x80));
+		ulen >>= 7;
+	}
+	appendStringInfoCharMacro(dst, (char) ulen);
+
+	table = palloc(sizeof(int32) << SNAPPY_HASH_BITS);
+	memset(table, -1, sizeof(int32) << SNAPPY_HASH_BITS);
+
+	while (ip + 4 <= srclen)
+	{
+		uint32		cur = snappy_load32(src + ip);
+		uint32		h = (cur * 0x1E35A7BD) >> (32 - SNAPPY_HASH_BITS);
+		int32		cand = table[h];
+
+		table[h] = ip;
+		if (cand >= 0 && ip - cand <= SNAPPY_MAX_OFFSET &&
+			snappy_load32(src + cand) == cur)
+		{
+			int			len = 4;
+
+			while (ip + len < srclen && src[cand + len] == src[ip + len])
+				len++;
+			snappy_put_literal(dst, src + lit, ip - lit);
+			snappy_put_copy(dst, ip - cand, len);
+			ip += len;
+			lit = ip;
+		}
+		else
+			ip++;
+	}
+	snappy_put_literal(dst, src + lit, srclen - lit);
+
+	pfree(table);
+}
+
+#ifdef HAVE_LIBZ
+static void
+gzip_compress(const char *src, int srclen, StringInfo dst)
+{
+	z_stream	zs;
+	int			ret;
+
+	memset(&zs, 0, sizeof(zs));
+	/* 16 + MAX_WBITS: write a gzip header, as the Parquet spec requires */
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS,
+					 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("could not initialize zlib compressor")));
+
+	enlargeStringInfo(dst, deflateBound(&zs, srclen));
+	zs.next_in = (Bytef *) src;
+	zs.avail_in = srclen;
+	zs.next_out = (Bytef *) dst->data + dst->len;
+	zs.avail_out = dst->maxlen - dst->len - 1;
+
+	ret = deflate(&zs, Z_FINISH);
+	dst->len += zs.total_out;
+	deflateEnd(&zs);
+
+	if (ret != Z_STREAM_END)
+		elog(ERROR, "could not compress Parquet page: zlib error %d", ret);
+}
+#endif
+
+/*
+ * Compress one Parquet page, appending the result to dst.
+ */
+void
+parquet_compress(int codec, const char *src, int srclen, StringInfo dst)
+{
+	switch (codec)
+	{
+		case PQZ_UNCOMPRESSED:
+			appendBinaryStringInfo(dst, src, srclen);
+			return;
+
+		case PQZ_SNAPPY:
+			snappy_compress((const uint8 *) src, srclen, dst);
+			return;
+
+		case PQZ_GZIP:
+#ifdef HAVE_LIBZ
+			gzip_compress(src, srclen, dst);
+			return;
+#else
+			break;
+#endif
+
+		case PQZ_ZSTD:
+#ifdef HAVE_LIBZSTD
+			{
+				size_t		bound = ZSTD_compressBound(srclen);
+				size_t		ret;
+
+				enlargeStringInfo(dst, bound);
+				ret = ZSTD_compress(dst->data + dst->len, bound, src, srclen, 3);
+				if (ZSTD_isError(ret))
+					elog(ERROR, "could not compress Parquet page: %s",
+						 ZSTD_getErrorName(ret));
+				dst->len += ret;
+				return;
+			}
+#else
+			break;
+#endif
+
+		default:
+			break;
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("Parquet compression codec %d is not supported", codec)));
+}
@@ -0,0 +1,1081 @@
+/*-------------------------------------------------------------------------
+ *
+ * parquet_reader.c
+ *	  Read column chunks of a Parquet file and convert their values to
+ *	  Datums of the external table's column types.
+ *
+ * Each column chunk is read into memory in one piece, and then decoded a
+ * page at a time as rows are requested. Dictionary pages are converted to
+ * Datums once per column chunk, so dictionary encoded columns, which are
+ * the common case for strings, cost one array lookup per value.
+ *
+ * Values are first decoded into the PostgreSQL type that corresponds to
+ * the column's Parquet type and annotation (see parquet_column_pg_type).
+ * If the table column has a different type, the value is converted with
+ * the output and input functions, like an explicit cast through text.
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/gp_parquet/parquet_reader.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/pg_type.h"
+#include "datatype/timestamp.h"
+#include "mb/pg_wchar.h"
+#include "storage/fd.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+#include "utils/uuid.h"
+
+#include "parquet.h"
+
+/*
+ * Decoder for the RLE / bit-packing hybrid encoding, used for definition
+ * levels, dictionary indexes and RLE encoded booleans.
+ */
+typedef struct RleDecoder
+{
+	const uint8 *p;
+	const uint8 *end;
+	int			bit_width;
+	uint32		rle_count;		/* values left in the current RLE run */
+	uint32		rle_value;
+	uint32		bp_count;		/* values left in the current bit-packed run */
+	const uint8 *bp;			/* start of the bit-packed run */
+	uint64		bp_bitpos;
+} RleDecoder;
+
+struct ParquetColumnReader
+{
+	ParquetFile *pf;
+	const ParquetSchemaElement *el;
+	const ParquetColumnChunk *cc;
+	MemoryContext mcxt;			/* for pages and dictionary */
+	int			max_def;		/* 0 for REQUIRED, 1 for OPTIONAL */
+
+	/* conversion from the Parquet value to the table column */
+	Oid			pgtype;			/* type produced by parquet_value_to_datum */
+	bool		io_convert;
+	FmgrInfo	out_func;
+	FmgrInfo	in_func;
+	Oid			in_ioparam;
+	int32		atttypmod;
+
+	/* the whole column chunk, as stored in the file */
+	char	   *chunk;
+	int64		chunk_len;
+	int64		chunk_pos;
+
+	/* current data page */
+	char	   *page;
+	int			page_alloc;
+	int			page_values;	/* values left, including nulls */
+	int			encoding;
+	RleDecoder	def;
+	const uint8 *vp;			/* PLAIN values */
+	const uint8 *vend;
+	int			bool_bit;		/* next bit of a PLAIN boolean byte */
+	RleDecoder	idx;			/* dictionary indexes or RLE booleans */
+
+	Datum	   *dict;
+	int			ndict;
+};
+
+static void corrupt_column(ParquetColumnReader *cr) pg_attribute_noreturn();
+
+static void
+corrupt_column(ParquetColumnReader *cr)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_DATA_CORRUPTED),
+			 errmsg("invalid data in column \"%s\" of Parquet file \"%s\"",
+					cr->el->name, cr->pf->filename)));
+}
+
+static inline uint32
+pq_get_uint32(const uint8 *p)
+{
+	return (uint32) p[0] | ((uint32) p[1] << 8) |
+		((uint32) p[2] << 16) | ((uint32) p[3] << 24);
+}
+
+static inline int64
+pq_get_int64(const uint8 *p)
+{
+	return (int64) ((uint64) pq_get_uint32(p) | ((uint64) pq_get_uint32(p + 4) << 32));
+}
+
+/* ----------------------------------------------------------------
+ * File access
+ * ----------------------------------------------------------------
+ */
+
+static void
+pq_read_at(ParquetFile *pf, int64 offset, char *buf, int64 len)
+{
+	if (offset < 0 || len < 0 || offset + len > pf->file_size)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid offset in Parquet file \"%s\"", pf->filename)));
+
+	if (fseeko(pf->fp, (off_t) offset, SEEK_SET) != 0 ||
+		fread(buf, 1, len, pf->fp) != (size_t) len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\": %m", pf->filename)));
+}
+
+/*
+ * Open a Parquet file and decode its footer.
+ *
+ * The file is opened with AllocateFile, so it is closed automatically if
+ * the query is aborted.
+ */
+ParquetFile *
+parquet_open_file(const char *filename)
+{
+	ParquetFile *pf;
+	char		footer[PARQUET_FOOTER_LEN];
+	uint32		metalen;
+	char	   *metabuf;
+
+	pf = palloc0(sizeof(ParquetFile));
+	pf->filename = pstrdup(filename);
+	pf->fp = AllocateFile(filename, PG_BINARY_R);
+	if (pf->fp == NULL)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\" for reading: %m", filename)));
+
+	if (fseeko(pf->fp, 0, SEEK_END) != 0 || (pf->file_size = ftello(pf->fp)) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not seek in file \"%s\": %m", filename)));
+
+	if (pf->file_size < PARQUET_MAGIC_LEN + PARQUET_FOOTER_LEN)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("file \"%s\" is not a Parquet file", filename)));
+
+	pq_read_at(pf, pf->file_size - PARQUET_FOOTER_LEN, footer, PARQUET_FOOTER_LEN);
+	if (memcmp(footer + 4, PARQUET_MAGIC, PARQUET_MAGIC_LEN) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("file \"%s\" is not a Parquet file", filename)));
+
+	metalen = pq_get_uint32((const uint8 *) footer);
+	if (metalen > pf->file_size - PARQUET_MAGIC_LEN - PARQUET_FOOTER_LEN ||
+		metalen > MaxAllocSize)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid Parquet metadata in file \"%s\"", filename)));
+
+	metabuf = palloc(metalen);
+	pq_read_at(pf, pf->file_size - PARQUET_FOOTER_LEN - metalen, metabuf, metalen);
+	pf->meta = parquet_parse_file_metadata(metabuf, metalen, pf->filename);
+	pfree(metabuf);
+
+	return pf;
+}
+
+void
+parquet_close_file(ParquetFile *pf)
+{
+	if (pf->fp)
+		FreeFile(pf->fp);
+	pf->fp = NULL;
+}
+
+/* ----------------------------------------------------------------
+ * Value conversion
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * The PostgreSQL type that values of a Parquet column are decoded into.
+ * atttypid is the type of the table column it is read into; unannotated
+ * binary columns are taken as text when read into a non-bytea column, since
+ * older writers did not mark strings as UTF8.
+ */
+Oid
+parquet_column_pg_type(const ParquetSchemaElement *el, Oid atttypid)
+{
+	switch (el->type)
+	{
+		case PQT_BOOLEAN:
+			return BOOLOID;
+
+		case PQT_INT32:
+			switch (el->logical)
+			{
+				case PQL_DATE:
+					return DATEOID;
+				case PQL_TIME:
+					return TIMEOID;
+				case PQL_DECIMAL:
+					return NUMERICOID;
+				case PQL_INTEGER:
+					if (!el->int_signed && el->int_bits == 32)
+						return INT8OID;
+					if (el->int_signed && el->int_bits <= 16)
+						return INT2OID;
+					return INT4OID;
+				default:
+					return INT4OID;
+			}
+
+		case PQT_INT64:
+			switch (el->logical)
+			{
+				case PQL_TIMESTAMP:
+					return el->utc_adjusted ? TIMESTAMPTZOID : TIMESTAMPOID;
+				case PQL_TIME:
+					return TIMEOID;
+				case PQL_DECIMAL:
+					return NUMERICOID;
+				case PQL_INTEGER:
+					return el->int_signed ? INT8OID : NUMERICOID;
+				default:
+					return INT8OID;
+			}
+
+		case PQT_INT96:
+			return TIMESTAMPOID;
+
+		case PQT_FLOAT:
+			return FLOAT4OID;
+
+		case PQT_DOUBLE:
+			return FLOAT8OID;
+
+		case PQT_BYTE_ARRAY:
+		case PQT_FIXED_LEN_BYTE_ARRAY:
+			switch (el->logical)
+			{
+				case PQL_STRING:
+				case PQL_JSON:
+					return TEXTOID;
+				case PQL_DECIMAL:
+					return NUMERICOID;
+				case PQL_UUID:
+					if (el->type == PQT_FIXED_LEN_BYTE_ARRAY && el->type_length == UUID_LEN)
+						return UUIDOID;
+					break;
+				default:
+					break;
+			}
+			return (atttypid == BYTEAOID) ? BYTEAOID : TEXTOID;
+	}
+
+	return InvalidOid;
+}
+
+/*
+ * Format an unscaled decimal, given as a big-endian two's complement
+ * integer, as a numeric.
+ */
+static Datum
+decimal_to_numeric(const uint8 *be, int len, int scale)
+{
+	uint8	   *mag;
+	char	   *digits;
+	int			ndigits = 0;
+	bool		neg;
+	int			i;
+	int			start;
+	StringInfoData str;
+
+	if (scale < 0 || len <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid Parquet decimal value")));
+
+	/* take the magnitude of the value */
+	mag = palloc(len);
+	memcpy(mag, be, len);
+	neg = (mag[0] & 0x80) != 0;
+	if (neg)
+	{
+		int			carry = 1;
+
+		for (i = len - 1; i >= 0; i--)
+		{
+			int			v = (uint8) ~mag[i] + carry;
+
+			mag[i] = (uint8) v;
+			carry = v >> 8;
+		}
+	}
+
+	/* repeatedly divide by 10, collecting the digits in reverse */
+	digits = palloc(len * 3 + 1);
+	start = 0;
+	while (start < len)
+	{
+		int			rem = 0;
+
+		for (i = start; i < len; i++)
+		{
+			int			cur = (rem << 8) | mag[i];
+
+			mag[i] = cur / 10;
+			rem = cur % 10;
+		}
+		digits[ndigits++] = '0' + rem;
+		while (start < len && mag[start] == 0)
+			start++;
+	}
+	if (ndigits == 0)
+		digits[ndigits++] = '0';
+
+	initStringInfo(&str);
+	if (neg)
+		appendStringInfoChar(&str, '-');
+	if (ndigits <= scale)
+	{
+		appendStringInfoString(&str, "0.");
+		for (i = ndigits; i < scale; i++)
+			appendStringInfoChar(&str, '0');
+		for (i = ndigits - 1; i >= 0; i--)
+			appendStringInfoChar(&str, digits[i]);
+	}
+	else
+	{
+		for (i = ndigits - 1; i >= 0; i--)
+		{
+			appendStringInfoChar(&str, digits[i]);
+			if (i == scale && i > 0)
+				appendStringInfoChar(&str, '.');
+		}
+	}
+
+	pfree(mag);
+	pfree(digits);
+
+	return DirectFunctionCall3(numeric_in,
+							   CStringGetDatum(str.data),
+							   ObjectIdGetDatum(InvalidOid),
+							   Int32GetDatum(-1));
+}
+
+static Datum
+int64_to_numeric(int64 v, bool is_unsigned, int scale)
+{
+	uint8		be[9];
+	int			i;
+	uint64		u = (uint64) v;
+
+	/* widen to 9 bytes so that unsigned values stay positive */
+	be[0] = (is_unsigned || v >= 0) ? 0 : 0xFF;
+	for (i = 8; i >= 1; i--)
+	{
+		be[i] = (uint8) u;
+		u >>= 8;
+	}
+	return decimal_to_numeric(be, 9, scale);
+}
+
+static void timestamp_out_of_range(void) pg_attribute_noreturn();
+
+static void
+timestamp_out_of_range(void)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+			 errmsg("timestamp out of range in Parquet column")));
+}
+
+static int64
+time_unit_to_usecs(int64 v, ParquetTimeUnit unit)
+{
+	int64		q;
+
+	switch (unit)
+	{
+		case PQU_MILLIS:
+			if (v > PG_INT64_MAX / 1000 || v < PG_INT64_MIN / 1000)
+				timestamp_out_of_range();
+			return v * 1000;
+		case PQU_NANOS:
+			/* round towards minus infinity, like the other readers do */
+			q = v / 1000;
+			if (v % 1000 < 0)
+				q--;
+			return q;
+		default:
+			return v;
+	}
+}
+
+/*
+ * Convert a time since the Unix epoch to a Timestamp, which counts from the
+ * PostgreSQL epoch.
+ */
+static Timestamp
+unix_to_timestamp(int64 v, ParquetTimeUnit unit)
+{
+	int64		usecs = time_unit_to_usecs(v, unit);
+
+	if (usecs < PG_INT64_MIN + PARQUET_EPOCH_SHIFT_DAYS * USECS_PER_DAY)
+		timestamp_out_of_range();
+	return usecs - PARQUET_EPOCH_SHIFT_DAYS * USECS_PER_DAY;
+}
+
+/*
+ * Convert a single PLAIN encoded value, without the length prefix of
+ * BYTE_ARRAY values, to a Datum of type pgtype. pgtype must be the result
+ * of parquet_column_pg_type for the column. This is also used to decode
+ * the min/max statistics, which have the same representation.
+ */
+Datum
+parquet_value_to_datum(const ParquetSchemaElement *el, Oid pgtype,
+					   const char *raw, int len)
+{
+	const uint8 *p = (const uint8 *) raw;
+
+	switch (el->type)
+	{
+		case PQT_BOOLEAN:
+			if (len < 1)
+				break;
+			return BoolGetDatum(p[0] != 0);
+
+		case PQT_INT32:
+			{
+				int32		v;
+
+				if (len != 4)
+					break;
+				v = (int32) pq_get_uint32(p);
+				switch (pgtype)
+				{
+					case DATEOID:
+						if (v < PG_INT32_MIN + PARQUET_EPOCH_SHIFT_DAYS)
+							ereport(ERROR,
+									(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+									 errmsg("date out of range in Parquet column \"%s\"", el->name)));
+						return DateADTGetDatum(v - PARQUET_EPOCH_SHIFT_DAYS);
+					case TIMEOID:
+						return TimeADTGetDatum((TimeADT) v * 1000);
+					case NUMERICOID:
+						return int64_to_numeric(v, false, el->scale);
+					case INT8OID:
+						return Int64GetDatum((int64) (uint32) v);
+					case INT2OID:
+						return Int16GetDatum((int16) v);
+					default:
+						return Int32GetDatum(v);
+				}
+			}
+
+		case PQT_INT64:
+			{
+				int64		v;
+
+				if (len != 8)
+					break;
+				v = pq_get_int64(p);
+				switch (pgtype)
+				{
+					case TIMESTAMPOID:
+					case TIMESTAMPTZOID:
+						return TimestampGetDatum(unix_to_timestamp(v, el->time_unit));
+					case TIMEOID:
+						return TimeADTGetDatum(time_unit_to_usecs(v, el->time_unit));
+					case NUMERICOID:
+						if (el->logical == PQL_DECIMAL)
+							return int64_to_numeric(v, false, el->scale);
+						return int64_to_numeric(v, true, 0);
+					default:
+						return Int64GetDatum(v);
+				}
+			}
+
+		case PQT_INT96:
+			{
+				/* nanoseconds within the day, then the Julian day */
+				int64		nanos;
+				int64		days;
+
+				if (len != 12)
+					break;
+				nanos = pq_get_int64(p);
+				days = (int64) (int32) pq_get_uint32(p + 8) - POSTGRES_EPOCH_JDATE;
+				if (nanos < 0 || nanos >= USECS_PER_DAY * 1000)
+					break;
+				if (days > PG_INT64_MAX / USECS_PER_DAY - 1 ||
+					days < PG_INT64_MIN / USECS_PER_DAY + 1)
+					timestamp_out_of_range();
+				return TimestampGetDatum(days * USECS_PER_DAY + nanos / 1000);
+			}
+
+		case PQT_FLOAT:
+			{
+				union
+				{
+					uint32		i;
+					float4		f;
+				}			u;
+
+				if (len != 4)
+					break;
+				u.i = pq_get_uint32(p);
+				return Float4GetDatum(u.f);
+			}
+
+		case PQT_DOUBLE:
+			{
+				union
+				{
+					int64		i;
+					float8		f;
+				}			u;
+
+				if (len != 8)
+					break;
+				u.i = pq_get_int64(p);
+				return Float8GetDatum(u.f);
+			}
+
+		case PQT_BYTE_ARRAY:
+		case PQT_FIXED_LEN_BYTE_ARRAY:
+			switch (pgtype)
+			{
+				case TEXTOID:
+					{
+						char	   *s = pg_any_to_server(raw, len, PG_UTF8);
+
+						if (s != raw)
+							len = strlen(s);
+						return PointerGetDatum(cstring_to_text_with_len(s, len));
+					}
+				case NUMERICOID:
+					return decimal_to_numeric(p, len, el->scale);
+				case UUIDOID:
+					{
+						char	   *u;
+
+						if (len != UUID_LEN)
+							break;
+						u = palloc(UUID_LEN);
+						memcpy(u, raw, UUID_LEN);
+						return UUIDPGetDatum((pg_uuid_t *) u);
+					}
+				default:
+					{
+						bytea	   *b = palloc(VARHDRSZ + len);
+
+						SET_VARSIZE(b, VARHDRSZ + len);
+						memcpy(VARDATA(b), raw, len);
+						return PointerGetDatum(b);
+					}
+			}
+			break;
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_DATA_CORRUPTED),
+			 errmsg("invalid value in Parquet column \"%s\"", el->name)));
+	return (Datum) 0;			/* keep compiler quiet */
+}
+
+static Datum
+convert_value(ParquetColumnReader *cr, const uint8 *raw, int len)
+{
+	Datum		d = parquet_value_to_datum(cr->el, cr->pgtype, (const char *) raw, len);
+
+	if (cr->io_convert)
+	{
+		char	   *str = OutputFunctionCall(&cr->out_func, d);
+
+		d = InputFunctionCall(&cr->in_func, str, cr->in_ioparam, cr->atttypmod);
+	}
+	return d;
+}
+
+/* ----------------------------------------------------------------
+ * Encodings
+ * ----------------------------------------------------------------
+ */
+
+static void
+rle_init(RleDecoder *rd, const uint8 *p, const uint8 *end, int bit_width)
+{
+	memset(rd, 0, sizeof(*rd));
+	rd->p = p;
+	rd->end = end;
+	rd->bit_width = bit_width;
+}
+
+/*
+ * Return the next value of an RLE / bit-packed hybrid run. Returns false if
+ * the input is exhausted or malformed.
+ */
+static bool
+rle_next(RleDecoder *rd, uint32 *value)
+{
+	for (;;)
+	{
+		uint64		header = 0;
+		int			shift = 0;
+
+		if (rd->rle_count > 0)
+		{
+			rd->rle_count--;
+			*value = rd->rle_value;
+			return true;
+		}
+
+		if (rd->bp_count > 0)
+		{
+			uint64		v = 0;
+			int			got = 0;
+
+			while (got < rd->bit_width)
+			{
+				uint8		b = rd->bp[rd->bp_bitpos >> 3];
+				int			off = rd->bp_bitpos & 7;
+				int			take = Min(8 - off, rd->bit_width - got);
+
+				v |= (uint64) ((b >> off) & ((1 << take) - 1)) << got;
+				got += take;
+				rd->bp_bitpos += take;
+			}
+			rd->bp_count--;
+			*value = (uint32) v;
+			return true;
+		}
+
+		/* read the next run header */
+		for (;;)
+		{
+			if (rd->p >= rd->end || shift > 35)
+				return false;
+			header |= (uint64) (*rd->p & 0x7F) << shift;
+			if ((*rd->p++ & 0x80) == 0)
+				break;
+			shift += 7;
+		}
+
+		if (header & 1)
+		{
+			/* bit-packed run of (header >> 1) groups of 8 values */
+			uint64		nvalues = (header >> 1) * 8;
+			uint64		nbytes = (header >> 1) * rd->bit_width;
+			uint64		avail = rd->end - rd->p;
+
+			/* tolerate a truncated final run */
+			if (nbytes > avail)
+			{
+				nbytes = avail;
+				nvalues = rd->bit_width > 0 ? avail * 8 / rd->bit_width : nvalues;
+			}
+			rd->bp = rd->p;
+			rd->bp_bitpos = 0;
+			rd->bp_count = (uint32) Min(nvalues, PG_UINT32_MAX);
+			rd->p += nbytes;
+		}
+		else
+		{
+			int			nbytes = (rd->bit_width + 7) / 8;
+			uint32		v = 0;
+			int			i;
+
+			if (rd->end - rd->p < nbytes)
+				return false;
+			for (i = 0; i < nbytes; i++)
+				v |= (uint32) rd->p[i] << (8 * i);
+			rd->p += nbytes;
+			rd->rle_count = (uint32) Min(header >> 1, PG_UINT32_MAX);
+			rd->rle_value = v;
+		}
+	}
+}
+
+/*
+ * Decode the next PLAIN value, returning a pointer to its bytes.
+ */
+static const uint8 *
+plain_next(ParquetColumnReader *cr, const uint8 **vp, const uint8 *vend,
+		   int *len, uint8 *boolbuf)
+{
+	const uint8 *v;
+	int			width;
+
+	switch (cr->el->type)
+	{
+		case PQT_BOOLEAN:
+			if (*vp >= vend)
+				corrupt_column(cr);
+			*boolbuf = (**vp >> cr->bool_bit) & 1;
+			if (++cr->bool_bit == 8)
+			{
+				cr->bool_bit = 0;
+				(*vp)++;
+			}
+			*len = 1;
+			return boolbuf;
+		case PQT_INT32:
+		case PQT_FLOAT:
+			width = 4;
+			break;
+		case PQT_INT64:
+		case PQT_DOUBLE:
+			width = 8;
+			break;
+		case PQT_INT96:
+			width = 12;
+			break;
+		case PQT_FIXED_LEN_BYTE_ARRAY:
+			width = cr->el->type_length;
+			break;
+		case PQT_BYTE_ARRAY:
+			if (vend - *vp < 4)
+				corrupt_column(cr);
+			width = (int) pq_get_uint32(*vp);
+			*vp += 4;
+			break;
+		default:
+			corrupt_column(cr);
+	}
+
+	if (width < 0 || vend - *vp < width)
+		corrupt_column(cr);
+	v = *vp;
+	*vp += width;
+	*len = width;
+	return v;
+}
+
+static void
+read_dictionary(ParquetColumnReader *cr, const ParquetPageHeader *hdr,
+				const uint8 *data, int len)
+{
+	MemoryContext oldcxt;
+	const uint8 *vp = data;
+	int			i;
+
+	if (hdr->dict.encoding != PQE_PLAIN && hdr->dict.encoding != PQE_PLAIN_DICTIONARY)
+		corrupt_column(cr);
+	if (hdr->dict.num_values < 0 || hdr->dict.num_values > (int64) len * 8 + 1)
+		corrupt_column(cr);
+
+	oldcxt = MemoryContextSwitchTo(cr->mcxt);
+	cr->ndict = hdr->dict.num_values;
+	cr->dict = palloc(sizeof(Datum) * Max(cr->ndict, 1));
+	cr->bool_bit = 0;
+	for (i = 0; i < cr->ndict; i++)
+	{
+		uint8		boolbuf;
+		int			vlen;
+		const uint8 *v = plain_next(cr, &vp, data + len, &vlen, &boolbuf);
+
+		cr->dict[i] = convert_value(cr, v, vlen);
+	}
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Make room for a decompressed page in the reader's page buffer.
+ */
+static char *
+page_buffer(ParquetColumnReader *cr, int size)
+{
+	if (cr->page == NULL || size > cr->page_alloc)
+	{
+		if (cr->page)
+			pfree(cr->page);
+		cr->page = MemoryContextAlloc(cr->mcxt, Max(size, 1));
+		cr->page_alloc = size;
+	}
+	return cr->page;
+}
+
+/*
+ * Advance to the next data page of the column chunk, decoding any
+ * dictionary page on the way.
+ */
+static void
+next_page(ParquetColumnReader *cr)
+{
+	for (;;)
+	{
+		ParquetPageHeader hdr;
+		const char *data;
+		const uint8 *levels;
+		const uint8 *values;
+		const uint8 *end;
+		int			hdrlen;
+		int			nvalues;
+
+		if (cr->chunk_pos >= cr->chunk_len)
+			corrupt_column(cr);
+
+		hdrlen = parquet_parse_page_header(cr->chunk + cr->chunk_pos,
+										   (int) Min(cr->chunk_len - cr->chunk_pos, PG_INT32_MAX),
+										   &hdr);
+		cr->chunk_pos += hdrlen;
+		if (hdr.compressed_page_size > cr->chunk_len - cr->chunk_pos)
+			corrupt_column(cr);
+		data = cr->chunk + cr->chunk_pos;
+		cr->chunk_pos += hdr.compressed_page_size;
+
+		switch (hdr.type)
+		{
+			case PQP_DICTIONARY_PAGE:
+				{
+					char	   *buf = page_buffer(cr, hdr.uncompressed_page_size);
+
+					parquet_decompress(cr->cc->codec, data, hdr.compressed_page_size,
+									   buf, hdr.uncompressed_page_size);
+					read_dictionary(cr, &hdr, (const uint8 *) buf,
+									hdr.uncompressed_page_size);
+				}
+				continue;
+
+			case PQP_DATA_PAGE:
+				{
+					char	   *buf = page_buffer(cr, hdr.uncompressed_page_size);
+
+					parquet_decompress(cr->cc->codec, data, hdr.compressed_page_size,
+									   buf, hdr.uncompressed_page_size);
+					levels = (const uint8 *) buf;
+					end = levels + hdr.uncompressed_page_size;
+					nvalues = hdr.data.num_values;
+					cr->encoding = hdr.data.encoding;
+
+					/* no repetition levels in a flat schema; v1 levels have a length prefix */
+					if (cr->max_def > 0)
+					{
+						uint32		deflen;
+
+						if (hdr.data.def_level_encoding != PQE_RLE || end - levels < 4)
+							corrupt_column(cr);
+						deflen = pq_get_uint32(levels);
+						levels += 4;
+						if (deflen > (uint32) (end - levels))
+							corrupt_column(cr);
+						rle_init(&cr->def, levels, levels + deflen, 1);
+						values = levels + deflen;
+					}
+					else
+						values = levels;
+				}
+				break;
+
+			case PQP_DATA_PAGE_V2:
+				{
+					int64		levlen64;
+					int			levlen;
+					int			vallen;
+					char	   *buf;
+
+					/* the lengths come from the file; sum them without overflow */
+					levlen64 = (int64) hdr.data_v2.rep_levels_byte_length +
+						hdr.data_v2.def_levels_byte_length;
+					if (hdr.data_v2.rep_levels_byte_length < 0 ||
+						hdr.data_v2.def_levels_byte_length < 0 ||
+						levlen64 > hdr.compressed_page_size ||
+						levlen64 > hdr.uncompressed_page_size)
+						corrupt_column(cr);
+					levlen = (int) levlen64;
+					vallen = hdr.uncompressed_page_size - levlen;
+
+					/* levels are never compressed in v2 pages */
+					buf = page_buffer(cr, hdr.uncompressed_page_size);
+					memcpy(buf, data, levlen);
+					if (hdr.data_v2.is_compressed)
+						parquet_decompress(cr->cc->codec, data + levlen,
+										   hdr.compressed_page_size - levlen,
+										   buf + levlen, vallen);
+					else
+						parquet_decompress(PQZ_UNCOMPRESSED, data + levlen,
+										   hdr.compressed_page_size - levlen,
+										   buf + levlen, vallen);
+
+					levels = (const uint8 *) buf + hdr.data_v2.rep_levels_byte_length;
+					end = (const uint8 *) buf + hdr.uncompressed_page_size;
+					nvalues = hdr.data_v2.num_values;
+					cr->encoding = hdr.data_v2.encoding;
+					if (cr->max_def > 0)
+						rle_init(&cr->def, levels,
+								 levels + hdr.data_v2.def_levels_byte_length, 1);
+					values = (const uint8 *) buf + levlen;
+				}
+				break;
+
+			default:
+				/* index pages and unknown page types carry no values */
+				continue;
+		}
+
+		if (nvalues <= 0)
+			continue;
+
+		cr->page_values = nvalues;
+		cr->vp = values;
+		cr->vend = end;
+		cr->bool_bit = 0;
+
+		switch (cr->encoding)
+		{
+			case PQE_PLAIN:
+				break;
+
+			case PQE_PLAIN_DICTIONARY:
+			case PQE_RLE_DICTIONARY:
+				if (cr->dict == NULL || values >= end || *values > 32)
+					corrupt_column(cr);
+				rle_init(&cr->idx, values + 1, end, *values);
+				break;
+
+			case PQE_RLE:
+				{
+					uint32		len;
+
+					if (cr->el->type != PQT_BOOLEAN || end - values < 4)
+						corrupt_column(cr);
+					len = pq_get_uint32(values);
+					if (len > (uint32) (end - values - 4))
+						corrupt_column(cr);
+					rle_init(&cr->idx, values + 4, values + 4 + len, 1);
+				}
+				break;
+
+			default:
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("Parquet encoding %d of column \"%s\" in file \"%s\" is not supported",
+								cr->encoding, cr->el->name, cr->pf->filename)));
+		}
+		return;
+	}
+}
+
+/* ----------------------------------------------------------------
+ * Column reader
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * Prepare to read the values of one leaf column in a row group, converted
+ * to the given type. The reader and its buffers are allocated in the
+ * current memory context.
+ */
+ParquetColumnReader *
+parquet_column_reader_create(ParquetFile *pf, int rowgroup, int leaf,
+							 Oid atttypid, int32 atttypmod)
+{
+	ParquetFileMetaData *meta = pf->meta;
+	ParquetColumnReader *cr;
+	int64		start;
+
+	Assert(rowgroup >= 0 && rowgroup < meta->nrowgroups);
+	Assert(leaf >= 0 && leaf < meta->nleaves);
+
+	cr = palloc0(sizeof(ParquetColumnReader));
+	cr->pf = pf;
+	cr->mcxt = CurrentMemoryContext;
+	cr->el = &meta->schema[meta->leaf_schema[leaf]];
+	cr->cc = &meta->rowgroups[rowgroup].columns[leaf];
+
+	if (!meta->leaf_flat[leaf])
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("column \"%s\" in Parquet file \"%s\" is a nested or repeated field, which is not supported",
+						cr->el->name, pf->filename)));
+	if (cr->cc->type != cr->el->type)
+		corrupt_column(cr);
+	if (cr->el->type == PQT_FIXED_LEN_BYTE_ARRAY && cr->el->type_length <= 0)
+		corrupt_column(cr);
+	cr->max_def = (cr->el->repetition == PQR_OPTIONAL) ? 1 : 0;
+
+	cr->pgtype = parquet_column_pg_type(cr->el, atttypid);
+	cr->atttypmod = atttypmod;
+	if (cr->pgtype != atttypid || atttypmod >= 0)
+	{
+		Oid			outfunc;
+		Oid			infunc;
+		bool		isvarlena;
+
+		getTypeOutputInfo(cr->pgtype, &outfunc, &isvarlena);
+		fmgr_info(outfunc, &cr->out_func);
+		getTypeInputInfo(atttypid, &infunc, &cr->in_ioparam);
+		fmgr_info(infunc, &cr->in_func);
+		cr->io_convert = true;
+	}
+
+	/* read the whole chunk, including the dictionary page */
+	start = (cr->cc->dictionary_page_offset >= 0) ?
+		cr->cc->dictionary_page_offset : cr->cc->data_page_offset;
+	cr->chunk_len = cr->cc->total_compressed_size;
+	if (cr->chunk_len <= 0 || cr->chunk_len > MaxAllocSize)
+		corrupt_column(cr);
+	cr->chunk = palloc(cr->chunk_len);
+	pq_read_at(pf, start, cr->chunk, cr->chunk_len);
+
+	return cr;
+}
+
+/*
+ * Return the column's value in the next row. Values that need memory are
+ * allocated in the current memory context, or point into the dictionary.
+ */
+void
+parquet_column_reader_next(ParquetColumnReader *cr, Datum *value, bool *isnull)
+{
+	uint32		v;
+
+	if (cr->page_values == 0)
+		next_page(cr);
+	cr->page_values--;
+
+	if (cr->max_def > 0)
+	{
+		if (!rle_next(&cr->def, &v))
+			corrupt_column(cr);
+		if (v < (uint32) cr->max_def)
+		{
+			*value = (Datum) 0;
+			*isnull = true;
+			return;
+		}
+	}
+	*isnull = false;
+
+	switch (cr->encoding)
+	{
+		case PQE_PLAIN:
+			{
+				uint8		boolbuf;
+				int			len;
+				const uint8 *raw = plain_next(cr, &cr->vp, cr->vend, &len, &boolbuf);
+
+				*value = convert_value(cr, raw, len);
+			}
+			break;
+
+		case PQE_PLAIN_DICTIONARY:
+		case PQE_RLE_DICTIONARY:
+			if (!rle_next(&cr->idx, &v) || v >= (uint32) cr->ndict)
+				corrupt_column(cr);
+			*value = cr->dict[v];
+			break;
+
+		case PQE_RLE:
+			{
+				uint8		b;
+
+				if (!rle_next(&cr->idx, &v))
+					corrupt_column(cr);
+				b = (uint8) v;
+				*value = convert_value(cr, &b, 1);
+			}
+			break;
+	}
+}
@@ -0,0 +1,1178 @@
+/*-------------------------------------------------------------------------
+ *
+ * parquet_thrift.c
+ *	  Coder for the Thrift compact protocol structures that make up the
+ *	  Parquet file footer and page headers.
+ *
+ * We only decode the fields gp_parquet uses and skip everything else, so
+ * files written by newer writers with additional fields are still readable.
+ * The encoder writes the required fields, plus the statistics and logical
+ * types that other readers use.
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/gp_parquet/parquet_thrift.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "parquet.h"
+
+/* Thrift compact protocol type codes */
+#define TCT_STOP			0
+#define TCT_BOOLEAN_TRUE	1
+#define TCT_BOOLEAN_FALSE	2
+#define TCT_BYTE			3
+#define TCT_I16				4
+#define TCT_I32				5
+#define TCT_I64				6
+#define TCT_DOUBLE			7
+#define TCT_BINARY			8
+#define TCT_LIST			9
+#define TCT_SET				10
+#define TCT_MAP				11
+#define TCT_STRUCT			12
+
+/* Deeper nesting than this can only come from a corrupt footer */
+#define THRIFT_MAX_DEPTH	64
+
+typedef struct ThriftReader
+{
+	const uint8 *p;
+	const uint8 *end;
+	const char *filename;		/* for error messages, may be NULL */
+} ThriftReader;
+
+static void thrift_error(ThriftReader *r) pg_attribute_noreturn();
+
+static void
+thrift_error(ThriftReader *r)
+{
+	if (r->filename)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid Parquet metadata in file \"%s\"", r->filename)));
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid Parquet page header")));
+}
+
+static uint64
+thrift_varint(ThriftReader *r)
+{
+	uint64		result = 0;
+	int			shift = 0;
+
+	for (;;)
+	{
+		uint8		b;
+
+		if (r->p >= r->end || shift > 63)
+			thrift_error(r);
+		b = *r->p++;
+		result |= (uint64) (b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+			return result;
+		shift += 7;
+	}
+}
+
+static int64
+thrift_zigzag(ThriftReader *r)
+{
+	uint64		v = thrift_varint(r);
+
+	return (int64) (v >> 1) ^ -(int64) (v & 1);
+}
+
+static int32
+thrift_i32(ThriftReader *r)
+{
+	return (int32) thrift_zigzag(r);
+}
+
+static int64
+thrift_i64(ThriftReader *r)
+{
+	return thrift_zigzag(r);
+}
+
+static int8
+thrift_byte(ThriftReader *r)
+{
+	if (r->p >= r->end)
+		thrift_error(r);
+	return (int8) *r->p++;
+}
+
+static void
+thrift_binary(ThriftReader *r, const char **data, int *len)
+{
+	uint64		n = thrift_varint(r);
+
+	if (n > (uint64) (r->end - r->p))
+		thrift_error(r);
+	*data = (const char *) r->p;
+	*len = (int) n;
+	r->p += n;
+}
+
+static char *
+thrift_string(ThriftReader *r)
+{
+	const char *data;
+	int			len;
+
+	thrift_binary(r, &data, &len);
+	return pnstrdup(data, len);
+}
+
+/*
+ * Read a list or set header, returning the number of elements.
+ */
+static int
+thrift_list_begin(ThriftReader *r, int *elemtype)
+{
+	uint8		b;
+	uint64		size;
+
+	if (r->p >= r->end)
+		thrift_error(r);
+	b = *r->p++;
+	*elemtype = b & 0x0F;
+	size = (b >> 4) & 0x0F;
+	if (size == 15)
+		size = thrift_varint(r);
+
+	/* every element takes at least one byte */
+	if (size > (uint64) (r->end - r->p) && *elemtype != TCT_BOOLEAN_TRUE)
+		thrift_error(r);
+	return (int) size;
+}
+
+/*
+ * Read the next field header of a struct. Returns false at the end of the
+ * struct. *last_id carries the previous field id, since ids are usually
+ * delta-encoded.
+ */
+static bool
+thrift_field(ThriftReader *r, int16 *last_id, int16 *id, int *type)
+{
+	uint8		b;
+	int			delta;
+
+	if (r->p >= r->end)
+		thrift_error(r);
+	b = *r->p++;
+	*type = b & 0x0F;
+	if (*type == TCT_STOP)
+		return false;
+
+	delta = (b >> 4) & 0x0F;
+	if (delta != 0)
+		*id = *last_id + delta;
+	else
+		*id = (int16) thrift_zigzag(r);
+	*last_id = *id;
+	return true;
+}
+
+static void thrift_skip(ThriftReader *r, int type, int depth);
+
+static void
+thrift_skip_struct(ThriftReader *r, int depth)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+
+	while (thrift_field(r, &last_id, &id, &type))
+		thrift_skip(r, type, depth + 1);
+}
+
+static void
+thrift_skip(ThriftReader *r, int type, int depth)
+{
+	const char *data;
+	int			len;
+	int			n;
+	int			i;
+
+	if (depth > THRIFT_MAX_DEPTH)
+		thrift_error(r);
+
+	switch (type)
+	{
+		case TCT_BOOLEAN_TRUE:
+		case TCT_BOOLEAN_FALSE:
+			/* the value is in the field header */
+			break;
+		case TCT_BYTE:
+			(void) thrift_byte(r);
+			break;
+		case TCT_I16:
+		case TCT_I32:
+		case TCT_I64:
+			(void) thrift_varint(r);
+			break;
+		case TCT_DOUBLE:
+			if (r->end - r->p < 8)
+				thrift_error(r);
+			r->p += 8;
+			break;
+		case TCT_BINARY:
+			thrift_binary(r, &data, &len);
+			break;
+		case TCT_LIST:
+		case TCT_SET:
+			{
+				int			elemtype;
+
+				n = thrift_list_begin(r, &elemtype);
+				for (i = 0; i < n; i++)
+				{
+					/* booleans in collections take a byte each */
+					if (elemtype == TCT_BOOLEAN_TRUE || elemtype == TCT_BOOLEAN_FALSE)
+						(void) thrift_byte(r);
+					else
+						thrift_skip(r, elemtype, depth + 1);
+				}
+			}
+			break;
+		case TCT_MAP:
+			{
+				uint8		kv = 0;
+
+				n = (int) thrift_varint(r);
+				if (n > 0)
+					kv = (uint8) thrift_byte(r);
+				for (i = 0; i < n; i++)
+				{
+					thrift_skip(r, kv >> 4, depth + 1);
+					thrift_skip(r, kv & 0x0F, depth + 1);
+				}
+			}
+			break;
+		case TCT_STRUCT:
+			thrift_skip_struct(r, depth);
+			break;
+		default:
+			thrift_error(r);
+	}
+}
+
+/* ----------------------------------------------------------------
+ * File metadata
+ * ----------------------------------------------------------------
+ */
+
+static ParquetTimeUnit
+parse_time_unit(ThriftReader *r)
+{
+	ParquetTimeUnit unit = PQU_MICROS;
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+
+	/* union TimeUnit { 1: MILLIS, 2: MICROS, 3: NANOS } */
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		if (id == 1)
+			unit = PQU_MILLIS;
+		else if (id == 2)
+			unit = PQU_MICROS;
+		else if (id == 3)
+			unit = PQU_NANOS;
+		thrift_skip(r, type, 1);
+	}
+	return unit;
+}
+
+static void
+parse_logical_type(ThriftReader *r, ParquetSchemaElement *el)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		int16		sub_last = 0;
+		int16		sub_id;
+		int			sub_type;
+
+		if (type != TCT_STRUCT)
+		{
+			thrift_skip(r, type, 1);
+			continue;
+		}
+
+		switch (id)
+		{
+			case 1:				/* STRING */
+			case 4:				/* ENUM */
+				el->logical = PQL_STRING;
+				thrift_skip_struct(r, 1);
+				break;
+			case 5:				/* DECIMAL */
+				el->logical = PQL_DECIMAL;
+				while (thrift_field(r, &sub_last, &sub_id, &sub_type))
+				{
+					if (sub_id == 1 && sub_type == TCT_I32)
+						el->scale = thrift_i32(r);
+					else if (sub_id == 2 && sub_type == TCT_I32)
+						el->precision = thrift_i32(r);
+					else
+						thrift_skip(r, sub_type, 2);
+				}
+				break;
+			case 6:				/* DATE */
+				el->logical = PQL_DATE;
+				thrift_skip_struct(r, 1);
+				break;
+			case 7:				/* TIME */
+			case 8:				/* TIMESTAMP */
+				el->logical = (id == 7) ? PQL_TIME : PQL_TIMESTAMP;
+				while (thrift_field(r, &sub_last, &sub_id, &sub_type))
+				{
+					if (sub_id == 1 && (sub_type == TCT_BOOLEAN_TRUE ||
+										sub_type == TCT_BOOLEAN_FALSE))
+						el->utc_adjusted = (sub_type == TCT_BOOLEAN_TRUE);
+					else if (sub_id == 2 && sub_type == TCT_STRUCT)
+						el->time_unit = parse_time_unit(r);
+					else
+						thrift_skip(r, sub_type, 2);
+				}
+				break;
+			case 10:			/* INTEGER */
+				el->logical = PQL_INTEGER;
+				while (thrift_field(r, &sub_last, &sub_id, &sub_type))
+				{
+					if (sub_id == 1 && sub_type == TCT_BYTE)
+						el->int_bits = thrift_byte(r);
+					else if (sub_id == 2 && (sub_type == TCT_BOOLEAN_TRUE ||
+											 sub_type == TCT_BOOLEAN_FALSE))
+						el->int_signed = (sub_type == TCT_BOOLEAN_TRUE);
+					else
+						thrift_skip(r, sub_type, 2);
+				}
+				break;
+			case 12:			/* JSON */
+				el->logical = PQL_JSON;
+				thrift_skip_struct(r, 1);
+				break;
+			case 14:			/* UUID */
+				el->logical = PQL_UUID;
+				thrift_skip_struct(r, 1);
+				break;
+			default:
+				el->logical = PQL_OTHER;
+				thrift_skip_struct(r, 1);
+				break;
+		}
+	}
+}
+
+/*
+ * Fold the legacy ConvertedType into the logical type, for files written
+ * before LogicalType existed.
+ */
+static void
+apply_converted_type(ParquetSchemaElement *el)
+{
+	switch (el->converted_type)
+	{
+		case PQC_UTF8:
+		case PQC_ENUM:
+			el->logical = PQL_STRING;
+			break;
+		case PQC_JSON:
+			el->logical = PQL_JSON;
+			break;
+		case PQC_DECIMAL:
+			el->logical = PQL_DECIMAL;
+			break;
+		case PQC_DATE:
+			el->logical = PQL_DATE;
+			break;
+		case PQC_TIME_MILLIS:
+		case PQC_TIME_MICROS:
+			el->logical = PQL_TIME;
+			el->time_unit = (el->converted_type == PQC_TIME_MILLIS) ? PQU_MILLIS : PQU_MICROS;
+			el->utc_adjusted = true;
+			break;
+		case PQC_TIMESTAMP_MILLIS:
+		case PQC_TIMESTAMP_MICROS:
+			el->logical = PQL_TIMESTAMP;
+			el->time_unit = (el->converted_type == PQC_TIMESTAMP_MILLIS) ? PQU_MILLIS : PQU_MICROS;
+			el->utc_adjusted = true;
+			break;
+		case PQC_UINT_8:
+		case PQC_UINT_16:
+		case PQC_UINT_32:
+		case PQC_UINT_64:
+		case PQC_INT_8:
+		case PQC_INT_16:
+		case PQC_INT_32:
+		case PQC_INT_64:
+			{
+				static const int bits[] = {8, 16, 32, 64};
+
+				el->logical = PQL_INTEGER;
+				el->int_signed = (el->converted_type >= PQC_INT_8);
+				el->int_bits = bits[(el->converted_type - (el->int_signed ? PQC_INT_8 : PQC_UINT_8))];
+			}
+			break;
+		case PQC_NONE:
+			break;
+		default:
+			el->logical = PQL_OTHER;
+			break;
+	}
+}
+
+static void
+parse_schema_element(ThriftReader *r, ParquetSchemaElement *el)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+	bool		has_logical = false;
+
+	memset(el, 0, sizeof(*el));
+	el->type = -1;
+	el->converted_type = PQC_NONE;
+	el->repetition = PQR_REQUIRED;
+	el->time_unit = PQU_MICROS;
+	el->int_signed = true;
+
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		if (id == 1 && type == TCT_I32)
+			el->type = thrift_i32(r);
+		else if (id == 2 && type == TCT_I32)
+			el->type_length = thrift_i32(r);
+		else if (id == 3 && type == TCT_I32)
+			el->repetition = thrift_i32(r);
+		else if (id == 4 && type == TCT_BINARY)
+			el->name = thrift_string(r);
+		else if (id == 5 && type == TCT_I32)
+			el->num_children = thrift_i32(r);
+		else if (id == 6 && type == TCT_I32)
+			el->converted_type = thrift_i32(r);
+		else if (id == 7 && type == TCT_I32)
+			el->scale = thrift_i32(r);
+		else if (id == 8 && type == TCT_I32)
+			el->precision = thrift_i32(r);
+		else if (id == 10 && type == TCT_STRUCT)
+		{
+			parse_logical_type(r, el);
+			has_logical = true;
+		}
+		else
+			thrift_skip(r, type, 1);
+	}
+
+	if (!has_logical)
+		apply_converted_type(el);
+
+	if (el->name == NULL)
+		thrift_error(r);
+	if (el->num_children < 0)
+		thrift_error(r);
+}
+
+static void
+parse_statistics(ThriftReader *r, ParquetStatistics *st)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+	const char *data;
+	int			len;
+	const char *legacy_min = NULL,
+			   *legacy_max = NULL;
+	int			legacy_min_len = 0,
+				legacy_max_len = 0;
+
+	memset(st, 0, sizeof(*st));
+
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		if ((id == 1 || id == 2 || id == 5 || id == 6) && type == TCT_BINARY)
+		{
+			thrift_binary(r, &data, &len);
+			switch (id)
+			{
+				case 1:
+					legacy_max = data;
+					legacy_max_len = len;
+					break;
+				case 2:
+					legacy_min = data;
+					legacy_min_len = len;
+					break;
+				case 5:
+					st->max = palloc(len + 1);
+					memcpy(st->max, data, len);
+					st->max_len = len;
+					st->has_max = true;
+					break;
+				case 6:
+					st->min = palloc(len + 1);
+					memcpy(st->min, data, len);
+					st->min_len = len;
+					st->has_min = true;
+					break;
+			}
+		}
+		else if (id == 3 && type == TCT_I64)
+		{
+			st->null_count = thrift_i64(r);
+			st->has_null_count = true;
+		}
+		else
+			thrift_skip(r, type, 1);
+	}
+
+	/*
+	 * The deprecated min/max fields used a signed byte-wise sort order for
+	 * every type. Keep them only when the new fields are absent; the caller
+	 * decides for which types they can be trusted.
+	 */
+	if (!st->has_min && !st->has_max && legacy_min && legacy_max)
+	{
+		st->min = palloc(legacy_min_len + 1);
+		memcpy(st->min, legacy_min, legacy_min_len);
+		st->min_len = legacy_min_len;
+		st->max = palloc(legacy_max_len + 1);
+		memcpy(st->max, legacy_max, legacy_max_len);
+		st->max_len = legacy_max_len;
+		st->has_min = st->has_max = true;
+		st->legacy = true;
+	}
+}
+
+static void
+parse_column_metadata(ThriftReader *r, ParquetColumnChunk *cc)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		if (id == 1 && type == TCT_I32)
+			cc->type = thrift_i32(r);
+		else if (id == 4 && type == TCT_I32)
+			cc->codec = thrift_i32(r);
+		else if (id == 5 && type == TCT_I64)
+			cc->num_values = thrift_i64(r);
+		else if (id == 6 && type == TCT_I64)
+			cc->total_uncompressed_size = thrift_i64(r);
+		else if (id == 7 && type == TCT_I64)
+			cc->total_compressed_size = thrift_i64(r);
+		else if (id == 9 && type == TCT_I64)
+			cc->data_page_offset = thrift_i64(r);
+		else if (id == 11 && type == TCT_I64)
+			cc->dictionary_page_offset = thrift_i64(r);
+		else if (id == 12 && type == TCT_STRUCT)
+			parse_statistics(r, &cc->stats);
+		else
+			thrift_skip(r, type, 1);
+	}
+}
+
+static void
+parse_column_chunk(ThriftReader *r, ParquetColumnChunk *cc)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+	bool		has_meta = false;
+
+	memset(cc, 0, sizeof(*cc));
+	cc->dictionary_page_offset = -1;
+
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		if (id == 1 && type == TCT_BINARY)
+		{
+			const char *data;
+			int			len;
+
+			thrift_binary(r, &data, &len);
+			if (len > 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("Parquet column chunks stored in separate files are not supported")));
+		}
+		else if (id == 3 && type == TCT_STRUCT)
+		{
+			parse_column_metadata(r, cc);
+			has_meta = true;
+		}
+		else
+			thrift_skip(r, type, 1);
+	}
+
+	if (!has_meta)
+		thrift_error(r);
+
+	/*
+	 * Some writers leave dictionary_page_offset unset and put the dictionary
+	 * page first at data_page_offset; others set it to 0 when there is no
+	 * dictionary. The column reader handles both by looking at the page
+	 * type, so only keep an offset that precedes the data pages.
+	 */
+	if (cc->dictionary_page_offset <= 0 ||
+		cc->dictionary_page_offset >= cc->data_page_offset)
+		cc->dictionary_page_offset = -1;
+}
+
+static void
+parse_row_group(ThriftReader *r, ParquetRowGroup *rg)
+{
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+
+	memset(rg, 0, sizeof(*rg));
+
+	while (thrift_field(r, &last_id, &id, &type))
+	{
+		if (id == 1 && type == TCT_LIST)
+		{
+			int			elemtype;
+			int			i;
+
+			rg->ncolumns = thrift_list_begin(r, &elemtype);
+			if (elemtype != TCT_STRUCT)
+				thrift_error(r);
+			rg->columns = palloc(sizeof(ParquetColumnChunk) * Max(rg->ncolumns, 1));
+			for (i = 0; i < rg->ncolumns; i++)
+				parse_column_chunk(r, &rg->columns[i]);
+		}
+		else if (id == 2 && type == TCT_I64)
+			rg->total_byte_size = thrift_i64(r);
+		else if (id == 3 && type == TCT_I64)
+			rg->num_rows = thrift_i64(r);
+		else
+			thrift_skip(r, type, 1);
+	}
+}
+
+/*
+ * Find the leaf columns in depth-first order, which is the order of the
+ * column chunks in each row group.
+ */
+static int
+collect_leaves(ThriftReader *r, ParquetFileMetaData *meta, int idx,
+			   int depth, bool flat)
+{
+	ParquetSchemaElement *el;
+	int			i;
+
+	if (idx >= meta->nschema || depth > THRIFT_MAX_DEPTH)
+		thrift_error(r);
+
+	el = &meta->schema[idx];
+	if (el->num_children == 0)
+	{
+		if (el->type < 0)
+			thrift_error(r);
+		meta->leaf_schema[meta->nleaves] = idx;
+		meta->leaf_flat[meta->nleaves] = flat && depth == 1 &&
+			el->repetition != PQR_REPEATED;
+		meta->nleaves++;
+		return idx + 1;
+	}
+
+	idx++;
+	for (i = 0; i < el->num_children; i++)
+		idx = collect_leaves(r, meta, idx, depth + 1, flat && depth == 0);
+	return idx;
+}
+
+/*
+ * Decode the FileMetaData structure from the footer of a Parquet file.
+ * Everything is allocated in the current memory context.
+ */
+ParquetFileMetaData *
+parquet_parse_file_metadata(const char *buf, int len, const char *filename)
+{
+	ThriftReader r;
+	ParquetFileMetaData *meta;
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+	int			i;
+
+	r.p = (const uint8 *) buf;
+	r.end = (const uint8 *) buf + len;
+	r.filename = filename;
+
+	meta = palloc0(sizeof(ParquetFileMetaData));
+
+	while (thrift_field(&r, &last_id, &id, &type))
+	{
+		int			elemtype;
+
+		if (id == 2 && type == TCT_LIST)
+		{
+			meta->nschema = thrift_list_begin(&r, &elemtype);
+			if (elemtype != TCT_STRUCT || meta->nschema < 1)
+				thrift_error(&r);
+			meta->schema = palloc(sizeof(ParquetSchemaElement) * meta->nschema);
+			for (i = 0; i < meta->nschema; i++)
+				parse_schema_element(&r, &meta->schema[i]);
+		}
+		else if (id == 3 && type == TCT_I64)
+			meta->num_rows = thrift_i64(&r);
+		else if (id == 4 && type == TCT_LIST)
+		{
+			meta->nrowgroups = thrift_list_begin(&r, &elemtype);
+			if (elemtype != TCT_STRUCT)
+				thrift_error(&r);
+			meta->rowgroups = palloc(sizeof(ParquetRowGroup) * Max(meta->nrowgroups, 1));
+			for (i = 0; i < meta->nrowgroups; i++)
+				parse_row_group(&r, &meta->rowgroups[i]);
+		}
+		else
+			thrift_skip(&r, type, 1);
+	}
+
+	if (meta->schema == NULL)
+		thrift_error(&r);
+
+	meta->leaf_schema = palloc(sizeof(int) * meta->nschema);
+	meta->leaf_flat = palloc(sizeof(bool) * meta->nschema);
+	if (collect_leaves(&r, meta, 0, 0, true) != meta->nschema)
+		thrift_error(&r);
+
+	for (i = 0; i < meta->nrowgroups; i++)
+	{
+		if (meta->rowgroups[i].ncolumns != meta->nleaves)
+			thrift_error(&r);
+	}
+
+	return meta;
+}
+
+/*
+ * Decode a page header at the start of buf. Returns the number of bytes the
+ * header occupies; the page data follows it.
+ */
+int
+parquet_parse_page_header(const char *buf, int len, ParquetPageHeader *hdr)
+{
+	ThriftReader r;
+	int16		last_id = 0;
+	int16		id;
+	int			type;
+
+	r.p = (const uint8 *) buf;
+	r.end = (const uint8 *) buf + len;
+	r.filename = NULL;
+
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->type = -1;
+	hdr->data_v2.is_compressed = true;
+
+	while (thrift_field(&r, &last_id, &id, &type))
+	{
+		int16		sub_last = 0;
+		int16		sub_id;
+		int			sub_type;
+
+		if (id == 1 && type == TCT_I32)
+			hdr->type = thrift_i32(&r);
+		else if (id == 2 && type == TCT_I32)
+			hdr->uncompressed_page_size = thrift_i32(&r);
+		else if (id == 3 && type == TCT_I32)
+			hdr->compressed_page_size = thrift_i32(&r);
+		else if (id == 5 && type == TCT_STRUCT)
+		{
+			while (thrift_field(&r, &sub_last, &sub_id, &sub_type))
+			{
+				if (sub_id == 1 && sub_type == TCT_I32)
+					hdr->data.num_values = thrift_i32(&r);
+				else if (sub_id == 2 && sub_type == TCT_I32)
+					hdr->data.encoding = thrift_i32(&r);
+				else if (sub_id == 3 && sub_type == TCT_I32)
+					hdr->data.def_level_encoding = thrift_i32(&r);
+				else if (sub_id == 4 && sub_type == TCT_I32)
+					hdr->data.rep_level_encoding = thrift_i32(&r);
+				else
+					thrift_skip(&r, sub_type, 2);
+			}
+		}
+		else if (id == 7 && type == TCT_STRUCT)
+		{
+			while (thrift_field(&r, &sub_last, &sub_id, &sub_type))
+			{
+				if (sub_id == 1 && sub_type == TCT_I32)
+					hdr->dict.num_values = thrift_i32(&r);
+				else if (sub_id == 2 && sub_type == TCT_I32)
+					hdr->dict.encoding = thrift_i32(&r);
+				else
+					thrift_skip(&r, sub_type, 2);
+			}
+		}
+		else if (id == 8 && type == TCT_STRUCT)
+		{
+			while (thrift_field(&r, &sub_last, &sub_id, &sub_type))
+			{
+				if (sub_id == 1 && sub_type == TCT_I32)
+					hdr->data_v2.num_values = thrift_i32(&r);
+				else if (sub_id == 2 && sub_type == TCT_I32)
+					hdr->data_v2.num_nulls = thrift_i32(&r);
+				else if (sub_id == 3 && sub_type == TCT_I32)
+					hdr->data_v2.num_rows = thrift_i32(&r);
+				else if (sub_id == 4 && sub_type == TCT_I32)
+					hdr->data_v2.encoding = thrift_i32(&r);
+				else if (sub_id == 5 && sub_type == TCT_I32)
+					hdr->data_v2.def_levels_byte_length = thrift_i32(&r);
+				else if (sub_id == 6 && sub_type == TCT_I32)
+					hdr->data_v2.rep_levels_byte_length = thrift_i32(&r);
+				else if (sub_id == 7 && (sub_type == TCT_BOOLEAN_TRUE ||
+										 sub_type == TCT_BOOLEAN_FALSE))
+					hdr->data_v2.is_compressed = (sub_type == TCT_BOOLEAN_TRUE);
+				else
+					thrift_skip(&r, sub_type, 2);
+			}
+		}
+		else
+			thrift_skip(&r, type, 1);
+	}
+
+	if (hdr->compressed_page_size < 0 || hdr->uncompressed_page_size < 0)
+		thrift_error(&r);
+
+	return (const char *) r.p - buf;
+}
+
+/* ----------------------------------------------------------------
+ * Encoder
+ * ----------------------------------------------------------------
+ */
+
+typedef struct ThriftWriter
+{
+	StringInfo	buf;
+	int			depth;
+	int16		last_id[THRIFT_MAX_DEPTH];	/* per nesting level of structs */
+} ThriftWriter;
+
+static void
+thrift_put_varint(ThriftWriter *w, uint64 v)
+{
+	while (v >= 0x80)
+	{
+		appendStringInfoCharMacro(w->buf, (char) ((v & 0x7F) | 0x80));
+		v >>= 7;
+	}
+	appendStringInfoCharMacro(w->buf, (char) v);
+}
+
+static void
+thrift_put_zigzag(ThriftWriter *w, int64 v)
+{
+	thrift_put_varint(w, ((uint64) v << 1) ^ (uint64) (v >> 63));
+}
+
+static void
+thrift_put_field(ThriftWriter *w, int16 id, int type)
+{
+	int16		delta = id - w->last_id[w->depth];
+
+	if (delta > 0 && delta <= 15)
+		appendStringInfoCharMacro(w->buf, (char) ((delta << 4) | type));
+	else
+	{
+		appendStringInfoCharMacro(w->buf, (char) type);
+		thrift_put_zigzag(w, id);
+	}
+	w->last_id[w->depth] = id;
+}
+
+static void
+thrift_struct_begin(ThriftWriter *w)
+{
+	if (++w->depth >= THRIFT_MAX_DEPTH)
+		elog(ERROR, "Parquet metadata nested too deeply");
+	w->last_id[w->depth] = 0;
+}
+
+static void
+thrift_struct_end(ThriftWriter *w)
+{
+	appendStringInfoCharMacro(w->buf, TCT_STOP);
+	w->depth--;
+}
+
+static void
+thrift_put_struct_field(ThriftWriter *w, int16 id)
+{
+	thrift_put_field(w, id, TCT_STRUCT);
+	thrift_struct_begin(w);
+}
+
+/* an empty struct, as used by the members of the LogicalType union */
+static void
+thrift_put_empty_struct_field(ThriftWriter *w, int16 id)
+{
+	thrift_put_struct_field(w, id);
+	thrift_struct_end(w);
+}
+
+static void
+thrift_put_i32_field(ThriftWriter *w, int16 id, int32 v)
+{
+	thrift_put_field(w, id, TCT_I32);
+	thrift_put_zigzag(w, v);
+}
+
+static void
+thrift_put_i64_field(ThriftWriter *w, int16 id, int64 v)
+{
+	thrift_put_field(w, id, TCT_I64);
+	thrift_put_zigzag(w, v);
+}
+
+static void
+thrift_put_byte_field(ThriftWriter *w, int16 id, int8 v)
+{
+	thrift_put_field(w, id, TCT_BYTE);
+	appendStringInfoCharMacro(w->buf, (char) v);
+}
+
+static void
+thrift_put_bool_field(ThriftWriter *w, int16 id, bool v)
+{
+	thrift_put_field(w, id, v ? TCT_BOOLEAN_TRUE : TCT_BOOLEAN_FALSE);
+}
+
+static void
+thrift_put_binary(ThriftWriter *w, const char *data, int len)
+{
+	thrift_put_varint(w, len);
+	appendBinaryStringInfo(w->buf, data, len);
+}
+
+static void
+thrift_put_binary_field(ThriftWriter *w, int16 id, const char *data, int len)
+{
+	thrift_put_field(w, id, TCT_BINARY);
+	thrift_put_binary(w, data, len);
+}
+
+static void
+thrift_put_list_field(ThriftWriter *w, int16 id, int elemtype, int n)
+{
+	thrift_put_field(w, id, TCT_LIST);
+	if (n < 15)
+		appendStringInfoCharMacro(w->buf, (char) ((n << 4) | elemtype));
+	else
+	{
+		appendStringInfoCharMacro(w->buf, (char) (0xF0 | elemtype));
+		thrift_put_varint(w, n);
+	}
+}
+
+static void
+put_time_unit(ThriftWriter *w, int16 id, ParquetTimeUnit unit)
+{
+	thrift_put_struct_field(w, id);
+	thrift_put_empty_struct_field(w, unit == PQU_MILLIS ? 1 :
+								  unit == PQU_MICROS ? 2 : 3);
+	thrift_struct_end(w);
+}
+
+static void
+put_logical_type(ThriftWriter *w, const ParquetSchemaElement *el)
+{
+	thrift_put_struct_field(w, 10);
+	switch (el->logical)
+	{
+		case PQL_STRING:
+			thrift_put_empty_struct_field(w, 1);
+			break;
+		case PQL_DECIMAL:
+			thrift_put_struct_field(w, 5);
+			thrift_put_i32_field(w, 1, el->scale);
+			thrift_put_i32_field(w, 2, el->precision);
+			thrift_struct_end(w);
+			break;
+		case PQL_DATE:
+			thrift_put_empty_struct_field(w, 6);
+			break;
+		case PQL_TIME:
+		case PQL_TIMESTAMP:
+			thrift_put_struct_field(w, el->logical == PQL_TIME ? 7 : 8);
+			thrift_put_bool_field(w, 1, el->utc_adjusted);
+			put_time_unit(w, 2, el->time_unit);
+			thrift_struct_end(w);
+			break;
+		case PQL_INTEGER:
+			thrift_put_struct_field(w, 10);
+			thrift_put_byte_field(w, 1, (int8) el->int_bits);
+			thrift_put_bool_field(w, 2, el->int_signed);
+			thrift_struct_end(w);
+			break;
+		case PQL_JSON:
+			thrift_put_empty_struct_field(w, 12);
+			break;
+		case PQL_UUID:
+			thrift_put_empty_struct_field(w, 14);
+			break;
+		default:
+			elog(ERROR, "cannot write Parquet logical type %d", el->logical);
+	}
+	thrift_struct_end(w);
+}
+
+static void
+put_schema_element(ThriftWriter *w, const ParquetSchemaElement *el)
+{
+	thrift_struct_begin(w);
+	if (el->type >= 0)
+		thrift_put_i32_field(w, 1, el->type);
+	if (el->type == PQT_FIXED_LEN_BYTE_ARRAY)
+		thrift_put_i32_field(w, 2, el->type_length);
+	if (el->num_children == 0)
+		thrift_put_i32_field(w, 3, el->repetition);
+	thrift_put_binary_field(w, 4, el->name, strlen(el->name));
+	if (el->num_children > 0)
+		thrift_put_i32_field(w, 5, el->num_children);
+	if (el->converted_type != PQC_NONE)
+		thrift_put_i32_field(w, 6, el->converted_type);
+	if (el->logical == PQL_DECIMAL)
+	{
+		thrift_put_i32_field(w, 7, el->scale);
+		thrift_put_i32_field(w, 8, el->precision);
+	}
+	if (el->logical != PQL_NONE)
+		put_logical_type(w, el);
+	thrift_struct_end(w);
+}
+
+static void
+put_statistics(ThriftWriter *w, const ParquetStatistics *st)
+{
+	thrift_put_struct_field(w, 12);
+	if (st->legacy && st->has_min && st->has_max)
+	{
+		thrift_put_binary_field(w, 1, st->max, st->max_len);
+		thrift_put_binary_field(w, 2, st->min, st->min_len);
+	}
+	if (st->has_null_count)
+		thrift_put_i64_field(w, 3, st->null_count);
+	if (st->has_min && st->has_max)
+	{
+		thrift_put_binary_field(w, 5, st->max, st->max_len);
+		thrift_put_binary_field(w, 6, st->min, st->min_len);
+	}
+	thrift_struct_end(w);
+}
+
+static void
+put_column_chunk(ThriftWriter *w, const ParquetColumnChunk *cc,
+				 const ParquetSchemaElement *el)
+{
+	thrift_struct_begin(w);
+	thrift_put_i64_field(w, 2, cc->dictionary_page_offset >= 0 ?
+						 cc->dictionary_page_offset : cc->data_page_offset);
+
+	/* ColumnMetaData */
+	thrift_put_struct_field(w, 3);
+	thrift_put_i32_field(w, 1, cc->type);
+	/* the writer only produces PLAIN values with RLE levels */
+	thrift_put_list_field(w, 2, TCT_I32, 2);
+	thrift_put_zigzag(w, PQE_PLAIN);
+	thrift_put_zigzag(w, PQE_RLE);
+	thrift_put_list_field(w, 3, TCT_BINARY, 1);
+	thrift_put_binary(w, el->name, strlen(el->name));
+	thrift_put_i32_field(w, 4, cc->codec);
+	thrift_put_i64_field(w, 5, cc->num_values);
+	thrift_put_i64_field(w, 6, cc->total_uncompressed_size);
+	thrift_put_i64_field(w, 7, cc->total_compressed_size);
+	thrift_put_i64_field(w, 9, cc->data_page_offset);
+	if (cc->dictionary_page_offset >= 0)
+		thrift_put_i64_field(w, 11, cc->dictionary_page_offset);
+	put_statistics(w, &cc->stats);
+	thrift_struct_end(w);
+
+	thrift_struct_end(w);
+}
+
+/*
+ * Encode a FileMetaData structure, for the footer of a Parquet file. Only
+ * flat schemas are supported: the leaves must be the root's children.
+ */
+void
+parquet_write_file_metadata(StringInfo buf, const ParquetFileMetaData *meta,
+							const char *created_by)
+{
+	ThriftWriter w;
+	int			i;
+	int			j;
+
+	w.buf = buf;
+	w.depth = 0;
+	w.last_id[0] = 0;
+
+	thrift_put_i32_field(&w, 1, 1);		/* version */
+
+	thrift_put_list_field(&w, 2, TCT_STRUCT, meta->nschema);
+	for (i = 0; i < meta->nschema; i++)
+		put_schema_element(&w, &meta->schema[i]);
+
+	thrift_put_i64_field(&w, 3, meta->num_rows);
+
+	thrift_put_list_field(&w, 4, TCT_STRUCT, meta->nrowgroups);
+	for (i = 0; i < meta->nrowgroups; i++)
+	{
+		ParquetRowGroup *rg = &meta->rowgroups[i];
+
+		Assert(rg->ncolumns == meta->nleaves);
+		thrift_struct_begin(&w);
+		thrift_put_list_field(&w, 1, TCT_STRUCT, rg->ncolumns);
+		for (j = 0; j < rg->ncolumns; j++)
+			put_column_chunk(&w, &rg->columns[j],
+							 &meta->schema[meta->leaf_schema[j]]);
+		thrift_put_i64_field(&w, 2, rg->total_byte_size);
+		thrift_put_i64_field(&w, 3, rg->num_rows);
+		thrift_struct_end(&w);
+	}
+
+	thrift_put_binary_field(&w, 6, created_by, strlen(created_by));
+	appendStringInfoCharMacro(buf, TCT_STOP);
+}
+
+/*
+ * Encode a data page (v1) header.
+ */
+void
+parquet_write_page_header(StringInfo buf, const ParquetPageHeader *hdr)
+{
+	ThriftWriter w;
+
+	Assert(hdr->type == PQP_DATA_PAGE);
+
+	w.buf = buf;
+	w.depth = 0;
+	w.last_id[0] = 0;
+
+	thrift_put_i32_field(&w, 1, hdr->type);
+	thrift_put_i32_field(&w, 2, hdr->uncompressed_page_size);
+	thrift_put_i32_field(&w, 3, hdr->compressed_page_size);
+	thrift_put_struct_field(&w, 5);
+	thrift_put_i32_field(&w, 1, hdr->data.num_values);
+	thrift_put_i32_field(&w, 2, hdr->data.encoding);
+	thrift_put_i32_field(&w, 3, hdr->data.def_level_encoding);
+	thrift_put_i32_field(&w, 4, hdr->data.rep_level_encoding);
+	thrift_struct_end(&w);
+	appendStringInfoCharMacro(buf, TCT_STOP);
+}
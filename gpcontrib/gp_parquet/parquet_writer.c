@@ -0,0 +1,1008 @@
+/*-------------------------------------------------------------------------
+ *
+ * parquet_writer.c
+ *	  Encode rows of an external table as Parquet row groups.
+ *
+ * Rows are buffered one row group at a time. As rows arrive, each column's
+ * values are PLAIN encoded into the column's current page. A full page is
+ * compressed and appended to the column's chunk buffer. When the chunks
+ * of all columns add up to the row group size, the caller writes them out
+ * one after another with parquet_writer_flush_rowgroup, and the writer
+ * remembers their offsets and min/max statistics for the file footer.
+ *
+ * Each column type maps to the Parquet type that preserves its values (see
+ * writer_column_type). Types without a Parquet counterpart are written as
+ * strings, using their output function.
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/gp_parquet/parquet_writer.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <ctype.h>
+#include <math.h>
+
+#include "catalog/pg_type.h"
+#include "datatype/timestamp.h"
+#include "mb/pg_wchar.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+#include "utils/uuid.h"
+
+#include "parquet.h"
+
+/* Uncompressed size at which a data page is closed */
+#define PARQUET_PAGE_SIZE		(1024 * 1024)
+
+/* Longer min/max values are not worth keeping in the footer */
+#define PARQUET_MAX_STAT_LEN	256
+
+/* How a column's Datums are turned into Parquet values */
+typedef enum ParquetWriteKind
+{
+	PW_BOOL,
+	PW_INT16,
+	PW_INT32,
+	PW_INT64,
+	PW_FLOAT4,
+	PW_FLOAT8,
+	PW_DATE,
+	PW_TIME,
+	PW_TIMESTAMP,
+	PW_DECIMAL32,
+	PW_DECIMAL64,
+	PW_UUID,
+	PW_BYTEA,
+	PW_TEXT,					/* text-like varlena, stored as is */
+	PW_OUTPUT					/* anything else, via the output function */
+} ParquetWriteKind;
+
+typedef struct ColumnWriter
+{
+	int			attno;			/* attribute number, 0-based */
+	ParquetSchemaElement *el;
+	ParquetWriteKind kind;
+	FmgrInfo	out_func;		/* for PW_OUTPUT */
+
+	/* current page */
+	StringInfoData values;		/* PLAIN encoded non-null values */
+	uint8	   *defs;			/* definition level of each value */
+	int			defs_alloc;
+	int			page_values;	/* values in the page, including nulls */
+	int			page_nonnull;
+
+	/* current row group */
+	StringInfoData chunk;		/* finished pages, with their headers */
+	int64		chunk_values;
+	int64		chunk_uncompressed;
+	int64		null_count;
+
+	/*
+	 * Min and max of the row group. Integers and floats are tracked as
+	 * numbers, everything else as PLAIN bytes compared as unsigned bytes.
+	 */
+	bool		has_minmax;
+	bool		stats_too_long;
+	int64		min_int;
+	int64		max_int;
+	double		min_float;
+	double		max_float;
+	StringInfoData min_bytes;
+	StringInfoData max_bytes;
+} ColumnWriter;
+
+struct ParquetWriter
+{
+	MemoryContext mcxt;			/* buffers, lives as long as the writer */
+	MemoryContext filecxt;		/* row group metadata of the current file */
+	MemoryContext rowcxt;		/* temporary conversions of one row */
+
+	int			codec;
+	int64		rowgroup_size;
+
+	int			ncolumns;
+	ColumnWriter *columns;
+	ParquetSchemaElement *schema;	/* schema[0] is the root */
+	int			nschema;
+
+	int64		pending_rows;	/* rows in the current row group */
+
+	/* current file */
+	int64		offset;			/* bytes written so far */
+	int64		num_rows;
+	ParquetRowGroup *rowgroups;
+	int			nrowgroups;
+	int			rowgroups_alloc;
+
+	StringInfoData page;		/* scratch: uncompressed page */
+	StringInfoData compressed;	/* scratch: compressed page */
+};
+
+/* ----------------------------------------------------------------
+ * Schema
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * Choose the Parquet representation of a column of type typid.
+ */
+static ParquetWriteKind
+writer_column_type(ParquetSchemaElement *el, Oid typid, int32 typmod)
+{
+	switch (typid)
+	{
+		case BOOLOID:
+			el->type = PQT_BOOLEAN;
+			return PW_BOOL;
+		case INT2OID:
+			el->type = PQT_INT32;
+			el->logical = PQL_INTEGER;
+			el->converted_type = PQC_INT_16;
+			el->int_bits = 16;
+			el->int_signed = true;
+			return PW_INT16;
+		case INT4OID:
+			el->type = PQT_INT32;
+			return PW_INT32;
+		case INT8OID:
+			el->type = PQT_INT64;
+			return PW_INT64;
+		case FLOAT4OID:
+			el->type = PQT_FLOAT;
+			return PW_FLOAT4;
+		case FLOAT8OID:
+			el->type = PQT_DOUBLE;
+			return PW_FLOAT8;
+		case DATEOID:
+			el->type = PQT_INT32;
+			el->logical = PQL_DATE;
+			el->converted_type = PQC_DATE;
+			return PW_DATE;
+		case TIMEOID:
+			el->type = PQT_INT64;
+			el->logical = PQL_TIME;
+			el->time_unit = PQU_MICROS;
+			el->utc_adjusted = false;
+			return PW_TIME;
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			el->type = PQT_INT64;
+			el->logical = PQL_TIMESTAMP;
+			el->time_unit = PQU_MICROS;
+			el->utc_adjusted = (typid == TIMESTAMPTZOID);
+			/* the legacy annotation implies UTC */
+			if (el->utc_adjusted)
+				el->converted_type = PQC_TIMESTAMP_MICROS;
+			return PW_TIMESTAMP;
+		case NUMERICOID:
+			if (typmod >= (int32) VARHDRSZ)
+			{
+				int			precision = ((typmod - VARHDRSZ) >> 16) & 0xFFFF;
+				int			scale = (typmod - VARHDRSZ) & 0xFFFF;
+
+				if (precision <= 18)
+				{
+					el->type = (precision <= 9) ? PQT_INT32 : PQT_INT64;
+					el->logical = PQL_DECIMAL;
+					el->converted_type = PQC_DECIMAL;
+					el->precision = precision;
+					el->scale = scale;
+					return (precision <= 9) ? PW_DECIMAL32 : PW_DECIMAL64;
+				}
+			}
+			/* unconstrained or too wide for an integer: keep the text */
+			break;
+		case UUIDOID:
+			el->type = PQT_FIXED_LEN_BYTE_ARRAY;
+			el->type_length = UUID_LEN;
+			el->logical = PQL_UUID;
+			return PW_UUID;
+		case BYTEAOID:
+			el->type = PQT_BYTE_ARRAY;
+			return PW_BYTEA;
+		case TEXTOID:
+		case VARCHAROID:
+		case BPCHAROID:
+			el->type = PQT_BYTE_ARRAY;
+			el->logical = PQL_STRING;
+			el->converted_type = PQC_UTF8;
+			return PW_TEXT;
+		case JSONOID:
+			el->type = PQT_BYTE_ARRAY;
+			el->logical = PQL_JSON;
+			el->converted_type = PQC_JSON;
+			return PW_TEXT;
+	}
+
+	el->type = PQT_BYTE_ARRAY;
+	el->logical = PQL_STRING;
+	el->converted_type = PQC_UTF8;
+	return PW_OUTPUT;
+}
+
+/*
+ * Create a writer for rows of tupdesc. Everything is allocated in a child
+ * of the current memory context.
+ */
+ParquetWriter *
+parquet_writer_create(TupleDesc tupdesc, int codec, int64 rowgroup_size)
+{
+	MemoryContext mcxt;
+	MemoryContext oldcxt;
+	ParquetWriter *pw;
+	int			i;
+
+	mcxt = AllocSetContextCreate(CurrentMemoryContext,
+								 "Parquet writer",
+								 ALLOCSET_DEFAULT_MINSIZE,
+								 ALLOCSET_DEFAULT_INITSIZE,
+								 ALLOCSET_DEFAULT_MAXSIZE);
+	oldcxt = MemoryContextSwitchTo(mcxt);
+
+	pw = palloc0(sizeof(ParquetWriter));
+	pw->mcxt = mcxt;
+	pw->filecxt = AllocSetContextCreate(mcxt,
+										"Parquet writer file",
+										ALLOCSET_DEFAULT_MINSIZE,
+										ALLOCSET_DEFAULT_INITSIZE,
+										ALLOCSET_DEFAULT_MAXSIZE);
+	pw->rowcxt = AllocSetContextCreate(mcxt,
+									   "Parquet writer row",
+									   ALLOCSET_DEFAULT_MINSIZE,
+									   ALLOCSET_DEFAULT_INITSIZE,
+									   ALLOCSET_DEFAULT_MAXSIZE);
+	pw->codec = codec;
+	pw->rowgroup_size = rowgroup_size;
+
+	pw->schema = palloc0(sizeof(ParquetSchemaElement) * (tupdesc->natts + 1));
+	pw->columns = palloc0(sizeof(ColumnWriter) * Max(tupdesc->natts, 1));
+
+	pw->schema[0].name = "schema";
+	pw->schema[0].type = -1;
+	pw->schema[0].converted_type = PQC_NONE;
+	pw->nschema = 1;
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+		ParquetSchemaElement *el;
+		ColumnWriter *cw;
+		Oid			basetype;
+		int32		typmod = attr->atttypmod;
+
+		if (attr->attisdropped)
+			continue;
+
+		el = &pw->schema[pw->nschema++];
+		el->name = pstrdup(NameStr(attr->attname));
+		el->repetition = attr->attnotnull ? PQR_REQUIRED : PQR_OPTIONAL;
+		el->converted_type = PQC_NONE;
+
+		basetype = getBaseTypeAndTypmod(attr->atttypid, &typmod);
+
+		cw = &pw->columns[pw->ncolumns++];
+		cw->attno = i;
+		cw->el = el;
+		cw->kind = writer_column_type(el, basetype, typmod);
+		if (cw->kind == PW_OUTPUT)
+		{
+			Oid			outfunc;
+			bool		isvarlena;
+
+			getTypeOutputInfo(attr->atttypid, &outfunc, &isvarlena);
+			fmgr_info(outfunc, &cw->out_func);
+		}
+
+		initStringInfo(&cw->values);
+		initStringInfo(&cw->chunk);
+		initStringInfo(&cw->min_bytes);
+		initStringInfo(&cw->max_bytes);
+		cw->defs_alloc = 1024;
+		cw->defs = palloc(cw->defs_alloc);
+	}
+	pw->schema[0].num_children = pw->ncolumns;
+
+	if (pw->ncolumns == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot write a Parquet file without columns")));
+
+	initStringInfo(&pw->page);
+	initStringInfo(&pw->compressed);
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return pw;
+}
+
+/* ----------------------------------------------------------------
+ * Values
+ * ----------------------------------------------------------------
+ */
+
+static inline void
+put_int32(StringInfo buf, int32 v)
+{
+	uint8		b[4];
+
+	b[0] = (uint8) v;
+	b[1] = (uint8) (v >> 8);
+	b[2] = (uint8) (v >> 16);
+	b[3] = (uint8) (v >> 24);
+	appendBinaryStringInfo(buf, (char *) b, 4);
+}
+
+static inline void
+put_int64(StringInfo buf, int64 v)
+{
+	put_int32(buf, (int32) v);
+	put_int32(buf, (int32) (v >> 32));
+}
+
+/*
+ * Convert a numeric to an integer holding its value times 10^scale. The
+ * column's typmod has already rounded it to that scale.
+ */
+static int64
+numeric_to_scaled(ColumnWriter *cw, Datum value)
+{
+	char	   *str = DatumGetCString(DirectFunctionCall1(numeric_out, value));
+	char	   *p = str;
+	bool		neg = false;
+	int64		result = 0;
+	int			frac = -1;
+
+	if (*p == '-')
+	{
+		neg = true;
+		p++;
+	}
+	if (!isdigit((unsigned char) *p))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("cannot write numeric value \"%s\" to Parquet decimal column \"%s\"",
+						str, cw->el->name)));
+
+	for (; *p; p++)
+	{
+		if (*p == '.')
+		{
+			frac = 0;
+			continue;
+		}
+		if (frac >= 0 && ++frac > cw->el->scale)
+			break;
+		result = result * 10 + (*p - '0');
+	}
+	for (frac = Max(frac, 0); frac < cw->el->scale; frac++)
+		result *= 10;
+
+	return neg ? -result : result;
+}
+
+static void
+update_int_stats(ColumnWriter *cw, int64 v)
+{
+	if (!cw->has_minmax)
+	{
+		cw->min_int = cw->max_int = v;
+		cw->has_minmax = true;
+	}
+	else if (v < cw->min_int)
+		cw->min_int = v;
+	else if (v > cw->max_int)
+		cw->max_int = v;
+}
+
+static void
+update_float_stats(ColumnWriter *cw, double v)
+{
+	/* NaN has no place in the order, so it is left out of the statistics */
+	if (isnan(v))
+		return;
+	if (!cw->has_minmax)
+	{
+		cw->min_float = cw->max_float = v;
+		cw->has_minmax = true;
+	}
+	else if (v < cw->min_float)
+		cw->min_float = v;
+	else if (v > cw->max_float)
+		cw->max_float = v;
+}
+
+static int
+compare_bytes(const char *a, int alen, const char *b, int blen)
+{
+	int			cmp = memcmp(a, b, Min(alen, blen));
+
+	if (cmp != 0)
+		return cmp;
+	return alen - blen;
+}
+
+static void
+update_bytes_stats(ColumnWriter *cw, const char *data, int len)
+{
+	if (cw->stats_too_long)
+		return;
+	if (len > PARQUET_MAX_STAT_LEN)
+	{
+		cw->stats_too_long = true;
+		return;
+	}
+	if (!cw->has_minmax ||
+		compare_bytes(data, len, cw->min_bytes.data, cw->min_bytes.len) < 0)
+	{
+		resetStringInfo(&cw->min_bytes);
+		appendBinaryStringInfo(&cw->min_bytes, data, len);
+	}
+	if (!cw->has_minmax ||
+		compare_bytes(data, len, cw->max_bytes.data, cw->max_bytes.len) > 0)
+	{
+		resetStringInfo(&cw->max_bytes);
+		appendBinaryStringInfo(&cw->max_bytes, data, len);
+	}
+	cw->has_minmax = true;
+}
+
+static void
+put_byte_array(ColumnWriter *cw, const char *data, int len)
+{
+	put_int32(&cw->values, len);
+	appendBinaryStringInfo(&cw->values, data, len);
+	update_bytes_stats(cw, data, len);
+}
+
+/*
+ * Append a string, converted from the server encoding to UTF-8.
+ */
+static void
+put_string(ColumnWriter *cw, const char *data, int len)
+{
+	char	   *utf8 = pg_server_to_any(data, len, PG_UTF8);
+
+	if (utf8 != data)
+		len = strlen(utf8);
+	put_byte_array(cw, utf8, len);
+}
+
+/*
+ * Append a non-null value to the column's page.
+ */
+static void
+put_value(ColumnWriter *cw, Datum value)
+{
+	switch (cw->kind)
+	{
+		case PW_BOOL:
+			{
+				int			bit = cw->page_nonnull % 8;
+
+				if (bit == 0)
+					appendStringInfoCharMacro(&cw->values, 0);
+				if (DatumGetBool(value))
+					cw->values.data[cw->values.len - 1] |= (char) (1 << bit);
+				update_int_stats(cw, DatumGetBool(value) ? 1 : 0);
+			}
+			break;
+
+		case PW_INT16:
+			put_int32(&cw->values, DatumGetInt16(value));
+			update_int_stats(cw, DatumGetInt16(value));
+			break;
+
+		case PW_INT32:
+			put_int32(&cw->values, DatumGetInt32(value));
+			update_int_stats(cw, DatumGetInt32(value));
+			break;
+
+		case PW_INT64:
+		case PW_TIME:
+			put_int64(&cw->values, DatumGetInt64(value));
+			update_int_stats(cw, DatumGetInt64(value));
+			break;
+
+		case PW_FLOAT4:
+			{
+				float4		f = DatumGetFloat4(value);
+
+				appendBinaryStringInfo(&cw->values, (char *) &f, sizeof(f));
+				update_float_stats(cw, f);
+			}
+			break;
+
+		case PW_FLOAT8:
+			{
+				float8		f = DatumGetFloat8(value);
+
+				appendBinaryStringInfo(&cw->values, (char *) &f, sizeof(f));
+				update_float_stats(cw, f);
+			}
+			break;
+
+		case PW_DATE:
+			{
+				DateADT		d = DatumGetDateADT(value);
+
+				if (DATE_NOT_FINITE(d))
+					ereport(ERROR,
+							(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+							 errmsg("cannot write infinite date to Parquet column \"%s\"",
+									cw->el->name)));
+				put_int32(&cw->values, d + PARQUET_EPOCH_SHIFT_DAYS);
+				update_int_stats(cw, d + PARQUET_EPOCH_SHIFT_DAYS);
+			}
+			break;
+
+		case PW_TIMESTAMP:
+			{
+				Timestamp	ts = DatumGetTimestamp(value);
+				int64		usecs;
+
+				if (TIMESTAMP_NOT_FINITE(ts) ||
+					ts > PG_INT64_MAX - PARQUET_EPOCH_SHIFT_DAYS * USECS_PER_DAY)
+					ereport(ERROR,
+							(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+							 errmsg("cannot write timestamp out of range to Parquet column \"%s\"",
+									cw->el->name)));
+				usecs = ts + PARQUET_EPOCH_SHIFT_DAYS * USECS_PER_DAY;
+				put_int64(&cw->values, usecs);
+				update_int_stats(cw, usecs);
+			}
+			break;
+
+		case PW_DECIMAL32:
+		case PW_DECIMAL64:
+			{
+				int64		v = numeric_to_scaled(cw, value);
+
+				if (cw->kind == PW_DECIMAL32)
+					put_int32(&cw->values, (int32) v);
+				else
+					put_int64(&cw->values, v);
+				update_int_stats(cw, v);
+			}
+			break;
+
+		case PW_UUID:
+			{
+				/* pg_uuid_t is opaque, but it is just the 16 bytes */
+				char	   *uuid = (char *) DatumGetUUIDP(value);
+
+				appendBinaryStringInfo(&cw->values, uuid, UUID_LEN);
+				update_bytes_stats(cw, uuid, UUID_LEN);
+			}
+			break;
+
+		case PW_BYTEA:
+			{
+				bytea	   *b = DatumGetByteaPP(value);
+
+				put_byte_array(cw, VARDATA_ANY(b), VARSIZE_ANY_EXHDR(b));
+			}
+			break;
+
+		case PW_TEXT:
+			{
+				text	   *t = DatumGetTextPP(value);
+
+				put_string(cw, VARDATA_ANY(t), VARSIZE_ANY_EXHDR(t));
+			}
+			break;
+
+		case PW_OUTPUT:
+			{
+				char	   *str = OutputFunctionCall(&cw->out_func, value);
+
+				put_string(cw, str, strlen(str));
+			}
+			break;
+	}
+}
+
+/* ----------------------------------------------------------------
+ * Pages and row groups
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * Append definition levels (0 or 1) with the RLE / bit-packing hybrid
+ * encoding and a bit width of 1.
+ */
+static void
+encode_levels(StringInfo buf, const uint8 *levels, int n)
+{
+	int			i = 0;
+
+	while (i < n)
+	{
+		int			run = 1;
+		int			ngroups;
+		int			hdrpos;
+		uint8		hdr[5];
+		int			hdrlen;
+		uint32		h;
+
+		while (i + run < n && levels[i + run] == levels[i])
+			run++;
+		if (run >= 8)
+		{
+			/* RLE run: count << 1, then the value in one byte */
+			h = (uint32) run << 1;
+			while (h >= 0x80)
+			{
+				appendStringInfoCharMacro(buf, (char) ((h & 0x7F) | 0x80));
+				h >>= 7;
+			}
+			appendStringInfoCharMacro(buf, (char) h);
+			appendStringInfoCharMacro(buf, (char) levels[i]);
+			i += run;
+			continue;
+		}
+
+		/*
+		 * Bit-packed run of 8-value groups, up to the next long RLE run.
+		 * The header holds the number of groups, which we only know at the
+		 * end, so reserve room for it and move the groups if it is shorter.
+		 */
+		hdrpos = buf->len;
+		appendBinaryStringInfo(buf, "\0\0\0\0\0", 5);
+		ngroups = 0;
+		for (;;)
+		{
+			uint8		bits = 0;
+			int			j;
+
+			for (j = 0; j < 8 && i + j < n; j++)
+				bits |= levels[i + j] << j;
+			appendStringInfoCharMacro(buf, (char) bits);
+			ngroups++;
+			i += 8;
+			if (i >= n)
+				break;
+			for (run = 1; run < 8 && i + run < n && levels[i + run] == levels[i]; run++)
+				;
+			if (run >= 8)
+				break;
+		}
+
+		h = ((uint32) ngroups << 1) | 1;
+		hdrlen = 0;
+		while (h >= 0x80)
+		{
+			hdr[hdrlen++] = (uint8) ((h & 0x7F) | 0x80);
+			h >>= 7;
+		}
+		hdr[hdrlen++] = (uint8) h;
+		memmove(buf->data + hdrpos + hdrlen, buf->data + hdrpos + 5, ngroups);
+		memcpy(buf->data + hdrpos, hdr, hdrlen);
+		buf->len -= 5 - hdrlen;
+		buf->data[buf->len] = '\0';
+	}
+}
+
+/*
+ * Compress the column's current page and append it to the column chunk.
+ */
+static void
+finish_page(ParquetWriter *pw, ColumnWriter *cw)
+{
+	ParquetPageHeader hdr;
+	int			hdrstart;
+
+	if (cw->page_values == 0)
+		return;
+
+	resetStringInfo(&pw->page);
+	if (cw->el->repetition == PQR_OPTIONAL)
+	{
+		/* the levels are prefixed with their length; build them aside */
+		resetStringInfo(&pw->compressed);
+		encode_levels(&pw->compressed, cw->defs, cw->page_values);
+		put_int32(&pw->page, pw->compressed.len);
+		appendBinaryStringInfo(&pw->page, pw->compressed.data, pw->compressed.len);
+	}
+	appendBinaryStringInfo(&pw->page, cw->values.data, cw->values.len);
+
+	resetStringInfo(&pw->compressed);
+	parquet_compress(pw->codec, pw->page.data, pw->page.len, &pw->compressed);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.type = PQP_DATA_PAGE;
+	hdr.uncompressed_page_size = pw->page.len;
+	hdr.compressed_page_size = pw->compressed.len;
+	hdr.data.num_values = cw->page_values;
+	hdr.data.encoding = PQE_PLAIN;
+	hdr.data.def_level_encoding = PQE_RLE;
+	hdr.data.rep_level_encoding = PQE_RLE;
+
+	hdrstart = cw->chunk.len;
+	parquet_write_page_header(&cw->chunk, &hdr);
+	cw->chunk_uncompressed += (cw->chunk.len - hdrstart) + pw->page.len;
+	appendBinaryStringInfo(&cw->chunk, pw->compressed.data, pw->compressed.len);
+	cw->chunk_values += cw->page_values;
+
+	resetStringInfo(&cw->values);
+	cw->page_values = 0;
+	cw->page_nonnull = 0;
+}
+
+/*
+ * Add a row. Returns true when the buffered row group has reached the row
+ * group size and should be flushed.
+ */
+bool
+parquet_writer_add_row(ParquetWriter *pw, Datum *values, bool *isnull)
+{
+	MemoryContext oldcxt;
+	int64		buffered = 0;
+	int			i;
+
+	/*
+	 * The buffers only grow with repalloc, which keeps them in their own
+	 * context, so everything else allocated here is per-row garbage.
+	 */
+	oldcxt = MemoryContextSwitchTo(pw->rowcxt);
+
+	for (i = 0; i < pw->ncolumns; i++)
+	{
+		ColumnWriter *cw = &pw->columns[i];
+		bool		null = isnull[cw->attno];
+
+		if (null && cw->el->repetition == PQR_REQUIRED)
+			ereport(ERROR,
+					(errcode(ERRCODE_NOT_NULL_VIOLATION),
+					 errmsg("null value in column \"%s\" violates not-null constraint",
+							cw->el->name)));
+
+		if (cw->page_values >= cw->defs_alloc)
+		{
+			cw->defs_alloc *= 2;
+			cw->defs = repalloc(cw->defs, cw->defs_alloc);
+		}
+		cw->defs[cw->page_values++] = null ? 0 : 1;
+
+		if (null)
+			cw->null_count++;
+		else
+		{
+			put_value(cw, values[cw->attno]);
+			cw->page_nonnull++;
+		}
+
+		if (cw->values.len + cw->page_values / 8 >= PARQUET_PAGE_SIZE)
+			finish_page(pw, cw);
+
+		buffered += cw->chunk.len + cw->values.len;
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextReset(pw->rowcxt);
+
+	pw->pending_rows++;
+	return buffered >= pw->rowgroup_size;
+}
+
+int64
+parquet_writer_pending_rows(ParquetWriter *pw)
+{
+	return pw->pending_rows;
+}
+
+static void
+write_bytes(FILE *fp, const char *filename, const char *data, size_t len)
+{
+	if (len > 0 && fwrite(data, 1, len, fp) != len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to file \"%s\": %m", filename)));
+}
+
+/*
+ * Fill in the column chunk statistics from what the column writer tracked.
+ */
+static void
+set_statistics(ColumnWriter *cw, ParquetStatistics *st)
+{
+	StringInfoData min;
+	StringInfoData max;
+
+	memset(st, 0, sizeof(*st));
+	st->has_null_count = true;
+	st->null_count = cw->null_count;
+
+	if (!cw->has_minmax || cw->stats_too_long)
+		return;
+
+	initStringInfo(&min);
+	initStringInfo(&max);
+	switch (cw->el->type)
+	{
+		case PQT_BOOLEAN:
+			appendStringInfoChar(&min, (char) cw->min_int);
+			appendStringInfoChar(&max, (char) cw->max_int);
+			break;
+		case PQT_INT32:
+			put_int32(&min, (int32) cw->min_int);
+			put_int32(&max, (int32) cw->max_int);
+			break;
+		case PQT_INT64:
+			put_int64(&min, cw->min_int);
+			put_int64(&max, cw->max_int);
+			break;
+		case PQT_FLOAT:
+		case PQT_DOUBLE:
+			{
+				/* zeros are written as -0.0 and +0.0, per the format spec */
+				double		lo = (cw->min_float == 0) ? -0.0 : cw->min_float;
+				double		hi = (cw->max_float == 0) ? 0.0 : cw->max_float;
+
+				if (cw->el->type == PQT_FLOAT)
+				{
+					float4		flo = (float4) lo;
+					float4		fhi = (float4) hi;
+
+					appendBinaryStringInfo(&min, (char *) &flo, sizeof(flo));
+					appendBinaryStringInfo(&max, (char *) &fhi, sizeof(fhi));
+				}
+				else
+				{
+					appendBinaryStringInfo(&min, (char *) &lo, sizeof(lo));
+					appendBinaryStringInfo(&max, (char *) &hi, sizeof(hi));
+				}
+			}
+			break;
+		default:
+			appendBinaryStringInfo(&min, cw->min_bytes.data, cw->min_bytes.len);
+			appendBinaryStringInfo(&max, cw->max_bytes.data, cw->max_bytes.len);
+			break;
+	}
+
+	st->has_min = st->has_max = true;
+	st->min = min.data;
+	st->min_len = min.len;
+	st->max = max.data;
+	st->max_len = max.len;
+
+	/*
+	 * Older readers only know the deprecated fields, which are sorted as
+	 * signed values. That is the right order for signed numbers only.
+	 */
+	st->legacy = (cw->el->type != PQT_BYTE_ARRAY &&
+				  cw->el->type != PQT_FIXED_LEN_BYTE_ARRAY);
+}
+
+/*
+ * Write the buffered row group to fp, preceded by the file header if this
+ * is the first one. Returns the size of the file so far.
+ */
+int64
+parquet_writer_flush_rowgroup(ParquetWriter *pw, FILE *fp, const char *filename)
+{
+	MemoryContext oldcxt;
+	ParquetRowGroup *rg;
+	int			i;
+
+	if (pw->pending_rows == 0)
+		return pw->offset;
+
+	if (pw->offset == 0)
+	{
+		write_bytes(fp, filename, PARQUET_MAGIC, PARQUET_MAGIC_LEN);
+		pw->offset = PARQUET_MAGIC_LEN;
+	}
+
+	oldcxt = MemoryContextSwitchTo(pw->filecxt);
+
+	if (pw->nrowgroups >= pw->rowgroups_alloc)
+	{
+		pw->rowgroups_alloc = Max(pw->rowgroups_alloc * 2, 8);
+		if (pw->rowgroups)
+			pw->rowgroups = repalloc(pw->rowgroups,
+									 sizeof(ParquetRowGroup) * pw->rowgroups_alloc);
+		else
+			pw->rowgroups = palloc(sizeof(ParquetRowGroup) * pw->rowgroups_alloc);
+	}
+	rg = &pw->rowgroups[pw->nrowgroups++];
+	rg->num_rows = pw->pending_rows;
+	rg->total_byte_size = 0;
+	rg->ncolumns = pw->ncolumns;
+	rg->columns = palloc0(sizeof(ParquetColumnChunk) * pw->ncolumns);
+
+	for (i = 0; i < pw->ncolumns; i++)
+	{
+		ColumnWriter *cw = &pw->columns[i];
+		ParquetColumnChunk *cc = &rg->columns[i];
+
+		finish_page(pw, cw);
+
+		cc->type = cw->el->type;
+		cc->codec = pw->codec;
+		cc->num_values = cw->chunk_values;
+		cc->total_uncompressed_size = cw->chunk_uncompressed;
+		cc->total_compressed_size = cw->chunk.len;
+		cc->data_page_offset = pw->offset;
+		cc->dictionary_page_offset = -1;
+		set_statistics(cw, &cc->stats);
+		rg->total_byte_size += cw->chunk_uncompressed;
+
+		write_bytes(fp, filename, cw->chunk.data, cw->chunk.len);
+		pw->offset += cw->chunk.len;
+
+		/* reset the column for the next row group */
+		resetStringInfo(&cw->chunk);
+		cw->chunk_values = 0;
+		cw->chunk_uncompressed = 0;
+		cw->null_count = 0;
+		cw->has_minmax = false;
+		cw->stats_too_long = false;
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	pw->num_rows += pw->pending_rows;
+	pw->pending_rows = 0;
+
+	return pw->offset;
+}
+
+/*
+ * Write out any buffered rows and the footer. The writer can then be used
+ * for the next file.
+ */
+void
+parquet_writer_finish_file(ParquetWriter *pw, FILE *fp, const char *filename)
+{
+	MemoryContext oldcxt;
+	ParquetFileMetaData meta;
+	StringInfoData buf;
+	uint8		len[4];
+	int			i;
+
+	parquet_writer_flush_rowgroup(pw, fp, filename);
+	if (pw->offset == 0)
+	{
+		/* no rows at all: still a valid file, with no row groups */
+		write_bytes(fp, filename, PARQUET_MAGIC, PARQUET_MAGIC_LEN);
+		pw->offset = PARQUET_MAGIC_LEN;
+	}
+
+	oldcxt = MemoryContextSwitchTo(pw->filecxt);
+
+	memset(&meta, 0, sizeof(meta));
+	meta.num_rows = pw->num_rows;
+	meta.nschema = pw->nschema;
+	meta.schema = pw->schema;
+	meta.nrowgroups = pw->nrowgroups;
+	meta.rowgroups = pw->rowgroups;
+	meta.nleaves = pw->ncolumns;
+	meta.leaf_schema = palloc(sizeof(int) * pw->ncolumns);
+	for (i = 0; i < pw->ncolumns; i++)
+		meta.leaf_schema[i] = i + 1;
+
+	initStringInfo(&buf);
+	parquet_write_file_metadata(&buf, &meta, "gp_parquet version 1.0.0");
+	len[0] = (uint8) buf.len;
+	len[1] = (uint8) (buf.len >> 8);
+	len[2] = (uint8) (buf.len >> 16);
+	len[3] = (uint8) (buf.len >> 24);
+	write_bytes(fp, filename, buf.data, buf.len);
+	write_bytes(fp, filename, (char *) len, 4);
+	write_bytes(fp, filename, PARQUET_MAGIC, PARQUET_MAGIC_LEN);
+
+	MemoryContextSwitchTo(oldcxt);
+
+	/* start over for the next file */
+	MemoryContextReset(pw->filecxt);
+	pw->rowgroups = NULL;
+	pw->nrowgroups = 0;
+	pw->rowgroups_alloc = 0;
+	pw->num_rows = 0;
+	pw->offset = 0;
+}
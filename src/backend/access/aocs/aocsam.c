@@ -169,6 +169,11 @@ open_ds_write(Relation rel, DatumStreamWrite **ds, TupleDesc relationTupleDesc,
 										/* title */ titleBuf.data,
 										XLogIsNeeded() && RelationNeedsWAL(rel));
 
+		/*
+		 * Let the background compression threads compress this column's
+		 * blocks while the insert fills the other columns.
+		 */
+		AppendOnlyStorageWrite_EnableBackgroundCompress(&ds[i]->ao_write);
 	}
 
 	for (int i = 0; i < RelationGetNumberOfAttributes(rel); i++)
@@ -513,6 +518,8 @@ aocs_beginscan_internal(Relation relation,
 						   relation->rd_appendonly->visimapidxid,
 						   AccessShareLock,
 						   appendOnlyMetaDataSnapshot);
+	/* the scan reads each segment file from start to end */
+	AppendOnlyVisimap_EnableCache(&scan->visibilityMap);
 
 	return scan;
 }
@@ -17,9 +17,13 @@
 #include "access/appendonly_visimap_entry.h"
 #include "access/appendonly_visimap_store.h"
 #include "access/appendonlytid.h"
+#include "access/genam.h"
 #include "access/hash.h"
+#include "catalog/aovisimap.h"
 #include "cdb/cdbappendonlyblockdirectory.h"
+#include "miscadmin.h"
 #include "storage/fd.h"
+#include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 #include "utils/snapmgr.h"
@@ -78,6 +82,14 @@ static void AppendOnlyVisimap_Find(
 					   AppendOnlyVisimap *visiMap,
 					   AOTupleId *tupleId);
 
+static void AppendOnlyVisimap_LoadCache(
+							AppendOnlyVisimap *visiMap,
+							int32 segno);
+
+static bool AppendOnlyVisimapCache_IsVisible(
+								 AppendOnlyVisimapCache *cache,
+								 int64 rowNum);
+
 /*
  * Finishes the visimap operations.
  * No other function should be called with the given
@@ -140,9 +152,246 @@ AppendOnlyVisimap_Init(
 								appendOnlyMetaDataSnapshot,
 								visiMap->memoryContext);
 
+	visiMap->cache.enabled = false;
+
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Makes the visibility checks load the hidden tuples of a segment file all
+ * at once, when they reach the segment file.
+ *
+ * Only for visibility maps of scans that read each segment file in order,
+ * and never hide tuples through this visibility map. The hidden tuples
+ * loaded must not change while the segment file is read, so the visimap
+ * snapshot has to be an MVCC snapshot; with any other snapshot, this does
+ * nothing.
+ */
+void
+AppendOnlyVisimap_EnableCache(AppendOnlyVisimap *visiMap)
+{
+	AppendOnlyVisimapCache *cache;
+
+	Assert(visiMap);
+
+	if (!IsMVCCSnapshot(visiMap->visimapStore.snapshot))
+		return;
+
+	cache = &visiMap->cache;
+	cache->memoryContext = AllocSetContextCreate(visiMap->memoryContext,
+												 "VisiMapCacheContext",
+												 ALLOCSET_DEFAULT_MINSIZE,
+												 ALLOCSET_DEFAULT_INITSIZE,
+												 ALLOCSET_DEFAULT_MAXSIZE);
+	cache->segno = -1;
+	cache->loaded = false;
+	cache->nranges = 0;
+	cache->ranges = NULL;
+	cache->curFirstRowNum = -1;
+	cache->curRange = -1;
+	cache->enabled = true;
+}
+
+/*
+ * Loads the hidden tuples of the given segment file into the cache.
+ *
+ * If they take more than work_mem, the cache is left unloaded and the
+ * visibility checks of the segment file use the visimap entries.
+ */
+static void
+AppendOnlyVisimap_LoadCache(AppendOnlyVisimap *visiMap, int32 segno)
+{
+	AppendOnlyVisimapCache *cache = &visiMap->cache;
+	AppendOnlyVisimapEntry *entry = &visiMap->visimapEntry;
+	ScanKeyData scanKey;
+	IndexScanDesc indexScan;
+	int			maxranges = 0;
+	Size		size = 0;
+	Size		limit = work_mem * 1024L;
+	bool		tooLarge = false;
+
+	MemoryContextReset(cache->memoryContext);
+	cache->segno = segno;
+	cache->loaded = false;
+	cache->nranges = 0;
+	cache->ranges = NULL;
+	cache->curFirstRowNum = -1;
+	cache->curRange = -1;
+
+	ScanKeyInit(&scanKey,
+				Anum_pg_aovisimap_segno,
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(segno));
+
+	/* the index returns the entries by first row number */
+	indexScan = AppendOnlyVisimapStore_BeginScan(&visiMap->visimapStore,
+												 1,
+												 &scanKey);
+
+	while (AppendOnlyVisimapStore_GetNext(&visiMap->visimapStore,
+										  indexScan, ForwardScanDirection,
+										  entry, NULL))
+	{
+		AppendOnlyVisimapCacheRange *range;
+		MemoryContext oldContext;
+		int			nhidden;
+		int			i;
+
+		nhidden = bms_num_members(entry->bitmap);
+		if (nhidden == 0)
+			continue;
+
+		if (nhidden <= APPENDONLY_VISIMAP_CACHE_MAX_OFFSETS)
+			size += nhidden * sizeof(uint16);
+		else
+			size += APPENDONLY_VISIMAP_MAX_RANGE / BITS_PER_BITMAPWORD * sizeof(bitmapword);
+		size += sizeof(AppendOnlyVisimapCacheRange);
+		if (size > limit)
+		{
+			tooLarge = true;
+			break;
+		}
+
+		oldContext = MemoryContextSwitchTo(cache->memoryContext);
+
+		if (cache->nranges == maxranges)
+		{
+			maxranges = Max(maxranges * 2, 16);
+			if (cache->ranges == NULL)
+				cache->ranges = palloc(maxranges * sizeof(AppendOnlyVisimapCacheRange));
+			else
+				cache->ranges = repalloc(cache->ranges,
+										 maxranges * sizeof(AppendOnlyVisimapCacheRange));
+		}
+
+		range = &cache->ranges[cache->nranges++];
+		range->firstRowNum = entry->firstRowNum;
+		range->nhidden = nhidden;
+		range->offsets = NULL;
+		range->words = NULL;
+
+		if (nhidden <= APPENDONLY_VISIMAP_CACHE_MAX_OFFSETS)
+		{
+			int			n = 0;
+
+			range->offsets = palloc(nhidden * sizeof(uint16));
+			for (i = 0; i < entry->bitmap->nwords; i++)
+			{
+				bitmapword	w = entry->bitmap->words[i];
+				int			bit = 0;
+
+				while (w != 0)
+				{
+					if (w & 1)
+						range->offsets[n++] = i * BITS_PER_BITMAPWORD + bit;
+					w >>= 1;
+					bit++;
+				}
+			}
+			Assert(n == nhidden);
+		}
+		else
+		{
+			range->words = palloc0(APPENDONLY_VISIMAP_MAX_RANGE / BITS_PER_BITMAPWORD *
+								   sizeof(bitmapword));
+			memcpy(range->words, entry->bitmap->words,
+				   entry->bitmap->nwords * sizeof(bitmapword));
+		}
+
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, indexScan);
+
+	/* the entry no longer covers the tuples being checked */
+	AppendOnlyVisimapEntry_Reset(entry);
+
+	if (tooLarge)
+	{
+		MemoryContextReset(cache->memoryContext);
+		cache->nranges = 0;
+		cache->ranges = NULL;
+
+		elogif(Debug_appendonly_print_visimap, LOG,
+			   "Append-only visi map: hidden tuples of segment file %d "
+			   "exceed work_mem, not cached", segno);
+		return;
+	}
+
+	cache->loaded = true;
+
+	elogif(Debug_appendonly_print_visimap, LOG,
+		   "Append-only visi map: cached %d ranges with hidden tuples "
+		   "of segment file %d", cache->nranges, segno);
+}
+
+/*
+ * Checks a row of the cached segment file.
+ */
+static bool
+AppendOnlyVisimapCache_IsVisible(AppendOnlyVisimapCache *cache, int64 rowNum)
+{
+	AppendOnlyVisimapCacheRange *range;
+	int64		firstRowNum;
+	int			offset;
+	int			low;
+	int			high;
+
+	/* no hidden tuples in this segment file */
+	if (cache->nranges == 0)
+		return true;
+
+	firstRowNum = (rowNum / APPENDONLY_VISIMAP_MAX_RANGE) * APPENDONLY_VISIMAP_MAX_RANGE;
+	if (firstRowNum != cache->curFirstRowNum)
+	{
+		cache->curFirstRowNum = firstRowNum;
+		cache->curRange = -1;
+
+		low = 0;
+		high = cache->nranges - 1;
+		while (low <= high)
+		{
+			int			mid = (low + high) / 2;
+
+			if (cache->ranges[mid].firstRowNum < firstRowNum)
+				low = mid + 1;
+			else if (cache->ranges[mid].firstRowNum > firstRowNum)
+				high = mid - 1;
+			else
+			{
+				cache->curRange = mid;
+				break;
+			}
+		}
+	}
+
+	if (cache->curRange < 0)
+		return true;
+
+	range = &cache->ranges[cache->curRange];
+	offset = (int) (rowNum - firstRowNum);
+
+	if (range->words)
+		return (range->words[offset / BITS_PER_BITMAPWORD] &
+				((bitmapword) 1 << (offset % BITS_PER_BITMAPWORD))) == 0;
+
+	low = 0;
+	high = range->nhidden - 1;
+	while (low <= high)
+	{
+		int			mid = (low + high) / 2;
+
+		if (range->offsets[mid] < offset)
+			low = mid + 1;
+		else if (range->offsets[mid] > offset)
+			high = mid - 1;
+		else
+			return false;
+	}
+	return true;
+}
+
 /*
  * Moves the visibility map entry so that the given
  * AO tuple id is covered by it.
@@ -198,6 +447,18 @@ AppendOnlyVisimap_IsVisible(
 		   "(tupleId) = %s",
 		   AOTupleIdToString(aoTupleId));
 
+	if (visiMap->cache.enabled)
+	{
+		int32		segno = AOTupleIdGet_segmentFileNum(aoTupleId);
+
+		if (segno != visiMap->cache.segno)
+			AppendOnlyVisimap_LoadCache(visiMap, segno);
+
+		if (visiMap->cache.loaded)
+			return AppendOnlyVisimapCache_IsVisible(&visiMap->cache,
+													AOTupleIdGet_rowNum(aoTupleId));
+	}
+
 	if (!AppendOnlyVisimapEntry_CoversTuple(&visiMap->visimapEntry,
 											aoTupleId))
 	{
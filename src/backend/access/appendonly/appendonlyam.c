@@ -1651,6 +1651,8 @@ appendonly_beginrangescan_internal(Relation relation,
 						   relation->rd_appendonly->visimapidxid,
 						   AccessShareLock,
 						   appendOnlyMetaDataSnapshot);
+	/* the scan reads each segment file from start to end */
+	AppendOnlyVisimap_EnableCache(&scan->visibilityMap);
 
 	return scan;
 }
@@ -29,12 +29,14 @@
 #include "libpq-fe.h"
 #include "miscadmin.h"
 #include "storage/lmgr.h"
+#include "storage/proc.h"
 #include "utils/builtins.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
 #include "utils/int8.h"
 #include "utils/lsyscache.h"
 #include "utils/snapmgr.h"
+#include "utils/timestamp.h"
 
 #include "cdb/cdbvars.h"		/* Gp_role              */
 #include "cdb/cdbdisp_query.h"
@@ -80,6 +82,19 @@ is_entry_in_use_by_other_transactions(AORelHashEntry aoentry) {
 	return aoentry->txns_using_rel != 0;
 }
 
+/*
+ * AppendOnlyWriterDataSize
+ *
+ * Size of the writer structure, which has a slot for every backend that may
+ * wait in SetSegnoForWrite.
+ */
+static Size
+AppendOnlyWriterDataSize(void)
+{
+	return add_size(offsetof(AppendOnlyWriterData, insert_waiting_for),
+					mul_size(MaxBackends, sizeof(Oid)));
+}
+
 /*
  * AppendOnlyWriterShmemSize -- estimate size the append only writer structures
  * will need in shared memory.
@@ -97,7 +112,7 @@ AppendOnlyWriterShmemSize(void)
 							  sizeof(AORelHashEntryData));
 
 	/* The writer structure. */
-	size = add_size(size, sizeof(AppendOnlyWriterData));
+	size = add_size(size, AppendOnlyWriterDataSize());
 
 	/* Add a safety margin */
 	size = add_size(size, size / 10);
@@ -121,7 +136,7 @@ InitAppendOnlyWriter(void)
 	/* Create the writer structure. */
 	AppendOnlyWriter = (AppendOnlyWriterData *)
 		ShmemInitStruct("Append Only Writer Data",
-						sizeof(AppendOnlyWriterData),
+						AppendOnlyWriterDataSize(),
 						&found);
 
 	if (found && AppendOnlyHash)
@@ -131,6 +146,11 @@ InitAppendOnlyWriter(void)
 	/* Specify that we have no AO rel information yet. */
 	AppendOnlyWriter->num_existing_aorels = 0;
 
+	/* Nobody waits for a segment file yet. */
+	AppendOnlyWriter->num_insert_waiters = 0;
+	for (int i = 0; i < MaxBackends; i++)
+		AppendOnlyWriter->insert_waiting_for[i] = InvalidOid;
+
 	/* Create AppendOnlyHash (empty at this point). */
 	ok = AOHashTableInit();
 	if (!ok)
@@ -1081,6 +1101,80 @@ SetSegnoForCompactionInsert(Relation rel,
 	return usesegno;
 }
 
+/*
+ * wakeInsertWaiters
+ *
+ * Wake up the inserts that wait in SetSegnoForWrite for a segfile of the
+ * given relation.  The caller must hold the AO segfile lock.
+ */
+static void
+wakeInsertWaiters(Oid relid)
+{
+	int			i;
+
+	if (AppendOnlyWriter->num_insert_waiters == 0)
+		return;
+
+	for (i = 0; i < MaxBackends; i++)
+	{
+		if (AppendOnlyWriter->insert_waiting_for[i] == relid)
+			SetLatch(&ProcGlobal->allProcs[i].procLatch);
+	}
+}
+
+/*
+ * chooseSegnoForWrite
+ *
+ * Returns the segno that this transaction already inserts into, or else the
+ * first of the segnos below 'limit' that is available, not over the allowed
+ * size threshold and not used by a concurrent transaction.
+ *
+ * Returns InvalidFileSegNumber if there is no such segno.  Never returns
+ * segno 0.  The caller must hold the AO segfile lock.
+ */
+static int
+chooseSegnoForWrite(AORelHashEntryData *aoentry, int limit, bool *reused)
+{
+	TransactionId CurrentXid = GetTopTransactionId();
+	int			usesegno = InvalidFileSegNumber;
+	int			i;
+
+	*reused = false;
+
+	for (i = 1; i < MAX_AOREL_CONCURRENCY; i++)
+	{
+		AOSegfileStatus *segfilestat = &aoentry->relsegfiles[i];
+
+		if (segfilestat->isfull)
+			continue;
+
+		if (usesegno == InvalidFileSegNumber &&
+			i < limit &&
+			segfilestat->state == AVAILABLE &&
+			segfilestat->formatversion == AORelationVersion_GetLatest() &&
+			!usedByConcurrentTransaction(segfilestat, i))
+		{
+			/*
+			 * this segno is avaiable and not full. use it.
+			 *
+			 * Notice that we don't break out of the loop quite yet. We still
+			 * need to check the rest of the segnos, if our txn is already
+			 * using one of them.
+			 */
+			usesegno = i;
+		}
+
+		if (segfilestat->xid == CurrentXid)
+		{
+			/* we already used this segno in our txn. use it again */
+			*reused = true;
+			return i;
+		}
+	}
+
+	return usesegno;
+}
+
 /*
  * SetSegnoForWrite
  *
@@ -1119,9 +1213,10 @@ int
 SetSegnoForWrite(Relation rel, int existingsegno)
 {
 	/* these vars are used in GP_ROLE_DISPATCH only */
-	int			i,
-				usesegno = RESERVED_SEGNO;
+	int			usesegno = RESERVED_SEGNO;
+	int			limit;
 	bool		segno_chosen = false;
+	bool		reused;
 	bool		increment_txns_using_rel = true;
 	AORelHashEntryData *aoentry = NULL;
 	TransactionId CurrentXid = GetTopTransactionId();
@@ -1171,51 +1266,96 @@ SetSegnoForWrite(Relation rel, int existingsegno)
 			 * in this very same transaction we are still in (explicit txn) we
 			 * pick the same one to insert into it again.
 			 *
-			 * Never use segno 0 for inserts (unless in utility mode)
+			 * With gp_appendonly_insert_segfile_limit set, concurrent inserts
+			 * take turns on the first segfiles instead of each taking a
+			 * segfile of its own, so that many small concurrent loads don't
+			 * spread the table over many small segfiles.  If none of them is
+			 * usable, wait for one to be released, and only go past the
+			 * limit when none becomes usable in time.  Waiting is
+			 * deadlock-free because of the timeout.
+			 *
+			 * A segfile released by a transaction that committed after our
+			 * snapshot was taken stays unusable for this statement, because
+			 * this transaction could then see rows it must not see through
+			 * the segfile's eof.  So the wait pays off when the holder
+			 * aborts; later statements reuse committed segfiles anyway.
 			 */
-			for (i = 1; i < MAX_AOREL_CONCURRENCY; i++)
+			limit = MAX_AOREL_CONCURRENCY;
+			if (gp_appendonly_insert_segfile_limit > 0)
+				limit = gp_appendonly_insert_segfile_limit + 1;
+
+			usesegno = chooseSegnoForWrite(aoentry, limit, &reused);
+
+			if (usesegno == InvalidFileSegNumber && limit < MAX_AOREL_CONCURRENCY)
 			{
-				AOSegfileStatus *segfilestat = &aoentry->relsegfiles[i];
+				TimestampTz deadline;
+				long		secs;
+				int			usecs;
 
-				if (!segfilestat->isfull)
+				deadline = TimestampTzPlusMilliseconds(GetCurrentTimestamp(),
+													   gp_appendonly_insert_segfile_wait);
+
+				Assert(MyProc->pgprocno < MaxBackends);
+				while (usesegno == InvalidFileSegNumber)
 				{
-					if (segfilestat->state == AVAILABLE &&
-						segfilestat->formatversion == AORelationVersion_GetLatest() &&
-						!segno_chosen &&
-						!usedByConcurrentTransaction(segfilestat, i))
-					{
-						/*
-						 * this segno is avaiable and not full. use it.
-						 *
-						 * Notice that we don't break out of the loop quite
-						 * yet. We still need to check the rest of the segnos,
-						 * if our txn is already using one of them. see below.
-						 */
-						usesegno = i;
-						segno_chosen = true;
-					}
+					TimestampDifference(GetCurrentTimestamp(), deadline, &secs, &usecs);
+					if (secs == 0 && usecs == 0)
+						break;
 
-					if (segfilestat->xid == CurrentXid)
-					{
-						/* we already used this segno in our txn. use it again */
-						usesegno = i;
-						segno_chosen = true;
-						increment_txns_using_rel = false; /* same transaction; do not increment */
-
-						ereportif(Debug_appendonly_print_segfile_choice, LOG,
-								  (errmsg("SetSegnoForWrite: reusing segno %d for append-"
-										  "only relation "
-										  "%d. there are " INT64_FORMAT " tuples "
-										  "added to it from previous operations "
-										  "in this not yet committed txn. decrementing"
-										  "txns_using_rel back to %d",
-										  usesegno, RelationGetRelid(rel),
-										  (int64) segfilestat->tupsadded,
-										  aoentry->txns_using_rel)));
+					/*
+					 * Sleep until AtEOXact_AppendOnly_Relation releases a
+					 * segfile of this relation, or the wait times out.
+					 */
+					AppendOnlyWriter->insert_waiting_for[MyProc->pgprocno] = RelationGetRelid(rel);
+					AppendOnlyWriter->num_insert_waiters++;
+					release_lightweight_lock();
 
-						break;
-					}
+					WaitLatch(&MyProc->procLatch, WL_LATCH_SET | WL_TIMEOUT,
+							  secs * 1000L + (usecs + 999) / 1000);
+					ResetLatch(&MyProc->procLatch);
+
+					acquire_lightweight_lock();
+					AppendOnlyWriter->insert_waiting_for[MyProc->pgprocno] = InvalidOid;
+					AppendOnlyWriter->num_insert_waiters--;
+					release_lightweight_lock();
+
+					CHECK_FOR_INTERRUPTS();
+
+					acquire_lightweight_lock();
+
+					/* the entry may have been evicted while we slept */
+					aoentry = AORelGetOrCreateHashEntry(RelationGetRelid(rel));
+					Assert(aoentry);
+					usesegno = chooseSegnoForWrite(aoentry, limit, &reused);
 				}
+
+				if (usesegno == InvalidFileSegNumber)
+				{
+					ereportif(Debug_appendonly_print_segfile_choice, LOG,
+							  (errmsg("SetSegnoForWrite: no segno within gp_appendonly_insert_segfile_limit "
+									  "was released in time for relation \"%s\" (%d)",
+									  RelationGetRelationName(rel), RelationGetRelid(rel))));
+
+					usesegno = chooseSegnoForWrite(aoentry, MAX_AOREL_CONCURRENCY, &reused);
+				}
+			}
+
+			segno_chosen = (usesegno != InvalidFileSegNumber);
+			if (reused)
+			{
+				/* same transaction; do not increment */
+				increment_txns_using_rel = false;
+
+				ereportif(Debug_appendonly_print_segfile_choice, LOG,
+						  (errmsg("SetSegnoForWrite: reusing segno %d for append-"
+								  "only relation "
+								  "%d. there are " INT64_FORMAT " tuples "
+								  "added to it from previous operations "
+								  "in this not yet committed txn. decrementing"
+								  "txns_using_rel back to %d",
+								  usesegno, RelationGetRelid(rel),
+								  (int64) aoentry->relsegfiles[usesegno].tupsadded,
+								  aoentry->txns_using_rel)));
 			}
 
 			if (!segno_chosen)
@@ -2024,6 +2164,7 @@ AtEOXact_AppendOnly_Relation(AORelHashEntry aoentry, TransactionId currentXid)
 	if (entry_updated)
 	{
 		aoentry->txns_using_rel--;
+		wakeInsertWaiters(aoentry->relid);
 
 		ereportif(Debug_appendonly_print_segfile_choice, LOG,
 				  (errmsg("AtEOXact_AppendOnly: updated txns_using_rel, it is now %d",
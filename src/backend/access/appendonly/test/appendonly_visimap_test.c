@@ -64,6 +64,64 @@ test__AppendOnlyVisimapDelete_Finish_outoforder(void **state)
 	assert_int_equal(val.workFileOffset, INT64_MAX);
 }
 
+/*
+ * Visibility checks against a cached segment file, with a range that keeps
+ * the offsets of its hidden tuples and a range that keeps a bitmap.
+ */
+static void
+test__AppendOnlyVisimapCache_IsVisible(void **state)
+{
+	AppendOnlyVisimapCache cache;
+	AppendOnlyVisimapCacheRange ranges[2];
+	uint16		offsets[] = {0, 7, 100};
+	bitmapword	words[APPENDONLY_VISIMAP_MAX_RANGE / BITS_PER_BITMAPWORD];
+	int64		bitmapFirst = 5 * APPENDONLY_VISIMAP_MAX_RANGE;
+
+	memset(&cache, 0, sizeof(cache));
+	cache.curFirstRowNum = -1;
+	cache.curRange = -1;
+
+	/* no hidden tuples at all */
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, 0));
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, 123456));
+
+	ranges[0].firstRowNum = APPENDONLY_VISIMAP_MAX_RANGE;
+	ranges[0].nhidden = 3;
+	ranges[0].offsets = offsets;
+	ranges[0].words = NULL;
+
+	memset(words, 0, sizeof(words));
+	words[0] = 1 << 3;
+	words[APPENDONLY_VISIMAP_MAX_RANGE / BITS_PER_BITMAPWORD - 1] =
+		(bitmapword) 1 << (BITS_PER_BITMAPWORD - 1);
+	ranges[1].firstRowNum = bitmapFirst;
+	ranges[1].nhidden = APPENDONLY_VISIMAP_CACHE_MAX_OFFSETS + 1;
+	ranges[1].offsets = NULL;
+	ranges[1].words = words;
+
+	cache.nranges = 2;
+	cache.ranges = ranges;
+
+	/* a range without hidden tuples */
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, 1));
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, 3 * APPENDONLY_VISIMAP_MAX_RANGE + 7));
+
+	/* the offsets range */
+	assert_false(AppendOnlyVisimapCache_IsVisible(&cache, APPENDONLY_VISIMAP_MAX_RANGE));
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, APPENDONLY_VISIMAP_MAX_RANGE + 1));
+	assert_false(AppendOnlyVisimapCache_IsVisible(&cache, APPENDONLY_VISIMAP_MAX_RANGE + 7));
+	assert_false(AppendOnlyVisimapCache_IsVisible(&cache, APPENDONLY_VISIMAP_MAX_RANGE + 100));
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, APPENDONLY_VISIMAP_MAX_RANGE + 101));
+
+	/* the bitmap range */
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, bitmapFirst));
+	assert_false(AppendOnlyVisimapCache_IsVisible(&cache, bitmapFirst + 3));
+	assert_true(AppendOnlyVisimapCache_IsVisible(&cache, bitmapFirst + 4));
+	assert_false(AppendOnlyVisimapCache_IsVisible(&cache, bitmapFirst + APPENDONLY_VISIMAP_MAX_RANGE - 1));
+
+	/* and back to the first one */
+	assert_false(AppendOnlyVisimapCache_IsVisible(&cache, APPENDONLY_VISIMAP_MAX_RANGE + 7));
+}
 
 int
 main(int argc, char *argv[])
@@ -71,7 +129,8 @@ main(int argc, char *argv[])
 	cmockery_parse_arguments(argc, argv);
 
 	const		UnitTest tests[] = {
-		unit_test(test__AppendOnlyVisimapDelete_Finish_outoforder)
+		unit_test(test__AppendOnlyVisimapDelete_Finish_outoforder),
+		unit_test(test__AppendOnlyVisimapCache_IsVisible)
 	};
 
 	MemoryContextInit();
@@ -29,10 +29,13 @@
 #include "storage/lmgr.h"
 #include "storage/smgr.h"
 #include "parser/parse_oper.h"
+#include "utils/guc.h"
 #include "utils/memutils.h"
 
 static void bmbuildCallback(Relation index,	ItemPointer tupleId, Datum *attdata,
 							bool *nulls, bool tupleIsAlive,	void *state);
+static uint32 literal_run_length(BM_HRL_WORD *hwords, uint32 wordno,
+								 uint32 maxwords);
 static bool words_get_match(BMBatchWords *words, BMIterateResult *result,
                             BlockNumber blockno, PagetableEntry *entry,
 							bool newentry);
@@ -86,9 +89,21 @@ bmbuild(PG_FUNCTION_ARGS)
 	/* initialize the build state. */
 	_bitmap_init_buildstate(index, &bmstate);
 
+	/*
+	 * Sort the index tuples on (key, tid), so that each bitmap vector can be
+	 * written out sequentially, rather than buffering the tids of all the
+	 * distinct values at once.
+	 */
+	if (gp_bitmap_index_sort_build)
+		bmstate.bm_spool = _bitmap_spoolinit(heap, index);
+
 	/* do the heap scan */
 	reltuples = IndexBuildScan(heap, index, indexInfo, false,
 							  bmbuildCallback, (void *)&bmstate);
+
+	if (bmstate.bm_spool)
+		_bitmap_write_spool(index, &bmstate);
+
 	/* clean up the build state */
 	_bitmap_cleanup_buildstate(index, &bmstate);
 	
@@ -829,6 +844,41 @@ copy_scan_desc(IndexScanDesc scan)
 	return s;
 }
 
+/*
+ * Return the number of consecutive literal (non-fill) words starting at
+ * 'wordno', looking at no more than 'maxwords' words. The header words have
+ * one bit per content word, leftmost first, so the run ends at the first
+ * set bit.
+ */
+static uint32
+literal_run_length(BM_HRL_WORD *hwords, uint32 wordno, uint32 maxwords)
+{
+	uint32		n = 0;
+
+	while (n < maxwords)
+	{
+		uint32		pos = wordno + n;
+		BM_HRL_WORD h = hwords[pos / BM_HRL_WORD_SIZE] << (pos % BM_HRL_WORD_SIZE);
+
+		if (h != 0)
+		{
+#ifdef __GNUC__
+			n += __builtin_clzll(h);
+#else
+			while ((h & ((BM_HRL_WORD) 1 << BM_HRL_WORD_LEFTMOST)) == 0)
+			{
+				h <<= 1;
+				n++;
+			}
+#endif
+			break;
+		}
+		n += BM_HRL_WORD_SIZE - (pos % BM_HRL_WORD_SIZE);
+	}
+
+	return Min(n, maxwords);
+}
+
 /*
  * Given a set of bitmap words and our current position, get the next
  * page with matches on it.
@@ -976,7 +1026,49 @@ restart:
 	while (words->nwords > 0 && result->nextTid < end)
 	{
 		BM_HRL_WORD word = words->cwords[result->lastScanWordNo];
+#if BM_HRL_WORD_SIZE == TBM_BITS_PER_BITMAPWORD
+		/*
+		 * Every HRL word maps onto exactly one word of the page, so expand
+		 * a whole fill word, or a whole run of literal words, at a time.
+		 */
+		uint64		nleft = (end + 1 - result->nextTid) / BM_HRL_WORD_SIZE;
+		uint64		n;
+
+		if (IS_FILL_WORD(words->hwords, result->lastScanWordNo))
+		{
+			uint64		filllen = FILL_LENGTH(word);
+
+			/* an empty fill word stands for one word of zeros, as above */
+			if (filllen == 0)
+				filllen = 1;
+			n = Min(filllen, nleft);
+
+			if (GET_FILL_BIT(word) == 1)
+				memset(&entry->words[newwordno], 0xFF,
+					   n * sizeof(tbm_bitmapword));
+
+			if (n == filllen)
+			{
+				result->lastScanWordNo++;
+				words->nwords--;
+			}
+			else
+				words->cwords[result->lastScanWordNo] -= n;
+		}
+		else
+		{
+			n = literal_run_length(words->hwords, result->lastScanWordNo,
+								   Min(words->nwords, nleft));
+			tbm_union_words(&entry->words[newwordno],
+							&words->cwords[result->lastScanWordNo], n);
+			result->lastScanWordNo += n;
+			words->nwords -= n;
+		}
 
+		Assert(newwordno + n <= WORDS_PER_PAGE);
+		newwordno += n;
+		result->nextTid += n * BM_HRL_WORD_SIZE;
+#else
 		if (IS_FILL_WORD(words->hwords, result->lastScanWordNo))
 		{
 			if (GET_FILL_BIT(word) == 1)
@@ -1012,6 +1104,7 @@ restart:
 			/* reset newWord */
 			newWord = 0;
 		}
+#endif
 	}
 
 	if (hrlwordno % nhrlwords != 0)
@@ -22,6 +22,7 @@
 #include "access/tupdesc.h"
 #include "access/heapam.h"
 #include "access/bitmap.h"
+#include "access/nbtree.h"
 #include "access/transam.h"
 #include "parser/parse_oper.h"
 #include "utils/builtins.h"
@@ -30,6 +31,7 @@
 #include "utils/lsyscache.h"
 #include "utils/snapmgr.h"
 #include "utils/faultinjector.h"
+#include "utils/tuplesort.h"
 
 /*
  * The following structure along with BMTIDBuffer are used to buffer
@@ -49,6 +51,15 @@ typedef struct BMTIDLOVBuffer
 	BMTIDBuffer *bufs[BM_MAX_LOVITEMS_PER_PAGE];
 } BMTIDLOVBuffer;
 
+/*
+ * BMSpool holds the index tuples of a sorted index build -- see
+ * _bitmap_write_spool().
+ */
+struct BMSpool
+{
+	Tuplesortstate *sortstate;
+};
+
 static void _bitmap_write_new_bitmapwords(Relation rel,
 							  Buffer lovBuffer, OffsetNumber lovOffset,
 							  BMTIDBuffer* buf, bool use_wal);
@@ -2273,6 +2284,212 @@ _bitmap_write_alltids(Relation rel, BMTidBuildBuf *tids,
 	tids->byte_size = 0;
 }
 
+/*
+ * _bitmap_spoolinit() -- start sorting the index tuples of an index build.
+ *
+ * Like a btree build, the sort may use maintenance_work_mem.
+ */
+BMSpool *
+_bitmap_spoolinit(Relation heap, Relation index)
+{
+	BMSpool	   *spool = (BMSpool *) palloc0(sizeof(BMSpool));
+
+	/*
+	 * The bitmap operator classes have the btree comparison function as
+	 * their support function 1, so the index sorts like a btree would. Equal
+	 * keys are ordered on their tids.
+	 */
+	spool->sortstate = tuplesort_begin_index_btree(heap, index, false,
+												   maintenance_work_mem,
+												   false);
+
+	return spool;
+}
+
+/*
+ * spool_keys_equal() -- are the keys of two sorted index tuples equal?
+ */
+static bool
+spool_keys_equal(TupleDesc tupDesc, ScanKey scanKeys,
+				 IndexTuple itup1, IndexTuple itup2)
+{
+	int			attno;
+
+	for (attno = 1; attno <= tupDesc->natts; attno++)
+	{
+		ScanKey		scanKey = &scanKeys[attno - 1];
+		Datum		datum1;
+		Datum		datum2;
+		bool		isNull1;
+		bool		isNull2;
+
+		datum1 = index_getattr(itup1, attno, tupDesc, &isNull1);
+		datum2 = index_getattr(itup2, attno, tupDesc, &isNull2);
+
+		if (isNull1 || isNull2)
+		{
+			if (isNull1 != isNull2)
+				return false;
+			continue;
+		}
+
+		if (DatumGetInt32(FunctionCall2Coll(&scanKey->sk_func,
+											scanKey->sk_collation,
+											datum1, datum2)) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * _bitmap_write_spool() -- write out the bitmap vectors of a sorted index
+ *	build.
+ *
+ * The index tuples come out of the sort grouped by key, and in tid order
+ * within a key. So each distinct value gets its LOV item when its first
+ * tuple is seen, and its bitmap words are compressed and written out
+ * sequentially through a single BMTIDBuffer, which is flushed before moving
+ * on to the next value. Only one value's words are in memory at a time.
+ */
+void
+_bitmap_write_spool(Relation rel, BMBuildState *state)
+{
+	Tuplesortstate *sortstate = state->bm_spool->sortstate;
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	ScanKey		scanKeys = _bt_mkscankey_nodata(rel);
+	Datum	   *attdata = (Datum *) palloc(tupDesc->natts * sizeof(Datum));
+	bool	   *nulls = (bool *) palloc(tupDesc->natts * sizeof(bool));
+	IndexTuple	previtup = NULL;
+	IndexTuple	itup;
+	bool		should_free;
+	BMTIDBuffer buf;
+	Buffer		lovBuffer = InvalidBuffer;
+	BlockNumber lovBlock = InvalidBlockNumber;
+	OffsetNumber lovOffset = InvalidOffsetNumber;
+	uint64		ntids = 0;
+
+	MemSet(&buf, 0, sizeof(BMTIDBuffer));
+
+	tuplesort_performsort(sortstate);
+
+	while ((itup = tuplesort_getindextuple(sortstate, true,
+										   &should_free)) != NULL)
+	{
+		uint64		tidnum = BM_IPTR_TO_INT(&itup->t_tid);
+
+		if (previtup == NULL ||
+			!spool_keys_equal(tupDesc, scanKeys, previtup, itup))
+		{
+			Page		lovPage;
+			BMLOVItem	lovItem;
+			bool		allNulls = true;
+			int			attno;
+
+			/* Done with the previous value. */
+			if (BufferIsValid(lovBuffer))
+			{
+				buf_free_mem_block(rel, &buf, lovBuffer, lovOffset,
+								   state->use_wal);
+				_bitmap_relbuf(lovBuffer);
+				lovBuffer = InvalidBuffer;
+			}
+
+			index_deform_tuple(itup, tupDesc, attdata, nulls);
+			for (attno = 0; attno < tupDesc->natts; attno++)
+			{
+				if (!nulls[attno])
+				{
+					allNulls = false;
+					break;
+				}
+			}
+
+			/*
+			 * All-NULL keys use the first LOV item. Any other key is seen
+			 * here for the first time, since the index is being built.
+			 */
+			if (allNulls)
+			{
+				lovBlock = BM_LOV_STARTPAGE;
+				lovOffset = 1;
+			}
+			else
+			{
+				Buffer		metabuf;
+
+				metabuf = _bitmap_getbuf(rel, BM_METAPAGE, BM_WRITE);
+				create_lovitem(rel, metabuf, tidnum, tupDesc, attdata, nulls,
+							   state->bm_lov_heap, state->bm_lov_index,
+							   &lovBlock, &lovOffset, state->use_wal);
+				_bitmap_wrtbuf(metabuf);
+			}
+
+			lovBuffer = _bitmap_getbuf(rel, lovBlock, BM_WRITE);
+			lovPage = BufferGetPage(lovBuffer);
+			lovItem = (BMLOVItem) PageGetItem(lovPage,
+											  PageGetItemId(lovPage, lovOffset));
+
+			MemSet(&buf, 0, sizeof(BMTIDBuffer));
+			buf.last_tid = lovItem->bm_last_setbit;
+			buf.last_compword = lovItem->bm_last_compword;
+			buf.last_word = lovItem->bm_last_word;
+			buf.is_last_compword_fill = (lovItem->lov_words_header == 2);
+			buf_extend(&buf);
+
+			if (previtup != NULL)
+				pfree(previtup);
+			previtup = should_free ? itup : CopyIndexTuple(itup);
+		}
+		else
+		{
+			/*
+			 * A heap tuple can be returned more than once for a HOT chain;
+			 * its bit is already set.
+			 */
+			if (tidnum == buf.last_tid)
+			{
+				if (should_free)
+					pfree(itup);
+				continue;
+			}
+
+			if (should_free)
+				pfree(itup);
+		}
+
+		buf_add_tid_with_fill(rel, &buf, lovBuffer, lovOffset, tidnum,
+							  state->use_wal);
+
+		/*
+		 * Let go of the LOV buffer now and then, so that a long run of equal
+		 * keys can be cancelled.
+		 */
+		if (++ntids % 1000 == 0)
+		{
+			_bitmap_relbuf(lovBuffer);
+			CHECK_FOR_INTERRUPTS();
+			lovBuffer = _bitmap_getbuf(rel, lovBlock, BM_WRITE);
+		}
+	}
+
+	if (BufferIsValid(lovBuffer))
+	{
+		buf_free_mem_block(rel, &buf, lovBuffer, lovOffset, state->use_wal);
+		_bitmap_relbuf(lovBuffer);
+	}
+
+	if (previtup != NULL)
+		pfree(previtup);
+	pfree(attdata);
+	pfree(nulls);
+	_bt_freeskey(scanKeys);
+
+	tuplesort_end(sortstate);
+	pfree(state->bm_spool);
+	state->bm_spool = NULL;
+}
+
 /*
  * build_inserttuple() -- insert a new tuple into the bitmap index
  *	during the bitmap index construction.
@@ -2542,6 +2759,18 @@ _bitmap_buildinsert(Relation rel, ItemPointerData ht_ctid, Datum *attdata,
 
 	tupDesc = RelationGetDescr(rel);
 
+	if (state->bm_spool)
+	{
+		IndexTuple	itup;
+
+		/* _bitmap_write_spool() sets the bits once the tuples are sorted */
+		itup = index_form_tuple(tupDesc, attdata, nulls);
+		itup->t_tid = ht_ctid;
+		tuplesort_putindextuple(state->bm_spool->sortstate, itup);
+		pfree(itup);
+		return;
+	}
+
 	/* insert a new bit into the corresponding bitmap */
 	build_inserttuple(rel, tidOffset, ht_ctid,
 							  tupDesc, attdata, nulls, state);
@@ -173,6 +173,7 @@ _bitmap_init_buildstate(Relation index, BMBuildState *bmstate)
 	bmstate->bm_tidLocsBuffer->byte_size = 0;
 	bmstate->bm_tidLocsBuffer->lov_blocks = NIL;
 	bmstate->bm_tidLocsBuffer->max_lov_block = InvalidBlockNumber;
+	bmstate->bm_spool = NULL;
 
 	metabuf = _bitmap_getbuf(index, BM_METAPAGE, BM_READ);
 	mp = _bitmap_get_metapage_data(index, metabuf);
@@ -910,7 +910,13 @@ externalgettup_defined(FileScanDesc scan)
 	MemoryContextReset(pstate->rowcontext);
 	oldcontext = MemoryContextSwitchTo(pstate->rowcontext);
 
-	/* Get a line */
+	/*
+	 * Get a line.  Parsing and the type input functions run here, in the
+	 * backend, one row at a time: they palloc and elog, so they can't be
+	 * farmed out to threads.  Only the transfer of the input overlaps with
+	 * them (see read_ahead() in url_curl.c, and the POSIX_FADV_SEQUENTIAL
+	 * hint in gfile_open()).
+	 */
 	if (!NextCopyFrom(pstate,
 					  NULL,
 					  scan->values,
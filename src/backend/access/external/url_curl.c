@@ -154,6 +154,13 @@ static CURLM *multi_handle = 0;
 
 static int
 fill_buffer(URL_CURL_FILE *curl, int want);
+static void read_ahead(URL_CURL_FILE *curl);
+
+/*
+ * How much data curl_fread() keeps pulling from gpfdist beyond what has been
+ * asked for, see read_ahead().
+ */
+#define CURL_READ_AHEAD_BYTES	(4 * 1024 * 1024)
 
 /*
  * A helper macro, to call curl_easy_setopt(), and ereport() if it fails.
@@ -822,6 +829,33 @@ fill_buffer(URL_CURL_FILE *curl, int want)
 	return 0;
 }
 
+/*
+ * read_ahead
+ *
+ * fill_buffer() only drives the transfer when the caller is short of data,
+ * so while the segment is busy parsing what it already has, nothing reads
+ * from the socket.  Once the kernel's socket buffer is full, gpfdist stalls
+ * on this segment.  To keep the transfer going alongside parsing, collect
+ * whatever has already arrived, without waiting, until we hold
+ * CURL_READ_AHEAD_BYTES of unread data.
+ */
+static void
+read_ahead(URL_CURL_FILE *curl)
+{
+	int			e;
+
+	if (!curl->still_running ||
+		curl->in.top - curl->in.bot >= CURL_READ_AHEAD_BYTES)
+		return;
+
+	while (CURLM_CALL_MULTI_PERFORM ==
+		   (e = curl_multi_perform(multi_handle, &curl->still_running)));
+
+	if (e != 0)
+		elog(ERROR, "internal error: curl_multi_perform failed (%d - %s)",
+			 e, curl_easy_strerror(e));
+}
+
 
 static void
 set_httpheader(URL_CURL_FILE *fcurl, const char *name, const char *value)
@@ -1778,6 +1812,8 @@ curl_fread(char *buf, int bufsz, URL_CURL_FILE *file, CopyState pstate)
 			break;
 	}
 
+	read_ahead(file);
+
 	return p - buf;
 }
 
@@ -9,6 +9,7 @@
 #include "cdb/cdbtimer.h"
 #include "cdb/cdbvars.h"
 #include "libpq/pqsignal.h"
+#include "utils/memutils.h"
 #include "utils/resowner.h"
 
 #if 0
@@ -17,6 +18,99 @@
 #include "kitesdk.h"
 #include "exx/exx_kite_url.h"
 
+/*
+ * The Kite requests of an open file. They are allocated in TopMemoryContext
+ * and tracked by resource owners, like the handles in url_curl.c, so that an
+ * error while the scan is running still closes the connections.
+ */
+typedef struct kitehandles_t
+{
+	int nhdl;
+	kite_handle_t **hdl;
+
+	ResourceOwner owner;	/* owner of these handles */
+	struct kitehandles_t *next;
+	struct kitehandles_t *prev;
+} kitehandles_t;
+
+static kitehandles_t *open_kite_handles;
+
+static bool url_kite_resowner_callback_registered;
+
+static void destroy_kitehandles(kitehandles_t *h)
+{
+	/* unlink from linked list first */
+	if (h->prev)
+		h->prev->next = h->next;
+	else
+		open_kite_handles = open_kite_handles->next;
+	if (h->next)
+		h->next->prev = h->prev;
+
+	for (int i = 0; i < h->nhdl; i++) {
+		if (h->hdl[i]) {
+			kite_release(h->hdl[i]);
+		}
+	}
+	pfree(h->hdl);
+	pfree(h);
+}
+
+/*
+ * Release the Kite requests of the resource owner being released.
+ */
+static void url_kite_abort_callback(ResourceReleasePhase phase, bool isCommit, bool isTopLevel, void *arg)
+{
+	kitehandles_t *curr;
+	kitehandles_t *next;
+
+	if (phase != RESOURCE_RELEASE_AFTER_LOCKS)
+		return;
+
+	next = open_kite_handles;
+	while (next) {
+		curr = next;
+		next = curr->next;
+
+		if (curr->owner == CurrentResourceOwner) {
+			if (isCommit)
+				elog(LOG, "url_kite reference leak: %p still referenced", curr);
+
+			destroy_kitehandles(curr);
+		}
+	}
+}
+
+/*
+ * Allocate room for n Kite requests in file->hdl.  The requests stored there
+ * are released by url_kite_fclose(), or on abort.
+ */
+void url_kite_alloc_handles(URL_KITE_FILE *file, int n)
+{
+	kitehandles_t *h;
+
+	if (!url_kite_resowner_callback_registered) {
+		RegisterResourceReleaseCallback(url_kite_abort_callback, NULL);
+		url_kite_resowner_callback_registered = true;
+	}
+
+	h = MemoryContextAlloc(TopMemoryContext, sizeof(kitehandles_t));
+	h->nhdl = n;
+	h->hdl = MemoryContextAllocZero(TopMemoryContext, sizeof(kite_handle_t *) * n);
+
+	h->owner = CurrentResourceOwner;
+	h->prev = NULL;
+	h->next = open_kite_handles;
+	if (open_kite_handles)
+		open_kite_handles->prev = h;
+	open_kite_handles = h;
+
+	file->handles = h;
+	file->hdl = h->hdl;
+	file->nhdl = n;
+	file->curr = 0;
+}
+
 
 URL_FILE *url_kite_fopen(char *url, bool forwrite, extvar_t *ev, CopyState pstate)
 {
@@ -24,7 +118,10 @@ URL_FILE *url_kite_fopen(char *url, bool forwrite, extvar_t *ev, CopyState pstat
 	file->common.type = CFTYPE_KITE;
 	file->common.url = pstrdup(url);
 	file->seq_number = 0;
+	file->nhdl = 0;
+	file->curr = 0;
 	file->hdl = 0;
+	file->handles = NULL;
 
 	return (URL_FILE *) file;
 
@@ -34,8 +131,9 @@ void url_kite_fclose(URL_FILE *ufile, bool failOnError, const char *relname)
 {
 	URL_KITE_FILE *file = (URL_KITE_FILE *) ufile;
 
-	if (file->hdl) {
-		kite_release(file->hdl);
+	if (file->handles) {
+		destroy_kitehandles(file->handles);
+		file->handles = NULL;
 		file->hdl = 0;
 	}
 
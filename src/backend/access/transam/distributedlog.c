@@ -324,6 +324,16 @@ DistributedLog_GetOldestXmin(TransactionId oldestLocalXmin)
 	return result;
 }
 
+/*
+ * Return the distributed log's oldestXmin without advancing it.  Xids
+ * preceding it are no longer tracked by the distributed log.
+ */
+TransactionId
+DistributedLog_PeekOldestXmin(void)
+{
+	return (TransactionId)pg_atomic_read_u32((pg_atomic_uint32 *)&DistributedLogShared->oldestXmin);
+}
+
 /*
  * Record that a distributed transaction committed in the distributed log for
  * all transaction ids on a single page. This function is similar to clog
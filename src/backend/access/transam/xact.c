@@ -74,6 +74,7 @@
 #include "pg_trace.h"
 
 #include "access/distributedlog.h"
+#include "cdb/cdbappendonlystoragewrite.h"
 #include "cdb/cdbdistributedsnapshot.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/cdbgang.h"
@@ -3302,6 +3303,8 @@ AbortTransaction(void)
 	 * do abort processing
 	 */
 	AfterTriggerEndXact(false); /* 'false' means it's abort */
+	AtAbort_AppendOnlyStorageWrite();
+	AtAbort_FileAsyncIO();
 	AtAbort_EndpointExecState();
 	AtAbort_Portals();
 	AtAbort_DispatcherState();
@@ -5650,6 +5653,8 @@ AbortSubTransaction(void)
 	if (s->curTransactionOwner)
 	{
 		AfterTriggerEndSubXact(false);
+		AtAbort_AppendOnlyStorageWrite();
+		AtAbort_FileAsyncIO();
 		AtSubAbort_Portals(s->subTransactionId,
 						   s->parent->subTransactionId,
 						   s->curTransactionOwner,
@@ -19,7 +19,17 @@
 #include <io.h>
 #endif
 #include <sys/file.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
 #include <unistd.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
 
 #include "catalog/catalog.h"
 #include "catalog/heap.h"
@@ -30,12 +40,16 @@
 #include "cdb/cdbappendonlystorageformat.h"
 #include "cdb/cdbappendonlystoragewrite.h"
 #include "cdb/cdbappendonlyxlog.h"
+#include "cdb/cdbgang.h"
 #include "common/relpath.h"
 #include "storage/gp_compress.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
 
 
+static void AppendOnlyStorageWrite_WaitPending(AppendOnlyStorageWritePending *pending);
+static void AppendOnlyStorageWrite_CompletePending(AppendOnlyStorageWrite *storageWrite);
+
 /*----------------------------------------------------------------
  * Initialization
  *----------------------------------------------------------------
@@ -214,6 +228,30 @@ AppendOnlyStorageWrite_FinishSession(AppendOnlyStorageWrite *storageWrite)
 		storageWrite->verifyWriteBuffer = NULL;
 	}
 
+	if (storageWrite->backgroundCompress)
+	{
+		/*
+		 * A block still being compressed is abandoned, as it is when the
+		 * session is not finished at all, but the thread must let go of it
+		 * first.
+		 */
+		AppendOnlyStorageWrite_WaitPending(&storageWrite->pending);
+		storageWrite->pending.state = AOPendingBlock_None;
+
+		pfree(storageWrite->pendingUncompressedBuffer);
+		storageWrite->pendingUncompressedBuffer = NULL;
+		pfree(storageWrite->pending.compressedBuffer);
+		storageWrite->pending.compressedBuffer = NULL;
+#ifdef HAVE_LIBZSTD
+		if (storageWrite->pending.zstdContext != NULL)
+		{
+			zstd_free_context(storageWrite->pending.zstdContext);
+			storageWrite->pending.zstdContext = NULL;
+		}
+#endif
+		storageWrite->backgroundCompress = false;
+	}
+
 	if (storageWrite->segmentFileName != NULL)
 	{
 		pfree(storageWrite->segmentFileName);
@@ -243,6 +281,329 @@ AppendOnlyStorageWrite_FinishSession(AppendOnlyStorageWrite *storageWrite)
 
 }
 
+/*----------------------------------------------------------------
+ * Background compression
+ *----------------------------------------------------------------
+ */
+
+/*
+ * Compressing a block is by far the most expensive part of writing it, and
+ * a column-oriented insert finishes blocks for many columns.  With
+ * gp_appendonly_compress_workers set, ~_FinishBuffer queues the block for a
+ * pool of threads and returns, so the insert goes on filling the next block
+ * of this column, and the blocks of the other columns, while it is being
+ * compressed.
+ *
+ * Each AppendOnlyStorageWrite has at most one block outstanding.  It is
+ * appended to the file by the inserting process, which waits for it if
+ * necessary, before the next block of the same file is started and before
+ * anything else is written, flushed or closed.  So the blocks of a file stay
+ * in order, and the position of a block in the file is known as soon as it
+ * is started, which the block directory relies on.
+ *
+ * The threads call the zlib or zstd library directly on buffers that belong
+ * to the block; they never go through the fmgr, allocate memory or raise
+ * errors.  A library failure is left in the block for the inserting process
+ * to report.  Everything else -- the header, checksums, write verification,
+ * WAL and the write itself -- stays in the inserting process.
+ */
+#define AOSTORAGEWRITE_MAX_COMPRESS_THREADS 32
+
+static struct
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t queuedCond;	/* signalled when a block is queued */
+	pthread_cond_t compressedCond;	/* signalled when a block is compressed */
+
+	AppendOnlyStorageWritePending *head;	/* queue of blocks to compress */
+	AppendOnlyStorageWritePending *tail;
+	int			nqueued;		/* queued or being compressed */
+
+	int			nthreads;
+	pthread_t	threads[AOSTORAGEWRITE_MAX_COMPRESS_THREADS];
+} compressPool = {
+	PTHREAD_MUTEX_INITIALIZER,
+	PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER
+};
+
+/*
+ * Compress a queued block.  Runs in a compression thread.
+ *
+ * As with the compress functions of pg_compression, if the block does not
+ * get smaller, compressedLen is set to sourceLen and the caller stores it
+ * uncompressed.
+ */
+static void
+AppendOnlyStorageWrite_CompressPending(AppendOnlyStorageWritePending *pending)
+{
+	pending->compressError = NULL;
+
+	switch (pending->compressLib)
+	{
+#ifdef HAVE_LIBZ
+		case AOCompressLib_Zlib:
+			{
+				unsigned long compressedLen = pending->compressedBufferLen;
+				int			zerr;
+
+				zerr = compress2(pending->compressedBuffer, &compressedLen,
+								 pending->sourceData, pending->sourceLen,
+								 pending->compressLevel);
+				if (zerr == Z_OK)
+					pending->compressedLen = compressedLen;
+				else if (zerr == Z_BUF_ERROR)
+					pending->compressedLen = pending->sourceLen;
+				else if (zerr == Z_MEM_ERROR)
+					pending->compressError = "out of memory";
+				else
+					pending->compressError = "zlib compression failed";
+				break;
+			}
+#endif
+#ifdef HAVE_LIBZSTD
+		case AOCompressLib_Zstd:
+			{
+				size_t		compressedLen;
+
+				compressedLen = ZSTD_compressCCtx(pending->zstdContext->cctx,
+												  pending->compressedBuffer,
+												  pending->compressedBufferLen,
+												  pending->sourceData,
+												  pending->sourceLen,
+												  pending->compressLevel);
+				if (!ZSTD_isError(compressedLen))
+					pending->compressedLen = compressedLen;
+				else if (ZSTD_getErrorCode(compressedLen) == ZSTD_error_dstSize_tooSmall)
+					pending->compressedLen = pending->sourceLen;
+				else
+					pending->compressError = ZSTD_getErrorName(compressedLen);
+				break;
+			}
+#endif
+		default:
+			pending->compressError = "unsupported compression library";
+			break;
+	}
+}
+
+static void *
+AppendOnlyStorageWrite_CompressThread(void *arg)
+{
+	pthread_mutex_lock(&compressPool.mutex);
+	for (;;)
+	{
+		AppendOnlyStorageWritePending *pending;
+
+		while (compressPool.head == NULL)
+			pthread_cond_wait(&compressPool.queuedCond, &compressPool.mutex);
+
+		pending = compressPool.head;
+		compressPool.head = pending->next;
+		if (compressPool.head == NULL)
+			compressPool.tail = NULL;
+		pending->next = NULL;
+		pthread_mutex_unlock(&compressPool.mutex);
+
+		AppendOnlyStorageWrite_CompressPending(pending);
+
+		pthread_mutex_lock(&compressPool.mutex);
+		pending->state = AOPendingBlock_Compressed;
+		compressPool.nqueued--;
+		pthread_cond_broadcast(&compressPool.compressedCond);
+	}
+
+	/* not reached */
+	return NULL;
+}
+
+/*
+ * Start compression threads until there are gp_appendonly_compress_workers
+ * of them.  The threads live as long as the process.  Returns false if there
+ * are none.
+ *
+ * All the primaries of a host insert at the same time, so a segment never
+ * starts more threads than its share of the host's CPUs.
+ */
+static bool
+AppendOnlyStorageWrite_StartCompressThreads(void)
+{
+	int			nthreads = Min(gp_appendonly_compress_workers,
+							   AOSTORAGEWRITE_MAX_COMPRESS_THREADS);
+	long		ncpus;
+	pthread_attr_t t_atts;
+	sigset_t	sigs;
+	sigset_t	old_sigs;
+
+	ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (ncpus > 0 && host_segments > 0)
+		nthreads = Min(nthreads, Max((int) (ncpus / host_segments), 1));
+
+	if (compressPool.nthreads >= nthreads)
+		return compressPool.nthreads > 0;
+
+	/*
+	 * The threads must never run a signal handler, so create them with every
+	 * signal blocked; they inherit the mask.
+	 */
+	pthread_attr_init(&t_atts);
+	pthread_attr_setstacksize(&t_atts, Max(PTHREAD_STACK_MIN, (256 * 1024)));
+	sigfillset(&sigs);
+	pthread_sigmask(SIG_SETMASK, &sigs, &old_sigs);
+
+	while (compressPool.nthreads < nthreads)
+	{
+		int			pthread_err;
+
+		pthread_err = pthread_create(&compressPool.threads[compressPool.nthreads],
+									 &t_atts,
+									 AppendOnlyStorageWrite_CompressThread,
+									 NULL);
+		if (pthread_err != 0)
+		{
+			elog(LOG, "could not create append-only compression thread: %s",
+				 strerror(pthread_err));
+			break;
+		}
+		compressPool.nthreads++;
+	}
+
+	pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+	pthread_attr_destroy(&t_atts);
+
+	return compressPool.nthreads > 0;
+}
+
+static void
+AppendOnlyStorageWrite_QueuePending(AppendOnlyStorageWritePending *pending)
+{
+	pthread_mutex_lock(&compressPool.mutex);
+	pending->state = AOPendingBlock_Queued;
+	pending->next = NULL;
+	if (compressPool.tail == NULL)
+		compressPool.head = pending;
+	else
+		compressPool.tail->next = pending;
+	compressPool.tail = pending;
+	compressPool.nqueued++;
+	pthread_cond_signal(&compressPool.queuedCond);
+	pthread_mutex_unlock(&compressPool.mutex);
+}
+
+/*
+ * Wait until a queued block has been compressed.
+ */
+static void
+AppendOnlyStorageWrite_WaitPending(AppendOnlyStorageWritePending *pending)
+{
+	pthread_mutex_lock(&compressPool.mutex);
+	while (pending->state == AOPendingBlock_Queued)
+		pthread_cond_wait(&compressPool.compressedCond, &compressPool.mutex);
+	pthread_mutex_unlock(&compressPool.mutex);
+}
+
+/*
+ * Hand the blocks of this write session to the background compression
+ * threads from now on, if gp_appendonly_compress_workers is set and the
+ * compression type allows it.  Returns true if it does.
+ *
+ * Must be called before the first block is written.
+ */
+bool
+AppendOnlyStorageWrite_EnableBackgroundCompress(AppendOnlyStorageWrite *storageWrite)
+{
+	char	   *compressType = storageWrite->storageAttributes.compressType;
+	AppendOnlyStorageWriteCompressLib compressLib;
+	MemoryContext oldMemoryContext;
+
+	Assert(storageWrite->isActive);
+	Assert(!storageWrite->backgroundCompress);
+
+	if (gp_appendonly_compress_workers <= 0 ||
+		!storageWrite->storageAttributes.compress ||
+		storageWrite->compression_functions == NULL ||
+		compressType == NULL)
+		return false;
+
+	/*
+	 * Only zlib and zstd are handed to the threads, which call the library
+	 * themselves.  Other compression types, such as rle_type or ones added by
+	 * extensions, are compressed by the inserting process as usual.
+	 */
+#ifdef HAVE_LIBZ
+	if (pg_strcasecmp(compressType, "zlib") == 0)
+		compressLib = AOCompressLib_Zlib;
+	else
+#endif
+#ifdef HAVE_LIBZSTD
+	if (pg_strcasecmp(compressType, "zstd") == 0)
+		compressLib = AOCompressLib_Zstd;
+	else
+#endif
+		return false;
+
+	if (!AppendOnlyStorageWrite_StartCompressThreads())
+		return false;
+
+	storageWrite->pending.compressLib = compressLib;
+	/* Level 0 means the default, as in the compression constructors. */
+	storageWrite->pending.compressLevel =
+		Max(storageWrite->storageAttributes.compressLevel, 1);
+
+#ifdef HAVE_LIBZSTD
+	storageWrite->pending.zstdContext = NULL;
+	if (compressLib == AOCompressLib_Zstd)
+	{
+		ResourceOwner oldowner = CurrentResourceOwner;
+
+		/*
+		 * The session may outlive the subtransaction that started it, so
+		 * keep the context with the top transaction.
+		 */
+		CurrentResourceOwner = TopTransactionResourceOwner;
+		storageWrite->pending.zstdContext = zstd_alloc_context();
+		storageWrite->pending.zstdContext->cctx = ZSTD_createCCtx();
+		CurrentResourceOwner = oldowner;
+		if (!storageWrite->pending.zstdContext->cctx)
+			elog(ERROR, "out of memory");
+	}
+#endif
+
+	oldMemoryContext = MemoryContextSwitchTo(storageWrite->memoryContext);
+
+	storageWrite->pendingUncompressedBuffer =
+		(uint8 *) palloc(storageWrite->maxBufferLen * sizeof(uint8));
+	storageWrite->pending.compressedBufferLen =
+		storageWrite->maxBufferWithCompressionOverrrunLen;
+	storageWrite->pending.compressedBuffer =
+		(uint8 *) palloc(storageWrite->pending.compressedBufferLen * sizeof(uint8));
+	storageWrite->pending.state = AOPendingBlock_None;
+
+	MemoryContextSwitchTo(oldMemoryContext);
+
+	storageWrite->backgroundCompress = true;
+
+	return true;
+}
+
+/*
+ * Wait for every queued block to be compressed.
+ *
+ * Called early in (sub)transaction abort, before the memory of the aborted
+ * inserts, which the threads may be reading and writing, is released.
+ */
+void
+AtAbort_AppendOnlyStorageWrite(void)
+{
+	if (compressPool.nthreads == 0)
+		return;
+
+	pthread_mutex_lock(&compressPool.mutex);
+	while (compressPool.nqueued > 0)
+		pthread_cond_wait(&compressPool.compressedCond, &compressPool.mutex);
+	pthread_mutex_unlock(&compressPool.mutex);
+}
+
 /*----------------------------------------------------------------
  * Open and FlushAndClose
  *----------------------------------------------------------------
@@ -481,6 +842,9 @@ AppendOnlyStorageWrite_FlushAndCloseFile(
 		return;
 	}
 
+	/* The last block may still be with the compression threads. */
+	AppendOnlyStorageWrite_CompletePending(storageWrite);
+
 	/*
 	 * We pad out append commands to the page boundary.
 	 */
@@ -757,6 +1121,12 @@ AppendOnlyStorageWrite_GetBuffer(AppendOnlyStorageWrite *storageWrite,
 		   aoHeaderKind == AoHeaderKind_NonBulkDenseContent ||
 		   aoHeaderKind == AoHeaderKind_BulkDenseContent);
 
+	/*
+	 * The previous block must be in the file before this one is started, so
+	 * that the caller can learn this block's position.
+	 */
+	AppendOnlyStorageWrite_CompletePending(storageWrite);
+
 	storageWrite->getBufferAoHeaderKind = aoHeaderKind;
 
 	/*
@@ -817,6 +1187,8 @@ AppendOnlyStorageWrite_CurrentPosition(AppendOnlyStorageWrite *storageWrite)
 	Assert(storageWrite != NULL);
 	Assert(storageWrite->isActive);
 
+	AppendOnlyStorageWrite_CompletePending(storageWrite);
+
 	return BufferedAppendCurrentBufferPosition(
 											   &storageWrite->bufferedAppend);
 }
@@ -1130,55 +1502,33 @@ AppendOnlyStorageWrite_VerifyWriteBlock(AppendOnlyStorageWrite *storageWrite,
 #endif
 }
 
+/*
+ * Make a compressed block in the BufferedAppend buffer 'header' from the
+ * outcome of compressing sourceData.
+ *
+ * The compressed data is at compressedData, which is where the block's data
+ * goes unless the compression was done elsewhere.  When it did not make the
+ * data smaller, the block stores sourceData as is and *compressedLen is set
+ * to 0.  The header is made from the given header kind and first row number
+ * rather than the ones in storageWrite, which belong to the next block when
+ * the compression was done in the background.
+ */
 static void
-AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
-									  uint8 *sourceData,
-									  int32 sourceLen,
-									  int executorBlockKind,
-									  int itemCount,
-									  int32 *compressedLen,
-									  int32 *bufferLen)
+AppendOnlyStorageWrite_MakeCompressedBlock(AppendOnlyStorageWrite *storageWrite,
+										   uint8 *header,
+										   uint8 *compressedData,
+										   uint8 *sourceData,
+										   int32 sourceLen,
+										   AoHeaderKind aoHeaderKind,
+										   int32 completeHeaderLen,
+										   bool isFirstRowNumSet,
+										   int64 firstRowNum,
+										   int executorBlockKind,
+										   int itemCount,
+										   int32 *compressedLen,
+										   int32 *bufferLen)
 {
-	uint8	   *header;
-	uint8	   *dataBuffer;
-	int32		dataBufferWithOverrrunLen;
-	PGFunction *cfns = storageWrite->compression_functions;
-	PGFunction	compressor;
-
-	if (cfns == NULL)
-		compressor = NULL;
-	else
-		compressor = cfns[COMPRESSION_COMPRESS];
-
-	/* UNDONE: This can be a duplicate call... */
-	storageWrite->currentCompleteHeaderLen =
-		AppendOnlyStorageWrite_CompleteHeaderLen(
-			storageWrite,
-			storageWrite->getBufferAoHeaderKind);
-
-	header = BufferedAppendGetMaxBuffer(&storageWrite->bufferedAppend);
-	if (header == NULL)
-		ereport(ERROR,
-				(errcode(ERRCODE_INTERNAL_ERROR),
-				 errmsg("We do not expect files to be have a maximum length"),
-				 errcontext_appendonly_write_storage_block(storageWrite)));
-
-	dataBuffer = &header[storageWrite->currentCompleteHeaderLen];
-	dataBufferWithOverrrunLen =
-		storageWrite->maxBufferWithCompressionOverrrunLen
-		- storageWrite->currentCompleteHeaderLen;
-
-	/*
-	 * Compress into the BufferedAppend buffer after the large header (and
-	 * optional checksum, etc.
-	 */
-	gp_trycompress(sourceData,
-					sourceLen,
-					dataBuffer,
-					dataBufferWithOverrrunLen,
-					compressedLen,
-					compressor,
-					storageWrite->compressionState);
+	uint8	   *dataBuffer = &header[completeHeaderLen];
 
 #ifdef FAULT_INJECTOR
 	/* Simulate that compression is not possible if the fault is set. */
@@ -1210,20 +1560,22 @@ AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
 		memcpy(dataBuffer, sourceData, sourceLen);
 		*compressedLen = 0;
 	}
+	else if (compressedData != dataBuffer)
+		memcpy(dataBuffer, compressedData, dataLen);
 	int32 dataRoundedUpLen =
 		AOStorage_RoundUp(dataLen, storageWrite->formatVersion);
 	AOStorage_ZeroPad(dataBuffer, dataLen, dataRoundedUpLen);
 
 	/* Make the header and compute the checksum if necessary. */
-	switch (storageWrite->getBufferAoHeaderKind)
+	switch (aoHeaderKind)
 	{
 		case AoHeaderKind_SmallContent:
 			AppendOnlyStorageFormat_MakeSmallContentHeader
 				(header,
 				 storageWrite->storageAttributes.checksum,
-				 storageWrite->isFirstRowNumSet,
+				 isFirstRowNumSet,
 				 storageWrite->formatVersion,
-				 storageWrite->firstRowNum,
+				 firstRowNum,
 				 executorBlockKind,
 				 itemCount,
 				 sourceLen,
@@ -1241,9 +1593,9 @@ AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
 			AppendOnlyStorageFormat_MakeBulkDenseContentHeader
 				(header,
 				 storageWrite->storageAttributes.checksum,
-				 storageWrite->isFirstRowNumSet,
+				 isFirstRowNumSet,
 				 storageWrite->formatVersion,
-				 storageWrite->firstRowNum,
+				 firstRowNum,
 				 executorBlockKind,
 				 itemCount,
 				 sourceLen,
@@ -1252,7 +1604,7 @@ AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
 
 		default:
 			elog(ERROR, "unexpected Append-Only header kind %d",
-				 storageWrite->getBufferAoHeaderKind);
+				 aoHeaderKind);
 			break;
 	}
 
@@ -1278,7 +1630,139 @@ AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
 		   itemCount,
 		   storageWrite->bufferCount);
 
-	*bufferLen = storageWrite->currentCompleteHeaderLen + dataRoundedUpLen;
+	*bufferLen = completeHeaderLen + dataRoundedUpLen;
+}
+
+static void
+AppendOnlyStorageWrite_CompressAppend(AppendOnlyStorageWrite *storageWrite,
+									  uint8 *sourceData,
+									  int32 sourceLen,
+									  int executorBlockKind,
+									  int itemCount,
+									  int32 *compressedLen,
+									  int32 *bufferLen)
+{
+	uint8	   *header;
+	uint8	   *dataBuffer;
+	int32		dataBufferWithOverrrunLen;
+	PGFunction *cfns = storageWrite->compression_functions;
+	PGFunction	compressor;
+
+	if (cfns == NULL)
+		compressor = NULL;
+	else
+		compressor = cfns[COMPRESSION_COMPRESS];
+
+	/* UNDONE: This can be a duplicate call... */
+	storageWrite->currentCompleteHeaderLen =
+		AppendOnlyStorageWrite_CompleteHeaderLen(
+			storageWrite,
+			storageWrite->getBufferAoHeaderKind);
+
+	header = BufferedAppendGetMaxBuffer(&storageWrite->bufferedAppend);
+	if (header == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("We do not expect files to be have a maximum length"),
+				 errcontext_appendonly_write_storage_block(storageWrite)));
+
+	dataBuffer = &header[storageWrite->currentCompleteHeaderLen];
+	dataBufferWithOverrrunLen =
+		storageWrite->maxBufferWithCompressionOverrrunLen
+		- storageWrite->currentCompleteHeaderLen;
+
+	/*
+	 * Compress into the BufferedAppend buffer after the large header (and
+	 * optional checksum, etc.
+	 */
+	gp_trycompress(sourceData,
+					sourceLen,
+					dataBuffer,
+					dataBufferWithOverrrunLen,
+					compressedLen,
+					compressor,
+					storageWrite->compressionState);
+
+	AppendOnlyStorageWrite_MakeCompressedBlock(storageWrite,
+											   header,
+											   dataBuffer,
+											   sourceData,
+											   sourceLen,
+											   storageWrite->getBufferAoHeaderKind,
+											   storageWrite->currentCompleteHeaderLen,
+											   storageWrite->isFirstRowNumSet,
+											   storageWrite->firstRowNum,
+											   executorBlockKind,
+											   itemCount,
+											   compressedLen,
+											   bufferLen);
+}
+
+/*
+ * Append the block handed to the compression threads by ~_FinishBuffer to
+ * the file, waiting for it to be compressed first if necessary.
+ */
+static void
+AppendOnlyStorageWrite_CompletePending(AppendOnlyStorageWrite *storageWrite)
+{
+	AppendOnlyStorageWritePending *pending = &storageWrite->pending;
+	int64		headerOffsetInFile;
+	uint8	   *header;
+	int32		compressedLen;
+	int32		bufferLen;
+
+	if (pending->state == AOPendingBlock_None)
+		return;
+
+	AppendOnlyStorageWrite_WaitPending(pending);
+	pending->state = AOPendingBlock_None;
+
+	if (pending->compressError != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not compress append-only block: %s",
+						pending->compressError),
+				 errcontext_appendonly_write_storage_block(storageWrite)));
+
+	headerOffsetInFile = BufferedAppendCurrentBufferPosition(&storageWrite->bufferedAppend);
+
+	header = BufferedAppendGetMaxBuffer(&storageWrite->bufferedAppend);
+	if (header == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("We do not expect files to be have a maximum length"),
+				 errcontext_appendonly_write_storage_block(storageWrite)));
+
+	compressedLen = pending->compressedLen;
+	AppendOnlyStorageWrite_MakeCompressedBlock(storageWrite,
+											   header,
+											   pending->compressedBuffer,
+											   pending->sourceData,
+											   pending->sourceLen,
+											   pending->aoHeaderKind,
+											   pending->completeHeaderLen,
+											   pending->isFirstRowNumSet,
+											   pending->firstRowNum,
+											   pending->executorBlockKind,
+											   pending->rowCount,
+											   &compressedLen,
+											   &bufferLen);
+
+	if (gp_appendonly_verify_write_block)
+		AppendOnlyStorageWrite_VerifyWriteBlock(storageWrite,
+												headerOffsetInFile,
+												bufferLen,
+												pending->sourceData,
+												pending->sourceLen,
+												pending->executorBlockKind,
+												pending->rowCount,
+												compressedLen);
+
+	BufferedAppendFinishBuffer(&storageWrite->bufferedAppend,
+							   bufferLen,
+							   (pending->completeHeaderLen +
+								AOStorage_RoundUp(pending->sourceLen, storageWrite->formatVersion) /* non-compressed size */ ),
+							   storageWrite->needsWAL);
 }
 
 /*
@@ -1426,6 +1910,34 @@ AppendOnlyStorageWrite_FinishBuffer(AppendOnlyStorageWrite *storageWrite,
 			   storageWrite->bufferCount);
 
 	}
+	else if (storageWrite->backgroundCompress)
+	{
+		AppendOnlyStorageWritePending *pending = &storageWrite->pending;
+		uint8	   *sourceData = storageWrite->uncompressedBuffer;
+
+		/* ~_GetBuffer has put the previous block in the file. */
+		Assert(pending->state == AOPendingBlock_None);
+
+		pending->sourceData = sourceData;
+		pending->sourceLen = contentLen;
+		pending->compressedLen = 0;
+		pending->compressError = NULL;
+		pending->aoHeaderKind = storageWrite->getBufferAoHeaderKind;
+		pending->completeHeaderLen = storageWrite->currentCompleteHeaderLen;
+		pending->isFirstRowNumSet = storageWrite->isFirstRowNumSet;
+		pending->firstRowNum = storageWrite->firstRowNum;
+		pending->executorBlockKind = executorBlockKind;
+		pending->rowCount = rowCount;
+
+		/* The next block is built in the other buffer meanwhile. */
+		storageWrite->uncompressedBuffer = storageWrite->pendingUncompressedBuffer;
+		storageWrite->pendingUncompressedBuffer = sourceData;
+
+		AppendOnlyStorageWrite_QueuePending(pending);
+
+		/* Declare it finished. */
+		storageWrite->currentCompleteHeaderLen = 0;
+	}
 	else
 	{
 		int32		compressedLen = 0;
@@ -1544,6 +2056,8 @@ AppendOnlyStorageWrite_Content(AppendOnlyStorageWrite *storageWrite,
 	Assert(storageWrite != NULL);
 	Assert(storageWrite->isActive);
 
+	AppendOnlyStorageWrite_CompletePending(storageWrite);
+
 	completeHeaderLen =
 		AppendOnlyStorageWrite_CompleteHeaderLen(storageWrite,
 												 AoHeaderKind_SmallContent);
@@ -38,6 +38,8 @@
  *
  * cdbCopyGetData() and cdbCopySendData() call libpq's PQgetCopyData() and
  * PQputCopyData(), respectively. If an error occurs, it is thrown with ereport().
+ * cdbCopySendData() batches the data per segment, so a row may not reach the
+ * segment until the batch fills up or cdbCopyEnd() is called.
  *
  * When you're done, call cdbCopyEnd().
  *
@@ -78,6 +80,9 @@
 static void cdbCopyEndInternal(CdbCopy *c, char *abort_msg,
 				   int64 *total_rows_completed_p,
 				   int64 *total_rows_rejected_p);
+static void cdbCopyPutData(CdbCopy *c, int target_seg, const char *buffer,
+			   int nbytes);
+static void cdbCopyFlushData(CdbCopy *c);
 
 static Gang *
 getCdbCopyPrimaryGang(CdbCopy *c)
@@ -132,6 +137,24 @@ makeCdbCopy(CopyState cstate, bool is_copy_in)
 			c->seglist = lappend_int(c->seglist, i);
 	}
 
+	/*
+	 * Set up the per-segment send buffers for COPY FROM. The buffers start
+	 * small and grow up to the batch size, so a COPY that only sends a few
+	 * rows doesn't pay for the full budget on every segment.
+	 */
+	if (is_copy_in)
+	{
+		int			i;
+
+		c->copy_in_batch_size = COPYIN_BATCH_TOTAL_SIZE / Max(c->total_segs, 1);
+		c->copy_in_batch_size = Min(c->copy_in_batch_size, COPYIN_BATCH_SIZE);
+		c->copy_in_batch_size = Max(c->copy_in_batch_size, COPYIN_BATCH_MIN_SIZE);
+
+		c->copy_in_bufs = palloc(c->total_segs * sizeof(StringInfoData));
+		for (i = 0; i < c->total_segs; i++)
+			initStringInfo(&c->copy_in_bufs[i]);
+	}
+
 	cstate->cdbCopy = c;
 
 	return c;
@@ -234,20 +257,67 @@ cdbCopySendDataToAll(CdbCopy *c, const char *buffer, int nbytes)
 /*
  * sends data to a copy command on a specific segment (usually
  * the hash result of the data value).
+ *
+ * The data is appended to the segment's pending buffer, and only handed to
+ * libpq once the buffer reaches copy_in_batch_size. The QE reads the COPY
+ * stream without regard to message boundaries, so several rows can share one
+ * CopyData message. Data sent to the same segment, including the header
+ * sent with cdbCopySendDataToAll(), stays in order.
  */
 void
 cdbCopySendData(CdbCopy *c, int target_seg, const char *buffer,
 				int nbytes)
+{
+	StringInfo	buf;
+
+	Assert(c->copy_in_bufs != NULL);
+	Assert(target_seg >= 0 && target_seg < c->total_segs);
+
+	buf = &c->copy_in_bufs[target_seg];
+
+	if (buf->len + nbytes > c->copy_in_batch_size && buf->len > 0)
+	{
+		cdbCopyPutData(c, target_seg, buf->data, buf->len);
+		resetStringInfo(buf);
+	}
+
+	/* Oversized rows go out directly, there's nothing to batch them with */
+	if (nbytes >= c->copy_in_batch_size)
+		cdbCopyPutData(c, target_seg, buffer, nbytes);
+	else
+		appendBinaryStringInfo(buf, buffer, nbytes);
+}
+
+/*
+ * Send out all pending COPY FROM data.
+ */
+static void
+cdbCopyFlushData(CdbCopy *c)
+{
+	int			seg;
+
+	if (!c->copy_in_bufs)
+		return;
+
+	for (seg = 0; seg < c->total_segs; seg++)
+	{
+		StringInfo	buf = &c->copy_in_bufs[seg];
+
+		if (buf->len > 0)
+		{
+			cdbCopyPutData(c, seg, buf->data, buf->len);
+			resetStringInfo(buf);
+		}
+	}
+}
+
+static void
+cdbCopyPutData(CdbCopy *c, int target_seg, const char *buffer, int nbytes)
 {
 	SegmentDatabaseDescriptor *q;
 	Gang	   *gp;
 	int			result;
 
-	/*
-	 * NOTE!! note that another DELIM was added, for the buf_converted in the
-	 * code above. I didn't do it because it's broken right now
-	 */
-
 	gp = getCdbCopyPrimaryGang(c);
 	Assert(gp);
 	q = getSegmentDescriptorFromGang(gp, target_seg);
@@ -411,6 +481,15 @@ cdbCopyGetData(CdbCopy *c, bool copy_cancel, uint64 *rows_processed)
 void
 cdbCopyAbort(CdbCopy *c)
 {
+	/* The QEs are told to throw away the data anyway, don't bother sending */
+	if (c->copy_in_bufs)
+	{
+		int			seg;
+
+		for (seg = 0; seg < c->total_segs; seg++)
+			resetStringInfo(&c->copy_in_bufs[seg]);
+	}
+
 	cdbCopyEndInternal(c, "aborting COPY in QE due to error in QD",
 					   NULL, NULL);
 }
@@ -426,6 +505,13 @@ cdbCopyEnd(CdbCopy *c,
 {
 	CHECK_FOR_INTERRUPTS();
 
+	/*
+	 * Send out the rows still sitting in the batch buffers. If this fails,
+	 * the caller's error handling calls cdbCopyAbort(), which discards them.
+	 */
+	if (getCdbCopyPrimaryGang(c))
+		cdbCopyFlushData(c);
+
 	cdbCopyEndInternal(c, NULL,
 					   total_rows_completed_p,
 					   total_rows_rejected_p);
@@ -574,6 +660,7 @@ cdbCopyEndInternal(CdbCopy *c, char *abort_msg,
 			if (q->conn->wrote_xlog)
 			{
 				MarkTopTransactionWriteXLogOnExecutor();
+				addToGxactXLogSegments(q->segindex);
 
 				/*
 				* Reset the worte_xlog here. Since if the received pgresult not process
@@ -29,6 +29,63 @@ GetMaxSnapshotDistributedXidCount()
 	return GetMaxSnapshotXidCount();
 }
 
+/*
+ * Binary search the sorted inProgressXidArray of a distributed snapshot.
+ *
+ * ds->inProgressXidArray is sorted in ascending order of distribXid while
+ * creating the snapshot in CreateDistributedSnapshot().
+ */
+static bool
+DistributedSnapshot_InProgressFind(DistributedSnapshot *ds,
+								   DistributedTransactionId distribXid)
+{
+	int			low = 0;
+	int			high = ds->count - 1;
+
+	while (low <= high)
+	{
+		int			middle = low + (high - low) / 2;
+		DistributedTransactionId middleXid = ds->inProgressXidArray[middle];
+
+		if (distribXid == middleXid)
+			return true;
+		else if (distribXid < middleXid)
+			high = middle - 1;
+		else
+			low = middle + 1;
+	}
+
+	return false;
+}
+
+/*
+ * Return the position of the first cached local xid which doesn't precede
+ * localXid, i.e. where localXid is or would be inserted.
+ *
+ * inProgressMappedLocalXids is kept sorted, all of its xids belong to
+ * transactions in progress for the same snapshot so they compare sanely
+ * with TransactionIdPrecedes().
+ */
+static int
+MappedLocalXids_LowerBound(DistributedSnapshotWithLocalMapping *dslm,
+						   TransactionId localXid)
+{
+	int			low = 0;
+	int			high = dslm->currentLocalXidsCount;
+
+	while (low < high)
+	{
+		int			middle = low + (high - low) / 2;
+
+		if (TransactionIdPrecedes(dslm->inProgressMappedLocalXids[middle], localXid))
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
 /*
  * DistributedSnapshotWithLocalMapping_CommittedTest
  *		Is the given XID still-in-progress according to the
@@ -45,7 +102,7 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 												  bool isVacuumCheck)
 {
 	DistributedSnapshot *ds = &dslm->ds;
-	uint32		i;
+	int			i;
 	DistributedTransactionId distribXid = InvalidDistributedTransactionId;
 
 	Assert(!IS_QUERY_DISPATCHER());
@@ -76,14 +133,12 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		if (TransactionIdFollows(localXid, dslm->minCachedLocalXid) &&
 			TransactionIdPrecedes(localXid, dslm->maxCachedLocalXid))
 		{
-			for (i = 0; i < dslm->currentLocalXidsCount; i++)
-			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-				Assert(TransactionIdIsValid(dslm->inProgressMappedLocalXids[i]));
+			Assert(dslm->inProgressMappedLocalXids != NULL);
 
-				if (TransactionIdEquals(localXid, dslm->inProgressMappedLocalXids[i]))
-					return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
-			}
+			i = MappedLocalXids_LowerBound(dslm, localXid);
+			if (i < dslm->currentLocalXidsCount &&
+				TransactionIdEquals(localXid, dslm->inProgressMappedLocalXids[i]))
+				return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 		}
 	}
 
@@ -124,10 +179,15 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 
 			/*
 			 * Committed distributed transactions from other DTM starts are
-			 * weeded out.
+			 * weeded out.  The DTM start of this backend's QD doesn't change,
+			 * so remember it like a local-only transaction.
 			 */
 			if (checkDistribTimeStamp != ds->distribTransactionTimeStamp)
+			{
+				LocalDistribXactCache_AddCommitted(localXid,
+												   /* distribXid */ InvalidDistributedTransactionId);
 				return DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE;
+			}
 
 			/*
 			 * We have a distributed committed xid that corresponds to the
@@ -190,46 +250,31 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
-	for (i = 0; i < ds->count; i++)
+	if (DistributedSnapshot_InProgressFind(ds, distribXid))
 	{
-		if (distribXid == ds->inProgressXidArray[i])
+		/*
+		 * Save the relationship to the local xid so we may avoid checking
+		 * the distributed committed log in a subsequent check. We can only
+		 * record local xids till cache size permits.
+		 */
+		if (dslm->currentLocalXidsCount < dslm->maxLocalXidsCount)
 		{
-			/*
-			 * Save the relationship to the local xid so we may avoid checking
-			 * the distributed committed log in a subsequent check. We can
-			 * only record local xids till cache size permits.
-			 */
-			if (dslm->currentLocalXidsCount < dslm->maxLocalXidsCount)
-			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-
-				dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount++] =
-					localXid;
-
-				if (!TransactionIdIsValid(dslm->minCachedLocalXid) ||
-					TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
-				{
-					dslm->minCachedLocalXid = localXid;
-				}
-
-				if (!TransactionIdIsValid(dslm->maxCachedLocalXid) ||
-					TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
-				{
-					dslm->maxCachedLocalXid = localXid;
-				}
-			}
-
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+			Assert(dslm->inProgressMappedLocalXids != NULL);
+
+			/* keep the cache sorted, see MappedLocalXids_LowerBound() */
+			i = MappedLocalXids_LowerBound(dslm, localXid);
+			memmove(&dslm->inProgressMappedLocalXids[i + 1],
+					&dslm->inProgressMappedLocalXids[i],
+					(dslm->currentLocalXidsCount - i) * sizeof(TransactionId));
+			dslm->inProgressMappedLocalXids[i] = localXid;
+			dslm->currentLocalXidsCount++;
+
+			dslm->minCachedLocalXid = dslm->inProgressMappedLocalXids[0];
+			dslm->maxCachedLocalXid =
+				dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount - 1];
 		}
 
-		/*
-		 * Leverage the fact that ds->inProgressXidArray is sorted in
-		 * ascending order based on distribXid while creating the snapshot in
-		 * CreateDistributedSnapshot(). So, can fail fast once known are
-		 * lower than rest of them.
-		 */
-		if (distribXid < ds->inProgressXidArray[i])
-			break;
+		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
 	/*
@@ -324,23 +369,92 @@ DistributedSnapshot_Copy(DistributedSnapshot *target,
 		   source->count * sizeof(DistributedTransactionId));
 }
 
+/*
+ * The in-progress xids are shipped with every dispatched command, and there
+ * may be as many as there are backends on the coordinator.  As the array is
+ * sorted and its xids are close to each other, send each one as the
+ * difference to its predecessor (to xmin for the first one) in a variable
+ * length encoding: 7 bits per byte, high bit set on all but the last byte.
+ *
+ * The differences are computed modulo 2^32, so an array that happens not to
+ * be sorted still round-trips, just less compactly.
+ */
+static int
+InProgressXid_EncodedSize(DistributedTransactionId delta)
+{
+	int			size = 1;
+
+	while (delta >= 0x80)
+	{
+		delta >>= 7;
+		size++;
+	}
+
+	return size;
+}
+
+static char *
+InProgressXid_Encode(DistributedTransactionId delta, char *p)
+{
+	while (delta >= 0x80)
+	{
+		*p++ = (char) ((delta & 0x7F) | 0x80);
+		delta >>= 7;
+	}
+	*p++ = (char) delta;
+
+	return p;
+}
+
+static const char *
+InProgressXid_Decode(const char *p, DistributedTransactionId *delta)
+{
+	DistributedTransactionId result = 0;
+	int			shift = 0;
+	uint8		byte;
+
+	do
+	{
+		byte = (uint8) *p++;
+		result |= (DistributedTransactionId) (byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	*delta = result;
+
+	return p;
+}
+
 int
 DistributedSnapshot_SerializeSize(DistributedSnapshot *ds)
 {
-	return sizeof(DistributedTransactionTimeStamp) +
+	DistributedTransactionId prev = ds->xmin;
+	int			size;
+	int			i;
+
+	size = sizeof(DistributedTransactionTimeStamp) +
 		sizeof(DistributedSnapshotId) +
 	/* xminAllDistributedSnapshots, xmin, xmax */
 		3 * sizeof(DistributedTransactionId) +
 	/* count */
-		sizeof(int32) +
-	/* Size of inProgressXidArray */
-		sizeof(DistributedTransactionId) * ds->count;
+		sizeof(int32);
+
+	/* Size of the encoded inProgressXidArray */
+	for (i = 0; i < ds->count; i++)
+	{
+		size += InProgressXid_EncodedSize(ds->inProgressXidArray[i] - prev);
+		prev = ds->inProgressXidArray[i];
+	}
+
+	return size;
 }
 
 int
 DistributedSnapshot_Serialize(DistributedSnapshot *ds, char *buf)
 {
 	char	   *p = buf;
+	DistributedTransactionId prev;
+	int			i;
 
 	memcpy(p, &ds->distribTransactionTimeStamp, sizeof(DistributedTransactionTimeStamp));
 	p += sizeof(DistributedTransactionTimeStamp);
@@ -355,8 +469,12 @@ DistributedSnapshot_Serialize(DistributedSnapshot *ds, char *buf)
 	memcpy(p, &ds->count, sizeof(int32));
 	p += sizeof(int32);
 
-	memcpy(p, ds->inProgressXidArray, sizeof(DistributedTransactionId) * ds->count);
-	p += sizeof(DistributedTransactionId) * ds->count;
+	prev = ds->xmin;
+	for (i = 0; i < ds->count; i++)
+	{
+		p = InProgressXid_Encode(ds->inProgressXidArray[i] - prev, p);
+		prev = ds->inProgressXidArray[i];
+	}
 
 	Assert((p - buf) == DistributedSnapshot_SerializeSize(ds));
 
@@ -415,13 +533,19 @@ DistributedSnapshot_Deserialize(const char *buf, DistributedSnapshot *ds)
 
 	if (count > 0)
 	{
-		int			xipsize;
+		DistributedTransactionId prev = ds->xmin;
+		int			i;
 
 		Assert(ds->inProgressXidArray != NULL);
 
-		xipsize = sizeof(DistributedTransactionId) * count;
-		memcpy(ds->inProgressXidArray, p, xipsize);
-		p += xipsize;
+		for (i = 0; i < count; i++)
+		{
+			DistributedTransactionId delta;
+
+			p = InProgressXid_Decode(p, &delta);
+			prev += delta;
+			ds->inProgressXidArray[i] = prev;
+		}
 	}
 	ds->count = count;
 
@@ -21,15 +21,14 @@
 
 #include "postgres.h"
 
+#include "access/distributedlog.h"
 #include "access/transam.h"
 #include "access/twophase.h"
 #include "cdb/cdblocaldistribxact.h"
 #include "cdb/cdbvars.h"
-#include "lib/ilist.h"
 #include "miscadmin.h"
 #include "storage/proc.h"
 #include "utils/guc.h"
-#include "utils/hsearch.h"
 #include "utils/memutils.h"
 
 /*  ***************************************************************************** */
@@ -152,33 +151,40 @@ LocalDistribXact_DisplayString(int pgprocno)
 
 /*  ***************************************************************************** */
 
+/*
+ * Cache of recently resolved local-distributed commit pairs.
+ *
+ * This is a direct-mapped table indexed by the low bits of the local xid,
+ * so a lookup is a single probe with no hashing, LRU maintenance or
+ * locking; a collision simply replaces the older pair.  The table starts
+ * small and is doubled, up to gp_max_local_distributed_cache entries, when
+ * collisions show that the working set does not fit.
+ *
+ * A committed pair never changes, but the local xid it is keyed on will
+ * eventually be reused after wraparound.  Xids preceding the distributed
+ * log's oldestXmin are never looked up here (the distributed log answers
+ * those without locking), and the whole table is discarded once that
+ * horizon has moved far enough that a cached xid could come around again.
+ */
+#define LOCAL_DISTRIB_CACHE_INITIAL_SIZE	256
+#define LOCAL_DISTRIB_CACHE_HORIZON_RESET	((uint32) 1 << 30)
+
 /* Memory context for long-lived local-distributed commit pairs. */
 static MemoryContext LocalDistribCacheMemCxt = NULL;
 
-/* Hash table for the long-lived local-distributed commit pairs. */
-static HTAB *LocalDistribCacheHtab;
-
 /*
  * A cached local-distributed transaction pair.
  *
  * We also cache just local-only transactions, so in that case distribXid
- * will be InvalidDistributedTransactionId.
+ * will be InvalidDistributedTransactionId.  An unused slot has an invalid
+ * localXid.
  */
 typedef struct LocalDistribXactCacheEntry
 {
-	/*
-	 * Distributed and local xids.
-	 */
 	TransactionId localXid;
-	/* MUST BE FIRST: Hash table key. */
 
 	DistributedTransactionId distribXid;
 
-	int64		visits;
-
-	dlist_node	lruDoubleLinks;
-	/* list link for LRU */
-
 } LocalDistribXactCacheEntry;
 
 /*
@@ -186,24 +192,61 @@ typedef struct LocalDistribXactCacheEntry
  */
 static struct LocalDistribXactCache
 {
-	int32		count;
+	LocalDistribXactCacheEntry *entries;
+
+	/* number of slots, always a power of two */
+	uint32		size;
 
-	dlist_head	lruDoublyLinkedHead;
+	/* maximum number of slots allowed by gp_max_local_distributed_cache */
+	uint32		maxSize;
+
+	/* collisions since the table was last resized */
+	uint32		collisions;
+
+	/* distributed log oldestXmin when the table was last emptied */
+	TransactionId horizon;
 
 	int64		hitCount;
 	int64		totalCount;
 	int64		addCount;
 	int64		removeCount;
 
-}			LocalDistribXactCache = {0, DLIST_STATIC_INIT(LocalDistribXactCache.lruDoublyLinkedHead), 0, 0, 0, 0};
+}			LocalDistribXactCache = {NULL, 0, 0, 0, InvalidTransactionId, 0, 0, 0, 0};
+
+#define LocalDistribXactCacheSlot(xid) \
+	(&LocalDistribXactCache.entries[(xid) & (LocalDistribXactCache.size - 1)])
 
+static void
+LocalDistribXactCache_Resize(uint32 newSize)
+{
+	LocalDistribXactCacheEntry *oldEntries = LocalDistribXactCache.entries;
+	uint32		oldSize = LocalDistribXactCache.size;
+	uint32		i;
+
+	LocalDistribXactCache.entries = (LocalDistribXactCacheEntry *)
+		MemoryContextAllocZero(LocalDistribCacheMemCxt,
+							   newSize * sizeof(LocalDistribXactCacheEntry));
+	LocalDistribXactCache.size = newSize;
+	LocalDistribXactCache.collisions = 0;
+
+	if (oldEntries == NULL)
+		return;
+
+	/* Carry over what we have; with more slots, nothing collides. */
+	for (i = 0; i < oldSize; i++)
+	{
+		if (TransactionIdIsValid(oldEntries[i].localXid))
+			*LocalDistribXactCacheSlot(oldEntries[i].localXid) = oldEntries[i];
+	}
+	pfree(oldEntries);
+}
 
 bool
 LocalDistribXactCache_CommittedFind(TransactionId localXid,
 									DistributedTransactionId *distribXid)
 {
 	LocalDistribXactCacheEntry *entry;
-	bool		found;
+	TransactionId horizon;
 
 	/* Before doing anything, see if we are enabled. */
 	if (gp_max_local_distributed_cache == 0)
@@ -211,7 +254,7 @@ LocalDistribXactCache_CommittedFind(TransactionId localXid,
 
 	if (LocalDistribCacheMemCxt == NULL)
 	{
-		HASHCTL		hash_ctl;
+		uint32		maxSize;
 
 		/* Create the memory context where cross-transaction state is stored */
 		LocalDistribCacheMemCxt = AllocSetContextCreate(TopMemoryContext,
@@ -220,48 +263,47 @@ LocalDistribXactCache_CommittedFind(TransactionId localXid,
 														ALLOCSET_DEFAULT_INITSIZE,
 														ALLOCSET_DEFAULT_MAXSIZE);
 
-		Assert(LocalDistribCacheHtab == NULL);
-
-		/* Create the hashtable proper */
-		MemSet(&hash_ctl, 0, sizeof(hash_ctl));
-		hash_ctl.keysize = sizeof(TransactionId);
-		hash_ctl.entrysize = sizeof(LocalDistribXactCacheEntry);
-		hash_ctl.hash = tag_hash;
-		hash_ctl.hcxt = LocalDistribCacheMemCxt;
-		LocalDistribCacheHtab = hash_create("Local-distributed commit cache",
-											25, /* start small and extend */
-											&hash_ctl,
-											HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
-
 		MemSet(&LocalDistribXactCache, 0, sizeof(LocalDistribXactCache));
-		dlist_init(&LocalDistribXactCache.lruDoublyLinkedHead);
 
+		/* Largest power of two that fits in gp_max_local_distributed_cache */
+		maxSize = 1;
+		while (maxSize <= (uint32) gp_max_local_distributed_cache / 2 &&
+			   maxSize < MaxAllocSize / (2 * sizeof(LocalDistribXactCacheEntry)))
+			maxSize *= 2;
+		LocalDistribXactCache.maxSize = maxSize;
+
+		LocalDistribXactCache_Resize(Min(maxSize, LOCAL_DISTRIB_CACHE_INITIAL_SIZE));
+		LocalDistribXactCache.horizon = DistributedLog_PeekOldestXmin();
 	}
 
-	entry = (LocalDistribXactCacheEntry *) hash_search(
-													   LocalDistribCacheHtab,
-													   &localXid,
-													   HASH_FIND,
-													   &found);
+	LocalDistribXactCache.totalCount++;
 
-	if (found)
-	{
-		/*
-		 * Maintain LRU ordering.
-		 */
-		dlist_delete(&entry->lruDoubleLinks);
-		dlist_push_head(&LocalDistribXactCache.lruDoublyLinkedHead, &entry->lruDoubleLinks);
+	/*
+	 * The distributed log doesn't know about xids older than its oldestXmin
+	 * and answers for them without taking any lock, so there is nothing to
+	 * gain from caching them.
+	 */
+	horizon = DistributedLog_PeekOldestXmin();
+	if (TransactionIdPrecedes(localXid, horizon))
+		return false;
 
-		*distribXid = entry->distribXid;
+	if ((uint32) (horizon - LocalDistribXactCache.horizon) >= LOCAL_DISTRIB_CACHE_HORIZON_RESET)
+	{
+		MemSet(LocalDistribXactCache.entries, 0,
+			   LocalDistribXactCache.size * sizeof(LocalDistribXactCacheEntry));
+		LocalDistribXactCache.horizon = horizon;
+		return false;
+	}
 
-		entry->visits++;
+	entry = LocalDistribXactCacheSlot(localXid);
+	if (!TransactionIdEquals(entry->localXid, localXid))
+		return false;
 
-		LocalDistribXactCache.hitCount++;
-	}
+	*distribXid = entry->distribXid;
 
-	LocalDistribXactCache.totalCount++;
+	LocalDistribXactCache.hitCount++;
 
-	return found;
+	return true;
 }
 
 void
@@ -269,64 +311,44 @@ LocalDistribXactCache_AddCommitted(TransactionId localXid,
 								   DistributedTransactionId distribXid)
 {
 	LocalDistribXactCacheEntry *entry;
-	bool		found;
 
 	/* Before doing anything, see if we are enabled. */
 	if (gp_max_local_distributed_cache == 0)
 		return;
 
 	Assert(LocalDistribCacheMemCxt != NULL);
-	Assert(LocalDistribCacheHtab != NULL);
+	Assert(LocalDistribXactCache.entries != NULL);
 
-	if (LocalDistribXactCache.count >= gp_max_local_distributed_cache)
+	/* See LocalDistribXactCache_CommittedFind() */
+	if (TransactionIdPrecedes(localXid, DistributedLog_PeekOldestXmin()))
+		return;
+
+	entry = LocalDistribXactCacheSlot(localXid);
+	if (TransactionIdEquals(entry->localXid, localXid))
 	{
-		LocalDistribXactCacheEntry *lastEntry;
-		LocalDistribXactCacheEntry *removedEntry;
+		elog(ERROR, "Add should not have found local xid = %x", localXid);
+	}
 
-		Assert(LocalDistribXactCache.count == gp_max_local_distributed_cache);
+	if (TransactionIdIsValid(entry->localXid))
+	{
+		LocalDistribXactCache.removeCount++;
 
 		/*
-		 * Remove oldest.
+		 * Frequent collisions mean the working set doesn't fit; grow the
+		 * table if we're still allowed to.
 		 */
-		lastEntry = (LocalDistribXactCacheEntry *)
-			dlist_container(LocalDistribXactCacheEntry,
-							lruDoubleLinks,
-							dlist_tail_node(&LocalDistribXactCache.lruDoublyLinkedHead));
-		Assert(lastEntry != NULL);
-		dlist_delete(&lastEntry->lruDoubleLinks);
-
-		removedEntry = (LocalDistribXactCacheEntry *)
-			hash_search(LocalDistribCacheHtab, &lastEntry->localXid,
-						HASH_REMOVE, NULL);
-		Assert(lastEntry == removedEntry);
-
-		LocalDistribXactCache.count--;
-
-		LocalDistribXactCache.removeCount++;
+		if (++LocalDistribXactCache.collisions > LocalDistribXactCache.size / 2 &&
+			LocalDistribXactCache.size < LocalDistribXactCache.maxSize)
+		{
+			LocalDistribXactCache_Resize(LocalDistribXactCache.size * 2);
+			entry = LocalDistribXactCacheSlot(localXid);
+		}
 	}
 
-	/* Now we can add entry to hash table */
-	entry = (LocalDistribXactCacheEntry *) hash_search(
-													   LocalDistribCacheHtab,
-													   &localXid,
-													   HASH_ENTER,
-													   &found);
-	if (found)
-	{
-		elog(ERROR, "Add should not have found local xid = %x", localXid);
-	}
-
-	dlist_push_head(&LocalDistribXactCache.lruDoublyLinkedHead,
-					&entry->lruDoubleLinks);
-
 	entry->localXid = localXid;
 	entry->distribXid = distribXid;
-	entry->visits = 1;
-
-	LocalDistribXactCache.count++;
 
 	LocalDistribXactCache.addCount++;
-
 }
 
 void
@@ -41,6 +41,14 @@
 
 #define PRINT_DISPATCH_DECISIONS_STRING ("print_dispatch_decisions")
 
+/*
+ * Upper bound on the number of distribution key value combinations we are
+ * willing to hash when looking for the target segments of a qual, e.g. the
+ * length of an IN-list.  Hashing stops early once every segment has been
+ * hit, so this only caps the planning cost of very long lists.
+ */
+#define MAX_DIRECT_DISPATCH_COMBINATIONS	MAX_POSSIBLE_VALUE_SET_SIZE
+
 static char *gp_test_options = "";
 
 /* PRINT_DISPATCH_DECISIONS_STRING; */
@@ -75,6 +83,13 @@ typedef struct DirectDispatchCalculationInfo
 	 *    no, and dd should be considered uninitialized.
 	 */
 	bool		haveProcessedAnyCalculations;
+
+	/**
+	 * Has targeted dispatch been disabled by something that must run on all
+	 *    contents, e.g. the receiving end of a motion?  As opposed to just not
+	 *    knowing where the rows are, as for a scan without usable quals.
+	 */
+	bool		isFullDispatchForced;
 }
 DirectDispatchCalculationInfo;
 
@@ -110,6 +125,9 @@ typedef struct ContentIdAssignmentData
 } ContentIdAssignmentData;
 
 static bool AssignContentIdsToPlanData_Walker(Node *node, void *context);
+static void AssignContentIdsToJoin(Join *join, ContentIdAssignmentData *data,
+					   DirectDispatchCalculationInfo *result);
+static bool AssignContentIdsToJoinExpressions(Join *join, ContentIdAssignmentData *data);
 
 /**
  * Initialize a DirectDispatchCalculationInfo.
@@ -120,6 +138,7 @@ InitDirectDispatchCalculationInfo(DirectDispatchCalculationInfo *data)
 	data->dd.isDirectDispatch = false;
 	data->dd.contentIds = NULL;
 	data->haveProcessedAnyCalculations = false;
+	data->isFullDispatchForced = false;
 }
 
 /**
@@ -132,6 +151,7 @@ DisableTargetedDispatch(DirectDispatchCalculationInfo *data)
 	data->dd.contentIds = NULL; /* leaks but it's okay, we made a new memory
 								 * context for the entire calculation */
 	data->haveProcessedAnyCalculations = true;
+	data->isFullDispatchForced = true;
 }
 
 /**
@@ -308,6 +328,13 @@ GetContentIdsFromPlanForSingleRelation(List *rtable, Plan *plan, int rangeTableI
 				parts[i].values = GetPossibleValuesAsArray(&pvs, &parts[i].numValues);
 				totalCombinations *= parts[i].numValues;
 				DeletePossibleValueSetData(&pvs);
+
+				/* too many to hash, and multiplying further could overflow */
+				if (totalCombinations > MAX_DIRECT_DISPATCH_COMBINATIONS)
+				{
+					totalCombinations = -1;
+					break;
+				}
 			}
 		}
 
@@ -326,9 +353,7 @@ GetContentIdsFromPlanForSingleRelation(List *rtable, Plan *plan, int rangeTableI
 													 * specific content at
 													 * all! */
 		}
-		else if (totalCombinations > 0 &&
-			/* don't bother for ones which will likely hash to many segments */
-				 totalCombinations < policy->numsegments * 3)
+		else if (totalCombinations > 0)
 		{
 			CdbHash    *h;
 			long		index;
@@ -373,6 +398,10 @@ GetContentIdsFromPlanForSingleRelation(List *rtable, Plan *plan, int rangeTableI
 				hashCode = cdbhashreduce(h);
 
 				result.dd.contentIds = list_append_unique_int(result.dd.contentIds, hashCode);
+
+				/* every segment is targeted already, the rest can't narrow it */
+				if (list_length(result.dd.contentIds) == policy->numsegments)
+					break;
 			}
 		}
 		else
@@ -396,6 +425,7 @@ MergeDirectDispatchCalculationInfo(DirectDispatchCalculationInfo *to, DirectDisp
 	{
 		/* from eliminates all options so take it */
 		to->dd.isDirectDispatch = false;
+		to->isFullDispatchForced |= from->isFullDispatchForced;
 	}
 	else if (!to->haveProcessedAnyCalculations)
 	{
@@ -424,6 +454,100 @@ MergeDirectDispatchCalculationInfo(DirectDispatchCalculationInfo *to, DirectDisp
 	to->haveProcessedAnyCalculations = true;
 }
 
+/**
+ * Does the info restrict the slice to a subset of the contents?
+ */
+static bool
+RestrictsContents(DirectDispatchCalculationInfo *info)
+{
+	return info->haveProcessedAnyCalculations && info->dd.isDirectDispatch;
+}
+
+/**
+ * Combine what was learned from the two inputs of a join that runs within a
+ * single slice, i.e. whose inputs are co-located.
+ *
+ * A join node computes its result on each segment from that segment's input
+ * rows only.  So if one input can only produce rows on some contents, and no
+ * result row can be emitted without a row from that input, the join only
+ * needs to run on those contents, however the other input is distributed.
+ * For an inner join either input qualifies, for an outer join only the
+ * preserved one.
+ *
+ * That does not hold if an input must run on all contents, e.g. because it
+ * receives from a motion whose senders expect every content to listen.
+ *
+ * Anything else falls back to the regular merge of both inputs.
+ */
+static void
+MergeJoinDirectDispatchCalculationInfo(JoinType jointype,
+									   DirectDispatchCalculationInfo *outer,
+									   DirectDispatchCalculationInfo *inner,
+									   DirectDispatchCalculationInfo *result)
+{
+	bool		outerRestricts = false;
+	bool		innerRestricts = false;
+
+	switch (jointype)
+	{
+		case JOIN_INNER:
+		case JOIN_SEMI:
+		case JOIN_DEDUP_SEMI:
+		case JOIN_DEDUP_SEMI_REVERSE:
+			outerRestricts = RestrictsContents(outer);
+			innerRestricts = RestrictsContents(inner);
+			break;
+		case JOIN_LEFT:
+		case JOIN_ANTI:
+			outerRestricts = RestrictsContents(outer);
+			break;
+		case JOIN_RIGHT:
+			innerRestricts = RestrictsContents(inner);
+			break;
+		default:
+
+			/*
+			 * JOIN_FULL preserves both inputs, and JOIN_LASJ_NOTIN must see
+			 * the NULLs of the inner input on every content.
+			 */
+			break;
+	}
+
+	InitDirectDispatchCalculationInfo(result);
+
+	if (outer->isFullDispatchForced || inner->isFullDispatchForced)
+		DisableTargetedDispatch(result);
+	else if (outerRestricts && innerRestricts)
+	{
+		*result = *outer;
+
+		/* a NULL contentIds means no content needs to run it at all */
+		result->dd.contentIds = NULL;
+		if (outer->dd.contentIds != NULL && inner->dd.contentIds != NULL)
+		{
+			ListCell   *lc;
+
+			foreach(lc, outer->dd.contentIds)
+			{
+				if (list_member_int(inner->dd.contentIds, lfirst_int(lc)))
+					result->dd.contentIds = lappend_int(result->dd.contentIds,
+														lfirst_int(lc));
+			}
+		}
+	}
+	else if (outerRestricts)
+		*result = *outer;
+	else if (innerRestricts)
+		*result = *inner;
+	else
+	{
+		if (outer->haveProcessedAnyCalculations)
+			MergeDirectDispatchCalculationInfo(result, outer);
+		if (inner->haveProcessedAnyCalculations)
+			MergeDirectDispatchCalculationInfo(result, inner);
+	}
+}
+
 /**
  * returns true if we should print test messages.  Note for clients: for multi-slice queries then messages will print in
  *   the order of processing which may not always be deterministic (single joins can be rearranged by the planner,
@@ -513,6 +637,7 @@ AssignContentIdsToPlanData_Walker(Node *node, void *context)
 	DirectDispatchCalculationInfo *ddcr = NULL;
 	DirectDispatchCalculationInfo dispatchInfo;
 	bool		pushNewDirectDispatchInfo = false;
+	bool		isJoin = false;
 	bool		result;
 
 	if (node == NULL)
@@ -621,13 +746,17 @@ AssignContentIdsToPlanData_Walker(Node *node, void *context)
 			case T_NestLoop:
 			case T_MergeJoin:
 			case T_HashJoin:
-				/* join: no change to dispatchInfo --> just iterate children */
 
 				/*
+				 * join: look at each input on its own, see
+				 * MergeJoinDirectDispatchCalculationInfo()
+				 *
 				 * note that we could want to look at the join qual but
 				 * constant checks should have been pushed down to the
 				 * underlying scans so we shouldn't learn anything
 				 */
+				AssignContentIdsToJoin((Join *) node, data, &dispatchInfo);
+				isJoin = true;
 				break;
 			case T_Material:
 			case T_Sort:
@@ -730,8 +859,14 @@ AssignContentIdsToPlanData_Walker(Node *node, void *context)
 	/*
 	 * note that the SubqueryScan nodes do NOT reach here -- its children are
 	 * managed in the switch above
+	 *
+	 * the inputs of a join have been walked already, only its expressions
+	 * are left (they may contain SubPlans)
 	 */
-	result = plan_tree_walker(node, AssignContentIdsToPlanData_Walker, context);
+	if (isJoin)
+		result = AssignContentIdsToJoinExpressions((Join *) node, data);
+	else
+		result = plan_tree_walker(node, AssignContentIdsToPlanData_Walker, context);
 	Assert(!result);
 
 	if (pushNewDirectDispatchInfo)
@@ -742,6 +877,82 @@ AssignContentIdsToPlanData_Walker(Node *node, void *context)
 	return result;
 }
 
+/**
+ * Walk one input of a join in a calculation info of its own, and return what
+ * was learned from it.
+ */
+static void
+AssignContentIdsToJoinInput(Plan *input, ContentIdAssignmentData *data,
+							DirectDispatchCalculationInfo *result)
+{
+	DirectDispatchCalculationInfo *ddcr;
+
+	ddcr = palloc(sizeof(DirectDispatchCalculationInfo));
+	InitDirectDispatchCalculationInfo(ddcr);
+	data->sliceStack = lappend(data->sliceStack, ddcr);
+
+	AssignContentIdsToPlanData_Walker((Node *) input, data);
+
+	/* slices below the input have been finalized and popped already */
+	Assert(llast(data->sliceStack) == ddcr);
+	data->sliceStack = list_truncate(data->sliceStack, list_length(data->sliceStack) - 1);
+
+	*result = *ddcr;
+	pfree(ddcr);
+}
+
+/**
+ * Compute the targeted dispatch info of a join from its inputs.
+ */
+static void
+AssignContentIdsToJoin(Join *join, ContentIdAssignmentData *data,
+					   DirectDispatchCalculationInfo *result)
+{
+	DirectDispatchCalculationInfo outerInfo;
+	DirectDispatchCalculationInfo innerInfo;
+
+	AssignContentIdsToJoinInput(outerPlan(join), data, &outerInfo);
+	AssignContentIdsToJoinInput(innerPlan(join), data, &innerInfo);
+
+	MergeJoinDirectDispatchCalculationInfo(join->jointype, &outerInfo, &innerInfo, result);
+}
+
+/**
+ * Walk everything of a join but its inputs, which AssignContentIdsToJoin()
+ * has taken care of.
+ */
+static bool
+AssignContentIdsToJoinExpressions(Join *join, ContentIdAssignmentData *data)
+{
+	Plan	   *plan = (Plan *) join;
+
+	if (AssignContentIdsToPlanData_Walker((Node *) plan->targetlist, data))
+		return true;
+	if (AssignContentIdsToPlanData_Walker((Node *) plan->qual, data))
+		return true;
+	if (AssignContentIdsToPlanData_Walker((Node *) plan->initPlan, data))
+		return true;
+	if (AssignContentIdsToPlanData_Walker((Node *) plan->flow, data))
+		return true;
+	if (AssignContentIdsToPlanData_Walker((Node *) join->joinqual, data))
+		return true;
+
+	switch (nodeTag(join))
+	{
+		case T_NestLoop:
+			return false;
+		case T_MergeJoin:
+			return AssignContentIdsToPlanData_Walker((Node *) ((MergeJoin *) join)->mergeclauses, data);
+		case T_HashJoin:
+			if (AssignContentIdsToPlanData_Walker((Node *) ((HashJoin *) join)->hashclauses, data))
+				return true;
+			return AssignContentIdsToPlanData_Walker((Node *) ((HashJoin *) join)->hashqualclauses, data);
+		default:
+			elog(ERROR, "unrecognized join node type: %d", (int) nodeTag(join));
+	}
+	return false;
+}
+
 /*
  * Update the plan and its descendants with markings telling which subsets of
  * content the node can run on.
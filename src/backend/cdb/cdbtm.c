@@ -432,7 +432,41 @@ doPrepareTransaction(void)
 		   DtxStateToString(MyTmGxactLocal->state));
 
 	Assert(MyTmGxactLocal->dtxSegments != NIL);
-	succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, true);
+	if (gp_dtx_prepare_writers_only)
+	{
+		/*
+		 * Only prepare the segments that wrote.  The others are left in
+		 * their open transaction, and commit it in one phase when the
+		 * Commit Prepared broadcast reaches them.  A read-only segment has
+		 * nothing to make durable, so this costs no atomicity.
+		 *
+		 * The second phase must tell the QEs about it, see
+		 * DTX_PROTOCOL_COMMAND_COMMIT_WRITERS_PREPARED.  Remember that
+		 * before dispatching, an abort can follow a partial PREPARE.
+		 */
+		char		gid[TMGIDSIZE];
+		List	   *writerSegments = NIL;
+		ListCell   *lc;
+
+		MyTmGxactLocal->preparedWritersOnly = true;
+
+		foreach(lc, MyTmGxactLocal->dtxSegments)
+		{
+			int			segindex = lfirst_int(lc);
+
+			if (bms_is_member(segindex, MyTmGxactLocal->xlogSegmentsMap))
+				writerSegments = lappend_int(writerSegments, segindex);
+		}
+
+		dtxFormGID(gid, getDistributedTransactionTimestamp(), getDistributedTransactionId());
+		succeeded = doDispatchDtxProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, gid,
+												 &MyTmGxactLocal->badPrepareGangs,
+												 /* raiseError */ true,
+												 writerSegments, NULL, 0);
+		list_free(writerSegments);
+	}
+	else
+		succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, true);
 
 	/*
 	 * Now we've cleaned up our dispatched statement, cancels are allowed
@@ -583,7 +617,10 @@ doNotifyingCommitPrepared(void)
 	Assert(MyTmGxactLocal->dtxSegments != NIL);
 	PG_TRY();
 	{
-		succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_PREPARED, true);
+		succeeded = currentDtxDispatchProtocolCommand(MyTmGxactLocal->preparedWritersOnly ?
+													  DTX_PROTOCOL_COMMAND_COMMIT_WRITERS_PREPARED :
+													  DTX_PROTOCOL_COMMAND_COMMIT_PREPARED,
+													  true);
 	}
 	PG_CATCH();
 	{
@@ -823,6 +860,11 @@ doNotifyingAbort(void)
 			dtxProtocolCommand = DTX_PROTOCOL_COMMAND_ABORT_SOME_PREPARED;
 			abortString = "Abort [Prepared]";
 		}
+		else if (MyTmGxactLocal->preparedWritersOnly)
+		{
+			dtxProtocolCommand = DTX_PROTOCOL_COMMAND_ABORT_WRITERS_PREPARED;
+			abortString = "Abort Prepared";
+		}
 		else
 		{
 			dtxProtocolCommand = DTX_PROTOCOL_COMMAND_ABORT_PREPARED;
@@ -900,9 +942,16 @@ prepareDtxTransaction(void)
 	 * has been assigned on the QD either, or there is no xlog writing related
 	 * to this transaction on all segments, we can perform one-phase commit.
 	 * Otherwise, broadcast PREPARE TRANSACTION to the segments.
+	 *
+	 * With gp_dtx_prepare_writers_only, only the segments that wrote xlog
+	 * count: if at most one of them did, every segment is committed in one
+	 * phase, and otherwise only the writers are prepared (see
+	 * doPrepareTransaction()).
 	 */
 	if (!TopXactExecutorDidWriteXLog() ||
-		(!markXidCommitted && list_length(MyTmGxactLocal->dtxSegments) < 2))
+		(!markXidCommitted && list_length(MyTmGxactLocal->dtxSegments) < 2) ||
+		(!markXidCommitted && gp_dtx_prepare_writers_only &&
+		 bms_num_members(MyTmGxactLocal->xlogSegmentsMap) < 2))
 	{
 		setCurrentDtxState(DTX_STATE_ONE_PHASE_COMMIT);
 		/*
@@ -1506,6 +1555,8 @@ resetGxact()
 	MyTmGxactLocal->writerGangLost = false;
 	MyTmGxactLocal->dtxSegmentsMap = NULL;
 	MyTmGxactLocal->dtxSegments = NIL;
+	MyTmGxactLocal->xlogSegmentsMap = NULL;
+	MyTmGxactLocal->preparedWritersOnly = false;
 	MyTmGxactLocal->isOnePhaseCommit = false;
 	if (MyTmGxactLocal->waitGxids != NULL)
 	{
@@ -2350,6 +2401,37 @@ performDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 			performDtxProtocolAbortPrepared(gid, /* raiseErrorIfNotFound */ true);
 			break;
 
+		case DTX_PROTOCOL_COMMAND_COMMIT_WRITERS_PREPARED:
+			/*
+			 * The QD only prepared the segments that wrote, see
+			 * gp_dtx_prepare_writers_only.  A segment that didn't write is
+			 * still in its open transaction, and has nothing to make
+			 * durable: commit it in one phase.
+			 */
+			if (DistributedTransactionContext == DTX_CONTEXT_QE_TWO_PHASE_EXPLICIT_WRITER ||
+				DistributedTransactionContext == DTX_CONTEXT_QE_TWO_PHASE_IMPLICIT_WRITER)
+			{
+				performDtxProtocolCommitOnePhase(gid);
+				break;
+			}
+			requireDistributedTransactionContext(DTX_CONTEXT_QE_PREPARED);
+			setDistributedTransactionContext(DTX_CONTEXT_QE_FINISH_PREPARED);
+			performDtxProtocolCommitPrepared(gid, /* raiseErrorIfNotFound */ true);
+			break;
+
+		case DTX_PROTOCOL_COMMAND_ABORT_WRITERS_PREPARED:
+			/* likewise, a segment that was never prepared just aborts */
+			if (DistributedTransactionContext == DTX_CONTEXT_QE_TWO_PHASE_EXPLICIT_WRITER ||
+				DistributedTransactionContext == DTX_CONTEXT_QE_TWO_PHASE_IMPLICIT_WRITER)
+			{
+				AbortOutOfAnyTransaction();
+				break;
+			}
+			requireDistributedTransactionContext(DTX_CONTEXT_QE_PREPARED);
+			setDistributedTransactionContext(DTX_CONTEXT_QE_FINISH_PREPARED);
+			performDtxProtocolAbortPrepared(gid, /* raiseErrorIfNotFound */ true);
+			break;
+
 		case DTX_PROTOCOL_COMMAND_RETRY_COMMIT_PREPARED:
 			requireDistributedTransactionContext(DTX_CONTEXT_LOCAL_ONLY);
 			performDtxProtocolCommitPrepared(gid, /* raiseErrorIfNotFound */ false);
@@ -2495,3 +2577,25 @@ addToGxactDtxSegments(Gang *gang)
 	}
 	MemoryContextSwitchTo(oldContext);
 }
+
+/*
+ * Record that the QE of a segment reported writing xlog in the current
+ * distributed transaction.
+ */
+void
+addToGxactXLogSegments(int segindex)
+{
+	MemoryContext oldContext;
+
+	/* entry db is just a reader, will not involve in two phase commit */
+	if (segindex == -1 || !isCurrentDtxActivated())
+		return;
+
+	if (bms_is_member(segindex, MyTmGxactLocal->xlogSegmentsMap))
+		return;
+
+	oldContext = MemoryContextSwitchTo(TopTransactionContext);
+	MyTmGxactLocal->xlogSegmentsMap =
+		bms_add_member(MyTmGxactLocal->xlogSegmentsMap, segindex);
+	MemoryContextSwitchTo(oldContext);
+}
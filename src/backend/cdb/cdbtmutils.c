@@ -108,6 +108,10 @@ DtxProtocolCommandToString(DtxProtocolCommand command)
 			return "Distributed Commit Prepared";
 		case DTX_PROTOCOL_COMMAND_ABORT_PREPARED:
 			return "Distributed Abort Prepared";
+		case DTX_PROTOCOL_COMMAND_COMMIT_WRITERS_PREPARED:
+			return "Distributed Commit Prepared (Writers Only)";
+		case DTX_PROTOCOL_COMMAND_ABORT_WRITERS_PREPARED:
+			return "Distributed Abort Prepared (Writers Only)";
 		case DTX_PROTOCOL_COMMAND_RETRY_COMMIT_PREPARED:
 			return "Retry Distributed Commit Prepared";
 		case DTX_PROTOCOL_COMMAND_RETRY_ABORT_PREPARED:
@@ -88,6 +88,9 @@ int			gp_safefswritesize; /* set for safe AO writes in non-mature fs */
 int			gp_cached_gang_threshold;	/* How many gangs to keep around from
 										 * stmt to stmt. */
 
+bool		gp_gang_prespawn = false;	/* create the writer gang at session
+										 * start */
+
 bool		Gp_write_shared_snapshot;	/* tell the writer QE to write the
 										 * shared snapshot */
 
@@ -267,6 +270,7 @@ double		gp_selectivity_damping_factor = 1;
 bool		gp_selectivity_damping_sigsort = true;
 
 int			gp_hashjoin_tuples_per_bucket = 5;
+bool		gp_hashjoin_adaptive_batches = false;
 int			gp_hashagg_groups_per_bucket = 5;
 
 /* Analyzing aid */
@@ -35,6 +35,7 @@
 #include "cdb/cdbgang.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbpq.h"
+#include "cdb/cdbtm.h"
 #include "miscadmin.h"
 #include "commands/sequence.h"
 #include "access/xact.h"
@@ -1087,6 +1088,7 @@ processResults(CdbDispatchResult *dispatchResult)
 		if (segdbDesc->conn->wrote_xlog)
 		{
 			MarkTopTransactionWriteXLogOnExecutor();
+			addToGxactXLogSegments(segdbDesc->segindex);
 
 			/*
 			 * Reset the worte_xlog here. Since if the received pgresult not process
@@ -747,6 +747,75 @@ void DisconnectAndDestroyUnusedQEs(void)
 	cdbcomponent_cleanupIdleQEs(false);
 }
 
+/*
+ * Create the writer gang of a freshly started session, so that its first
+ * query finds warm QEs in the freelist instead of paying for the fork,
+ * authentication and GUC sync of every QE.
+ *
+ * This only pays off when something else sits between the client and the
+ * session, e.g. a connection pooler that keeps server connections open and
+ * hands them out to short-lived clients: the writer gang survives the idle
+ * cleanup (see DisconnectAndDestroyUnusedQEs()) and DISCARD ALL, so one
+ * pre-spawn serves every client the pooler leases the session to.
+ *
+ * The gang is created during backend startup, before ReadyForQuery is sent,
+ * so the client waits for the slowest QE before it can send its first query.
+ *
+ * Failures are not fatal, the gang is just created lazily as usual.
+ *
+ * call only from an idle session, outside of a transaction.
+ */
+void
+PrespawnGangs(void)
+{
+	MemoryContext oldContext = CurrentMemoryContext;
+
+	if (Gp_role != GP_ROLE_DISPATCH || !gp_gang_prespawn)
+		return;
+
+	/* nothing to do if we already have QEs */
+	if (cdbcomponent_qesExist())
+		return;
+
+	ELOG_DISPATCHER_DEBUG("PrespawnGangs begin.");
+
+	StartTransactionCommand();
+
+	PG_TRY();
+	{
+		CdbDispatcherState *ds = cdbdisp_makeDispatcherState(false);
+
+		AllocateGang(ds, GANGTYPE_PRIMARY_WRITER,
+					 cdbcomponent_getCdbComponentsList());
+
+		/* return the QEs to the freelist */
+		cdbdisp_destroyDispatcherState(ds);
+
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		ErrorData  *edata;
+
+		MemoryContextSwitchTo(oldContext);
+		edata = CopyErrorData();
+		FlushErrorState();
+
+		/* AtAbort_DispatcherState() cleans up the half-built gang */
+		AbortCurrentTransaction();
+
+		ereport(LOG,
+				(errmsg("could not pre-spawn the writer gang: %s",
+						edata->message)));
+		FreeErrorData(edata);
+	}
+	PG_END_TRY();
+
+	MemoryContextSwitchTo(oldContext);
+
+	ELOG_DISPATCHER_DEBUG("PrespawnGangs end.");
+}
+
 /*
  * Drop any temporary tables associated with the current session and
  * use a new session id since we have effectively reset the session.
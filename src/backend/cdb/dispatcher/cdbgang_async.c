@@ -119,12 +119,17 @@ create_gang_retry:
 
 	PG_TRY();
 	{
+		/*
+		 * The GUC options are the same for every QE of the gang, build them
+		 * once rather than walking all the GUCs for each segment.
+		 */
+		char	   *options = NULL;
+		char	   *diff_options = NULL;
+
 		for (i = 0; i < size; i++)
 		{
 			bool		ret;
 			char		gpqeid[100];
-			char	   *options = NULL;
-			char	   *diff_options = NULL;
 
 			/*
 			 * Create the connection requests.	If we find a segment without a
@@ -159,7 +164,8 @@ create_gang_retry:
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("failed to construct connectionstring")));
 
-			makeOptions(&options, &diff_options);
+			if (options == NULL)
+				makeOptions(&options, &diff_options);
 
 			/* start connection in asynchronous way */
 			cdbconn_doConnectStart(segdbDesc, gpqeid, options, diff_options);
@@ -35,6 +35,9 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 		ds->distribTransactionTimeStamp = timeStamp;
 	}
 
+	/* Nothing has been truncated from the distributed log */
+	will_return_count(DistributedLog_PeekOldestXmin, FirstNormalTransactionId, -1);
+
 	/*
 	 * Define how distributed xids will map to localXids. For the purpose of
 	 * the testing keep it extremely simple distribXid == 10 * localXid.
@@ -131,9 +134,14 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
+
+	/* The cache is kept sorted, and found even when not at either end */
+	retval = DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 10, false);
+	assert_true(retval == DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS);
+	assert_true(dslm.currentLocalXidsCount == 3);
 
 	/*
 	 * Lets revalidate that local cache is working and
@@ -145,9 +153,9 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
 
 	/*
 	 * Test where local cache should not be touched, if distributedXid is not
@@ -158,14 +166,55 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
 
 	free(ds->inProgressXidArray);
 	free(dslm.inProgressMappedLocalXids);
 }
 
+static void
+test__DistributedSnapshot_Serialize(void **state)
+{
+	DistributedSnapshot ds = DistributedSnapshot_StaticInit;
+	DistributedSnapshot copy = DistributedSnapshot_StaticInit;
+	DistributedTransactionId xids[] = {1000, 1001, 1130, 1131, 70000, 4294967290U};
+	char		buf[1024];
+	int			size;
+	int			i;
+
+	ds.distribTransactionTimeStamp = 1234;
+	ds.xminAllDistributedSnapshots = 900;
+	ds.distribSnapshotId = 42;
+	ds.xmin = 1000;
+	ds.xmax = 4294967291U;
+	ds.count = lengthof(xids);
+	ds.maxCount = lengthof(xids);
+	ds.inProgressXidArray = xids;
+
+	size = DistributedSnapshot_SerializeSize(&ds);
+
+	/* the header, then 1 + 1 + 2 + 1 + 3 + 5 bytes for the xids */
+	assert_int_equal(size, sizeof(DistributedTransactionTimeStamp) +
+					 sizeof(DistributedSnapshotId) +
+					 3 * sizeof(DistributedTransactionId) +
+					 sizeof(int32) + 13);
+	assert_int_equal(DistributedSnapshot_Serialize(&ds, buf), size);
+	assert_int_equal(DistributedSnapshot_Deserialize(buf, &copy), size);
+
+	assert_int_equal(copy.distribTransactionTimeStamp, ds.distribTransactionTimeStamp);
+	assert_int_equal(copy.xminAllDistributedSnapshots, ds.xminAllDistributedSnapshots);
+	assert_int_equal(copy.distribSnapshotId, ds.distribSnapshotId);
+	assert_int_equal(copy.xmin, ds.xmin);
+	assert_int_equal(copy.xmax, ds.xmax);
+	assert_int_equal(copy.count, ds.count);
+	for (i = 0; i < ds.count; i++)
+		assert_int_equal(copy.inProgressXidArray[i], xids[i]);
+
+	free(copy.inProgressXidArray);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -173,7 +222,8 @@ main(int argc, char* argv[])
 
 	const UnitTest tests[] =
 	{
-		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest)
+		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest),
+		unit_test(test__DistributedSnapshot_Serialize)
 	};
 
 	MemoryContextInit();
@@ -24,6 +24,10 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <catalog/catalog.h>
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define USE_SSE2_COPY_SCAN
+#endif
 
 #include "access/heapam.h"
 #include "access/htup_details.h"
@@ -145,6 +149,95 @@ if (1) \
 
 static const char BinarySignature[11] = "PGCOPY\n\377\r\n\0";
 
+/*
+ * The characters that the COPY text/CSV parsing loops must look at one by
+ * one.  Everything else is just carried along, so the loops use
+ * CopyScanSpecial() to skip over runs of ordinary bytes in one go.
+ */
+#define COPY_SCAN_MAX_SPECIALS 5
+
+typedef struct CopyScanSpecials
+{
+	int			nspecials;
+	char		specials[COPY_SCAN_MAX_SPECIALS];
+	bool		highbit;		/* also stop at bytes with the high bit set */
+} CopyScanSpecials;
+
+static void
+CopyScanSpecialsInit(CopyScanSpecials *scan, const char *chars, int nchars,
+					 bool highbit)
+{
+	int			i;
+	int			j;
+
+	Assert(nchars <= COPY_SCAN_MAX_SPECIALS);
+
+	scan->nspecials = 0;
+	for (i = 0; i < nchars; i++)
+	{
+		/* a '\0' in the list stands for an unused (or disabled) character */
+		if (chars[i] == '\0')
+			continue;
+		for (j = 0; j < scan->nspecials; j++)
+		{
+			if (scan->specials[j] == chars[i])
+				break;
+		}
+		if (j == scan->nspecials)
+			scan->specials[scan->nspecials++] = chars[i];
+	}
+	scan->highbit = highbit;
+}
+
+/*
+ * Return a pointer to the first special character in [s, end), or end if
+ * there is none.
+ */
+static inline const char *
+CopyScanSpecial(const CopyScanSpecials *scan, const char *s, const char *end)
+{
+	int			i;
+
+#ifdef USE_SSE2_COPY_SCAN
+	if (end - s >= sizeof(__m128i))
+	{
+		__m128i		needles[COPY_SCAN_MAX_SPECIALS];
+
+		for (i = 0; i < scan->nspecials; i++)
+			needles[i] = _mm_set1_epi8(scan->specials[i]);
+
+		while (end - s >= sizeof(__m128i))
+		{
+			__m128i		chunk = _mm_loadu_si128((const __m128i *) s);
+			__m128i		hits = _mm_setzero_si128();
+			int			mask;
+
+			for (i = 0; i < scan->nspecials; i++)
+				hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[i]));
+			mask = _mm_movemask_epi8(hits);
+			if (scan->highbit)
+				mask |= _mm_movemask_epi8(chunk);
+
+			if (mask != 0)
+				return s + __builtin_ctz(mask);
+			s += sizeof(__m128i);
+		}
+	}
+#endif
+
+	for (; s < end; s++)
+	{
+		if (scan->highbit && IS_HIGHBIT_SET(*s))
+			return s;
+		for (i = 0; i < scan->nspecials; i++)
+		{
+			if (*s == scan->specials[i])
+				return s;
+		}
+	}
+	return end;
+}
+
 
 /* non-export function prototypes */
 static CopyState BeginCopy(bool is_from, Relation rel, Node *raw_query,
@@ -4738,6 +4831,13 @@ BeginCopyFrom(Relation rel,
 				ereport(ERROR,
 						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
 						 errmsg("\"%s\" is a directory", filename)));
+
+#ifdef USE_POSIX_FADVISE
+			/* let kernel read-ahead overlap with parsing, see gfile_open() */
+			if (S_ISREG(st.st_mode))
+				(void) posix_fadvise(fileno(cstate->copy_file), 0, 0,
+									 POSIX_FADV_SEQUENTIAL);
+#endif
 		}
 	}
 
@@ -6130,6 +6230,7 @@ CopyReadLineText(CopyState cstate)
 				last_was_esc = false;
 	char		quotec = '\0';
 	char		escapec = '\0';
+	CopyScanSpecials scan;
 
 	if (cstate->csv_mode)
 	{
@@ -6142,6 +6243,13 @@ CopyReadLineText(CopyState cstate)
 
 	mblen_str[1] = '\0';
 
+	{
+		char		specials[] = {'\r', '\n', '\\', quotec, escapec};
+
+		CopyScanSpecialsInit(&scan, specials, lengthof(specials),
+							 cstate->encoding_embeds_ascii);
+	}
+
 	/*
 	 * The objective of this loop is to transfer the entire next input line
 	 * into line_buf.  Hence, we only care for detecting newlines (\r and/or
@@ -6207,6 +6315,26 @@ CopyReadLineText(CopyState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Skip ahead to the next character that needs a closer look.  The
+		 * bytes skipped are plain data, so all they would do below is clear
+		 * last_was_esc and first_char_in_line.
+		 */
+		if (!first_char_in_line)
+		{
+			int			skip_to;
+
+			skip_to = CopyScanSpecial(&scan, copy_raw_buf + raw_buf_ptr,
+									  copy_raw_buf + copy_buf_len) - copy_raw_buf;
+			if (skip_to > raw_buf_ptr)
+			{
+				raw_buf_ptr = skip_to;
+				last_was_esc = false;
+				if (raw_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = raw_buf_ptr;
 		c = copy_raw_buf[raw_buf_ptr++];
@@ -6611,6 +6739,7 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 	char	   *output_ptr;
 	char	   *cur_ptr;
 	char	   *line_end_ptr;
+	CopyScanSpecials scan;
 
 	/*
 	 * We need a special case for zero-column tables: check that the input
@@ -6642,6 +6771,13 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 	cur_ptr = cstate->line_buf.data + cstate->line_buf.cursor;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	{
+		char		specials[] = {delim_off ? '\0' : delimc,
+								  cstate->escape_off ? '\0' : escapec};
+
+		CopyScanSpecialsInit(&scan, specials, lengthof(specials), false);
+	}
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -6687,6 +6823,16 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 		for (;;)
 		{
 			char		c;
+			char	   *special_ptr;
+
+			/* Copy everything up to the next delimiter or escape as is */
+			special_ptr = (char *) CopyScanSpecial(&scan, cur_ptr, line_end_ptr);
+			if (special_ptr > cur_ptr)
+			{
+				memcpy(output_ptr, cur_ptr, special_ptr - cur_ptr);
+				output_ptr += special_ptr - cur_ptr;
+				cur_ptr = special_ptr;
+			}
 
 			end_ptr = cur_ptr;
 			if (cur_ptr >= line_end_ptr)
@@ -6860,6 +7006,8 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 	char	   *output_ptr;
 	char	   *cur_ptr;
 	char	   *line_end_ptr;
+	CopyScanSpecials unquoted_scan;
+	CopyScanSpecials quoted_scan;
 
 	/*
 	 * We need a special case for zero-column tables: check that the input
@@ -6891,6 +7039,16 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 	cur_ptr = cstate->line_buf.data + cstate->line_buf.cursor;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	{
+		char		unquoted_specials[] = {delim_off ? '\0' : delimc, quotec};
+		char		quoted_specials[] = {escapec, quotec};
+
+		CopyScanSpecialsInit(&unquoted_scan, unquoted_specials,
+							 lengthof(unquoted_specials), false);
+		CopyScanSpecialsInit(&quoted_scan, quoted_specials,
+							 lengthof(quoted_specials), false);
+	}
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -6932,10 +7090,20 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 		for (;;)
 		{
 			char		c;
+			char	   *special_ptr;
 
 			/* Not in quote */
 			for (;;)
 			{
+				/* Copy everything up to the next delimiter or quote as is */
+				special_ptr = (char *) CopyScanSpecial(&unquoted_scan, cur_ptr, line_end_ptr);
+				if (special_ptr > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, special_ptr - cur_ptr);
+					output_ptr += special_ptr - cur_ptr;
+					cur_ptr = special_ptr;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					goto endfield;
@@ -6959,6 +7127,15 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 			/* In quote */
 			for (;;)
 			{
+				/* Copy everything up to the next escape or quote as is */
+				special_ptr = (char *) CopyScanSpecial(&quoted_scan, cur_ptr, line_end_ptr);
+				if (special_ptr > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, special_ptr - cur_ptr);
+					output_ptr += special_ptr - cur_ptr;
+					cur_ptr = special_ptr;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					ereport(ERROR,
@@ -45,7 +45,14 @@
 #include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"
 
+static void ExecHashTableOverflow(HashJoinTable hashtable);
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static void ExecHashGrowBatchArrays(HashJoinTable hashtable, int nbatch,
+						bool resident);
+static void ExecHashDumpNonResident(HashJoinTable hashtable,
+						long *ninmemory, long *nfreed);
+static void ExecHashChooseNumBatches(HashJoinTable hashtable);
+static void ExecHashSpillResidentBatches(HashJoinTable hashtable);
 static void ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node,
 					  int mcvsToUse);
 static void ExecHashSkewTableInsert(HashState *hashState, HashJoinTable hashtable,
@@ -272,6 +279,7 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	Plan	   *outerNode;
 	int			nbuckets;
 	int			nbatch;
+	int			planned_nbatch;
 	int			num_skew_mcvs;
 	int			log2_nbuckets;
 	int			nkeys;
@@ -295,6 +303,15 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 							operatorMemKB,
 							&nbuckets, &nbatch, &num_skew_mcvs);
 
+	/*
+	 * With adaptive batching, start out with a single batch whatever the
+	 * planner expects.  If the table overflows, ExecHashChooseNumBatches
+	 * picks the number of batches from the inner tuples seen by then.
+	 */
+	planned_nbatch = nbatch;
+	if (gp_hashjoin_adaptive_batches && !hjstate->reuse_hashtable)
+		nbatch = 1;
+
 #ifdef HJDEBUG
 	printf("nbatch = %d, nbuckets = %d\n", nbatch, nbuckets);
 #endif
@@ -339,6 +356,18 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	hashtable->eagerlyReleased = false;
 	hashtable->hjstate = hjstate;
 	hashtable->first_pass = true;
+	hashtable->adaptive = gp_hashjoin_adaptive_batches && !hjstate->reuse_hashtable;
+	hashtable->batchResident = NULL;
+	hashtable->batchSpace = NULL;
+	hashtable->innerRowsEstimate = outerNode->plan_rows;
+	if (Gp_role == GP_ROLE_EXECUTE)
+		hashtable->innerRowsEstimate /= getgpsegmentCount();
+	hashtable->chunked = false;
+	hashtable->moreChunks = false;
+	hashtable->chunkno = 0;
+	hashtable->outerTupleNo = 0;
+	hashtable->outerMatched = NULL;
+	hashtable->outerMatchedLen = 0;
 
 	/*
 	 * Create temporary memory contexts in which to keep the hashtable working
@@ -418,7 +447,7 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	 * Set up for skew optimization, if possible and there's a need for more
 	 * than one batch.  (In a one-batch join, there's no point in it.)
 	 */
-	if (nbatch > 1)
+	if (planned_nbatch > 1)
 		ExecHashBuildSkewHash(hashtable, node, num_skew_mcvs);
 
 	MemoryContextSwitchTo(oldcxt);
@@ -700,6 +729,19 @@ ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable)
 	END_MEMORY_ACCOUNT();
 }
 
+/*
+ * ExecHashTableOverflow
+ *		called when the hash table has grown past spaceAllowed
+ */
+static void
+ExecHashTableOverflow(HashJoinTable hashtable)
+{
+	if (hashtable->adaptive && hashtable->curbatch == 0)
+		ExecHashSpillResidentBatches(hashtable);
+	else
+		ExecHashIncreaseNumBatches(hashtable);
+}
+
 /*
  * ExecHashIncreaseNumBatches
  *		increase the original number of batches in order to reduce
@@ -709,15 +751,10 @@ static void
 ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 {
 	int			oldnbatch = hashtable->nbatch;
-	int			curbatch = hashtable->curbatch;
 	int			nbatch;
-	int			i;
-	MemoryContext oldcxt;
 	long		ninmemory;
 	long		nfreed;
 	Size		spaceUsedBefore = hashtable->spaceUsed;
-	Size		spaceFreed = 0;
-	HashJoinTableStats *stats = hashtable->stats;
 
 	/* do nothing if we've decided to shut off growth */
 	if (!hashtable->growEnabled)
@@ -738,6 +775,56 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		   nbatch, (unsigned long) hashtable->spaceUsed);
 #endif
 
+	ExecHashGrowBatchArrays(hashtable, nbatch, false);
+
+	/*
+	 * Dump out any tuples that are no longer of the current batch.  (In the
+	 * first pass of an adaptive hash table, we only get here once batch 0 is
+	 * the only resident batch with tuples in memory, and the batches that
+	 * were just added are not resident.)
+	 */
+	ExecHashDumpNonResident(hashtable, &ninmemory, &nfreed);
+	if (hashtable->batchSpace)
+		hashtable->batchSpace[hashtable->curbatch] -=
+			spaceUsedBefore - hashtable->spaceUsed;
+
+#ifdef HJDEBUG
+	printf("Freed %ld of %ld tuples, space now %lu\n",
+		   nfreed, ninmemory, (unsigned long) hashtable->spaceUsed);
+#endif
+
+	/*
+	 * If we dumped out either all or none of the tuples in the table, disable
+	 * further expansion of nbatch.  This situation implies that we have
+	 * enough tuples of identical hashvalues to overflow spaceAllowed.
+	 * Increasing nbatch will not fix it since there's no way to subdivide the
+	 * group any more finely. We have to just gut it out and hope the server
+	 * has enough RAM, unless adaptive batching joins the batch in chunks.
+	 */
+	if (nfreed == 0 || nfreed == ninmemory)
+	{
+		hashtable->growEnabled = false;
+		elog(LOG, "HJ: Disabling further increase of nbatch");
+	}
+
+}
+
+/*
+ * ExecHashGrowBatchArrays
+ *		switch to a larger nbatch, enlarging the per-batch arrays
+ *
+ * In the first pass of an adaptive hash table, the batches added are
+ * resident or not according to 'resident'.  No tuples are moved.
+ */
+static void
+ExecHashGrowBatchArrays(HashJoinTable hashtable, int nbatch, bool resident)
+{
+	int			oldnbatch = hashtable->nbatch;
+	HashJoinTableStats *stats = hashtable->stats;
+	MemoryContext oldcxt;
+
+	Assert(nbatch > oldnbatch);
+
 	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
 
 	if (hashtable->innerBatchFile == NULL)
@@ -761,6 +848,18 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 			   (nbatch - oldnbatch) * sizeof(BufFile *));
 	}
 
+	if (hashtable->batchResident)
+	{
+		hashtable->batchResident = (bool *) repalloc(hashtable->batchResident,
+													 nbatch * sizeof(bool));
+		hashtable->batchSpace = (Size *) repalloc(hashtable->batchSpace,
+												  nbatch * sizeof(Size));
+		memset(hashtable->batchResident + oldnbatch, resident,
+			   (nbatch - oldnbatch) * sizeof(bool));
+		MemSet(hashtable->batchSpace + oldnbatch, 0,
+			   (nbatch - oldnbatch) * sizeof(Size));
+	}
+
 	/* EXPLAIN ANALYZE batch statistics */
 	if (stats && stats->nbatchstats < nbatch)
 	{
@@ -776,12 +875,30 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	MemoryContextSwitchTo(oldcxt);
 
 	hashtable->nbatch = nbatch;
+}
+
+/*
+ * ExecHashDumpNonResident
+ *		write out the tuples in the hash table whose batch is not resident
+ *		any more, and free them
+ *
+ * Returns the number of tuples scanned in *ninmemory, and the number of
+ * them written out in *nfreed.
+ */
+static void
+ExecHashDumpNonResident(HashJoinTable hashtable, long *ninmemory, long *nfreed)
+{
+	int			curbatch = hashtable->curbatch;
+	int			i;
+	Size		spaceUsedBefore = hashtable->spaceUsed;
+	Size		spaceFreed = 0;
+	HashJoinTableStats *stats = hashtable->stats;
 
 	/*
 	 * Scan through the existing hash table entries and dump out any that are
-	 * no longer of the current batch.
+	 * no longer of a resident batch.
 	 */
-	ninmemory = nfreed = 0;
+	*ninmemory = *nfreed = 0;
 
 	for (i = 0; i < hashtable->nbuckets; i++)
 	{
@@ -798,11 +915,11 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 			int			bucketno;
 			int			batchno;
 
-			ninmemory++;
+			(*ninmemory)++;
 			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
 									  &bucketno, &batchno);
 			Assert(bucketno == i);
-			if (batchno == curbatch)
+			if (HashJoinBatchIsResident(hashtable, batchno))
 			{
 				/* keep tuple */
 				prevtuple = tuple;
@@ -831,7 +948,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 					stats->batchstats[batchno].spillspace_in += spaceTuple;
 
 				pfree(tuple);
-				nfreed++;
+				(*nfreed)++;
 			}
 
 			tuple = nexttuple;
@@ -841,33 +958,184 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		}
 	}
 
-#ifdef HJDEBUG
-	printf("Freed %ld of %ld tuples, space now %lu\n",
-		   nfreed, ninmemory, (unsigned long) hashtable->spaceUsed);
-#endif
-
 	/* Update work_mem high-water mark and amount spilled. */
 	if (stats)
 	{
 		stats->workmem_max = Max(stats->workmem_max, spaceUsedBefore);
 		stats->batchstats[curbatch].spillspace_out += spaceFreed;
-		stats->batchstats[curbatch].spillrows_out += nfreed;
+		stats->batchstats[curbatch].spillrows_out += *nfreed;
 	}
+}
+
+/*
+ * ExecHashChooseNumBatches
+ *		pick the number of batches when an adaptive hash table first
+ *		overflows
+ *
+ * The tuples in memory tell how much room an inner tuple really takes.
+ * Together with the planner's row count, that gives the expected size of
+ * the inner relation, which is divided into batches that fit in memory.
+ * The row count is not trusted when it is low, though: the relation is
+ * assumed to be at least twice as big as what has been seen so far.
+ *
+ * All the batches start out resident; ExecHashSpillResidentBatches then
+ * writes out as many of them as needed.
+ */
+static void
+ExecHashChooseNumBatches(HashJoinTable hashtable)
+{
+	double		nseen = hashtable->totalTuples + 1;
+	double		nexpected;
+	double		dbatch;
+	int			nbatch;
+	int			i;
+	MemoryContext oldcxt;
+
+	Assert(hashtable->nbatch == 1 && hashtable->batchResident == NULL);
+
+	nexpected = Max(hashtable->innerRowsEstimate, 2 * nseen);
+	dbatch = ceil(nexpected * (hashtable->spaceUsed / nseen) /
+				  hashtable->spaceAllowed);
+	dbatch = Min(dbatch, Min(INT_MAX / 2, MaxAllocSize / (sizeof(void *) * 2)));
+
+	nbatch = 2;
+	while (nbatch < dbatch)
+		nbatch <<= 1;
 
 	/*
-	 * If we dumped out either all or none of the tuples in the table, disable
-	 * further expansion of nbatch.  This situation implies that we have
-	 * enough tuples of identical hashvalues to overflow spaceAllowed.
-	 * Increasing nbatch will not fix it since there's no way to subdivide the
-	 * group any more finely. We have to just gut it out and hope the server
-	 * has enough RAM.
+	 * We create two files per batch; stay under the per-query limit, as
+	 * ExecChooseHashTableSize does.
 	 */
-	if (nfreed == 0 || nfreed == ninmemory)
+	if (gp_workfile_limit_files_per_query > 0)
 	{
-		hashtable->growEnabled = false;
-		elog(LOG, "HJ: Disabling further increase of nbatch");
+		while (nbatch * 2 > gp_workfile_limit_files_per_query && nbatch > 2)
+			nbatch >>= 1;
+	}
+
+	elog(DEBUG1, "HashJoin: using %d batches after %.0f inner tuples",
+		 nbatch, nseen);
+
+	ExecHashGrowBatchArrays(hashtable, nbatch, true);
+
+	/* Nothing has been written out yet */
+	hashtable->nbatch_original = nbatch;
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+	hashtable->batchResident = (bool *) palloc(nbatch * sizeof(bool));
+	memset(hashtable->batchResident, true, nbatch * sizeof(bool));
+	hashtable->batchSpace = (Size *) palloc0(nbatch * sizeof(Size));
+	MemoryContextSwitchTo(oldcxt);
+
+	/* Find out how much room each batch takes */
+	for (i = 0; i < hashtable->nbuckets; i++)
+	{
+		HashJoinTuple tuple;
+
+		for (tuple = hashtable->buckets[i]; tuple != NULL; tuple = tuple->next)
+		{
+			int			bucketno;
+			int			batchno;
+
+			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
+									  &bucketno, &batchno);
+			hashtable->batchSpace[batchno] +=
+				HJTUPLE_OVERHEAD + memtuple_get_size(HJTUPLE_MINTUPLE(tuple));
+		}
+	}
+}
+
+/*
+ * ExecHashSpillResidentBatches
+ *		bring an adaptive hash table back under spaceAllowed during the
+ *		first pass, by writing out the biggest resident batches
+ *
+ * The batches that stay resident are joined in the first pass along with
+ * batch 0, so their outer tuples are never written out.  Batch 0 itself is
+ * never written out: once it is the only batch left in memory, it is split
+ * by increasing nbatch instead.
+ */
+static void
+ExecHashSpillResidentBatches(HashJoinTable hashtable)
+{
+	Size		spaceToFree;
+	int			nspilled = 0;
+	long		ninmemory;
+	long		nfreed;
+
+	if (hashtable->batchResident == NULL)
+		ExecHashChooseNumBatches(hashtable);
+
+	/* Pick the batches to write out, biggest first */
+	spaceToFree = hashtable->spaceUsed - hashtable->spaceAllowed;
+	while (spaceToFree > 0)
+	{
+		int			victim = 0;
+		int			i;
+
+		for (i = 1; i < hashtable->nbatch; i++)
+		{
+			if (hashtable->batchResident[i] && hashtable->batchSpace[i] > 0 &&
+				(victim == 0 ||
+				 hashtable->batchSpace[i] > hashtable->batchSpace[victim]))
+				victim = i;
+		}
+		if (victim == 0)
+			break;
+
+		hashtable->batchResident[victim] = false;
+		spaceToFree -= Min(spaceToFree, hashtable->batchSpace[victim]);
+		hashtable->batchSpace[victim] = 0;
+		nspilled++;
+	}
+
+	if (nspilled > 0)
+	{
+		ExecHashDumpNonResident(hashtable, &ninmemory, &nfreed);
+
+#ifdef HJDEBUG
+		printf("Wrote out %d batches, %ld of %ld tuples, space now %lu\n",
+			   nspilled, nfreed, ninmemory,
+			   (unsigned long) hashtable->spaceUsed);
+#endif
 	}
 
+	if (hashtable->spaceUsed > hashtable->spaceAllowed)
+		ExecHashIncreaseNumBatches(hashtable);
+}
+
+/*
+ * ExecHashTableFitBatch
+ *		increase nbatch before loading a batch whose inner file is known not
+ *		to fit in memory
+ *
+ * With adaptive batching, the batch is split in one step, so that each of
+ * its tuples is written out once, rather than nbatch being doubled each
+ * time the table overflows while the file is loaded.  A tuple takes a little
+ * more room in memory than in the file, so the table may still overflow.
+ */
+void
+ExecHashTableFitBatch(HashJoinTable hashtable, int64 innerBytes)
+{
+	int			nbatch = hashtable->nbatch;
+
+	if (!hashtable->adaptive || !hashtable->growEnabled)
+		return;
+
+	while (innerBytes > (int64) hashtable->spaceAllowed &&
+		   nbatch <= Min(INT_MAX / 2, MaxAllocSize / (sizeof(void *) * 2)))
+	{
+		nbatch *= 2;
+		innerBytes /= 2;
+	}
+
+	if (nbatch > hashtable->nbatch)
+	{
+#ifdef HJDEBUG
+		printf("Increasing nbatch to %d to load batch %d\n",
+			   nbatch, hashtable->curbatch);
+#endif
+		ExecHashGrowBatchArrays(hashtable, nbatch, false);
+	}
 }
 
 /*
@@ -894,6 +1162,7 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	int			bucketno;
 	int			batchno;
 	int			hashTupleSize;
+	bool		inserted;
 
 	START_MEMORY_ACCOUNT(hashState->ps.memoryAccountId);
 	{
@@ -907,7 +1176,8 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	/*
 	 * decide whether to put the tuple in the hash table or a temp file
 	 */
-	if (batchno == hashtable->curbatch)
+	inserted = HashJoinBatchIsResident(hashtable, batchno);
+	if (inserted)
 	{
 		/*
 		 * put the tuple in hash table
@@ -934,11 +1204,13 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 
 		/* Account for space used, and back off if we've used too much */
 		hashtable->spaceUsed += hashTupleSize;
+		if (hashtable->batchSpace)
+			hashtable->batchSpace[batchno] += hashTupleSize;
 		if (hashtable->spaceUsed > hashtable->spacePeak)
 			hashtable->spacePeak = hashtable->spaceUsed;
 		if (hashtable->spaceUsed > hashtable->spaceAllowed)
 		{
-			ExecHashIncreaseNumBatches(hashtable);
+			ExecHashTableOverflow(hashtable);
 
 			if (ps && ps->instrument)
 			{
@@ -967,7 +1239,7 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	}
 	END_MEMORY_ACCOUNT();
 
-	return (batchno == hashtable->curbatch);
+	return inserted;
 }
 
 /*
@@ -1989,7 +2261,7 @@ ExecHashSkewTableInsert(HashState *hashState,
 
 	/* Check we are not over the total spaceAllowed, either */
 	if (hashtable->spaceUsed > hashtable->spaceAllowed)
-		ExecHashIncreaseNumBatches(hashtable);
+		ExecHashTableOverflow(hashtable);
 }
 
 /*
@@ -2039,13 +2311,15 @@ ExecHashRemoveNextSkewBucket(HashState *hashState, HashJoinTable hashtable)
 		tupleSize = HJTUPLE_OVERHEAD + memtuple_get_size(tuple);
 
 		/* Decide whether to put the tuple in the hash table or a temp file */
-		if (batchno == hashtable->curbatch)
+		if (HashJoinBatchIsResident(hashtable, batchno))
 		{
 			/* Move the tuple to the main hash table */
 			hashTuple->next = hashtable->buckets[bucketno];
 			hashtable->buckets[bucketno] = hashTuple;
 			/* We have reduced skew space, but overall space doesn't change */
 			hashtable->spaceUsedSkew -= tupleSize;
+			if (hashtable->batchSpace)
+				hashtable->batchSpace[batchno] += tupleSize;
 		}
 		else
 		{
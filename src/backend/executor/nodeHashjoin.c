@@ -55,6 +55,9 @@ static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
 						  uint32 *hashvalue,
 						  TupleTableSlot *tupleSlot);
 static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
+static void ExecHashJoinRewindOuterBatch(HashJoinTable hashtable);
+static bool ExecHashJoinOuterMatched(HashJoinTable hashtable);
+static void ExecHashJoinMarkOuterMatched(HashJoinTable hashtable);
 static bool isNotDistinctJoin(List *qualList);
 
 static void ReleaseHashTable(HashJoinState *node);
@@ -309,6 +312,8 @@ ExecHashJoin_guts(HashJoinState *node)
 
 				econtext->ecxt_outertuple = outerTupleSlot;
 				node->hj_MatchedOuter = false;
+				if (hashtable->chunked)
+					hashtable->outerTupleNo++;
 
 				/*
 				 * Find the corresponding bucket for this tuple in the main
@@ -323,25 +328,40 @@ ExecHashJoin_guts(HashJoinState *node)
 
 				/*
 				 * The tuple might not belong to the current batch (where
-				 * "current batch" includes the skew buckets if any).
+				 * "current batch" includes the skew buckets if any, and the
+				 * other resident batches of an adaptive hash table).
 				 */
-				if (batchno != hashtable->curbatch &&
+				if (!HashJoinBatchIsResident(hashtable, batchno) &&
 					node->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO)
 				{
 					/*
 					 * Need to postpone this outer tuple to a later batch.
-					 * Save it in the corresponding outer-batch file.
+					 * Save it in the corresponding outer-batch file.  If the
+					 * batch is joined in chunks, that was done while joining
+					 * the first chunk.
 					 */
 					Assert(batchno > hashtable->curbatch);
-					ExecHashJoinSaveTuple(&node->js.ps, ExecFetchSlotMemTuple(outerTupleSlot),
-										  hashvalue,
-										  hashtable,
-										  &hashtable->outerBatchFile[batchno],
-										  hashtable->bfCxt);
+					if (hashtable->chunkno == 0)
+						ExecHashJoinSaveTuple(&node->js.ps, ExecFetchSlotMemTuple(outerTupleSlot),
+											  hashvalue,
+											  hashtable,
+											  &hashtable->outerBatchFile[batchno],
+											  hashtable->bfCxt);
 					/* Loop around, staying in HJ_NEED_NEW_OUTER state */
 					continue;
 				}
 
+				/*
+				 * In a semijoin or antijoin, we're done with an outer tuple
+				 * that found a match in an earlier chunk of the batch.
+				 */
+				if (hashtable->chunkno > 0 &&
+					(node->js.jointype == JOIN_SEMI ||
+					 node->js.jointype == JOIN_ANTI ||
+					 node->js.jointype == JOIN_LASJ_NOTIN) &&
+					ExecHashJoinOuterMatched(hashtable))
+					continue;
+
 				/* OK, let's scan the bucket for matches */
 				node->hj_JoinState = HJ_SCAN_BUCKET;
 
@@ -398,6 +418,11 @@ ExecHashJoin_guts(HashJoinState *node)
 					node->hj_MatchedOuter = true;
 					MemTupleSetMatch(HJTUPLE_MINTUPLE(node->hj_CurTuple));
 
+					/* Tell the later chunks of the batch about the match */
+					if (hashtable->moreChunks &&
+						(HJ_FILL_OUTER(node) || node->js.jointype == JOIN_SEMI))
+						ExecHashJoinMarkOuterMatched(hashtable);
+
 					/* In an antijoin, we never return a matched tuple */
 					if (node->js.jointype == JOIN_ANTI ||
 						node->js.jointype == JOIN_LASJ_NOTIN)
@@ -441,6 +466,16 @@ ExecHashJoin_guts(HashJoinState *node)
 				if (!node->hj_MatchedOuter &&
 					HJ_FILL_OUTER(node))
 				{
+					/*
+					 * If the batch is joined in chunks, the outer tuple may
+					 * have matched in an earlier chunk, or match in a later
+					 * one.  Only the last chunk knows.
+					 */
+					if (hashtable->chunked &&
+						(hashtable->moreChunks ||
+						 ExecHashJoinOuterMatched(hashtable)))
+						break;
+
 					/*
 					 * Generate a fake join tuple with nulls for the inner
 					 * tuple, and return it if it passes the non-join quals.
@@ -935,9 +970,38 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 	if (curbatch >= nbatch)
 		return false;
 
+	/*
+	 * If the current batch is being joined in chunks and part of its inner
+	 * file is still unread, load the next chunk, and join the whole outer
+	 * batch file with it again.
+	 */
+	if (hashtable->moreChunks)
+	{
+		hashtable->chunkno++;
+		hashtable->outerTupleNo = 0;
+
+		if (!ExecHashJoinReloadHashTable(hjstate))
+			return false;
+
+		ExecHashJoinRewindOuterBatch(hashtable);
+		return true;
+	}
+
 	if (curbatch >= 0 && hashtable->stats)
 		ExecHashTableExplainBatchEnd(hashState, hashtable);
 
+	if (hashtable->chunked)
+	{
+		/* Done with the chunks of the current batch */
+		hashtable->chunked = false;
+		hashtable->chunkno = 0;
+		hashtable->outerTupleNo = 0;
+		if (hashtable->outerMatched)
+			pfree(hashtable->outerMatched);
+		hashtable->outerMatched = NULL;
+		hashtable->outerMatchedLen = 0;
+	}
+
 	if (curbatch > 0)
 	{
 		/*
@@ -961,6 +1025,15 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 		hashtable->skewBucketNums = NULL;
 		hashtable->nSkewBuckets = 0;
 		hashtable->spaceUsedSkew = 0;
+
+		/* From now on, only the current batch is resident */
+		if (hashtable->batchResident)
+		{
+			pfree(hashtable->batchResident);
+			pfree(hashtable->batchSpace);
+			hashtable->batchResident = NULL;
+			hashtable->batchSpace = NULL;
+		}
 	}
 
 	/*
@@ -1070,18 +1143,73 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 		return false;
 	}
 
-	/*
-	 * Rewind outer batch file (if present), so that we can start reading it.
-	 */
-	if (hashtable->outerBatchFile[curbatch] != NULL)
+	ExecHashJoinRewindOuterBatch(hashtable);
+
+	return true;
+}
+
+/*
+ * ExecHashJoinRewindOuterBatch
+ *		rewind the outer batch file of the current batch (if present), so
+ *		that we can start reading it
+ */
+static void
+ExecHashJoinRewindOuterBatch(HashJoinTable hashtable)
+{
+	BufFile	   *file = hashtable->outerBatchFile[hashtable->curbatch];
+
+	if (file != NULL)
 	{
-		if (BufFileSeek(hashtable->outerBatchFile[curbatch], 0, 0, SEEK_SET) != 0)
+		if (BufFileSeek(file, 0, 0, SEEK_SET) != 0)
 			ereport(ERROR,
 					(errcode_for_file_access(),
 					 errmsg("could not access temporary file")));
 	}
+}
 
-	return true;
+/*
+ * ExecHashJoinOuterMatched
+ *		did the current outer tuple match in an earlier chunk of the batch?
+ */
+static bool
+ExecHashJoinOuterMatched(HashJoinTable hashtable)
+{
+	uint64		tupno = hashtable->outerTupleNo - 1;
+	Size		byteno = tupno / BITS_PER_BYTE;
+
+	return (byteno < hashtable->outerMatchedLen &&
+			(hashtable->outerMatched[byteno] & (1 << (tupno % BITS_PER_BYTE))) != 0);
+}
+
+/*
+ * ExecHashJoinMarkOuterMatched
+ *		remember that the current outer tuple matched, for the later chunks
+ *		of the batch
+ */
+static void
+ExecHashJoinMarkOuterMatched(HashJoinTable hashtable)
+{
+	uint64		tupno = hashtable->outerTupleNo - 1;
+	Size		byteno = tupno / BITS_PER_BYTE;
+
+	if (byteno >= hashtable->outerMatchedLen)
+	{
+		Size		newlen = Max(byteno + 1, Max(hashtable->outerMatchedLen * 2, 1024));
+
+		if (hashtable->outerMatched == NULL)
+			hashtable->outerMatched = (bits8 *)
+				MemoryContextAllocZero(hashtable->hashCxt, newlen);
+		else
+		{
+			hashtable->outerMatched = (bits8 *)
+				repalloc(hashtable->outerMatched, newlen);
+			memset(hashtable->outerMatched + hashtable->outerMatchedLen, 0,
+				   newlen - hashtable->outerMatchedLen);
+		}
+		hashtable->outerMatchedLen = newlen;
+	}
+
+	hashtable->outerMatched[byteno] |= (1 << (tupno % BITS_PER_BYTE));
 }
 
 /*
@@ -1433,12 +1561,22 @@ ExecHashJoinReloadHashTable(HashJoinState *hjstate)
 
 	if (hashtable->innerBatchFile[curbatch] != NULL)
 	{
-		/* Rewind batch file */
-		if (BufFileSeek(hashtable->innerBatchFile[curbatch], 0, 0, SEEK_SET) != 0)
+		/*
+		 * Rewind batch file, unless we are loading the next chunk of a batch
+		 * joined in chunks.
+		 */
+		if (!hashtable->moreChunks)
 		{
-			ereport(ERROR, (errcode_for_file_access(),
-							errmsg("could not access temporary file")));
+			if (BufFileSeek(hashtable->innerBatchFile[curbatch], 0, 0, SEEK_SET) != 0)
+			{
+				ereport(ERROR, (errcode_for_file_access(),
+								errmsg("could not access temporary file")));
+			}
+
+			ExecHashTableFitBatch(hashtable,
+								  BufFileGetSize(hashtable->innerBatchFile[curbatch]));
 		}
+		hashtable->moreChunks = false;
 
 		for (;;)
 		{
@@ -1460,6 +1598,21 @@ ExecHashJoinReloadHashTable(HashJoinState *hjstate)
 			 */
 			if (!ExecHashTableInsert(hashState, hashtable, slot, hashvalue))
 				nmoved++;
+
+			/*
+			 * With adaptive batching, if the table is full and the batch
+			 * cannot be split any further, stop here and join the batch in
+			 * chunks.  The rest of the file is loaded after the outer batch
+			 * file has been joined with the tuples in memory.
+			 */
+			if (hashtable->adaptive && !hashtable->growEnabled &&
+				hashtable->spaceUsed > hashtable->spaceAllowed)
+			{
+				hashtable->chunked = true;
+				hashtable->moreChunks = true;
+				SIMPLE_FAULT_INJECTOR("exec_hashjoin_batch_chunked");
+				return true;
+			}
 		}
 
 		/*
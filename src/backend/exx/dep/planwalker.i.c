@@ -50,6 +50,7 @@ typedef struct exx_walker_ctxt_t {
 	bool has_shareinput;
 	bool has_window;
 	bool has_agg;
+	bool has_limit;
 	PlannedStmt *stmt;
 } exx_walker_ctxt_t;
 
@@ -59,6 +60,7 @@ static void hj_fix_walker(Node *node, void *ctxt);
 static Node* query_hint_mutator(Node *node, void *ctxt); 
 
 extern void xscan_build_kite_query(ExternalScan *xscan, Agg *agg, PlannedStmt *stmt); 
+extern void xscan_build_kite_topn(ExternalScan *xscan, Sort *sort, Limit *limit, PlannedStmt *stmt); 
 
 typedef struct exx_query_hint_t {
 	bool disable_orca;
@@ -122,7 +124,7 @@ void exx_post_planner_pass(PlannedStmt *p)
 	
 	exx_find_nodetype(p, &ctxt); 
 
-	if (! ctxt.has_agg) {
+	if (! ctxt.has_agg && ! ctxt.has_limit) {
 		return;
 	}
 
@@ -237,6 +239,8 @@ void find_nodetype_walker(Node *node, void *ctxt)
 			ntctxt->has_nlj = true;
 		} else if (IsA(node, Agg)) {
 			ntctxt->has_agg = true;
+		} else if (IsA(node, Limit)) {
+			ntctxt->has_limit = true;
 		}
 
 		find_nodetype_walker((Node *)plan->lefttree, ctxt);
@@ -334,6 +338,15 @@ void hj_fix_walker(Node *node, void *ctxt)
 			hj_fix_walker((Node *)plan->initPlan, ctxt);
 		}
 	}
+	else if(IsA(node, Limit) && IsA(plan->lefttree, Sort) && IsA(plan->lefttree->lefttree, ExternalScan))
+	{
+		Sort *sort = (Sort *) plan->lefttree;
+		ExternalScan *xscan = (ExternalScan *) sort->plan.lefttree;
+		exx_walker_ctxt_t *pctxt = (exx_walker_ctxt_t *) ctxt;
+		xscan_build_kite_topn(xscan, sort, (Limit *) node, pctxt->stmt);
+		hj_fix_walker((Node *)plan->lefttree, ctxt);
+		hj_fix_walker((Node *)plan->initPlan, ctxt);
+	}
 	else if(IsA(node, ExternalScan)) 
 	{
 		ExternalScan *xscan = (ExternalScan *) node;
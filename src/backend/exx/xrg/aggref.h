@@ -22,6 +22,12 @@ extern "C" {
 typedef bool (*GP_FUNC_PTR_MESS)();
 void xscan_build_kite_query(ExternalScan *xscan, Agg *agg, PlannedStmt *stmt);
 
+/*
+ * Interface for planwalker.  Saves the sort keys and row count of a Limit -> Sort -> ExternalScan
+ * plan to exx_bc, so that the segments ask kite for the top-N rows only.
+ */
+void xscan_build_kite_topn(ExternalScan *xscan, Sort *sort, Limit *limit, PlannedStmt *stmt);
+
 bool node_to_xexpr(Node *node, void *ptr);
 bool not_required_fill_xexpr(void *ptr);
 
@@ -14,6 +14,7 @@
 #include "executor/nodeExternalscan.h"
 #include "nodes/makefuncs.h"
 #include "utils/lsyscache.h"
+#include "utils/typcache.h"
 #include "parser/parsetree.h"
 #include "optimizer/var.h"
 #include "optimizer/clauses.h"
@@ -136,6 +137,28 @@ static bool expr_kite_valid(Node *node, void *ptr) {
 		return false;
 	}
 
+	if (IsA(node, ArrayExpr)) {
+		ArrayExpr *e = (ArrayExpr *)node;
+		ListCell *lc;
+		foreach (lc, e->elements) {
+			expr_kite_valid((Node *)lfirst(lc), ptr);
+		}
+		return false;
+	}
+
+	/*
+	 * Params are evaluated by the segment when it sends the query to kite, so initplan results
+	 * such as col = ANY(ARRAY(SELECT key FROM dim)) go to kite as an IN list of the keys.
+	 */
+	if (IsA(node, Param)) {
+		Param *param = (Param *)node;
+		if (param->paramkind != PARAM_EXTERN && param->paramkind != PARAM_EXEC) {
+			*((bool *)ptr) = false;
+			elog(LOG, "Invalid Param kind(%d) for Kite.", param->paramkind);
+		}
+		return false;
+	}
+
 	elog_node_display(LOG, "KITE_INVALID", node, true);
 
 	*((bool *)ptr) = false;
@@ -274,3 +297,131 @@ void xscan_build_kite_query(ExternalScan *xscan, Agg *agg, PlannedStmt *stmt) {
 	xscan->exx_bc = (char *)palloc(xscan->exx_bcsz);
 	strcpy(xscan->exx_bc, x);
 }
+
+/* Evaluate a LIMIT/OFFSET expression; false if it is not a constant */
+static bool limit_const_value(Node *node, int64_t *value) {
+	if (!node) {
+		*value = 0;
+		return true;
+	}
+
+	node = eval_const_expressions(NULL, (Node *)copyObject(node));
+	if (!IsA(node, Const) || ((Const *)node)->constisnull) {
+		return false;
+	}
+
+	*value = DatumGetInt64(((Const *)node)->constvalue);
+	return *value >= 0;
+}
+
+/*
+ * Sort key types that kite orders the same way as their default btree opclass.  Strings are
+ * left out because kite does not know the collation, and floats and numerics because of NaN.
+ */
+static bool topn_type_valid(Oid typid) {
+	switch (typid) {
+	case INT2OID:
+	case INT4OID:
+	case INT8OID:
+	case DATEOID:
+	case TIMEOID:
+	case TIMESTAMPOID:
+	case TIMESTAMPTZOID:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * This function runs in master segment, for a Limit -> Sort -> ExternalScan plan.
+ * It saves the sort keys and the number of rows to exx_bc, and the segment adds ORDER BY ... LIMIT
+ * to the kite query, so that kite returns the top-N rows of each fragment instead of all of them.
+ * The Sort and Limit nodes stay in the plan and merge the per-fragment top-N into the final one.
+ *
+ * Every qual must go to kite too.  Otherwise kite cuts off the rows before the quals are applied.
+ *
+ * exx_bc = [ [ [attno, desc, nullsfirst], ... ], count ]
+ */
+void xscan_build_kite_topn(ExternalScan *xscan, Sort *sort, Limit *limit, PlannedStmt *stmt) {
+	ListCell *lc;
+
+	if (!(fmttype_is_xrg_par_orc(xscan->fmtType) || fmttype_is_csv(xscan->fmtType))) {
+		return;
+	}
+
+	/* something else is pushed down already */
+	if (xscan->exx_bcsz > 0) {
+		return;
+	}
+
+	/* a sort that discards duplicates needs more than N rows */
+	if (sort->noduplicates || sort->numCols == 0 || !limit->limitCount) {
+		return;
+	}
+
+	int64_t count, offset;
+	if (!limit_const_value(limit->limitCount, &count) || !limit_const_value(limit->limitOffset, &offset)) {
+		return;
+	}
+	if (count > PG_INT64_MAX - offset) {
+		return;
+	}
+	count += offset;
+
+	/* Check Valid Qual.  Same node types as kite_json.c traverse_qual */
+	bool kite_valid = true;
+	foreach (lc, xscan->scan.plan.qual) {
+		Node *qual = (Node *)lfirst(lc);
+		if (!(IsA(qual, OpExpr) || IsA(qual, BoolExpr) || IsA(qual, ScalarArrayOpExpr) || IsA(qual, NullTest))) {
+			return;
+		}
+		expr_kite_valid(qual, &kite_valid);
+		if (!kite_valid) {
+			elog(LOG, "Qual is not valid for Kite and fall back to table scan");
+			return;
+		}
+	}
+
+	/* Check Valid Sort Keys */
+	int32_t attnos[sort->numCols];
+	bool descs[sort->numCols];
+	for (int i = 0; i < sort->numCols; i++) {
+		TargetEntry *tle = get_tle_by_resno(xscan->scan.plan.targetlist, sort->sortColIdx[i]);
+		if (!tle || !IsA(tle->expr, Var) || ((Var *)tle->expr)->varattno <= 0) {
+			return;
+		}
+
+		Var *var = (Var *)tle->expr;
+		if (!topn_type_valid(var->vartype)) {
+			return;
+		}
+
+		TypeCacheEntry *tc = lookup_type_cache(var->vartype, TYPECACHE_LT_OPR | TYPECACHE_GT_OPR);
+		if (sort->sortOperators[i] != tc->lt_opr && sort->sortOperators[i] != tc->gt_opr) {
+			return;
+		}
+
+		attnos[i] = var->varattno;
+		descs[i] = (sort->sortOperators[i] == tc->gt_opr);
+	}
+
+	xex_list_t *keys = xex_list_create();
+	for (int i = 0; i < sort->numCols; i++) {
+		xex_list_t *key = xex_list_create();
+		xex_list_append_int32(key, attnos[i]);
+		xex_list_append_int32(key, descs[i]);
+		xex_list_append_int32(key, sort->nullsFirst[i]);
+		xex_list_append_list(keys, key);
+	}
+
+	xex_list_t *xexpr = xex_list_create();
+	xex_list_append_list(xexpr, keys);
+	xex_list_append_int64(xexpr, count);
+	char *x = xex_to_text((xex_object_t *)xexpr);
+
+	xscan->exx_bclv = BCLV_TOPN;
+	xscan->exx_bcsz = strlen(x) + 1;
+	xscan->exx_bc = (char *)palloc(xscan->exx_bcsz);
+	strcpy(xscan->exx_bc, x);
+}
@@ -3,7 +3,6 @@
 #include "decode.h"
 #include "exx/exx_trans.h"
 #include "aggop.h"
-#include "../util/decimal.h"
 
 static inline Datum decode_int16(char *data) {
 	int16_t *p = (int16_t *)data;
@@ -49,83 +48,192 @@ static inline Datum decode_time(char *data) {
 	return Int64GetDatum(t);
 }
 
-static Datum decode_timestamp(char *data) {
+static inline Datum decode_timestamp(char *data) {
 	int64_t ts = *((int64_t *)data);
-	Timestamp epoch_ts = SetEpochTimestamp();
-	ts += epoch_ts;
+	ts -= (int64_t)(POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
 	return Int64GetDatum(ts);
 }
 
+static inline Datum decode_interval(char *data) {
+	return PointerGetDatum((__int128_t *)data);
+}
+
+/* type-specialized decoders, picked by decode_var for a bound target */
+
+#define DEFINE_DECODE_FIXED(NAME, FN)                                                               \
+	static int NAME(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) { \
+		int idx = tgt->vidx[0];                                                                     \
+		*pg_isnull = (*iter->flag[idx] & XRG_FLAG_NULL);                                            \
+		*pg_datum = FN(iter->value[idx]);                                                           \
+		return 0;                                                                                   \
+	}
+
+DEFINE_DECODE_FIXED(decode_col_char, decode_char)
+DEFINE_DECODE_FIXED(decode_col_int16, decode_int16)
+DEFINE_DECODE_FIXED(decode_col_int32, decode_int32)
+DEFINE_DECODE_FIXED(decode_col_int64, decode_int64)
+DEFINE_DECODE_FIXED(decode_col_int128, decode_int128)
+DEFINE_DECODE_FIXED(decode_col_float, decode_float)
+DEFINE_DECODE_FIXED(decode_col_double, decode_double)
+
+/* same as above, but the datum of a NULL is 0 rather than garbage */
+#define DEFINE_DECODE_FIXED_NULL0(NAME, FN)                                                         \
+	static int NAME(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) { \
+		int idx = tgt->vidx[0];                                                                     \
+		char flag = *iter->flag[idx];                                                               \
+		*pg_isnull = (flag & XRG_FLAG_NULL);                                                        \
+		*pg_datum = (flag & XRG_FLAG_NULL) ? 0 : FN(iter->value[idx]);                              \
+		return 0;                                                                                   \
+	}
+
+DEFINE_DECODE_FIXED_NULL0(decode_col_date, decode_date)
+DEFINE_DECODE_FIXED_NULL0(decode_col_time, decode_time)
+DEFINE_DECODE_FIXED_NULL0(decode_col_timestamp, decode_timestamp)
+DEFINE_DECODE_FIXED_NULL0(decode_col_interval, decode_interval)
+
+static int decode_col_decimal64(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	int idx = tgt->vidx[0];
+	char flag = *iter->flag[idx];
+
+	*pg_isnull = (flag & XRG_FLAG_NULL);
+	if (flag & XRG_FLAG_NULL) {
+		*pg_datum = 0;
+		return 0;
+	}
+
+	int64_t v = *((int64_t *)iter->value[idx]);
+	*pg_datum = NumericGetDatum(exx_decimal128_to_numeric(v, tgt->scale, tgt->pg_attr->atttypmod));
+	return 0;
+}
+
+static int decode_col_decimal128(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	int idx = tgt->vidx[0];
+	char flag = *iter->flag[idx];
+
+	*pg_isnull = (flag & XRG_FLAG_NULL);
+	if (flag & XRG_FLAG_NULL) {
+		*pg_datum = 0;
+		return 0;
+	}
+
+	__int128_t v = *((__int128_t *)iter->value[idx]);
+	*pg_datum = NumericGetDatum(exx_decimal128_to_numeric(v, tgt->scale, tgt->pg_attr->atttypmod));
+	return 0;
+}
+
+static int decode_col_bytea(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	int idx = tgt->vidx[0];
+	char *data = iter->value[idx];
+	char flag = *iter->flag[idx];
+
+	*pg_isnull = (flag & XRG_FLAG_NULL);
+	if (flag & XRG_FLAG_NULL) {
+		*pg_datum = 0;
+	} else {
+		int sz = xrg_bytea_len(data);
+		SET_VARSIZE(data, sz + VARHDRSZ);
+		*pg_datum = PointerGetDatum(data);
+	}
+	return 0;
+}
+
+/* other physical types of DECIMAL and STRING columns are not decoded */
+static int decode_col_none(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	*pg_isnull = (*iter->flag[tgt->vidx[0]] & XRG_FLAG_NULL);
+	return 0;
+}
+
+/**
+ * Resolve the kite result columns of the target once.  The column types
+ * are the same for every row of a result, so the checks are done here
+ * rather than on each row.
+ */
+static void bind_columns(struct kite_target_t *tgt, xrg_iter_t *iter, int ncol) {
+	Insist(tgt->attrs && (list_length(tgt->attrs) == ncol));
+
+	tgt->vidx[0] = linitial_int(tgt->attrs);
+	Insist(tgt->vidx[0] < iter->nvec);
+	if (ncol == 2) {
+		tgt->vidx[1] = lsecond_int(tgt->attrs);
+		Insist(tgt->vidx[1] < iter->nvec);
+	}
+}
+
 /* decode functions */
 
 /**
  * decode basic data type such as fixed point data type and string from XRG format to PG format
+ *
+ * This binds the target to a decoder for the type of its column and then
+ * decodes the row with it; later rows go to that decoder directly.
  */
 int decode_var(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
-	Insist(tgt->attrs && (list_length(tgt->attrs) == 1));
+	bind_columns(tgt, iter, 1);
 
-	int idx = linitial_int(tgt->attrs);
-	Insist(idx < iter->nvec);
-
-	char *data = iter->value[idx];
-	char flag = *iter->flag[idx];
+	int idx = tgt->vidx[0];
 	int ltyp = iter->attr[idx].ltyp;
 	int ptyp = iter->attr[idx].ptyp;
-	int precision = iter->attr[idx].precision;
-	int scale = iter->attr[idx].scale;
 
-	// data in iter->value[idx] and iter->flag[idx] and iter->attrs[idx].ptyp
-	*pg_isnull = (flag & XRG_FLAG_NULL);
+	tgt->scale = iter->attr[idx].scale;
 
 	switch (ltyp) {
 	case XRG_LTYP_NONE:
 		// primitive type. no decode here
 		switch (ptyp) {
-		case XRG_PTYP_INT8: {
-			*pg_datum = decode_char(data);
-		} break;
-		case XRG_PTYP_INT16: {
-			*pg_datum = decode_int16(data);
-		} break;
-		case XRG_PTYP_INT32: {
-			*pg_datum = decode_int32(data);
-		} break;
-		case XRG_PTYP_INT64: {
-			*pg_datum = decode_int64(data);
-		} break;
-		case XRG_PTYP_INT128: {
-			*pg_datum = decode_int128(data);
-		} break;
-		case XRG_PTYP_FP32: {
-			*pg_datum = decode_float(data);
-		} break;
-		case XRG_PTYP_FP64: {
-			*pg_datum = decode_double(data);
-		} break;
+		case XRG_PTYP_INT8:
+			tgt->decode = decode_col_char;
+			break;
+		case XRG_PTYP_INT16:
+			tgt->decode = decode_col_int16;
+			break;
+		case XRG_PTYP_INT32:
+			tgt->decode = decode_col_int32;
+			break;
+		case XRG_PTYP_INT64:
+			tgt->decode = decode_col_int64;
+			break;
+		case XRG_PTYP_INT128:
+			tgt->decode = decode_col_int128;
+			break;
+		case XRG_PTYP_FP32:
+			tgt->decode = decode_col_float;
+			break;
+		case XRG_PTYP_FP64:
+			tgt->decode = decode_col_double;
+			break;
 		default: {
 			elog(ERROR, "decode_var: invalid physcial type %d with NONE logical type", ptyp);
 			return -1;
 		}
 		}
-		return 0;
-	case XRG_LTYP_DATE: {
-		*pg_datum = (flag & XRG_FLAG_NULL) ? 0 : decode_date(data);
-	}
-		return 0;
-	case XRG_LTYP_TIME: {
-		*pg_datum = (flag & XRG_FLAG_NULL) ? 0 : decode_time(data);
-	}
-		return 0;
-	case XRG_LTYP_TIMESTAMP: {
-		*pg_datum = (flag & XRG_FLAG_NULL) ? 0 : decode_timestamp(data);
-	}
-		return 0;
-	case XRG_LTYP_INTERVAL: {
-		*pg_datum = (flag & XRG_FLAG_NULL) ? 0 : PointerGetDatum((__int128_t *)data);
-	}
-		return 0;
+		break;
+	case XRG_LTYP_DATE:
+		tgt->decode = decode_col_date;
+		break;
+	case XRG_LTYP_TIME:
+		tgt->decode = decode_col_time;
+		break;
+	case XRG_LTYP_TIMESTAMP:
+		tgt->decode = decode_col_timestamp;
+		break;
+	case XRG_LTYP_INTERVAL:
+		tgt->decode = decode_col_interval;
+		break;
 	case XRG_LTYP_DECIMAL:
+		if (ptyp == XRG_PTYP_INT64) {
+			tgt->decode = decode_col_decimal64;
+		} else if (ptyp == XRG_PTYP_INT128) {
+			tgt->decode = decode_col_decimal128;
+		} else {
+			tgt->decode = decode_col_none;
+		}
+		break;
 	case XRG_LTYP_STRING:
+		if (ptyp == XRG_PTYP_BYTEA) {
+			tgt->decode = decode_col_bytea;
+		} else {
+			tgt->decode = decode_col_none;
+		}
 		break;
 	default: {
 		elog(ERROR, "invalid xrg logical type %d", ltyp);
@@ -133,44 +241,7 @@ int decode_var(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, boo
 	}
 	}
 
-	if (ltyp == XRG_LTYP_DECIMAL && ptyp == XRG_PTYP_INT64) {
-		int64_t v = *((int64_t *)data);
-		char dst[MAX_DEC128_STRLEN];
-		decimal64_to_string(v, precision, scale, dst, sizeof(dst));
-		FmgrInfo flinfo;
-		memset(&flinfo, 0, sizeof(FmgrInfo));
-		flinfo.fn_addr = numeric_in;
-		flinfo.fn_nargs = 3;
-		flinfo.fn_strict = true;
-		*pg_datum = InputFunctionCall(&flinfo, dst, 0, tgt->pg_attr->atttypmod);
-		return 0;
-	}
-
-	if (ltyp == XRG_LTYP_DECIMAL && ptyp == XRG_PTYP_INT128) {
-		__int128_t v = *((__int128_t *)data);
-		char dst[MAX_DEC128_STRLEN];
-		decimal128_to_string(v, precision, scale, dst, sizeof(dst));
-		FmgrInfo flinfo;
-		memset(&flinfo, 0, sizeof(FmgrInfo));
-		flinfo.fn_addr = numeric_in;
-		flinfo.fn_nargs = 3;
-		flinfo.fn_strict = true;
-		*pg_datum = InputFunctionCall(&flinfo, dst, 0, tgt->pg_attr->atttypmod);
-		return 0;
-	}
-
-	if (ltyp == XRG_LTYP_STRING && ptyp == XRG_PTYP_BYTEA) {
-		int sz = xrg_bytea_len(data);
-		if (flag & XRG_FLAG_NULL) {
-			*pg_datum = 0;
-		} else {
-			SET_VARSIZE(data, sz + VARHDRSZ);
-			*pg_datum = PointerGetDatum(data);
-		}
-		return 0;
-	}
-
-	return 0;
+	return tgt->decode(tgt, iter, pg_datum, pg_isnull);
 }
 
 /**
@@ -178,88 +249,68 @@ int decode_var(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, boo
  * XRG will split AVG column into SUM and COUNT and finally convert to 
  * struct Int128AggState (See utils/adt/numeric.)
  */
-int decode_avg_int64(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
-	Insist(tgt->attrs && (list_length(tgt->attrs) == 2));
+static int decode_avg_int64_bound(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	ExxInt128AggState *p = (ExxInt128AggState *)tgt->data;
 
-	int idx0 = linitial_int(tgt->attrs);
-	int idx1 = lsecond_int(tgt->attrs);
-	Insist(idx0 < iter->nvec && idx1 < iter->nvec);
+	p->calcSumX2 = false;
+	p->N = *((int64_t *)iter->value[tgt->vidx[1]]);
+	p->sumX = *((int64_t *)iter->value[tgt->vidx[0]]);
+	p->sumX2 = 0;
 
-	char *data0 = iter->value[idx0];
-	//char flag0 = *iter->flag[idx0];
-	int ltyp0 = iter->attr[idx0].ltyp;
-	int ptyp0 = iter->attr[idx0].ptyp;
+	*pg_isnull = false;
+	*pg_datum = PointerGetDatum(p);
 
-	Insist(ltyp0 == XRG_LTYP_NONE && ptyp0 == XRG_PTYP_INT64);
+	return 0;
+}
 
-	char *data1 = iter->value[idx1];
-	//char flag1 = *iter->flag[idx1];
-	int ltyp1 = iter->attr[idx1].ltyp;
-	int ptyp1 = iter->attr[idx1].ptyp;
+int decode_avg_int64(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	bind_columns(tgt, iter, 2);
 
-	Insist(ltyp1 == XRG_LTYP_NONE && ptyp1 == XRG_PTYP_INT64);
+	int idx0 = tgt->vidx[0];
+	int idx1 = tgt->vidx[1];
+	Insist(iter->attr[idx0].ltyp == XRG_LTYP_NONE && iter->attr[idx0].ptyp == XRG_PTYP_INT64);
+	Insist(iter->attr[idx1].ltyp == XRG_LTYP_NONE && iter->attr[idx1].ptyp == XRG_PTYP_INT64);
 
 	if (!tgt->data) {
 		tgt->data = palloc(sizeof(ExxInt128AggState));
 	}
-	ExxInt128AggState *p = (ExxInt128AggState *)tgt->data;
 
-	int128 sum = *((int64_t *)data0);
-	int64 count = *((int64_t *)data1);
-	;
+	tgt->decode = decode_avg_int64_bound;
+	return tgt->decode(tgt, iter, pg_datum, pg_isnull);
+}
+
+/**
+ * decode AVG int128 column.
+ * XRG will split AVG column into SUM and COUNT and finally convert to 
+ * struct Int128AggState/ExxInt128AggState (See utils/adt/numeric.)
+ */
+static int decode_avg_int128_bound(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	ExxInt128AggState *p = (ExxInt128AggState *)tgt->data;
 
 	p->calcSumX2 = false;
-	p->N = count;
-	p->sumX = sum;
+	p->N = *((int64_t *)iter->value[tgt->vidx[1]]);
+	p->sumX = *((__int128_t *)iter->value[tgt->vidx[0]]);
 	p->sumX2 = 0;
 
 	*pg_isnull = false;
 	*pg_datum = PointerGetDatum(p);
-
 	return 0;
 }
 
-/**
- * decode AVG int128 column.
- * XRG will split AVG column into SUM and COUNT and finally convert to 
- * struct Int128AggState/ExxInt128AggState (See utils/adt/numeric.)
- */
 int decode_avg_int128(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
-	Insist(tgt->attrs && (list_length(tgt->attrs) == 2));
-
-	int idx0 = linitial_int(tgt->attrs);
-	int idx1 = lsecond_int(tgt->attrs);
-	Insist(idx0 < iter->nvec && idx1 < iter->nvec);
-
-	char *data0 = iter->value[idx0];
-	//char flag0 = *iter->flag[idx0];
-	int ltyp0 = iter->attr[idx0].ltyp;
-	int ptyp0 = iter->attr[idx0].ptyp;
-	Insist(ltyp0 == XRG_LTYP_NONE && ptyp0 == XRG_PTYP_INT128);
+	bind_columns(tgt, iter, 2);
 
-	char *data1 = iter->value[idx1];
-	//char flag1 = *iter->flag[idx1];
-	int ltyp1 = iter->attr[idx1].ltyp;
-	int ptyp1 = iter->attr[idx1].ptyp;
-	Insist(ltyp1 == XRG_LTYP_NONE && ptyp1 == XRG_PTYP_INT64);
+	int idx0 = tgt->vidx[0];
+	int idx1 = tgt->vidx[1];
+	Insist(iter->attr[idx0].ltyp == XRG_LTYP_NONE && iter->attr[idx0].ptyp == XRG_PTYP_INT128);
+	Insist(iter->attr[idx1].ltyp == XRG_LTYP_NONE && iter->attr[idx1].ptyp == XRG_PTYP_INT64);
 
 	if (!tgt->data) {
 		tgt->data = palloc(sizeof(ExxInt128AggState));
 	}
-	ExxInt128AggState *p = (ExxInt128AggState *)tgt->data;
-
-	int128 sum = *((__int128_t *)data0);
-	int64 count = *((int64_t *)data1);
-	;
-
-	p->calcSumX2 = false;
-	p->N = count;
-	p->sumX = sum;
-	p->sumX2 = 0;
 
-	*pg_isnull = false;
-	*pg_datum = PointerGetDatum(p);
-	return 0;
+	tgt->decode = decode_avg_int128_bound;
+	return tgt->decode(tgt, iter, pg_datum, pg_isnull);
 }
 
 /**
@@ -267,100 +318,79 @@ int decode_avg_int128(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_dat
  * XRG will split AVG column into SUM and COUNT and finally convert to PG internal transdata
  * struct ExxFloatAvgTransdata (See include/exx/exx_trans.h)
  */
-int decode_avg_double(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
-	Insist(tgt->attrs && (list_length(tgt->attrs) == 2));
+static int decode_avg_double_bound(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	ExxFloatAvgTransdata *p = (ExxFloatAvgTransdata *)tgt->data;
 
-	int idx0 = linitial_int(tgt->attrs);
-	int idx1 = lsecond_int(tgt->attrs);
-	Insist(idx0 < iter->nvec && idx1 < iter->nvec);
+	// the array header is set up by decode_avg_double
+	p->data[0] = *((int64_t *)iter->value[tgt->vidx[1]]);
+	p->data[1] = *((double *)iter->value[tgt->vidx[0]]);
+	p->data[2] = 0;
 
-	char *data0 = iter->value[idx0];
-	//char flag0 = *iter->flag[idx0];
-	int ltyp0 = iter->attr[idx0].ltyp;
-	int ptyp0 = iter->attr[idx0].ptyp;
-	Insist(ltyp0 == XRG_LTYP_NONE && ptyp0 == XRG_PTYP_FP64);
+	*pg_isnull = false;
+	*pg_datum = PointerGetDatum(p);
+	return 0;
+}
 
-	char *data1 = iter->value[idx1];
-	//char flag1 = *iter->flag[idx1];
-	int ltyp1 = iter->attr[idx1].ltyp;
-	int ptyp1 = iter->attr[idx1].ptyp;
-	Insist(ltyp1 == XRG_LTYP_NONE && ptyp1 == XRG_PTYP_INT64);
+int decode_avg_double(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	bind_columns(tgt, iter, 2);
+
+	int idx0 = tgt->vidx[0];
+	int idx1 = tgt->vidx[1];
+	Insist(iter->attr[idx0].ltyp == XRG_LTYP_NONE && iter->attr[idx0].ptyp == XRG_PTYP_FP64);
+	Insist(iter->attr[idx1].ltyp == XRG_LTYP_NONE && iter->attr[idx1].ptyp == XRG_PTYP_INT64);
 
 	if (!tgt->data) {
 		tgt->data = palloc(sizeof(ExxFloatAvgTransdata));
 	}
 	ExxFloatAvgTransdata *p = (ExxFloatAvgTransdata *)tgt->data;
 
-	double sum = *((double *)data0);
-	int64 count = *((int64_t *)data1);
-	;
-
 	SET_VARSIZE(p, sizeof(ExxFloatAvgTransdata));
 	p->arraytype.ndim = 1;
 	p->arraytype.dataoffset = (char *)p->data - (char *)p;
 	p->arraytype.elemtype = FLOAT8OID;
 	p->nelem = 3;
-	p->data[0] = count;
-	p->data[1] = sum;
-	p->data[2] = 0;
 
-	*pg_isnull = false;
-	*pg_datum = PointerGetDatum(p);
-	return 0;
+	tgt->decode = decode_avg_double_bound;
+	return tgt->decode(tgt, iter, pg_datum, pg_isnull);
 }
 
 /**
  * decode AVG numeric column.
  * XRG will split AVG column into SUM and COUNT and finally convert to PG internal transdata
  * struct NumericAggState/ExxNumericAggState (See utils/adt/numeric.c)
+ *
+ * The sum is built straight from the XRG decimal, without a round trip
+ * through its text form and numeric_in.
  */
-int decode_avg_numeric(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
-	Insist(tgt->attrs && (list_length(tgt->attrs) == 2));
-
-	int idx0 = linitial_int(tgt->attrs);
-	int idx1 = lsecond_int(tgt->attrs);
-	Insist(idx0 < iter->nvec && idx1 < iter->nvec);
-
-	char *data0 = iter->value[idx0];
-	//char flag0 = *iter->flag[idx0];
-	int ltyp0 = iter->attr[idx0].ltyp;
-	int ptyp0 = iter->attr[idx0].ptyp;
-	int precision0 = iter->attr[idx0].precision;
-	int scale0 = iter->attr[idx0].scale;
-	Insist(ltyp0 == XRG_LTYP_DECIMAL && ptyp0 == XRG_PTYP_INT128);
-
-	char *data1 = iter->value[idx1];
-	//char flag1 = *iter->flag[idx1];
-	int ltyp1 = iter->attr[idx1].ltyp;
-	int ptyp1 = iter->attr[idx1].ptyp;
-	Insist(ltyp1 == XRG_LTYP_NONE && ptyp1 == XRG_PTYP_INT64);
-
-	if (!tgt->data) {
-		tgt->data = palloc(sizeof(ExxNumericAggState));
-	}
+static int decode_avg_numeric_bound(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
 	ExxNumericAggState *p = (ExxNumericAggState *)tgt->data;
 
-	int128 i128 = *((__int128_t *)data0);
-	int64 count = *((int64_t *)data1);
-	;
+	__int128_t i128 = *((__int128_t *)iter->value[tgt->vidx[0]]);
+	int64 count = *((int64_t *)iter->value[tgt->vidx[1]]);
 
-	Datum sum;
-	char dst[MAX_DEC128_STRLEN];
-
-	decimal128_to_string(i128, precision0, scale0, dst, sizeof(dst));
-	FmgrInfo flinfo;
-	memset(&flinfo, 0, sizeof(FmgrInfo));
-	flinfo.fn_addr = numeric_in;
-	flinfo.fn_nargs = 3;
-	flinfo.fn_strict = true;
-	//elog(LOG, "avg_numeric: typmod = %d (can be -1)", tgt->pg_attr->atttypmod);
-
-	sum = InputFunctionCall(&flinfo, dst, 0, tgt->pg_attr->atttypmod);
-
-	p->sumX = DatumGetNumeric(sum);
+	p->sumX = exx_decimal128_to_numeric(i128, tgt->scale, tgt->pg_attr->atttypmod);
 	p->N = count;
 
 	*pg_isnull = false;
 	*pg_datum = PointerGetDatum(p);
 	return 0;
 }
+
+int decode_avg_numeric(struct kite_target_t *tgt, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull) {
+	bind_columns(tgt, iter, 2);
+
+	int idx0 = tgt->vidx[0];
+	int idx1 = tgt->vidx[1];
+	Insist(iter->attr[idx0].ltyp == XRG_LTYP_DECIMAL && iter->attr[idx0].ptyp == XRG_PTYP_INT128);
+	Insist(iter->attr[idx1].ltyp == XRG_LTYP_NONE && iter->attr[idx1].ptyp == XRG_PTYP_INT64);
+
+	tgt->scale = iter->attr[idx0].scale;
+	//elog(LOG, "avg_numeric: typmod = %d (can be -1)", tgt->pg_attr->atttypmod);
+
+	if (!tgt->data) {
+		tgt->data = palloc(sizeof(ExxNumericAggState));
+	}
+
+	tgt->decode = decode_avg_numeric_bound;
+	return tgt->decode(tgt, iter, pg_datum, pg_isnull);
+}
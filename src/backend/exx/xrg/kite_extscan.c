@@ -9,6 +9,7 @@
 #include "executor/nodeExternalscan.h"
 #include "utils/builtins.h"
 #include "utils/datetime.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/uri.h"
 #include "utils/memutils.h"
@@ -62,6 +63,17 @@ kite_extscan_t *kite_extscan_create(ExternalScanState *node) {
 	// setup targetlist
 	kite_extscan_setup_targetlist(scan);
 
+	// flatten the targetlist for kite_extscan_get_next
+	scan->m_ntarget = list_length(scan->m_targetlist);
+	scan->m_targets = palloc(sizeof(kite_target_t *) * (scan->m_ntarget + 1));
+	int i = 0;
+	ListCell *l;
+	foreach (l, scan->m_targetlist) {
+		kite_target_t *target = (kite_target_t *)lfirst(l);
+		target->bind = target->decode;
+		scan->m_targets[i++] = target;
+	}
+
 	// create handle
 	kite_extscan_exec(scan);
 
@@ -85,11 +97,20 @@ void kite_extscan_destroy(kite_extscan_t *scan) {
 		list_free(scan->m_targetlist);
 	}
 
+	if (scan->m_targets) {
+		pfree(scan->m_targets);
+	}
+
 	// m_xexpr
 	if (scan->m_xexpr) {
 		xex_release((xex_object_t *)scan->m_xexpr);
 	}
 
+	// m_topn
+	if (scan->m_topn) {
+		xex_release((xex_object_t *)scan->m_topn);
+	}
+
 	pfree(scan);
 }
 
@@ -236,7 +257,7 @@ static void setup_targetlist_from_project(kite_extscan_t *scan) {
 static void kite_extscan_setup_targetlist(kite_extscan_t *scan) {
 	ExternalScan *es = scan_plan(scan->m_node);
 
-	if (es->exx_bcsz > 0 && es->exx_bclv == BCLV_AGG) {
+	if (es->exx_bcsz > 0 && (es->exx_bclv == BCLV_AGG || es->exx_bclv == BCLV_TOPN)) {
 		//elog(LOG, es->exx_bc);
 
 		const char *endp;
@@ -247,11 +268,19 @@ static void kite_extscan_setup_targetlist(kite_extscan_t *scan) {
 			elog(ERROR, "xexpr error: %s. [linenum=%d, offset=%d]", err.errmsg, err.linenum, err.lineoff);
 		}
 
-		scan->m_xexpr = xex_to_list(obj);
-		if (!scan->m_xexpr) {
+		xex_list_t *list = xex_to_list(obj);
+		if (!list) {
 			elog(ERROR, "xexpr error: exx_bc is not a list");
 		}
 
+		if (es->exx_bclv == BCLV_TOPN) {
+			// top-N only changes the SQL, columns are the same as a plain scan
+			scan->m_topn = list;
+			setup_targetlist_from_project(scan);
+			return;
+		}
+
+		scan->m_xexpr = list;
 		setup_targetlist_from_xexpr(scan, scan->m_xexpr);
 
 	} else {
@@ -284,12 +313,19 @@ static void kite_extscan_exec(kite_extscan_t *ex) {
 		return;
 	}
 
-	urlf->hdl = kite_submit(addr, schema, sql, fragid, fragcnt, &fs, errmsg, errlen);
-	if (!urlf->hdl) {
-		elog(ERROR, "kite_submit failed");
-		return;
+	// Split the fragment of this segment into sub-fragments and submit
+	// them all, so that the Kite server works on them concurrently while
+	// this segment reads and decodes the first one.  Sub-fragment k of
+	// fragment f is fragment f * n + k of fragcnt * n.
+	int nsub = gp_kite_fetch_connections;
+	url_kite_alloc_handles(urlf, nsub);
+	for (int i = 0; i < nsub; i++) {
+		urlf->hdl[i] = kite_submit(addr, schema, sql, fragid * nsub + i, fragcnt * nsub, &fs, errmsg, errlen);
+		if (!urlf->hdl[i]) {
+			elog(ERROR, "kite_submit failed: %s", errmsg);
+			return;
+		}
 	}
-
 }
 
 /**
@@ -301,30 +337,49 @@ bool kite_extscan_get_next(kite_extscan_t *ex, int ncol, Datum *datums, bool *is
 	char errmsg[1024];
 	int errlen = sizeof(errmsg);
 
-	int e = kite_next_row(urlf->hdl, &iter, errmsg, errlen);
-	if (e == 0) {
-		if (iter == 0) {
+	if (urlf->curr == urlf->nhdl) {
+		return false;
+	}
+
+	for (;;) {
+		int e = kite_next_row(urlf->hdl[urlf->curr], &iter, errmsg, errlen);
+		if (e < 0) {
+			// error
+			elog(ERROR, "%s", errmsg);
+			return false;
+		}
+		if (iter) {
+			break;
+		}
+
+		// this sub-fragment is done; close its connection and go on to the next
+		kite_release(urlf->hdl[urlf->curr]);
+		urlf->hdl[urlf->curr] = 0;
+		if (++urlf->curr == urlf->nhdl) {
 			// no more pending data
 			return false;
 		}
-	} else if (e < 0) {
-		// error
-		elog(ERROR, "%s", errmsg);
-		return false;
+	}
+
+	// Targets bind to the column types of the first row they decode.  If
+	// the column layout changes, go back to the generic decoders so that
+	// they bind again.
+	if (iter->attr != ex->m_bound_attr) {
+		for (int i = 0; i < ex->m_ntarget; i++) {
+			ex->m_targets[i]->decode = ex->m_targets[i]->bind;
+		}
+		ex->m_bound_attr = iter->attr;
 	}
 
 	// decode with targetlist
-	int i = 0;
-	ListCell *l;
-	foreach (l, ex->m_targetlist) {
-		kite_target_t *target = (kite_target_t *)lfirst(l);
+	for (int i = 0; i < ex->m_ntarget; i++) {
+		kite_target_t *target = ex->m_targets[i];
 		if (target->decode) {
 			target->decode(target, iter, &datums[i], &isnulls[i]);
 		} else {
 			datums[i] = 0;
 			isnulls[i] = true;
 		}
-		i++;
 	}
 
 	return true;
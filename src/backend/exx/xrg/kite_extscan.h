@@ -61,6 +61,13 @@ typedef struct kite_target_t {
 	List *tuplist; // list of target expr in string
 	void *data;	// storage of the current decoded data
 	int (*decode)(struct kite_target_t *, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull);
+
+	// decode binding.  decode starts as one of the generic decode functions,
+	// which resolves the kite columns and their types on the first row and
+	// replaces itself with a type-specialized decoder (see decode.c).
+	int (*bind)(struct kite_target_t *, xrg_iter_t *iter, Datum *pg_datum, bool *pg_isnull);
+	int vidx[2]; // kite result columns of attrs
+	int scale;   // decimal scale of vidx[0]
 } kite_target_t;
 
 // start_idx is the column idx from kite and will be changed to next start idx for the next call
@@ -75,8 +82,14 @@ void traverse(xex_list_t *list, TupleDesc tupdesc, stringbuffer_t *strbuf);
 typedef struct kite_extscan_t {
 	ExternalScanState *m_node;
 	xex_list_t *m_xexpr;
+	xex_list_t *m_topn; // ORDER BY ... LIMIT pushed down by the planner. See aggref.i.c
 	List *m_targetlist; // mirror of the gpdb target list. List of kite_target_t
 	exx_required_t *m_req;
+
+	// m_targetlist as an array, for the per-row decode loop
+	kite_target_t **m_targets;
+	int m_ntarget;
+	const void *m_bound_attr; // iter->attr the targets are bound to
 } kite_extscan_t;
 
 // create extscan, create targetlist, create JSON request and connect socket
@@ -7,8 +7,10 @@
 #include "cdb/cdbtm.h"
 #include "executor/execdebug.h"
 #include "executor/nodeExternalscan.h"
+#include "nodes/makefuncs.h"
 #include "utils/builtins.h"
 #include "utils/datetime.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/uri.h"
 #include "utils/memutils.h"
@@ -31,6 +33,8 @@ static char *setup_qual(kite_extscan_t *ex);
 
 static void traverse_qual(kite_extscan_t *ex, ExprState *exprstate, stringbuffer_t *strbuf);
 
+static void setup_topn(kite_extscan_t *ex, stringbuffer_t *strbuf);
+
 /**
  * Generate schema JSON
  */
@@ -157,6 +161,9 @@ static char *generate_sql(kite_extscan_t *ex, xex_list_t *xexpr, List *targetlis
 		}
 	}
 
+	// order by ... limit
+	setup_topn(ex, sbuf);
+
 	char *ret = stringbuffer_to_string(sbuf);
 	stringbuffer_release(sbuf);
 	return ret;
@@ -228,11 +235,126 @@ static char *setup_qual(kite_extscan_t *ex) {
 	return ret;
 }
 
+/**
+ * Generate ORDER BY ... LIMIT.  exx_bc = [ [ [attno, desc, nullsfirst], ... ], count ]
+ * Kite returns the top-N rows of the fragment and the Sort and Limit above the scan merge them.
+ */
+static void setup_topn(kite_extscan_t *ex, stringbuffer_t *strbuf) {
+	xex_list_t *topn = ex->m_topn;
+	if (!topn) {
+		return;
+	}
+
+	Insist(xex_list_length(topn) == 2);
+	xex_object_t *obj = xex_list_get(topn, 0);
+	Insist(obj);
+	xex_list_t *keys = xex_to_list(obj);
+	Insist(keys);
+
+	stringbuffer_append_string(strbuf, " ORDER BY ");
+	for (int i = 0; i < xex_list_length(keys); i++) {
+		int32_t attno, desc, nullsfirst;
+		obj = xex_list_get(keys, i);
+		Insist(obj);
+		xex_list_t *key = xex_to_list(obj);
+		Insist(key);
+		Insist(xex_list_get_int32(key, 0, &attno) == 0);
+		Insist(xex_list_get_int32(key, 1, &desc) == 0);
+		Insist(xex_list_get_int32(key, 2, &nullsfirst) == 0);
+
+		if (i > 0) {
+			stringbuffer_append(strbuf, ',');
+		}
+		stringbuffer_append_string(strbuf, colname(ex->m_node, attno));
+		stringbuffer_append_string(strbuf, desc ? " DESC" : " ASC");
+		stringbuffer_append_string(strbuf, nullsfirst ? " NULLS FIRST" : " NULLS LAST");
+	}
+
+	int64_t count;
+	Insist(xex_list_get_int64(topn, 1, &count) == 0);
+	stringbuffer_append_string(strbuf, " LIMIT ");
+	stringbuffer_append_long_long(strbuf, count);
+}
+
+/*
+ * Evaluate a Param to a Const.  Initplan results come to the segment with the plan, and a rescan
+ * sends the kite query again, so this is the value for the current scan.
+ */
+static Const *eval_param(kite_extscan_t *ex, Param *param) {
+	ExprContext *econtext = ex->m_node->ss.ps.ps_ExprContext;
+	ExprState *state = ExecInitExpr((Expr *)param, (PlanState *)ex->m_node);
+	int16 typlen;
+	bool typbyval;
+	bool isnull;
+
+	get_typlenbyval(param->paramtype, &typlen, &typbyval);
+	Datum value = ExecEvalExpr(state, econtext, &isnull, NULL);
+	if (!isnull) {
+		value = datumCopy(value, typbyval, typlen);
+	}
+
+	return makeConst(param->paramtype, param->paramtypmod, param->paramcollid, typlen, value, isnull, typbyval);
+}
+
+static void traverse_qual_expr(kite_extscan_t *ex, Expr *expr, stringbuffer_t *strbuf);
+
+/*
+ * IN list of an array Const.  NULL elements are sent as NULL so that IN and NOT IN keep their
+ * meaning for arrays built by a subquery.
+ */
+static void traverse_array_const(kite_extscan_t *ex, Const *c, stringbuffer_t *strbuf) {
+	if (c->constisnull) {
+		stringbuffer_append_string(strbuf, "(NULL)");
+		return;
+	}
+
+	ArrayType *arr = DatumGetArrayTypeP(c->constvalue);
+	if (!ARR_HASNULL(arr)) {
+		traverse_qual_expr(ex, (Expr *)c, strbuf);
+		return;
+	}
+
+	Oid elemtype = ARR_ELEMTYPE(arr);
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+	Datum *elems;
+	bool *nulls;
+	int nelem, nvalid = 0;
+
+	get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+	deconstruct_array(arr, elemtype, typlen, typbyval, typalign, &elems, &nulls, &nelem);
+	for (int i = 0; i < nelem; i++) {
+		if (!nulls[i]) {
+			elems[nvalid++] = elems[i];
+		}
+	}
+
+	if (nvalid == 0) {
+		stringbuffer_append_string(strbuf, "(NULL)");
+		return;
+	}
+
+	ArrayType *valid = construct_array(elems, nvalid, elemtype, typlen, typbyval, typalign);
+	Const *vc = makeConst(c->consttype, c->consttypmod, c->constcollid, c->constlen, PointerGetDatum(valid), false, false);
+	const char *constvalue = op_arraytype_to_string(vc);
+
+	// (v1,...,vn) => (v1,...,vn,NULL)
+	stringbuffer_append_string_with_options(strbuf, constvalue, 0, strlen(constvalue) - 1);
+	stringbuffer_append_string(strbuf, ",NULL)");
+	pfree((void *)constvalue);
+}
+
 /* traverse the Qual Expression */
 static void traverse_qual_expr(kite_extscan_t *ex, Expr *expr, stringbuffer_t *strbuf) {
 
 	if (IsA(expr, Const)) {
 		Const *c = (Const *)expr;
+		if (c->constisnull) {
+			stringbuffer_append_string(strbuf, "NULL");
+			return;
+		}
+
 		int16_t ptyp, ltyp, precision, scale;
 		bool is_array = false;
 		ptyp = ltyp = precision = scale = 0;
@@ -313,6 +435,9 @@ static void traverse_qual_expr(kite_extscan_t *ex, Expr *expr, stringbuffer_t *s
 		Var *var = (Var *)expr;
 		stringbuffer_append_string(strbuf, colname(ex->m_node, var->varattno));
 		return;
+	} else if (IsA(expr, Param)) {
+		traverse_qual_expr(ex, (Expr *)eval_param(ex, (Param *)expr), strbuf);
+		return;
 	} else if (IsA(expr, RelabelType)) {
 		RelabelType *r = (RelabelType *)expr;
 		traverse_qual_expr(ex, r->arg, strbuf);
@@ -421,22 +546,59 @@ static void traverse_qual_expr(kite_extscan_t *ex, Expr *expr, stringbuffer_t *s
 		Expr *left = (Expr *)linitial(sp->args);
 		Expr *right = (Expr *)lsecond(sp->args);
 
-		traverse_qual_expr(ex, left, strbuf);
-
 		int32_t op = pg_proc_to_op(sp->opfuncid);
+		const char *opstr = 0;
 		switch (op) {
 		case XRG_OP_EQ:
-			stringbuffer_append_string(strbuf, " IN ");
+			opstr = " IN ";
 			break;
 		case XRG_OP_NE:
-			stringbuffer_append_string(strbuf, " NOT IN ");
+			opstr = " NOT IN ";
 			break;
 		default:
 			elog(ERROR, "ScalarArrayOpExpr: Invalid operation. (op = %d, funcid = %d)", sp->opno, sp->opfuncid);
 			break;
 		}
 
-		traverse_qual_expr(ex, right, strbuf);
+		// semi-join keys, e.g. col = ANY(ARRAY(SELECT key FROM dim)), go to kite as an IN list
+		if (IsA(right, Param)) {
+			right = (Expr *)eval_param(ex, (Param *)right);
+		}
+
+		int nelem = -1;
+		if (IsA(right, Const) && !((Const *)right)->constisnull) {
+			ArrayType *arr = DatumGetArrayTypeP(((Const *)right)->constvalue);
+			nelem = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+		} else if (IsA(right, ArrayExpr)) {
+			nelem = list_length(((ArrayExpr *)right)->elements);
+		}
+
+		// IN () is not valid.  col = ANY('{}') is false and col <> ALL('{}') is true
+		if (nelem == 0) {
+			stringbuffer_append_string(strbuf, op == XRG_OP_EQ ? "1 = 0" : "1 = 1");
+			return;
+		}
+
+		traverse_qual_expr(ex, left, strbuf);
+		stringbuffer_append_string(strbuf, opstr);
+
+		if (IsA(right, Const)) {
+			traverse_array_const(ex, (Const *)right, strbuf);
+		} else if (IsA(right, ArrayExpr)) {
+			ListCell *l;
+			int i = 0;
+			stringbuffer_append(strbuf, '(');
+			foreach (l, ((ArrayExpr *)right)->elements) {
+				if (i > 0) {
+					stringbuffer_append(strbuf, ',');
+				}
+				traverse_qual_expr(ex, (Expr *)lfirst(l), strbuf);
+				i++;
+			}
+			stringbuffer_append(strbuf, ')');
+		} else {
+			traverse_qual_expr(ex, right, strbuf);
+		}
 		return;
 	} else if (IsA(expr, NullTest)) {
 		NullTest *ntest = (NullTest *)expr;
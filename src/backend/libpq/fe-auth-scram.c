@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-auth-scram.c
\ No newline at end of file
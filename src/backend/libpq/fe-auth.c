@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-auth.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-connect.c
\ No newline at end of file
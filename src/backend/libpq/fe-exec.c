@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-exec.c
\ No newline at end of file
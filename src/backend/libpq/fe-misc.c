@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-misc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-protocol2.c
\ No newline at end of file
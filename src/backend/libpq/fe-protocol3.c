@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-protocol3.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/interfaces/libpq/fe-secure.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/port/getpeereid.c
\ No newline at end of file
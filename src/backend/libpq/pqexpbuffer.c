@@ -0,0 +1 @@
+../../../src/interfaces/libpq/pqexpbuffer.c
\ No newline at end of file
@@ -30,6 +30,10 @@
 #include "postgres.h"
 
 #include <limits.h>
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define USE_SSE2_TBM_WORDS
+#endif
 
 #include "access/htup.h"
 #include "access/htup_details.h"
@@ -423,8 +427,7 @@ tbm_union_page(TIDBitmap *a, const PagetableEntry *bpage)
 		else
 		{
 			/* Both pages are exact, merge at the bit level */
-			for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
-				apage->words[wordnum] |= bpage->words[wordnum];
+			tbm_union_words(apage->words, bpage->words, WORDS_PER_PAGE);
 			apage->recheck |= bpage->recheck;
 		}
 	}
@@ -557,12 +560,8 @@ tbm_intersect_page(TIDBitmap *a, PagetableEntry *apage, const TIDBitmap *b)
 		{
 			/* Both pages are exact, merge at the bit level */
 			Assert(!bpage->ischunk);
-			for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
-			{
-				apage->words[wordnum] &= bpage->words[wordnum];
-				if (apage->words[wordnum] != 0)
-					candelete = false;
-			}
+			if (tbm_intersect_words(apage->words, bpage->words, WORDS_PER_PAGE))
+				candelete = false;
 			apage->recheck |= bpage->recheck;
 		}
 		/* If there is no matching b page, we can just delete the a page */
@@ -570,6 +569,75 @@ tbm_intersect_page(TIDBitmap *a, PagetableEntry *apage, const TIDBitmap *b)
 	}
 }
 
+/*
+ * tbm_union_words - OR 'nwords' bitmap words of src into dst
+ *
+ * This is the inner loop of every union of exact pages, so it works on as
+ * many words at a time as the platform allows.
+ */
+void
+tbm_union_words(tbm_bitmapword *dst, const tbm_bitmapword *src, int nwords)
+{
+	int			i = 0;
+
+#ifdef USE_SSE2_TBM_WORDS
+	for (; i + 4 <= nwords; i += 4)
+	{
+		__m128i		a0 = _mm_loadu_si128((const __m128i *) &dst[i]);
+		__m128i		a1 = _mm_loadu_si128((const __m128i *) &dst[i + 2]);
+		__m128i		b0 = _mm_loadu_si128((const __m128i *) &src[i]);
+		__m128i		b1 = _mm_loadu_si128((const __m128i *) &src[i + 2]);
+
+		_mm_storeu_si128((__m128i *) &dst[i], _mm_or_si128(a0, b0));
+		_mm_storeu_si128((__m128i *) &dst[i + 2], _mm_or_si128(a1, b1));
+	}
+#endif
+
+	for (; i < nwords; i++)
+		dst[i] |= src[i];
+}
+
+/*
+ * tbm_intersect_words - AND 'nwords' bitmap words of src into dst
+ *
+ * Returns true if any bit is still set in dst afterwards.
+ */
+bool
+tbm_intersect_words(tbm_bitmapword *dst, const tbm_bitmapword *src, int nwords)
+{
+	tbm_bitmapword any = 0;
+	int			i = 0;
+
+#ifdef USE_SSE2_TBM_WORDS
+	if (nwords >= 4)
+	{
+		__m128i		acc = _mm_setzero_si128();
+
+		for (; i + 4 <= nwords; i += 4)
+		{
+			__m128i		r0 = _mm_and_si128(_mm_loadu_si128((const __m128i *) &dst[i]),
+										   _mm_loadu_si128((const __m128i *) &src[i]));
+			__m128i		r1 = _mm_and_si128(_mm_loadu_si128((const __m128i *) &dst[i + 2]),
+										   _mm_loadu_si128((const __m128i *) &src[i + 2]));
+
+			_mm_storeu_si128((__m128i *) &dst[i], r0);
+			_mm_storeu_si128((__m128i *) &dst[i + 2], r1);
+			acc = _mm_or_si128(acc, _mm_or_si128(r0, r1));
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF)
+			any = 1;
+	}
+#endif
+
+	for (; i < nwords; i++)
+	{
+		dst[i] &= src[i];
+		any |= dst[i];
+	}
+
+	return (any != 0);
+}
+
 /*
  * tbm_is_empty - is a TIDBitmap completely empty?
  */
@@ -1541,10 +1609,7 @@ opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 	 */
 	ListCell   *map;
 	BlockNumber minblockno;
-	ListCell   *cell;
-	int			wordnum;
-	List	   *matches;
-	bool		empty;
+	bool		nonempty;
 
 	Assert(n->type == BMS_OR || n->type == BMS_AND);
 
@@ -1565,20 +1630,22 @@ opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 	 * for block 10 for one of the streams: the intersection with fail.
 	 * So, we set the desired block (op->nextblock) to block 15 and loop
 	 * around to the `restart' label.
+	 *
+	 * Each input pulls into the page entry embedded in its own iterator,
+	 * which is otherwise unused below the top of the stream tree. That
+	 * saves allocating and freeing a page for every input and block.
 	 */
 restart:
 	e->blockno = InvalidBlockNumber;
-	empty = false;
-	matches = NIL;
 	minblockno = InvalidBlockNumber;
 	Assert(PointerIsValid(iterator->input.stream));
 	foreach(map, iterator->input.stream)
 	{
 		StreamBMIterator *inIter = lfirst(map);
-		PagetableEntry *new;
+		PagetableEntry *new = &inIter->entry;
 		bool		r;
 
-		new = (PagetableEntry *) palloc0(sizeof(PagetableEntry));
+		MemSet(new, 0, sizeof(PagetableEntry));
 
 		/* set the desired block */
 		inIter->nextblock = iterator->nextblock;
@@ -1600,11 +1667,10 @@ restart:
 				minblockno = Min(minblockno, new->blockno);
 			else
 				minblockno = Max(minblockno, new->blockno);
-			matches = lappend(matches, (void *) new);
 		}
 		else
 		{
-			pfree(new);
+			new->blockno = InvalidBlockNumber;
 
 			if (n->type == BMS_AND)
 			{
@@ -1616,8 +1682,6 @@ restart:
 				iterator->nextblock = minblockno + 1;	/* seems safe */
 				return false;
 			}
-			else if (n->type == BMS_OR)
-				continue;
 		}
 	}
 
@@ -1625,9 +1689,11 @@ restart:
 	 * Now we iterate through the actual matches and perform the desired
 	 * operation on those from the same minimum block
 	 */
-	foreach(cell, matches)
+	nonempty = true;
+	foreach(map, iterator->input.stream)
 	{
-		PagetableEntry *tmp = (PagetableEntry *) lfirst(cell);
+		StreamBMIterator *inIter = lfirst(map);
+		PagetableEntry *tmp = &inIter->entry;
 
 		if (tmp->blockno == minblockno)
 		{
@@ -1646,18 +1712,15 @@ restart:
 				e->ischunk = true;
 				/* XXX: we can just return now... I think :) */
 				iterator->nextblock = minblockno + 1;
-				list_free_deep(matches);
 				return res;
 			}
 
 			/* union/intersect existing output and new matches */
-			for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
-			{
-				if (n->type == BMS_OR)
-					e->words[wordnum] |= tmp->words[wordnum];
-				else
-					e->words[wordnum] &= tmp->words[wordnum];
-			}
+			if (n->type == BMS_OR)
+				tbm_union_words(e->words, tmp->words, WORDS_PER_PAGE);
+			else
+				nonempty = tbm_intersect_words(e->words, tmp->words,
+											   WORDS_PER_PAGE);
 			e->recheck |= tmp->recheck;
 		}
 		else if (n->type == BMS_AND)
@@ -1672,20 +1735,22 @@ restart:
 			 */
 
 			iterator->nextblock = minblockno;
-			empty = true;
-			break;
+			MemSet(e->words, 0, sizeof(tbm_bitmapword) * WORDS_PER_PAGE);
+			goto restart;
 		}
 	}
-	if (empty)
+
+	/*
+	 * All the inputs had matches on this block, but none in common. Don't
+	 * hand an empty page to the caller, who would go and read it; move on
+	 * to the next block instead.
+	 */
+	if (!nonempty && !e->ischunk)
 	{
-		/* start again */
-		empty = false;
-		MemSet(e->words, 0, sizeof(tbm_bitmapword) * WORDS_PER_PAGE);
-		list_free_deep(matches);
+		iterator->nextblock = minblockno + 1;
 		goto restart;
 	}
-	else
-		list_free_deep(matches);
+
 	if (res)
 		iterator->nextblock = minblockno + 1;
 
@@ -2004,6 +2004,15 @@ ProcessOrClauseForPossibleValues( PredIterInfoData *clauseInfo, Node *clause, No
 			AddUnmatchingValues( &result, &childPossible );
 			DeletePossibleValueSetData( &childPossible);
 		}
+
+		/* too many values to be useful, so stop expanding the OR */
+		if ( result.set != NULL &&
+			 hash_get_num_entries(result.set) > MAX_POSSIBLE_VALUE_SET_SIZE )
+		{
+			DeletePossibleValueSetData( &result );
+			result.isAnyValuePossible = true;
+			break;
+		}
 	}
 	iterate_end(*clauseInfo);
 
@@ -2045,6 +2054,53 @@ DeterminePossibleValueSet(Node *clause, Node *variable, Oid opfamily)
 			{
 				return result;
 			}
+
+			/*
+			 * predicate_classify() gives up on IN-lists longer than
+			 * MAX_SAOP_ARRAY_SIZE, to bound the cost of its proofs.  Here
+			 * each element costs only a hash table entry, so expand long
+			 * constant IN-lists as well.
+			 */
+			if (IsA(clause, ScalarArrayOpExpr) &&
+				((ScalarArrayOpExpr *) clause)->useOr)
+			{
+				Node	   *arraynode = (Node *) lsecond(((ScalarArrayOpExpr *) clause)->args);
+
+				if (arraynode && IsA(arraynode, Const) &&
+					!((Const *) arraynode)->constisnull)
+				{
+					ArrayType  *arrayval = DatumGetArrayTypeP(((Const *) arraynode)->constvalue);
+
+					/* don't bother deconstructing a list we'd give up on */
+					if (ArrayGetNItems(ARR_NDIM(arrayval), ARR_DIMS(arrayval)) >
+						MAX_POSSIBLE_VALUE_SET_SIZE)
+					{
+						InitPossibleValueSetData(&result);
+						return result;
+					}
+
+					clauseInfo.startup_fn = arrayconst_startup_fn;
+					clauseInfo.next_fn = arrayconst_next_fn;
+					clauseInfo.cleanup_fn = arrayconst_cleanup_fn;
+					return ProcessOrClauseForPossibleValues(&clauseInfo, clause, variable, opfamily);
+				}
+				else if (arraynode && IsA(arraynode, ArrayExpr) &&
+						 !((ArrayExpr *) arraynode)->multidims)
+				{
+					if (list_length(((ArrayExpr *) arraynode)->elements) >
+						MAX_POSSIBLE_VALUE_SET_SIZE)
+					{
+						InitPossibleValueSetData(&result);
+						return result;
+					}
+
+					clauseInfo.startup_fn = arrayexpr_startup_fn;
+					clauseInfo.next_fn = arrayexpr_next_fn;
+					clauseInfo.cleanup_fn = arrayexpr_cleanup_fn;
+					return ProcessOrClauseForPossibleValues(&clauseInfo, clause, variable, opfamily);
+				}
+			}
+
 			/* can't infer anything, so return that any value is possible */
 			InitPossibleValueSetData(&result);
 			return result;
@@ -0,0 +1 @@
+../../../src/backend/port/dynloader/linux.c
\ No newline at end of file
@@ -0,0 +1,611 @@
+/*-------------------------------------------------------------------------
+ *
+ * aocompactor.c
+ *	  Background compaction of append-optimized tables.
+ *
+ * Rows deleted or updated in an append-optimized table are only hidden in
+ * its visibility map; the space is given back when VACUUM compacts the
+ * segment files whose ratio of hidden tuples is above
+ * gp_appendonly_compaction_threshold.  With gp_appendonly_compaction_worker
+ * on, the master runs that compaction in the background:
+ *
+ * The launcher is an auxiliary process of the master.  Every
+ * gp_appendonly_compaction_worker_naptime seconds it visits the databases
+ * that accept connections, one at a time, by starting a worker connected to
+ * the database and waiting for it to exit.
+ *
+ * The worker only considers the tables written to since its last complete
+ * pass over the database.  Every INSERT, UPDATE and DELETE of an
+ * append-optimized table updates the table's segment file entries in the
+ * master's pg_aoseg or pg_aocsseg table, so a table none of whose entries
+ * has an xmin at or after the horizon of the last pass has no new hidden
+ * tuples, and is skipped without asking the segments.  The launcher keeps
+ * the horizon of each database, and hands it to the worker in shared
+ * memory.
+ *
+ * For the remaining tables, the worker asks the segments for the hidden and
+ * total tuple counts of their segment files, and runs a lazy VACUUM on each
+ * table that has a segment file above the threshold, most hidden tuples
+ * first.  VACUUM compacts such a table one segment file per transaction, so
+ * a worker never holds more than one segment file's worth of work in a
+ * transaction, and concurrent inserts keep using the table's other segment
+ * files.  The worker sets vacuum_cost_delay for itself from
+ * gp_appendonly_compaction_worker_cost_delay; the segments throttle their
+ * part of the work with their own vacuum_cost_delay.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/postmaster/aocompactor.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <unistd.h>
+
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/pg_database.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbvars.h"
+#include "commands/vacuum.h"
+#include "executor/spi.h"
+#include "miscadmin.h"
+#include "postmaster/aocompactor.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/postmaster.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "tcop/tcopprot.h"
+#include "utils/array.h"
+#include "utils/faultinjector.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/snapmgr.h"
+
+/* GUCs */
+bool		gp_appendonly_compaction_worker = false;
+int			gp_appendonly_compaction_worker_naptime = 60;
+int			gp_appendonly_compaction_worker_cost_delay = 20;
+
+/*
+ * The append-optimized tables that hold data of their own: no partitioned
+ * parents, and no temporary tables, which the segments could not read for
+ * another session.
+ */
+#define AOCOMPACTOR_TABLES_SQL \
+	"SELECT a.relid, a.segrelid FROM pg_catalog.pg_appendonly a" \
+	" JOIN pg_catalog.pg_class c ON c.oid = a.relid" \
+	" WHERE c.relkind = 'r' AND c.relpersistence <> 't'" \
+	" AND NOT EXISTS (SELECT 1 FROM pg_catalog.pg_inherits i WHERE i.inhparent = a.relid)"
+
+/*
+ * Of the tables in $1, those with a segment file, on any segment, whose
+ * percentage of hidden tuples is above $2; the same test as
+ * AppendOnlyCompaction_ShouldCompact().
+ */
+#define AOCOMPACTOR_CANDIDATES_SQL \
+	"SELECT relid FROM" \
+	" (SELECT relid, gp_toolkit.__gp_aovisimap_hidden_typed(relid) AS h" \
+	"  FROM gp_dist_random('gp_id'), pg_catalog.unnest($1) AS relid) s" \
+	" WHERE (h).hidden * 100.0 > (h).total * $2" \
+	" GROUP BY relid ORDER BY sum((h).hidden) DESC"
+
+/*
+ * Shared by the launcher and the worker it waits for; there is never more
+ * than one worker at a time.
+ */
+typedef struct AOCompactorShmemStruct
+{
+	/* set by the launcher: horizon of the database's last complete pass */
+	TransactionId horizon;
+	/* set by the worker once it has completed its pass */
+	TransactionId next_horizon;
+} AOCompactorShmemStruct;
+
+static AOCompactorShmemStruct *AOCompactorShmem;
+
+/* The launcher's horizon for each database */
+typedef struct AOCompactorDatabase
+{
+	Oid			dboid;			/* hash key */
+	TransactionId horizon;
+} AOCompactorDatabase;
+
+static HTAB *database_horizons = NULL;
+
+static volatile sig_atomic_t got_SIGHUP = false;
+
+static void AOCompactorLauncherLoop(void);
+static List *get_database_oids(void);
+static void run_worker(Oid dboid);
+static List *get_compaction_candidates(TransactionId horizon,
+						  TransactionId *next_horizon);
+static bool aoseg_changed_since(Oid segrelid, TransactionId horizon);
+static bool compact_relation(Oid relid);
+
+Size
+AOCompactorShmemSize(void)
+{
+	return sizeof(AOCompactorShmemStruct);
+}
+
+void
+AOCompactorShmemInit(void)
+{
+	bool		found;
+
+	AOCompactorShmem = (AOCompactorShmemStruct *)
+		ShmemInitStruct("AO Compactor Data", AOCompactorShmemSize(), &found);
+
+	if (!found)
+	{
+		AOCompactorShmem->horizon = InvalidTransactionId;
+		AOCompactorShmem->next_horizon = InvalidTransactionId;
+	}
+}
+
+/* SIGHUP: set flag to reload config file */
+static void
+sigHupHandler(SIGNAL_ARGS)
+{
+	got_SIGHUP = true;
+
+	if (MyProc)
+		SetLatch(&MyProc->procLatch);
+}
+
+bool
+AOCompactorLauncherStartRule(Datum main_arg)
+{
+	/* the segment files are compacted at the direction of the master */
+	if (IsUnderMasterDispatchMode() &&
+		gp_appendonly_compaction_worker)
+		return true;
+
+	return false;
+}
+
+/*
+ * AOCompactorLauncherMain
+ */
+void
+AOCompactorLauncherMain(Datum main_arg)
+{
+	pqsignal(SIGHUP, sigHupHandler);
+
+	/* We're now ready to receive signals */
+	BackgroundWorkerUnblockSignals();
+
+	/* Connect to our database, to read pg_database */
+	BackgroundWorkerInitializeConnection(DB_FOR_COMMON_ACCESS, NULL);
+
+	AOCompactorLauncherLoop();
+
+	proc_exit(0);
+}
+
+static void
+AOCompactorLauncherLoop(void)
+{
+	MemoryContext launcherContext;
+
+	launcherContext = AllocSetContextCreate(TopMemoryContext,
+											"AOCompactorLauncher",
+											ALLOCSET_DEFAULT_MINSIZE,
+											ALLOCSET_DEFAULT_INITSIZE,
+											ALLOCSET_DEFAULT_MAXSIZE);
+
+	while (true)
+	{
+		int			rc;
+
+		if (got_SIGHUP)
+		{
+			int			old_threshold = gp_appendonly_compaction_threshold;
+
+			got_SIGHUP = false;
+			ProcessConfigFile(PGC_SIGHUP);
+
+			/* tables skipped under the old threshold may qualify now */
+			if (gp_appendonly_compaction_threshold != old_threshold &&
+				database_horizons != NULL)
+			{
+				hash_destroy(database_horizons);
+				database_horizons = NULL;
+			}
+		}
+
+		/*
+		 * VACUUM would not compact anything with compaction disabled or a
+		 * threshold of 0, so don't bother the databases.
+		 */
+		if (gp_appendonly_compaction && gp_appendonly_compaction_threshold > 0)
+		{
+			MemoryContext oldcontext;
+			List	   *dboids;
+			ListCell   *lc;
+
+			oldcontext = MemoryContextSwitchTo(launcherContext);
+			dboids = get_database_oids();
+			MemoryContextSwitchTo(oldcontext);
+
+			foreach(lc, dboids)
+				run_worker(lfirst_oid(lc));
+
+			MemoryContextReset(launcherContext);
+
+			SIMPLE_FAULT_INJECTOR("ao_compaction_round_done");
+		}
+
+		rc = WaitLatch(&MyProc->procLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+					   gp_appendonly_compaction_worker_naptime * 1000L);
+
+		ResetLatch(&MyProc->procLatch);
+
+		/* emergency bailout if postmaster has died */
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+	}
+}
+
+/*
+ * Returns the OIDs of the databases that accept connections, allocated in
+ * the caller's memory context.
+ */
+static List *
+get_database_oids(void)
+{
+	List	   *dboids = NIL;
+	Relation	rel;
+	HeapScanDesc scan;
+	HeapTuple	tup;
+	MemoryContext resultcxt = CurrentMemoryContext;
+
+	StartTransactionCommand();
+	(void) GetTransactionSnapshot();
+
+	rel = heap_open(DatabaseRelationId, AccessShareLock);
+	scan = heap_beginscan_catalog(rel, 0, NULL);
+
+	while (HeapTupleIsValid(tup = heap_getnext(scan, ForwardScanDirection)))
+	{
+		Form_pg_database pgdatabase = (Form_pg_database) GETSTRUCT(tup);
+		MemoryContext oldcxt;
+
+		if (!pgdatabase->datallowconn)
+			continue;
+
+		oldcxt = MemoryContextSwitchTo(resultcxt);
+		dboids = lappend_oid(dboids, HeapTupleGetOid(tup));
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	heap_endscan(scan);
+	heap_close(rel, AccessShareLock);
+
+	CommitTransactionCommand();
+
+	return dboids;
+}
+
+/*
+ * Start a worker on the given database and wait for it to exit.
+ */
+static void
+run_worker(Oid dboid)
+{
+	BackgroundWorker worker;
+	BackgroundWorkerHandle *handle;
+	AOCompactorDatabase *db;
+	bool		found;
+
+	if (database_horizons == NULL)
+	{
+		HASHCTL		ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(Oid);
+		ctl.entrysize = sizeof(AOCompactorDatabase);
+		ctl.hash = oid_hash;
+		database_horizons = hash_create("AO compaction horizons", 16, &ctl,
+										HASH_ELEM | HASH_FUNCTION);
+	}
+
+	db = (AOCompactorDatabase *) hash_search(database_horizons, &dboid,
+											 HASH_ENTER, &found);
+	if (!found)
+		db->horizon = InvalidTransactionId;
+
+	AOCompactorShmem->horizon = db->horizon;
+	AOCompactorShmem->next_horizon = InvalidTransactionId;
+
+	MemSet(&worker, 0, sizeof(worker));
+	snprintf(worker.bgw_name, BGW_MAXLEN, "ao compaction worker");
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+	worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	worker.bgw_main = AOCompactorWorkerMain;
+	worker.bgw_main_arg = ObjectIdGetDatum(dboid);
+	worker.bgw_notify_pid = MyProcPid;
+
+	if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+	{
+		/* all worker slots are in use; try again at the next round */
+		ereport(LOG,
+				(errmsg("could not start append-only compaction worker for database %u", dboid),
+				 errhint("You might need to increase max_worker_processes.")));
+		return;
+	}
+
+	/* the postmaster signals us when the worker has started and exited */
+	while (true)
+	{
+		pid_t		pid;
+		int			rc;
+
+		if (GetBackgroundWorkerPid(handle, &pid) == BGWH_STOPPED)
+			break;
+
+		rc = WaitLatch(&MyProc->procLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+					   1000L);
+
+		ResetLatch(&MyProc->procLatch);
+
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+	}
+
+	pfree(handle);
+
+	/* if the worker didn't complete its pass, look at the same tables again */
+	if (TransactionIdIsValid(AOCompactorShmem->next_horizon))
+		db->horizon = AOCompactorShmem->next_horizon;
+}
+
+/*
+ * AOCompactorWorkerMain
+ *
+ * Compacts the append-optimized tables of one database, and exits.
+ */
+void
+AOCompactorWorkerMain(Datum main_arg)
+{
+	Oid			dboid = DatumGetObjectId(main_arg);
+	TransactionId horizon = AOCompactorShmem->horizon;
+	TransactionId next_horizon;
+	bool		complete = true;
+	MemoryContext workerContext;
+	List	   *relids;
+	ListCell   *lc;
+
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnectionByOid(dboid, NULL);
+
+	/* disable orca here */
+	optimizer = false;
+
+	/*
+	 * This only throttles the worker itself; vacuum_cost_delay is not
+	 * dispatched, so the segments keep their own setting.
+	 */
+	if (gp_appendonly_compaction_worker_cost_delay >= 0)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", gp_appendonly_compaction_worker_cost_delay);
+		SetConfigOption("vacuum_cost_delay", buf, PGC_SUSET, PGC_S_OVERRIDE);
+	}
+
+	workerContext = AllocSetContextCreate(TopMemoryContext,
+										  "AOCompactorWorker",
+										  ALLOCSET_DEFAULT_MINSIZE,
+										  ALLOCSET_DEFAULT_INITSIZE,
+										  ALLOCSET_DEFAULT_MAXSIZE);
+
+	/* VACUUM keeps its cross-transaction state under PortalContext */
+	PortalContext = AllocSetContextCreate(workerContext,
+										  "AOCompactorWorker Portal",
+										  ALLOCSET_DEFAULT_MINSIZE,
+										  ALLOCSET_DEFAULT_INITSIZE,
+										  ALLOCSET_DEFAULT_MAXSIZE);
+
+	MemoryContextSwitchTo(workerContext);
+	relids = get_compaction_candidates(horizon, &next_horizon);
+
+	foreach(lc, relids)
+	{
+		if (!compact_relation(lfirst_oid(lc)))
+			complete = false;
+		MemoryContextResetAndDeleteChildren(PortalContext);
+	}
+
+	if (complete)
+		AOCompactorShmem->next_horizon = next_horizon;
+
+	proc_exit(0);
+}
+
+/*
+ * Returns the OIDs of the tables that have a segment file to compact,
+ * allocated in the caller's memory context.  Only tables written to at or
+ * after horizon are looked at, or all of them if it is invalid.  The horizon
+ * for the next pass is returned in *next_horizon.
+ */
+static List *
+get_compaction_candidates(TransactionId horizon, TransactionId *next_horizon)
+{
+	List	   *relids = NIL;
+	Oid		   *oids;
+	int			noids;
+	Snapshot	snapshot;
+	int			ret;
+	int			i;
+	Oid			argtypes[2] = {OIDARRAYOID, INT4OID};
+	Datum		args[2];
+	MemoryContext resultcxt = CurrentMemoryContext;
+	MemoryContext oldcxt;
+
+	StartTransactionCommand();
+	snapshot = GetTransactionSnapshot();
+	PushActiveSnapshot(snapshot);
+
+	/*
+	 * Every transaction before our xmin is visible to us, so the next pass
+	 * needs to look only at the ones from there on.
+	 */
+	*next_horizon = snapshot->xmin;
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "SPI_connect failed");
+
+	ret = SPI_execute(AOCOMPACTOR_TABLES_SQL, true, 0);
+	if (ret != SPI_OK_SELECT)
+		elog(ERROR, "could not list append-only tables: %s", SPI_result_code_string(ret));
+
+	noids = 0;
+	oids = (Oid *) palloc(Max(SPI_processed, 1) * sizeof(Oid));
+	for (i = 0; i < SPI_processed; i++)
+	{
+		bool		isnull;
+		Oid			relid;
+		Oid			segrelid;
+
+		relid = DatumGetObjectId(SPI_getbinval(SPI_tuptable->vals[i],
+											   SPI_tuptable->tupdesc,
+											   1, &isnull));
+		segrelid = DatumGetObjectId(SPI_getbinval(SPI_tuptable->vals[i],
+												  SPI_tuptable->tupdesc,
+												  2, &isnull));
+
+		if (TransactionIdIsValid(horizon) &&
+			!aoseg_changed_since(segrelid, horizon))
+			continue;
+
+		oids[noids++] = relid;
+	}
+
+	if (noids > 0)
+	{
+		args[0] = PointerGetDatum(construct_array((Datum *) oids, noids, OIDOID,
+												  sizeof(Oid), true, 'i'));
+		args[1] = Int32GetDatum(gp_appendonly_compaction_threshold);
+
+		ret = SPI_execute_with_args(AOCOMPACTOR_CANDIDATES_SQL, 2, argtypes,
+									args, NULL, true, 0);
+		if (ret != SPI_OK_SELECT)
+			elog(ERROR, "could not read hidden tuple counts: %s", SPI_result_code_string(ret));
+
+		oldcxt = MemoryContextSwitchTo(resultcxt);
+		for (i = 0; i < SPI_processed; i++)
+		{
+			bool		isnull;
+
+			relids = lappend_oid(relids,
+								 DatumGetObjectId(SPI_getbinval(SPI_tuptable->vals[i],
+																SPI_tuptable->tupdesc,
+																1, &isnull)));
+		}
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	SPI_finish();
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+
+	return relids;
+}
+
+/*
+ * Has the pg_aoseg or pg_aocsseg table segrelid been written to by a
+ * transaction at or after horizon?
+ */
+static bool
+aoseg_changed_since(Oid segrelid, TransactionId horizon)
+{
+	Relation	rel;
+	HeapScanDesc scan;
+	HeapTuple	tup;
+	bool		changed = false;
+
+	/* the table may have been dropped since we listed it */
+	rel = try_relation_open(segrelid, AccessShareLock, false);
+	if (rel == NULL)
+		return false;
+
+	scan = heap_beginscan(rel, GetActiveSnapshot(), 0, NULL);
+	while (HeapTupleIsValid(tup = heap_getnext(scan, ForwardScanDirection)))
+	{
+		TransactionId xmin = HeapTupleHeaderGetXmin(tup->t_data);
+
+		if (TransactionIdIsNormal(xmin) &&
+			TransactionIdFollowsOrEquals(xmin, horizon))
+		{
+			changed = true;
+			break;
+		}
+	}
+	heap_endscan(scan);
+	heap_close(rel, AccessShareLock);
+
+	return changed;
+}
+
+/*
+ * Run a lazy VACUUM on one table.  An error, such as the table having been
+ * dropped meanwhile, is reported and the worker moves on to the next table.
+ * Returns false after an error.
+ */
+static bool
+compact_relation(Oid relid)
+{
+	VacuumStmt	vacstmt;
+	bool		ok = true;
+
+	MemSet(&vacstmt, 0, sizeof(vacstmt));
+
+	/*
+	 * We pass the OID; vacuumStatement_Relation() fills in the name that is
+	 * dispatched, once it has the table locked.
+	 */
+	vacstmt.type = T_VacuumStmt;
+	vacstmt.options = VACOPT_VACUUM;
+	vacstmt.freeze_min_age = -1;
+	vacstmt.freeze_table_age = -1;
+	vacstmt.multixact_freeze_min_age = -1;
+	vacstmt.multixact_freeze_table_age = -1;
+	vacstmt.relation = NULL;
+	vacstmt.va_cols = NIL;
+	vacstmt.auto_stats = false;
+
+	StartTransactionCommand();
+
+	PG_TRY();
+	{
+		vacuum(&vacstmt, relid, false, NULL, false, true);
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		HOLD_INTERRUPTS();
+		errcontext("background compaction of relation with OID %u", relid);
+		EmitErrorReport();
+
+		AbortOutOfAnyTransaction();
+		FlushErrorState();
+		RESUME_INTERRUPTS();
+
+		ok = false;
+	}
+	PG_END_TRY();
+
+	return ok;
+}
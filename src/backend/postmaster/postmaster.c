@@ -112,6 +112,7 @@
 #include "miscadmin.h"
 #include "pg_getopt.h"
 #include "pgstat.h"
+#include "postmaster/aocompactor.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/bgwriter.h"
@@ -421,6 +422,13 @@ static BackgroundWorker PMAuxProcList[MaxPMAuxProc] =
 	 PerfmonMain, {0}, {0}, 0, 0,
 	 PerfmonStartRule},
 
+	{"ao compaction launcher process",
+	 BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION,
+	 BgWorkerStart_RecoveryFinished,
+	 0, /* restart immediately if the launcher exits with non-zero code */
+	 AOCompactorLauncherMain, {0}, {0}, 0, 0,
+	 AOCompactorLauncherStartRule},
+
 #ifdef ENABLE_IC_PROXY
 	{"ic proxy process",
 #ifdef FAULT_INJECTOR
@@ -6012,6 +6020,28 @@ BackgroundWorkerInitializeConnection(char *dbname, char *username)
 	SetProcessingMode(NormalProcessing);
 }
 
+/*
+ * Connect background worker to a database using OIDs.
+ */
+void
+BackgroundWorkerInitializeConnectionByOid(Oid dboid, char *username)
+{
+	BackgroundWorker *worker = MyBgworkerEntry;
+
+	if (!(worker->bgw_flags & BGWORKER_BACKEND_DATABASE_CONNECTION))
+		ereport(FATAL,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("database connection requirement not indicated during registration")));
+
+	InitPostgres(NULL, dboid, username, NULL);
+
+	/* it had better not gotten out of "init" mode yet */
+	if (!IsInitProcessingMode())
+		ereport(ERROR,
+				(errmsg("invalid processing mode in background worker")));
+	SetProcessingMode(NormalProcessing);
+}
+
 /*
  * Block/unblock signals in a background worker
  */
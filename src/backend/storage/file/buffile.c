@@ -54,6 +54,14 @@
  * - We support compressing the files, with some limitations. See
  *   BufFilePledgeSequential().
  *
+ * - With gp_workfile_async_io, a full buffer is written out by a helper
+ *   thread (see FileWriteAsync()) while the caller fills a second buffer,
+ *   and when a file is read block after block, the next block is read ahead
+ *   into the second buffer.  Reads and writes of whole blocks are copied
+ *   through the buffers then, instead of bypassing them.  At most one such request is in flight per file,
+ *   and everything else waits for it first, so the file is always read and
+ *   written in the same order as without it.
+ *
  *-------------------------------------------------------------------------
  */
 
@@ -103,6 +111,18 @@ struct BufFile
 
 	char        *buffer;        /* GPDB: PG upstream uses PGAlignedBlock */
 
+	/*
+	 * Asynchronous I/O, with gp_workfile_async_io. 'asyncBuffer' is the
+	 * second buffer, allocated on first use; while 'asyncPending', it is
+	 * being written out or read into by 'asyncIO'.  'loadEnd' is the end of
+	 * the last block loaded into 'buffer', to tell when the file is read
+	 * sequentially.
+	 */
+	char	   *asyncBuffer;
+	FileAsyncIO asyncIO;
+	bool		asyncPending;
+	int64		loadEnd;
+
 	/*
 	 * Current stage, if this is a sequential BufFile. A sequential BufFile
 	 * can be written to once, and read once after that. Without compression,
@@ -144,10 +164,14 @@ static bool force_default_tablespace = false;
 
 static BufFile *makeBufFile(File firstfile);
 static void BufFileUpdateSize(BufFile *buffile);
+static int	BufFileWaitAsync(BufFile *file);
+static void BufFileDumpBufferAsync(BufFile *file);
+static void BufFileLoadBlock(BufFile *file);
 
 static void BufFileStartCompression(BufFile *file);
 static void BufFileDumpCompressedBuffer(BufFile *file, const void *buffer, Size nbytes);
 static void BufFileEndCompression(BufFile *file);
+static void BufFileRestartDecompression(BufFile *file);
 static int BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize);
 
 
@@ -354,11 +378,17 @@ BufFileClose(BufFile *file)
 		BufFileFlush(file);
 	}
 
+	/* temp files aren't flushed; a failed write to one doesn't matter */
+	if (file->asyncPending)
+		(void) FileWaitAsync(&file->asyncIO);
+
 	FileClose(file->file);
 
 	/* release the buffer space */
 	if (file->buffer)
 		pfree(file->buffer);
+	if (file->asyncBuffer)
+		pfree(file->asyncBuffer);
 
 	/* release zstd handles */
 #ifdef HAVE_LIBZSTD
@@ -392,6 +422,9 @@ BufFileLoadBuffer(BufFile *file, void* buffer, size_t bufsize)
 {
 	int			nb;
 
+	/* finish, or forget, the write or read-ahead in flight */
+	BufFileWaitAsync(file);
+
 	/*
 	 * May need to reposition physical file.
 	 */
@@ -430,6 +463,9 @@ BufFileDumpBuffer(BufFile *file, const void* buffer, Size nbytes)
 	size_t bytestowrite;
 	int wrote = 0;
 
+	/* writes must not overtake the one in flight */
+	BufFileWaitAsync(file);
+
 	/*
 	 * Unlike BufFileLoadBuffer, we must dump the whole buffer.
 	 */
@@ -459,6 +495,119 @@ BufFileDumpBuffer(BufFile *file, const void* buffer, Size nbytes)
 	file->nbytes = 0;
 }
 
+/*
+ * BufFileWaitAsync
+ *
+ * Wait for the write or read-ahead in flight, if any.  A failed write throws
+ * an error.  Returns the number of bytes read or written, or -1 if a read
+ * failed.
+ */
+static int
+BufFileWaitAsync(BufFile *file)
+{
+	int			nb;
+
+	if (!file->asyncPending)
+		return 0;
+
+	file->asyncPending = false;
+	nb = FileWaitAsync(&file->asyncIO);
+	if (file->asyncIO.isWrite && nb != file->asyncIO.amount)
+		elog(ERROR, "could not write %d bytes to temporary file: %m",
+			 file->asyncIO.amount);
+
+	return nb;
+}
+
+/*
+ * BufFileDumpBufferAsync
+ *
+ * Like BufFileDumpBuffer(file, file->buffer, file->nbytes), but the buffer is
+ * written out in the background, and the caller goes on with the second
+ * buffer.
+ */
+static void
+BufFileDumpBufferAsync(BufFile *file)
+{
+	char	   *buffer;
+
+	/* the second buffer may still be in use */
+	BufFileWaitAsync(file);
+
+	if (file->asyncBuffer == NULL)
+		file->asyncBuffer = MemoryContextAlloc(GetMemoryChunkContext(file->buffer),
+											   BLCKSZ);
+
+	if (FileWriteAsync(file->file, &file->asyncIO, file->buffer,
+					   file->nbytes, file->offset) < 0)
+		elog(ERROR, "could not write %d bytes to temporary file: %m", file->nbytes);
+	file->asyncPending = true;
+
+	buffer = file->buffer;
+	file->buffer = file->asyncBuffer;
+	file->asyncBuffer = buffer;
+
+	pgBufferUsage.temp_blks_written++;
+
+	file->offset += file->nbytes;
+	file->dirty = false;
+	file->pos = 0;
+	file->nbytes = 0;
+}
+
+/*
+ * BufFileLoadBlock
+ *
+ * Load the block at file->offset into the buffer, like
+ * BufFileLoadBuffer(file, file->buffer, BLCKSZ), taking it from the
+ * read-ahead buffer if it has been read ahead.  If the file is being read
+ * sequentially, start reading the next block ahead.
+ * At call, must have dirty = false, pos and nbytes = 0.
+ */
+static void
+BufFileLoadBlock(BufFile *file)
+{
+	bool		sequential = (file->offset == file->loadEnd);
+
+	if (file->asyncPending && !file->asyncIO.isWrite &&
+		file->asyncIO.offset == file->offset)
+	{
+		char	   *buffer;
+		int			nb;
+
+		nb = BufFileWaitAsync(file);
+		if (nb < 0)
+			elog(ERROR, "could not read from temporary file: %m");
+
+		buffer = file->buffer;
+		file->buffer = file->asyncBuffer;
+		file->asyncBuffer = buffer;
+		file->nbytes = nb;
+	}
+	else
+		file->nbytes = BufFileLoadBuffer(file, file->buffer, BLCKSZ);
+
+	file->loadEnd = file->offset + file->nbytes;
+
+	if (gp_workfile_async_io && sequential && file->nbytes == BLCKSZ &&
+		file->loadEnd < file->maxoffset)
+	{
+		Assert(!file->asyncPending);
+
+		if (file->asyncBuffer == NULL)
+			file->asyncBuffer = MemoryContextAlloc(GetMemoryChunkContext(file->buffer),
+												   BLCKSZ);
+
+		/* If it can't be started, the block is simply read when needed */
+		if (FileReadAsync(file->file, &file->asyncIO, file->asyncBuffer,
+						  BLCKSZ, file->loadEnd) == 0)
+		{
+			file->asyncPending = true;
+			pgBufferUsage.temp_blks_read++;
+		}
+	}
+}
+
 /*
  * BufFileRead
  *
@@ -499,9 +648,11 @@ BufFileRead(BufFile *file, void *ptr, size_t size)
 			file->nbytes = 0;
 
 			/*
-			 * Read full blocks directly into caller's buffer.
+			 * Read full blocks directly into caller's buffer.  Not with
+			 * gp_workfile_async_io, though: then the blocks go through our
+			 * buffer, so that the next one is read ahead.
 			 */
-			while (size >= BLCKSZ)
+			while (size >= BLCKSZ && !gp_workfile_async_io)
 			{
 				size_t nwant;
 
@@ -520,7 +671,7 @@ BufFileRead(BufFile *file, void *ptr, size_t size)
 			}
 
 			/* Try to load more data into buffer. */
-			file->nbytes = BufFileLoadBuffer(file, file->buffer, BLCKSZ);
+			BufFileLoadBlock(file);
 			if (file->nbytes == 0)
 			{
 				break; /* no more data available */
@@ -587,6 +738,46 @@ BufFileReadFromBuffer(BufFile *file, size_t size)
 	return result;
 }
 
+/*
+ * BufFileReadAt
+ *
+ * Read 'size' bytes starting at 'offset' directly into the caller's buffer,
+ * without going through the BufFile's own buffer. This is for callers that
+ * read short records at scattered offsets, where loading a full BLCKSZ
+ * buffer for each of them would read much more than needed. Afterwards the
+ * file is positioned just past the data read.
+ *
+ * Returns the number of bytes read, which is less than 'size' at EOF.
+ */
+Size
+BufFileReadAt(BufFile *file, off_t offset, void *ptr, Size size)
+{
+	Size		nread = 0;
+
+	if (file->state != BFS_RANDOM_ACCESS)
+		elog(ERROR, "cannot read at an offset in sequential BufFile");
+
+	if (file->dirty)
+		BufFileFlush(file);
+
+	file->offset = offset;
+	file->pos = 0;
+	file->nbytes = 0;
+
+	while (nread < size)
+	{
+		int			nb;
+
+		nb = BufFileLoadBuffer(file, (char *) ptr + nread, size - nread);
+		if (nb == 0)
+			break;
+		file->offset += nb;
+		nread += nb;
+	}
+
+	return nread;
+}
+
 /*
  * BufFileWrite
  *
@@ -625,7 +816,10 @@ BufFileWrite(BufFile *file, const void *ptr, size_t size)
 			if (file->dirty)
 			{
 				/* This can throw an exception, but it correctly updates the size when that happens */
-				BufFileDumpBuffer(file, file->buffer, file->nbytes);
+				if (gp_workfile_async_io)
+					BufFileDumpBufferAsync(file);
+				else
+					BufFileDumpBuffer(file, file->buffer, file->nbytes);
 			}
 			else
 			{
@@ -637,9 +831,11 @@ BufFileWrite(BufFile *file, const void *ptr, size_t size)
 		}
 
 		/*
-		 * Write full blocks directly from caller's buffer.
+		 * Write full blocks directly from caller's buffer.  Not with
+		 * gp_workfile_async_io, though: then the blocks go through our
+		 * buffer, so that they are written out in the background.
 		 */
-		if (size >= BLCKSZ && file->pos == 0)
+		if (size >= BLCKSZ && file->pos == 0 && !gp_workfile_async_io)
 		{
 			nthistime = size - size % BLCKSZ;
 
@@ -718,6 +914,10 @@ BufFileFlush(BufFile *file)
 		file->offset -= (nbytes - pos);
 		BufFileUpdateSize(file);
 	}
+
+	/* make sure the data is written, and report if it couldn't be */
+	if (file->asyncPending && file->asyncIO.isWrite)
+		BufFileWaitAsync(file);
 }
 
 /*
@@ -761,6 +961,12 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 			return 0;
 
 		case BFS_COMPRESSED_READING:
+			/* We have been reading. Rewinding starts over from the beginning */
+			if (fileno != 0 || offset != 0 || whence != SEEK_SET)
+				elog(ERROR, "cannot seek in sequential BufFile");
+			BufFileRestartDecompression(file);
+			return 0;
+
 		case BFS_SEQUENTIAL_READING:
 			elog(ERROR, "cannot seek in sequential BufFile");
 	}
@@ -920,9 +1126,15 @@ BufFileSuspend(BufFile *buffile)
 	}
 
 	BufFileFlush(buffile);
+	BufFileWaitAsync(buffile);
 	pfree(buffile->buffer);
 	buffile->buffer = NULL;
 	buffile->nbytes = 0;
+	if (buffile->asyncBuffer)
+	{
+		pfree(buffile->asyncBuffer);
+		buffile->asyncBuffer = NULL;
+	}
 }
 
 void
@@ -956,6 +1168,7 @@ BufFileResume(BufFile *buffile)
  */
 
 bool gp_workfile_compression;		/* GUC */
+bool gp_workfile_async_io;			/* GUC */
 
 /*
  * BufFilePledgeSequential
@@ -1139,6 +1352,28 @@ BufFileEndCompression(BufFile *file)
 		elog(ERROR, "could not seek in temporary file: %m");
 }
 
+/*
+ * Rewind a compressed BufFile that is being read, to read it again.
+ */
+static void
+BufFileRestartDecompression(BufFile *file)
+{
+	size_t		ret;
+
+	Assert(file->state == BFS_COMPRESSED_READING);
+
+	ret = ZSTD_initDStream(file->zstd_context->dctx);
+	if (ZSTD_isError(ret))
+		elog(ERROR, "failed to initialize zstd dstream: %s", ZSTD_getErrorName(ret));
+
+	file->compressed_buffer.size = 0;
+	file->compressed_buffer.pos = 0;
+	file->decompression_finished = false;
+
+	if (FileSeek(file->file, 0, SEEK_SET) != 0)
+		elog(ERROR, "could not seek in temporary file: %m");
+}
+
 static int
 BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize)
 {
@@ -1223,6 +1458,11 @@ BufFileEndCompression(BufFile *file)
 {
 	elog(ERROR, "zstandard compression not supported by this build");
 }
+static void
+BufFileRestartDecompression(BufFile *file)
+{
+	elog(ERROR, "zstandard compression not supported by this build");
+}
 static int
 BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize)
 {
@@ -65,6 +65,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
 #ifdef HAVE_SYS_RESOURCE_H
 #include <sys/resource.h>		/* for getrlimit */
 #endif
@@ -192,6 +195,7 @@ typedef struct vfd
 	/* NB: fileName is malloc'd, and must be free'd when closing the VFD */
 	int			fileFlags;		/* open(2) flags for (re)opening the file */
 	int			fileMode;		/* mode to pass to open(2) */
+	FileAsyncIO *asyncIO;		/* async requests in flight on the file */
 } Vfd;
 
 /*
@@ -301,6 +305,8 @@ static int	nextTempTableSpace = 0;
  */
 static void Delete(File file);
 static void LruDelete(File file);
+static void FileWaitAllAsync(File file);
+static void FileReserveSpace(File file, off_t newPos);
 static void Insert(File file);
 static int	LruInsert(File file);
 static bool ReleaseLruFile(void);
@@ -863,6 +869,9 @@ LruDelete(File file)
 
 	vfdP = &VfdCache[file];
 
+	/* the helper thread may be using the kernel fd */
+	FileWaitAllAsync(file);
+
 	/*
 	 * Normally we should know the seek position, but if for some reason we
 	 * have lost track of it, try again to get it.  If we still can't get it,
@@ -1202,6 +1211,7 @@ PathNameOpenFile(FileName fileName, int fileFlags, int fileMode)
 	vfdP->fileSize = 0;
 	vfdP->fdstate = 0x0;
 	vfdP->resowner = NULL;
+	vfdP->asyncIO = NULL;
 
 	return file;
 }
@@ -1553,6 +1563,8 @@ FileClose(File file)
 
 	vfdP = &VfdCache[file];
 
+	FileWaitAllAsync(file);
+
 	if (!FileIsNotOpen(file))
 	{
 		/* close the file */
@@ -1736,6 +1748,46 @@ retry:
 	return returnCode;
 }
 
+/*
+ * Check, before writing, that a temporary file may grow to 'newPos'.
+ *
+ * If enforcing temp_file_limit and it's a temp file, check to see if the
+ * write would overrun temp_file_limit, and throw error if so.  Note: it's
+ * really a modularity violation to throw error here; we should set errno
+ * and return -1.  However, there's no way to report a suitable error
+ * message if we do that.  All current callers would just throw error
+ * immediately anyway, so this is safe at present.
+ *
+ * Also update the stats in workfile manager. This might also
+ * throw an error, if we're over the limits.
+ *
+ * Because we update the stats in workfile manager first, if the write
+ * fails, the workfile manager's status will be out of sync with reality.
+ * That's OK, the inaccuracy doens't accumulate, and it doesn't need to be
+ * totallyaccurate.
+ */
+static void
+FileReserveSpace(File file, off_t newPos)
+{
+	Vfd		   *vfdP = &VfdCache[file];
+
+	if (temp_file_limit >= 0 && (vfdP->fdstate & FD_TEMPORARY) &&
+		newPos > vfdP->fileSize)
+	{
+		uint64		newTotal = temporary_files_size;
+
+		newTotal += newPos - vfdP->fileSize;
+		if (newTotal > (uint64) temp_file_limit * (uint64) 1024)
+			ereport(ERROR,
+					(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
+			 errmsg("temporary file size exceeds temp_file_limit (%dkB)",
+					temp_file_limit)));
+	}
+
+	if ((vfdP->fdstate & FD_WORKFILE) != 0 && newPos > vfdP->fileSize)
+		UpdateWorkFileSize(file, newPos);
+}
+
 int
 FileWrite(File file, char *buffer, int amount)
 {
@@ -1756,59 +1808,19 @@ FileWrite(File file, char *buffer, int amount)
 	vfdP = &VfdCache[file];
 
 	/*
-	 * If enforcing temp_file_limit and it's a temp file, check to see if the
-	 * write would overrun temp_file_limit, and throw error if so.  Note: it's
-	 * really a modularity violation to throw error here; we should set errno
-	 * and return -1.  However, there's no way to report a suitable error
-	 * message if we do that.  All current callers would just throw error
-	 * immediately anyway, so this is safe at present.
+	 * Normally we should know the seek position, but if for some reason we
+	 * have lost track of it, try again to get it.  Here, it's fine to throw
+	 * an error if we still can't get it.
 	 */
-	if (temp_file_limit >= 0 && (vfdP->fdstate & FD_TEMPORARY))
+	if (temp_file_limit >= 0 && (vfdP->fdstate & FD_TEMPORARY) &&
+		FilePosIsUnknown(vfdP->seekPos))
 	{
-		off_t		newPos;
-
-		/*
-		 * Normally we should know the seek position, but if for some reason
-		 * we have lost track of it, try again to get it.  Here, it's fine to
-		 * throw an error if we still can't get it.
-		 */
+		vfdP->seekPos = lseek(vfdP->fd, (off_t) 0, SEEK_CUR);
 		if (FilePosIsUnknown(vfdP->seekPos))
-		{
-			vfdP->seekPos = lseek(vfdP->fd, (off_t) 0, SEEK_CUR);
-			if (FilePosIsUnknown(vfdP->seekPos))
-				elog(ERROR, "could not seek file \"%s\": %m", vfdP->fileName);
-		}
-
-		newPos = vfdP->seekPos + amount;
-		if (newPos > vfdP->fileSize)
-		{
-			uint64		newTotal = temporary_files_size;
-
-			newTotal += newPos - vfdP->fileSize;
-			if (newTotal > (uint64) temp_file_limit * (uint64) 1024)
-				ereport(ERROR,
-						(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
-				 errmsg("temporary file size exceeds temp_file_limit (%dkB)",
-						temp_file_limit)));
-		}
+			elog(ERROR, "could not seek file \"%s\": %m", vfdP->fileName);
 	}
 
-	/*
-	 * Also update the stats in workfile manager. This might also
-	 * throw an error, if we're over the limits.
-	 *
-	 * Because we update the stats in workfile manager first, if the write
-	 * fails, the workfile manager's status will be out of sync with reality.
-	 * That's OK, the inaccuracy doens't accumulate, and it doesn't need to be
-	 * totallyaccurate.
-	 */
-	if ((VfdCache[file].fdstate & FD_WORKFILE) != 0)
-	{
-		off_t		newPos = VfdCache[file].seekPos + amount;
-
-		if (newPos > VfdCache[file].fileSize)
-			UpdateWorkFileSize(file, newPos);
-	}
+	FileReserveSpace(file, vfdP->seekPos + amount);
 
 retry:
 	errno = 0;
@@ -1872,6 +1884,316 @@ retry:
 	return returnCode;
 }
 
+/*
+ * Asynchronous reads and writes
+ *
+ * FileReadAsync() and FileWriteAsync() hand a read or write at a given
+ * offset to a helper thread and return, and FileWaitAsync() waits for it
+ * to finish.  This lets a caller such as buffile.c fill one buffer while the
+ * previous one is being written out, or work on one block while the next is
+ * being read.
+ *
+ * The helper thread only calls pread() or pwrite() on the kernel fd it is
+ * given, and touches nothing else; the VFD cache, the temp_file_limit and
+ * workfile manager accounting all stay in the backend.  Accounting is done
+ * when a write is submitted, as if it had succeeded, so limits are enforced
+ * and reported in the backend just like for FileWrite().
+ *
+ * While a request is in flight it is linked to its VFD, and anything that
+ * would close the kernel fd -- LruDelete(), FileClose() or FileTruncate() --
+ * waits for it first.  The requests keep their result, so that the owner
+ * still gets it from FileWaitAsync() afterwards.
+ */
+static struct
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t queuedCond;	/* signalled when a request is queued */
+	pthread_cond_t doneCond;	/* signalled when a request is done */
+
+	FileAsyncIO *head;			/* queue of requests to run */
+	FileAsyncIO *tail;
+	int			nqueued;		/* queued or running */
+
+	bool		started;		/* has the thread been started? */
+	bool		failed;			/* could it not be started? */
+	pthread_t	thread;
+} asyncIOPool = {
+	PTHREAD_MUTEX_INITIALIZER,
+	PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER
+};
+
+/*
+ * Run one request.  Called on the helper thread, or in the backend if the
+ * thread could not be started.
+ */
+static void
+FileRunAsync(FileAsyncIO *io)
+{
+	int			done = 0;
+	int			rc = 0;
+
+	errno = 0;
+	while (done < io->amount)
+	{
+		if (io->isWrite)
+			rc = pwrite(io->fd, io->buffer + done, io->amount - done,
+						io->offset + done);
+		else
+			rc = pread(io->fd, io->buffer + done, io->amount - done,
+					   io->offset + done);
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (rc == 0)
+			break;
+		done += rc;
+	}
+
+	if (rc < 0)
+	{
+		io->result = -1;
+		io->error = errno;
+	}
+	else
+	{
+		io->result = done;
+		/* if write didn't set errno, assume problem is no disk space */
+		io->error = (io->isWrite && done != io->amount) ? ENOSPC : 0;
+	}
+}
+
+static void *
+FileAsyncIOThread(void *arg)
+{
+	pthread_mutex_lock(&asyncIOPool.mutex);
+	for (;;)
+	{
+		FileAsyncIO *io;
+
+		while (asyncIOPool.head == NULL)
+			pthread_cond_wait(&asyncIOPool.queuedCond, &asyncIOPool.mutex);
+
+		io = asyncIOPool.head;
+		asyncIOPool.head = io->queueNext;
+		if (asyncIOPool.head == NULL)
+			asyncIOPool.tail = NULL;
+		io->queueNext = NULL;
+		pthread_mutex_unlock(&asyncIOPool.mutex);
+
+		FileRunAsync(io);
+
+		pthread_mutex_lock(&asyncIOPool.mutex);
+		io->done = true;
+		asyncIOPool.nqueued--;
+		pthread_cond_broadcast(&asyncIOPool.doneCond);
+	}
+
+	/* not reached */
+	return NULL;
+}
+
+/*
+ * Start the helper thread, if it isn't running yet.  It lives as long as
+ * the process.  Returns false if it could not be started.
+ */
+static bool
+FileStartAsyncIOThread(void)
+{
+	pthread_attr_t t_atts;
+	sigset_t	sigs;
+	sigset_t	old_sigs;
+	int			pthread_err;
+
+	if (asyncIOPool.started)
+		return true;
+	if (asyncIOPool.failed)
+		return false;
+
+	/*
+	 * The thread must never run a signal handler, so create it with every
+	 * signal blocked; it inherits the mask.
+	 */
+	pthread_attr_init(&t_atts);
+	pthread_attr_setstacksize(&t_atts, Max(PTHREAD_STACK_MIN, (256 * 1024)));
+	sigfillset(&sigs);
+	pthread_sigmask(SIG_SETMASK, &sigs, &old_sigs);
+
+	pthread_err = pthread_create(&asyncIOPool.thread, &t_atts,
+								 FileAsyncIOThread, NULL);
+
+	pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+	pthread_attr_destroy(&t_atts);
+
+	if (pthread_err != 0)
+	{
+		elog(LOG, "could not create asynchronous file I/O thread: %s",
+			 strerror(pthread_err));
+		asyncIOPool.failed = true;
+		return false;
+	}
+
+	asyncIOPool.started = true;
+	return true;
+}
+
+static int
+FileSubmitAsync(File file, FileAsyncIO *io, bool isWrite,
+				char *buffer, int amount, off_t offset)
+{
+	int			returnCode;
+	Vfd		   *vfdP;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FileSubmitAsync: %d (%s) %s " INT64_FORMAT " %d %p",
+			   file, VfdCache[file].fileName, isWrite ? "write" : "read",
+			   (int64) offset, amount, buffer));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	vfdP = &VfdCache[file];
+
+	if (isWrite)
+	{
+		off_t		newPos = offset + amount;
+
+		FileReserveSpace(file, newPos);
+
+		/* Maintain fileSize and temporary_files_size if it's a temp file. */
+		if ((vfdP->fdstate & FD_TEMPORARY) && newPos > vfdP->fileSize)
+		{
+			temporary_files_size += newPos - vfdP->fileSize;
+			vfdP->fileSize = newPos;
+		}
+	}
+
+	io->isWrite = isWrite;
+	io->fd = vfdP->fd;
+	io->buffer = buffer;
+	io->amount = amount;
+	io->offset = offset;
+	io->done = false;
+	io->result = 0;
+	io->error = 0;
+	io->queueNext = NULL;
+
+	if (!FileStartAsyncIOThread())
+	{
+		FileRunAsync(io);
+		io->done = true;
+		io->file = 0;
+		io->fileNext = NULL;
+		return 0;
+	}
+
+	io->file = file;
+	io->fileNext = vfdP->asyncIO;
+	vfdP->asyncIO = io;
+
+	pthread_mutex_lock(&asyncIOPool.mutex);
+	if (asyncIOPool.tail == NULL)
+		asyncIOPool.head = io;
+	else
+		asyncIOPool.tail->queueNext = io;
+	asyncIOPool.tail = io;
+	asyncIOPool.nqueued++;
+	pthread_cond_signal(&asyncIOPool.queuedCond);
+	pthread_mutex_unlock(&asyncIOPool.mutex);
+
+	return 0;
+}
+
+/*
+ * Start reading 'amount' bytes at 'offset' into 'buffer'.  The seek position
+ * of the file is not used or changed.  Returns 0, or -1 with errno set if
+ * the file could not be re-opened.
+ */
+int
+FileReadAsync(File file, FileAsyncIO *io, char *buffer, int amount, off_t offset)
+{
+	return FileSubmitAsync(file, io, false, buffer, amount, offset);
+}
+
+/*
+ * Start writing 'amount' bytes from 'buffer' at 'offset'.  The seek position
+ * of the file is not used or changed.  Like FileWrite(), this throws an
+ * error if the write would exceed temp_file_limit or the workfile limits.
+ */
+int
+FileWriteAsync(File file, FileAsyncIO *io, char *buffer, int amount, off_t offset)
+{
+	return FileSubmitAsync(file, io, true, buffer, amount, offset);
+}
+
+/*
+ * Wait for a read or write started with FileReadAsync() or FileWriteAsync().
+ * Returns what FileRead() or FileWrite() would have: the number of bytes
+ * transferred, or -1 with errno set.  A write that returns less than the
+ * requested amount sets errno, too.
+ */
+int
+FileWaitAsync(FileAsyncIO *io)
+{
+	pthread_mutex_lock(&asyncIOPool.mutex);
+	while (!io->done)
+		pthread_cond_wait(&asyncIOPool.doneCond, &asyncIOPool.mutex);
+	pthread_mutex_unlock(&asyncIOPool.mutex);
+
+	/* unlink it from the file */
+	if (io->file != 0)
+	{
+		FileAsyncIO **prev = &VfdCache[io->file].asyncIO;
+
+		while (*prev != io)
+			prev = &(*prev)->fileNext;
+		*prev = io->fileNext;
+		io->file = 0;
+		io->fileNext = NULL;
+	}
+
+	if (io->error != 0)
+		errno = io->error;
+	return io->result;
+}
+
+/*
+ * Wait for all requests in flight on a file, before its kernel fd is closed.
+ */
+static void
+FileWaitAllAsync(File file)
+{
+	while (VfdCache[file].asyncIO != NULL)
+		(void) FileWaitAsync(VfdCache[file].asyncIO);
+}
+
+/*
+ * Abort processing: wait for the helper thread to finish everything it has
+ * been given, before the buffers are released with the memory of the
+ * aborted (sub)transaction, and forget the requests.
+ */
+void
+AtAbort_FileAsyncIO(void)
+{
+	Index		i;
+
+	if (!asyncIOPool.started)
+		return;
+
+	pthread_mutex_lock(&asyncIOPool.mutex);
+	while (asyncIOPool.nqueued > 0)
+		pthread_cond_wait(&asyncIOPool.doneCond, &asyncIOPool.mutex);
+	pthread_mutex_unlock(&asyncIOPool.mutex);
+
+	for (i = 1; i < SizeVfdCache; i++)
+		FileWaitAllAsync((File) i);
+}
+
 int
 FileSync(File file)
 {
@@ -2032,6 +2354,8 @@ FileTruncate(File file, int64 offset)
 	if (returnCode < 0)
 		return returnCode;
 
+	FileWaitAllAsync(file);
+
 	/*
 	 * Call ftruncate with a int64 value.
 	 *
@@ -4958,6 +4958,13 @@ PostgresMain(int argc, char *argv[],
 			sendQEDetails();
 	}
 
+	/*
+	 * Warm up the writer gang of a new dispatcher session if asked to, see
+	 * PrespawnGangs().
+	 */
+	if (!am_walsender)
+		PrespawnGangs();
+
 	/* Welcome banner for standalone case */
 	if (whereToSendOutput == DestDebug)
 		printf("\nPostgreSQL stand-alone backend %s\n", PG_VERSION);
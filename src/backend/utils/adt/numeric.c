@@ -3716,6 +3716,56 @@ exx_int128_numeric(PG_FUNCTION_ARGS)
         PG_RETURN_NUMERIC(res);
 }
 
+/*
+ * EXX_IN_PG - convert a scaled 128 bit decimal, as sent by XRG, to numeric
+ * without going through its text form.  The value is val * 10^-scale, and
+ * the result is checked against typmod like numeric_in does.
+ */
+Numeric
+exx_decimal128_to_numeric(int128 val, int scale, int32 typmod)
+{
+	NumericVar	result;
+	int128		maxval = (int128) (~(uint128) 0 >> 1);
+	int128		mul = 1;
+	int			pad;
+	int			i;
+
+	Assert(scale >= 0);
+
+	/*
+	 * Scale the value up to a whole number of NBASE digits after the decimal
+	 * point; then dividing by 10^scale only moves the weight.
+	 */
+	pad = (DEC_DIGITS - scale % DEC_DIGITS) % DEC_DIGITS;
+	for (i = 0; i < pad; i++)
+		mul *= 10;
+
+	init_var(&result);
+	if (val <= maxval / mul && val >= -(maxval / mul))
+	{
+		int128_to_numericvar(val * mul, &result);
+		result.weight -= (scale + pad) / DEC_DIGITS;
+	}
+	else
+	{
+		NumericVar	num;
+		NumericVar	divisor;
+
+		init_var(&num);
+		init_var(&divisor);
+		int128_to_numericvar(val, &num);
+		power_var_int(&const_ten, scale, &divisor, 0);
+		div_var(&num, &divisor, &result, scale, false);
+		free_var(&num);
+		free_var(&divisor);
+	}
+	result.dscale = scale;
+
+	apply_typmod(&result, typmod);
+
+	return make_result(&result);
+}
+
 /*
  * Transition function for int128 input when we don't need sumX2.
  */
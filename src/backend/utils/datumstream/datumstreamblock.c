@@ -13,6 +13,7 @@
  */
 
 #include "postgres.h"
+#include "access/hash.h"
 #include "access/tupmacs.h"
 #include "access/tuptoaster.h"
 #include "utils/datumstreamblock.h"
@@ -144,6 +145,104 @@ DatumStreamBlockRead_ResetOrig(DatumStreamBlockRead * dsr)
 
 	dsr->buffer_beginp = NULL;
 	dsr->datump = NULL;
+
+	dsr->dictionary_entry_count = 0;
+	dsr->dictionary_code_width = 0;
+	dsr->dictionary_code_count = 0;
+	dsr->dictionary_codesp = NULL;
+}
+
+/*
+ * Set up reading the items of an Original block through its dictionary.
+ */
+static void
+DatumStreamBlockRead_GetReadyDictionary(DatumStreamBlockRead * dsr)
+{
+	DatumStreamBlock_Dictionary *dictionary;
+	uint8	   *p;
+	uint8	   *entries_afterp;
+	int32		i;
+	int32		code;
+
+	dictionary = (DatumStreamBlock_Dictionary *) dsr->datum_beginp;
+	if (dsr->typeInfo.datumlen != -1 ||
+		dsr->physical_data_size < sizeof(DatumStreamBlock_Dictionary) ||
+		dictionary->entry_count <= 0 ||
+		dictionary->entry_count > dsr->logical_row_count ||
+		dictionary->entries_size <= 0 ||
+		dictionary->entries_size > dsr->physical_data_size - sizeof(DatumStreamBlock_Dictionary))
+	{
+		ereport(ERROR,
+				(errmsg("bad datum stream Original block dictionary"),
+				 errdetail_internal("Found %d entries of size %d in %d bytes of data.",
+									dictionary->entry_count,
+									dictionary->entries_size,
+									dsr->physical_data_size),
+				 errdetail_datumstreamblockread(dsr),
+				 errcontext_datumstreamblockread(dsr)));
+	}
+
+	if (dictionary->entry_count > dsr->dictionary_entries_maxcount)
+	{
+		if (dsr->dictionary_entries != NULL)
+			pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries =
+			MemoryContextAlloc(dsr->memctxt,
+							   dictionary->entry_count * sizeof(uint8 *));
+		dsr->dictionary_entries_maxcount = dictionary->entry_count;
+	}
+
+	p = dsr->datum_beginp + sizeof(DatumStreamBlock_Dictionary);
+	entries_afterp = p + dictionary->entries_size;
+	for (i = 0; i < dictionary->entry_count; i++)
+	{
+		/*
+		 * Skip any possible zero paddings AFTER PREVIOUS varlena data.
+		 */
+		if (i > 0 && p < entries_afterp && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsr->typeInfo.align);
+
+		if (p >= entries_afterp || p + VARSIZE_ANY(p) > entries_afterp)
+			ereport(ERROR,
+					(errmsg("bad datum stream Original block dictionary"),
+					 errdetail_internal("Entry %d of %d runs past the %d bytes of entries.",
+										i,
+										dictionary->entry_count,
+										dictionary->entries_size),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+
+		dsr->dictionary_entries[i] = p;
+		p += VARSIZE_ANY(p);
+	}
+
+	dsr->dictionary_entry_count = dictionary->entry_count;
+	dsr->dictionary_code_width =
+		(dictionary->entry_count <= DatumStreamBlock_Dictionary_MaxOneByteCodes ? 1 : 2);
+	dsr->dictionary_codesp = entries_afterp;
+	dsr->dictionary_code_count =
+		(dsr->datum_afterp - dsr->dictionary_codesp) / dsr->dictionary_code_width;
+
+	/*
+	 * Pre-position on the first item, like a plain block.  Every code is
+	 * checked against the entry count before it is used.
+	 */
+	if (dsr->dictionary_code_count <= 0)
+		code = -1;
+	else if (dsr->dictionary_code_width == 1)
+		code = dsr->dictionary_codesp[0];
+	else
+		code = dsr->dictionary_codesp[0] | (dsr->dictionary_codesp[1] << 8);
+
+	if (code < 0 || code >= dsr->dictionary_entry_count)
+		ereport(ERROR,
+				(errmsg("bad datum stream Original block dictionary"),
+				 errdetail_internal("Code %d of the first item is out of bounds for %d entries.",
+									code,
+									dictionary->entry_count),
+				 errdetail_datumstreamblockread(dsr),
+				 errcontext_datumstreamblockread(dsr)));
+	dsr->datump = dsr->dictionary_entries[code];
 }
 
 void
@@ -338,7 +437,10 @@ DatumStreamBlockRead_GetReadyOrig(
 	}
 #endif
 
-	dsr->datump = dsr->datum_beginp;
+	if ((blockOrig->flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0)
+		DatumStreamBlockRead_GetReadyDictionary(dsr);
+	else
+		dsr->datump = dsr->datum_beginp;
 }
 
 void
@@ -403,7 +505,12 @@ void
 DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr)
 {
-	/* Place holder. */
+	if (dsr->dictionary_entries != NULL)
+	{
+		pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries = NULL;
+		dsr->dictionary_entries_maxcount = 0;
+	}
 }
 
 /*
@@ -3640,6 +3747,145 @@ DatumStreamBlockWrite_GetReady(
 	}
 }
 
+/*
+ * Try to dictionary-encode the variable-length items of an Original block.
+ *
+ * Lays out the dictionary header, the distinct items and the codes in
+ * dictionary_buffer and returns their size, or 0 when the block is not worth
+ * encoding: the items are mostly distinct, or the encoding would not be
+ * smaller than the items themselves.
+ */
+static int32
+DatumStreamBlockWrite_DictionaryEncode(DatumStreamBlockWrite * dsw)
+{
+	DatumStreamBlock_Dictionary dictionary;
+	int32		dataSize;
+	int32		count;
+	int32		slotMask;
+	int32		entryCount;
+	int32		codeWidth;
+	int32		encodedSize;
+	uint8	   *datump;
+	uint8	   *entryp;
+	uint8	   *codesp;
+	int32		i;
+
+	count = dsw->physical_datum_count;
+	if (!gp_appendonly_dictionary_encoding ||
+		dsw->typeInfo->datumlen != -1 ||
+		count < 2)
+		return 0;
+
+	dataSize = dsw->datump - dsw->datum_buffer;
+
+	if (dsw->dictionary_buffer == NULL)
+		dsw->dictionary_buffer = MemoryContextAlloc(dsw->memctxt,
+													dsw->maxDataBlockSize);
+
+	if (count > dsw->dictionary_maxcount)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(dsw->memctxt);
+		if (dsw->dictionary_slots != NULL)
+		{
+			pfree(dsw->dictionary_slots);
+			pfree(dsw->dictionary_entry_offsets);
+			pfree(dsw->dictionary_entry_lens);
+			pfree(dsw->dictionary_codes);
+		}
+
+		/*
+		 * Keep the open-addressing table at most half full.
+		 */
+		dsw->dictionary_slots_count = 1;
+		while (dsw->dictionary_slots_count < 2 * count)
+			dsw->dictionary_slots_count <<= 1;
+
+		dsw->dictionary_maxcount = count;
+		dsw->dictionary_slots = palloc(dsw->dictionary_slots_count * sizeof(int32));
+		dsw->dictionary_entry_offsets = palloc(count * sizeof(int32));
+		dsw->dictionary_entry_lens = palloc(count * sizeof(int32));
+		dsw->dictionary_codes = palloc(count * sizeof(uint16));
+		MemoryContextSwitchTo(oldCtxt);
+	}
+
+	slotMask = dsw->dictionary_slots_count - 1;
+	memset(dsw->dictionary_slots, -1, dsw->dictionary_slots_count * sizeof(int32));
+
+	entryCount = 0;
+	entryp = dsw->dictionary_buffer + sizeof(DatumStreamBlock_Dictionary);
+	datump = dsw->datum_buffer;
+	for (i = 0; i < count; i++)
+	{
+		int32		len;
+		uint32		slot;
+		int32		code;
+
+		/*
+		 * Skip any possible zero paddings AFTER PREVIOUS varlena data.
+		 */
+		if (i > 0 && *datump == 0)
+			datump = (uint8 *) att_align_nominal(datump, dsw->typeInfo->align);
+
+		len = VARSIZE_ANY(datump);
+		slot = DatumGetUInt32(hash_any(datump, len)) & slotMask;
+		while ((code = dsw->dictionary_slots[slot]) != -1)
+		{
+			if (dsw->dictionary_entry_lens[code] == len &&
+				memcmp(dsw->dictionary_buffer + dsw->dictionary_entry_offsets[code],
+					   datump, len) == 0)
+				break;
+			slot = (slot + 1) & slotMask;
+		}
+
+		if (code == -1)
+		{
+			if (2 * (entryCount + 1) > count)
+				return 0;
+
+			/*
+			 * Lay out the new distinct item the way it was put in the block.
+			 */
+			if (!VARATT_IS_SHORT(datump))
+				entryp = (uint8 *) att_align_zero((char *) entryp, dsw->typeInfo->align);
+			if ((entryp - dsw->dictionary_buffer) + len >= dataSize)
+				return 0;
+
+			code = entryCount++;
+			memcpy(entryp, datump, len);
+			dsw->dictionary_entry_offsets[code] = entryp - dsw->dictionary_buffer;
+			dsw->dictionary_entry_lens[code] = len;
+			dsw->dictionary_slots[slot] = code;
+			entryp += len;
+		}
+
+		dsw->dictionary_codes[i] = (uint16) code;
+		datump += len;
+	}
+
+	codeWidth = (entryCount <= DatumStreamBlock_Dictionary_MaxOneByteCodes ? 1 : 2);
+	encodedSize = (entryp - dsw->dictionary_buffer) + count * codeWidth;
+	if (encodedSize >= dataSize)
+		return 0;
+
+	dictionary.entry_count = entryCount;
+	dictionary.entries_size = (entryp - dsw->dictionary_buffer) -
+		sizeof(DatumStreamBlock_Dictionary);
+	memcpy(dsw->dictionary_buffer, &dictionary, sizeof(DatumStreamBlock_Dictionary));
+
+	codesp = entryp;
+	for (i = 0; i < count; i++)
+	{
+		*(codesp++) = (uint8) dsw->dictionary_codes[i];
+		if (codeWidth == 2)
+			*(codesp++) = (uint8) (dsw->dictionary_codes[i] >> 8);
+	}
+	Assert(codesp - dsw->dictionary_buffer == encodedSize);
+
+	return encodedSize;
+}
+
 static int64
 DatumStreamBlockWrite_BlockOrig(
 								DatumStreamBlockWrite * dsw,
@@ -3651,6 +3897,8 @@ DatumStreamBlockWrite_BlockOrig(
 	int32		rowCount;
 	int64		writesz;
 	bool		minimalIntegrityChecks;
+	uint8	   *data;
+	int32		dictionarySize;
 
 	p = buffer;
 
@@ -3677,6 +3925,21 @@ DatumStreamBlockWrite_BlockOrig(
 	}
 
 	block.sz = dsw->datump - dsw->datum_buffer;
+	data = dsw->datum_buffer;
+
+	dictionarySize = DatumStreamBlockWrite_DictionaryEncode(dsw);
+	if (dictionarySize > 0)
+	{
+		block.flags |= DSB_HAS_DICTIONARY_COMPRESSION;
+
+		/*
+		 * In the end, we use savings to estimate the eofUncompress.
+		 */
+		dsw->savings += block.sz - dictionarySize;
+
+		block.sz = dictionarySize;
+		data = dsw->dictionary_buffer;
+	}
 
 	/*
 	 * Serialize the different data in to the write buffer.
@@ -3704,7 +3967,7 @@ DatumStreamBlockWrite_BlockOrig(
 	}
 
 	/* Next write data */
-	memcpy(p, dsw->datum_buffer, block.sz);
+	memcpy(p, data, block.sz);
 	p += block.sz;
 
 	/* Calculate write size. */
@@ -4481,6 +4744,25 @@ DatumStreamBlockWrite_Finish(
 		dsw->delta_sign = NULL;
 	}
 
+	if (dsw->dictionary_buffer != NULL)
+	{
+		pfree(dsw->dictionary_buffer);
+		dsw->dictionary_buffer = NULL;
+	}
+
+	if (dsw->dictionary_slots != NULL)
+	{
+		pfree(dsw->dictionary_slots);
+		pfree(dsw->dictionary_entry_offsets);
+		pfree(dsw->dictionary_entry_lens);
+		pfree(dsw->dictionary_codes);
+		dsw->dictionary_slots = NULL;
+		dsw->dictionary_entry_offsets = NULL;
+		dsw->dictionary_entry_lens = NULL;
+		dsw->dictionary_codes = NULL;
+		dsw->dictionary_maxcount = 0;
+	}
+
 	MemoryContextSwitchTo(oldCtxt);
 }
 
@@ -4753,7 +5035,91 @@ DatumStreamBlock_IntegrityCheckOrig(
 		p += blockOrig->nullsz;
 	}
 
-	if (typeInfo->datumlen == -1)
+	if (typeInfo->datumlen == -1 &&
+		(blockOrig->flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0)
+	{
+		DatumStreamBlock_Dictionary *dictionary;
+		int32		entryCount;
+		int32		codeWidth;
+		int32		codeCount;
+		uint8	   *codesp;
+		int32		i;
+
+		/*
+		 * Dictionary of variable length items, followed by one code per
+		 * non-NULL item.
+		 */
+		dictionary = (DatumStreamBlock_Dictionary *) p;
+		if (blockOrig->sz < sizeof(DatumStreamBlock_Dictionary) ||
+			dictionary->entries_size <= 0 ||
+			dictionary->entries_size > blockOrig->sz - sizeof(DatumStreamBlock_Dictionary))
+		{
+			ereport(ERROR,
+					(errmsg("Bad datum stream Original block dictionary size.  Found %d and expected it to be between 1 and %d",
+							(blockOrig->sz < sizeof(DatumStreamBlock_Dictionary) ? 0 : dictionary->entries_size),
+							(int32) (blockOrig->sz - sizeof(DatumStreamBlock_Dictionary))),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		/* The check returns the index of the last item. */
+		entryCount = 1 + DatumStreamBlock_IntegrityCheckVarlena(
+										p + sizeof(DatumStreamBlock_Dictionary),
+															dictionary->entries_size,
+												DatumStreamVersion_Original,
+															typeInfo,
+															errdetailCallback,
+															errdetailArg,
+														  errcontextCallback,
+															errcontextArg);
+		if (entryCount != dictionary->entry_count)
+		{
+			ereport(ERROR,
+					(errmsg("Bad datum stream Original block dictionary entry count.  Found %d, expected %d",
+							entryCount,
+							dictionary->entry_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		codeWidth = (entryCount <= DatumStreamBlock_Dictionary_MaxOneByteCodes ? 1 : 2);
+		codeCount = blockOrig->ndatum;
+		if (hasNull)
+			codeCount -= DatumStreamBitMap_CountOn(buffer + headerSize, blockOrig->ndatum);
+		if (sizeof(DatumStreamBlock_Dictionary) + dictionary->entries_size +
+			codeCount * codeWidth != blockOrig->sz)
+		{
+			ereport(ERROR,
+					(errmsg("Bad datum stream Original block dictionary code size.  Found %d, expected %d",
+							(int32) (blockOrig->sz - sizeof(DatumStreamBlock_Dictionary) - dictionary->entries_size),
+							codeCount * codeWidth),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		codesp = p + sizeof(DatumStreamBlock_Dictionary) + dictionary->entries_size;
+		for (i = 0; i < codeCount; i++)
+		{
+			int32		code;
+
+			if (codeWidth == 1)
+				code = codesp[i];
+			else
+				code = codesp[2 * i] | (codesp[2 * i + 1] << 8);
+
+			if (code >= entryCount)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream Original block dictionary code %d for item index #%d.  Expected it to be less than %d",
+								code,
+								i,
+								entryCount),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+		}
+	}
+	else if (typeInfo->datumlen == -1)
 	{
 		/*
 		 * Variable length items (i.e. varlena).
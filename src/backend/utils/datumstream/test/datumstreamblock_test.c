@@ -4,6 +4,9 @@
 #include "cmockery.h"
 
 #include "../datumstreamblock.c"
+#include "catalog/pg_type.h"
+#include "cdb/cdbappendonlystorage.h"
+#include "utils/memutils.h"
 
 /* 
  * Unit test function to test the routines added for
@@ -166,13 +169,182 @@ test__DeltaCompression__Core(void **state)
 	free(dsw);
 }
 
+static int
+dummy_errcallback(void *arg)
+{
+	return 0;
+}
+
+static Datum
+make_text(const char *value, int len)
+{
+	struct varlena *v = palloc(VARHDRSZ + len);
+
+	SET_VARSIZE(v, VARHDRSZ + len);
+	memcpy(VARDATA(v), value, len);
+
+	return PointerGetDatum(v);
+}
+
+/*
+ * Write an Original block of text items, some of them NULL, and read it back.
+ * Returns the flags of the block written.
+ */
+static int16
+write_and_read_text_block(const char **values, int count)
+{
+	DatumStreamTypeInfo typeInfo;
+	DatumStreamBlockWrite *dsw = palloc0(sizeof(DatumStreamBlockWrite));
+	DatumStreamBlockRead *dsr = palloc0(sizeof(DatumStreamBlockRead));
+	uint8	   *buffer = palloc(32768);
+	int64		writesz;
+	bool		hadToAdjustRowCount;
+	int32		adjustedRowCount;
+	int16		flags;
+	int			i;
+
+	typeInfo.datumlen = -1;
+	typeInfo.typid = TEXTOID;
+	typeInfo.align = 'i';
+	typeInfo.byval = false;
+
+	DatumStreamBlockWrite_Init(dsw, &typeInfo, DatumStreamVersion_Original,
+							   false, false,
+							   AOSmallContentHeader_MaxRowCount,
+							   AOSmallContentHeader_MaxRowCount,
+							   32768,
+							   dummy_errcallback, NULL,
+							   dummy_errcallback, NULL);
+	for (i = 0; i < count; i++)
+	{
+		void	   *toFree = NULL;
+		int			result;
+
+		if (values[i] == NULL)
+			result = DatumStreamBlockWrite_Put(dsw, (Datum) 0, true, &toFree);
+		else
+			result = DatumStreamBlockWrite_Put(dsw,
+											   make_text(values[i], strlen(values[i])),
+											   false, &toFree);
+		assert_true(result >= 0);
+	}
+	writesz = DatumStreamBlockWrite_Block(dsw, buffer);
+	flags = ((DatumStreamBlock_Orig *) buffer)->flags;
+
+	DatumStreamBlockRead_Init(dsr, &typeInfo, DatumStreamVersion_Original,
+							  false,
+							  dummy_errcallback, NULL,
+							  dummy_errcallback, NULL);
+	DatumStreamBlockRead_Reset(dsr);
+	DatumStreamBlockRead_GetReady(dsr, buffer, writesz, 0, count,
+								  &hadToAdjustRowCount, &adjustedRowCount);
+	for (i = 0; i < count; i++)
+	{
+		Datum		d = (Datum) 0;
+		bool		null;
+
+		assert_int_equal(DatumStreamBlockRead_Advance(dsr), 1);
+		DatumStreamBlockRead_Get(dsr, &d, &null);
+		if (values[i] == NULL)
+			assert_true(null);
+		else
+		{
+			assert_false(null);
+			assert_int_equal(VARSIZE_ANY_EXHDR(DatumGetPointer(d)), strlen(values[i]));
+			assert_true(memcmp(VARDATA_ANY(DatumGetPointer(d)), values[i],
+							   strlen(values[i])) == 0);
+		}
+	}
+	assert_int_equal(DatumStreamBlockRead_Advance(dsr), 0);
+
+	DatumStreamBlockRead_Finish(dsr);
+	DatumStreamBlockWrite_Finish(dsw);
+
+	return flags;
+}
+
+/*
+ * Unit test for dictionary encoding of Original blocks of variable-length
+ * items.
+ */
+static void
+test__DictionaryEncoding__RoundTrip(void **state)
+{
+	const char *values[1000];
+	char		longValue[150];
+	char		distinct[1000][16];
+	int16		flags;
+	int			i;
+
+	/* The encoding is off by default */
+	gp_appendonly_dictionary_encoding = true;
+
+	/* A few distinct values, with NULLs and a value too long for a short header */
+	memset(longValue, 'x', sizeof(longValue) - 1);
+	longValue[sizeof(longValue) - 1] = '\0';
+	for (i = 0; i < 1000; i++)
+	{
+		switch (i % 7)
+		{
+			case 0:
+				values[i] = "red";
+				break;
+			case 1:
+			case 4:
+				values[i] = "green";
+				break;
+			case 2:
+				values[i] = NULL;
+				break;
+			case 3:
+				values[i] = longValue;
+				break;
+			default:
+				values[i] = (i % 2 == 0 ? "blue" : "");
+				break;
+		}
+	}
+	flags = write_and_read_text_block(values, 1000);
+	assert_true((flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0);
+	assert_true((flags & DSB_HAS_NULLBITMAP) != 0);
+
+	/* More than 256 distinct values need 2-byte codes */
+	for (i = 0; i < 1000; i++)
+	{
+		snprintf(distinct[i], sizeof(distinct[i]), "value %d", i % 300);
+		values[i] = distinct[i];
+	}
+	flags = write_and_read_text_block(values, 1000);
+	assert_true((flags & DSB_HAS_DICTIONARY_COMPRESSION) != 0);
+
+	/* Mostly distinct values are stored as they are */
+	for (i = 0; i < 1000; i++)
+	{
+		snprintf(distinct[i], sizeof(distinct[i]), "value %d", i);
+		values[i] = distinct[i];
+	}
+	flags = write_and_read_text_block(values, 1000);
+	assert_true((flags & DSB_HAS_DICTIONARY_COMPRESSION) == 0);
+
+	/* So is everything when the encoding is turned off */
+	gp_appendonly_dictionary_encoding = false;
+	for (i = 0; i < 1000; i++)
+		values[i] = (i % 2 == 0 ? "red" : "green");
+	flags = write_and_read_text_block(values, 1000);
+	assert_true((flags & DSB_HAS_DICTIONARY_COMPRESSION) == 0);
+}
+
 int 
 main(int argc, char* argv[]) 
 {
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-			unit_test(test__DeltaCompression__Core)
+			unit_test(test__DeltaCompression__Core),
+			unit_test(test__DictionaryEncoding__RoundTrip)
 	};
+
+	MemoryContextInit();
+
 	return run_tests(tests);
 }
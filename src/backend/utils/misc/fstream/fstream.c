@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/stat.h>
 
 #ifdef GPFXDIST
 #include <gpfxdist.h>
@@ -1058,3 +1059,20 @@ bool_t fstream_is_win_pipe(fstream_t *fs)
 	return fs->fd.is_win_pipe;
 }
 
+/*
+ * Returns true if every source of the stream is a regular file, as opposed
+ * to e.g. a named pipe.
+ */
+bool_t fstream_is_regular_files(fstream_t *fs)
+{
+	struct stat sta;
+	int			i;
+
+	for (i = 0; i < fs->glob.gl_pathc; i++)
+	{
+		if (stat(fs->glob.gl_pathv[i], &sta) != 0 || !S_ISREG(sta.st_mode))
+			return 0;
+	}
+	return 1;
+}
+
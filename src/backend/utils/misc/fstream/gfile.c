@@ -49,6 +49,16 @@
 
 #define COMPRESSION_BUFFER_SIZE		(1<<14)
 
+/*
+ * gpfdist decompresses the frames of zstd files in the seekable format on
+ * worker threads. The backend must stay single-threaded, so it always uses
+ * the streaming decoder.
+ */
+#if defined(HAVE_LIBZSTD) && defined(FRONTEND) && !defined(WIN32)
+#define USE_ZSTD_PARALLEL_READ
+#include <pthread.h>
+#endif
+
 #ifdef WIN32
 #if !defined(S_ISDIR)
 #define S_IFDIR  _S_IFDIR
@@ -527,6 +537,8 @@ gz_file_open(gfile_t *fd)
 #ifndef ZSTD_CLEVEL_DEFAULT
 #  define ZSTD_CLEVEL_DEFAULT 3
 #endif
+struct zstd_parallel;
+
 struct zstdlib_stuff
 {
 	ZSTD_inBuffer in;
@@ -534,6 +546,7 @@ struct zstdlib_stuff
 	int in_size, out_size;
 	ZSTD_CStream* cstream;
 	ZSTD_DStream* dstream;
+	struct zstd_parallel* par;	/* set when frames are decompressed in parallel */
 	unsigned char in_buffer[COMPRESSION_BUFFER_SIZE];
 	unsigned char out_buffer[COMPRESSION_BUFFER_SIZE];
 };
@@ -544,11 +557,395 @@ enum compress_mode
 	ZSTD_FLUSH_FLUSH = 1,
 	ZSTD_END_FLUSH = 2,
 };
+#ifdef USE_ZSTD_PARALLEL_READ
+/*
+ * Parallel decompression of zstd seekable files.
+ *
+ * A file in the zstd seekable format is a series of independent frames,
+ * followed by a skippable frame holding a seek table that lists the
+ * compressed and decompressed size of every frame. When we find such a
+ * table at the end of a regular file, worker threads pread() and decompress
+ * frames ahead of the reader, and zstd_file_read() hands out the results in
+ * file order. Any other .zst file goes through the streaming decoder.
+ */
+#define ZSTD_SEEKABLE_MAGIC			0x8F92EAB1
+#define ZSTD_SEEKTABLE_FRAME_MAGIC	0x184D2A5E
+#define ZSTD_SEEKTABLE_FOOTER_SIZE	9
+#define ZSTD_SKIPPABLE_HEADER_SIZE	8
+#define ZSTD_PARALLEL_MAX_THREADS	8
+#define ZSTD_PARALLEL_MAX_FRAME		(64 * 1024 * 1024)
+/* memory for the frames of one file, in and out, across all its workers */
+#define ZSTD_PARALLEL_MEMORY_BUDGET	(256 * 1024 * 1024)
+
+struct zstd_seek_frame
+{
+	off_t	offset;			/* start of the frame in the file */
+	size_t	csize;			/* compressed size */
+	size_t	dsize;			/* decompressed size */
+};
+
+struct zstd_frame_slot
+{
+	int		state;			/* 0: not ready, 1: decompressed, -1: error */
+	char*	data;
+	size_t	datalen;
+	size_t	alloced;
+};
+
+struct zstd_parallel
+{
+	pthread_mutex_t	mutex;
+	pthread_cond_t	cond;
+	pthread_t		threads[ZSTD_PARALLEL_MAX_THREADS];
+	int				nthreads;
+	int				filefd;
+
+	struct zstd_seek_frame* frames;
+	int				nframes;
+
+	/*
+	 * Frame i is decompressed into slots[i % nslots]. Workers stay within
+	 * nslots frames of the reader, so a slot is only reused after the
+	 * reader has consumed it.
+	 */
+	struct zstd_frame_slot* slots;
+	int				nslots;
+	int				next_dispatch;	/* next frame for a worker */
+	int				next_consume;	/* frame the reader is on */
+	size_t			consume_pos;	/* bytes of it already returned */
+	int				stop;
+};
+
+static uint32
+zstd_read_le32(const unsigned char *p)
+{
+	return (uint32) p[0] | ((uint32) p[1] << 8) |
+		((uint32) p[2] << 16) | ((uint32) p[3] << 24);
+}
+
+static int
+zstd_pread_full(int filefd, void *ptr, size_t len, off_t offset)
+{
+	while (len > 0)
+	{
+		ssize_t i = pread(filefd, ptr, len, offset);
+
+		if (i < 0 && errno == EINTR)
+			continue;
+		if (i <= 0)
+			return -1;
+		ptr = (char *) ptr + i;
+		len -= i;
+		offset += i;
+	}
+	return 0;
+}
+
+/*
+ * Read the seek table of a seekable zstd file. Returns the number of frames
+ * and fills in *frames, or 0 if the file isn't in the seekable format or
+ * its table doesn't add up.
+ */
+static int
+zstd_read_seek_table(int filefd, off_t filesize, struct zstd_seek_frame **frames)
+{
+	unsigned char	footer[ZSTD_SEEKTABLE_FOOTER_SIZE];
+	unsigned char	header[ZSTD_SKIPPABLE_HEADER_SIZE];
+	unsigned char*	table;
+	struct zstd_seek_frame* f;
+	uint32			nframes;
+	int				entry_size;
+	off_t			table_size;
+	off_t			offset;
+	uint32			i;
+
+	if (filesize < ZSTD_SKIPPABLE_HEADER_SIZE + ZSTD_SEEKTABLE_FOOTER_SIZE)
+		return 0;
+	if (zstd_pread_full(filefd, footer, sizeof footer, filesize - sizeof footer))
+		return 0;
+	if (zstd_read_le32(footer + 5) != ZSTD_SEEKABLE_MAGIC)
+		return 0;
+	/* reserved bits of the descriptor must be zero */
+	if (footer[4] & 0x7C)
+		return 0;
+
+	nframes = zstd_read_le32(footer);
+	entry_size = (footer[4] & 0x80) ? 12 : 8;	/* with or without checksums */
+	if (nframes < 2 || nframes > (uint32) (filesize / entry_size))
+		return 0;
+
+	table_size = (off_t) nframes * entry_size + ZSTD_SEEKTABLE_FOOTER_SIZE;
+	if (table_size + ZSTD_SKIPPABLE_HEADER_SIZE > filesize)
+		return 0;
+	if (zstd_pread_full(filefd, header, sizeof header,
+						filesize - table_size - ZSTD_SKIPPABLE_HEADER_SIZE))
+		return 0;
+	if (zstd_read_le32(header) != ZSTD_SEEKTABLE_FRAME_MAGIC ||
+		zstd_read_le32(header + 4) != table_size)
+		return 0;
+
+	if (!(table = gfile_malloc(table_size)))
+		return 0;
+	if (!(f = gfile_malloc(nframes * sizeof(*f))))
+	{
+		gfile_free(table);
+		return 0;
+	}
+	if (zstd_pread_full(filefd, table, table_size, filesize - table_size))
+		goto bad;
+
+	offset = 0;
+	for (i = 0; i < nframes; i++)
+	{
+		f[i].offset = offset;
+		f[i].csize = zstd_read_le32(table + i * entry_size);
+		f[i].dsize = zstd_read_le32(table + i * entry_size + 4);
+		if (f[i].dsize > ZSTD_PARALLEL_MAX_FRAME ||
+			f[i].csize > ZSTD_compressBound(ZSTD_PARALLEL_MAX_FRAME))
+			goto bad;
+		offset += f[i].csize;
+	}
+
+	/* the frames must exactly fill the file up to the seek table */
+	if (offset != filesize - table_size - ZSTD_SKIPPABLE_HEADER_SIZE)
+		goto bad;
+
+	gfile_free(table);
+	*frames = f;
+	return nframes;
+
+bad:
+	gfile_free(table);
+	gfile_free(f);
+	return 0;
+}
+
+static void *
+zstd_parallel_worker(void *arg)
+{
+	struct zstd_parallel* par = (struct zstd_parallel*) arg;
+	ZSTD_DCtx*	dctx = ZSTD_createDCtx();
+	char*		in = NULL;
+	size_t		inlen = 0;
+
+	pthread_mutex_lock(&par->mutex);
+	for (;;)
+	{
+		struct zstd_seek_frame* f;
+		struct zstd_frame_slot* slot;
+		int			state = -1;
+		int			i;
+
+		while (!par->stop && par->next_dispatch < par->nframes &&
+			   par->next_dispatch >= par->next_consume + par->nslots)
+			pthread_cond_wait(&par->cond, &par->mutex);
+		if (par->stop || par->next_dispatch >= par->nframes)
+			break;
+
+		i = par->next_dispatch++;
+		f = &par->frames[i];
+		slot = &par->slots[i % par->nslots];
+		pthread_mutex_unlock(&par->mutex);
+
+		if (inlen < f->csize)
+		{
+			gfile_free(in);
+			in = gfile_malloc(f->csize);
+			inlen = in ? f->csize : 0;
+		}
+		if (slot->alloced < f->dsize)
+		{
+			gfile_free(slot->data);
+			slot->data = gfile_malloc(f->dsize);
+			slot->alloced = slot->data ? f->dsize : 0;
+		}
+
+		if (dctx && inlen >= f->csize && slot->alloced >= f->dsize &&
+			zstd_pread_full(par->filefd, in, f->csize, f->offset) == 0)
+		{
+			size_t		ret = ZSTD_decompressDCtx(dctx, slot->data, f->dsize,
+												  in, f->csize);
+
+			if (!ZSTD_isError(ret) && ret == f->dsize)
+			{
+				slot->datalen = ret;
+				state = 1;
+			}
+		}
+
+		pthread_mutex_lock(&par->mutex);
+		slot->state = state;
+		pthread_cond_broadcast(&par->cond);
+	}
+	pthread_mutex_unlock(&par->mutex);
+
+	gfile_free(in);
+	if (dctx)
+		ZSTD_freeDCtx(dctx);
+	return NULL;
+}
+
+static void
+zstd_parallel_close(struct zstd_parallel* par)
+{
+	int			i;
+
+	pthread_mutex_lock(&par->mutex);
+	par->stop = 1;
+	pthread_cond_broadcast(&par->cond);
+	pthread_mutex_unlock(&par->mutex);
+
+	for (i = 0; i < par->nthreads; i++)
+		pthread_join(par->threads[i], NULL);
+
+	pthread_cond_destroy(&par->cond);
+	pthread_mutex_destroy(&par->mutex);
+	for (i = 0; i < par->nslots; i++)
+		gfile_free(par->slots[i].data);
+	gfile_free(par->slots);
+	gfile_free(par->frames);
+	gfile_free(par);
+}
+
+/*
+ * Set up parallel decompression if fd is a regular file in the seekable
+ * format. Returns NULL if it isn't, or if the workers can't be started;
+ * the caller then uses the streaming decoder.
+ */
+static struct zstd_parallel*
+zstd_parallel_open(gfile_t *fd)
+{
+	struct zstd_parallel* par;
+	struct stat	sta;
+	long		ncpus;
+	int			nthreads;
+	size_t		maxcsize = 0;
+	size_t		maxdsize = 0;
+	size_t		per_thread;
+	int			i;
+
+	if (fstat(fd->fd.filefd, &sta) != 0 || !S_ISREG(sta.st_mode))
+		return NULL;
+
+	if (!(par = gfile_malloc(sizeof *par)))
+		return NULL;
+	memset(par, 0, sizeof *par);
+
+	par->nframes = zstd_read_seek_table(fd->fd.filefd, sta.st_size, &par->frames);
+	if (par->nframes == 0)
+	{
+		gfile_free(par);
+		return NULL;
+	}
+
+	ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	nthreads = (ncpus > 0) ? (int) ncpus : 1;
+	nthreads = Min(nthreads, ZSTD_PARALLEL_MAX_THREADS);
+	nthreads = Min(nthreads, par->nframes);
+
+	/*
+	 * Every worker holds one compressed frame, and there are two slots of
+	 * decompressed frames per worker. Use fewer workers for large frames,
+	 * to keep the total within the budget.
+	 */
+	for (i = 0; i < par->nframes; i++)
+	{
+		maxcsize = Max(maxcsize, par->frames[i].csize);
+		maxdsize = Max(maxdsize, par->frames[i].dsize);
+	}
+	per_thread = maxcsize + 2 * maxdsize;
+	if (per_thread > 0)
+		nthreads = Min(nthreads, (int) Max(ZSTD_PARALLEL_MEMORY_BUDGET / per_thread, 1));
+
+	par->filefd = fd->fd.filefd;
+	par->nslots = 2 * nthreads;
+	if (!(par->slots = gfile_malloc(par->nslots * sizeof(*par->slots))))
+	{
+		gfile_free(par->frames);
+		gfile_free(par);
+		return NULL;
+	}
+	memset(par->slots, 0, par->nslots * sizeof(*par->slots));
+	pthread_mutex_init(&par->mutex, NULL);
+	pthread_cond_init(&par->cond, NULL);
+
+	for (i = 0; i < nthreads; i++)
+	{
+		if (pthread_create(&par->threads[i], NULL, zstd_parallel_worker, par) != 0)
+			break;
+		par->nthreads++;
+	}
+	if (par->nthreads == 0)
+	{
+		zstd_parallel_close(par);
+		return NULL;
+	}
+
+	return par;
+}
+
+static ssize_t
+zstd_parallel_read(gfile_t* fd, void* ptr, size_t len)
+{
+	struct zstd_parallel* par = fd->u.zstd->par;
+
+	for (;;)
+	{
+		struct zstd_frame_slot* slot;
+		size_t		s;
+
+		if (par->next_consume >= par->nframes)
+		{
+			/* count the seek table as read, too */
+			fd->compressed_position = fd->compressed_size;
+			return 0;
+		}
+
+		slot = &par->slots[par->next_consume % par->nslots];
+
+		pthread_mutex_lock(&par->mutex);
+		while (slot->state == 0)
+			pthread_cond_wait(&par->cond, &par->mutex);
+		pthread_mutex_unlock(&par->mutex);
+
+		if (slot->state < 0)
+		{
+			gfile_printf_then_putc_newline("ZSTD failed to decompress frame %d", par->next_consume);
+			return -1;
+		}
+
+		s = slot->datalen - par->consume_pos;
+		if (s > 0)
+		{
+			if (s > len)
+				s = len;
+			memcpy(ptr, slot->data + par->consume_pos, s);
+			par->consume_pos += s;
+			return s;
+		}
+
+		/* done with this frame, let a worker reuse the slot */
+		fd->compressed_position += par->frames[par->next_consume].csize;
+		pthread_mutex_lock(&par->mutex);
+		slot->state = 0;
+		par->next_consume++;
+		par->consume_pos = 0;
+		pthread_cond_broadcast(&par->cond);
+		pthread_mutex_unlock(&par->mutex);
+	}
+}
+#endif   /* USE_ZSTD_PARALLEL_READ */
+
 static ssize_t
 zstd_file_read(gfile_t* fd, void* ptr, size_t len)
 {
 	struct zstdlib_stuff* zstd = fd->u.zstd;
 
+#ifdef USE_ZSTD_PARALLEL_READ
+	if (zstd->par)
+		return zstd_parallel_read(fd, ptr, len);
+#endif
+
 	for (;;)
 	{
 		size_t	ret;
@@ -710,6 +1107,10 @@ zstd_file_close(gfile_t *fd)
 	int ret;
 	if ( fd->is_write == FALSE ) /* writing, or in other words compressing */
 	{
+#ifdef USE_ZSTD_PARALLEL_READ
+		if (fd->u.zstd->par)
+			zstd_parallel_close(fd->u.zstd->par);
+#endif
 		ZSTD_freeDStream(fd->u.zstd->dstream);
 	}
 	else
@@ -759,6 +1160,9 @@ zstd_file_open(gfile_t *fd)
 			gfile_printf_then_putc_newline("ZSTD_initDStream failed");
 			return 1;
 		}
+#ifdef USE_ZSTD_PARALLEL_READ
+		fd->u.zstd->par = zstd_parallel_open(fd);
+#endif
 	}
 	else
 	{
@@ -1181,6 +1585,15 @@ int gfile_open(gfile_t* fd, const char* fpath, int flags, int* response_code, co
 			}
 		}
 #endif
+
+#ifdef USE_POSIX_FADVISE
+		/*
+		 * Files are read front to back; let the kernel read ahead
+		 * aggressively so that disk reads overlap with parsing the data.
+		 */
+		if (S_ISREG(sta.st_mode) && (flags == GFILE_OPEN_FOR_READ))
+			(void) posix_fadvise(fd->fd.filefd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 	}
 
 	/*
@@ -19,6 +19,7 @@
 #include <sys/stat.h>
 #include <sys/unistd.h>
 
+#include "access/appendonlywriter.h"
 #include "access/reloptions.h"
 #include "access/transam.h"
 #include "access/url.h"
@@ -38,6 +39,7 @@
 #include "optimizer/planmain.h"
 #include "pgstat.h"
 #include "parser/scansup.h"
+#include "postmaster/aocompactor.h"
 #include "postmaster/syslogger.h"
 #include "postmaster/fts.h"
 #include "replication/walsender.h"
@@ -132,15 +134,20 @@ bool		Debug_appendonly_print_datumstream = false;
 bool		Debug_appendonly_print_visimap = false;
 bool		Debug_appendonly_print_compaction = false;
 bool		Debug_bitmap_print_insert = false;
+bool		gp_bitmap_index_sort_build = true;
 bool		Test_print_direct_dispatch_info = false;
 bool        Test_print_prefetch_joinqual = false;
 bool		Test_copy_qd_qe_split = false;
 bool		gp_permit_relation_node_change = false;
-int			gp_max_local_distributed_cache = 1024;
+int			gp_max_local_distributed_cache = 16384;
 bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_insert_segfile_limit = 0;
+int			gp_appendonly_insert_segfile_wait = 1000;
+int			gp_appendonly_compress_workers = 0;
+bool		gp_appendonly_dictionary_encoding = false;
 bool		gp_heap_require_relhasoids_match = true;
 bool		gp_local_distributed_cache_stats = false;
 bool		debug_xlog_record_read = false;
@@ -157,6 +164,7 @@ bool		gp_allow_non_uniform_partitioning_ddl = true;
 bool		gp_print_create_gang_time = false;
 bool		gp_enable_exchange_default_partition = false;
 int			dtx_phase2_retry_count = 0;
+bool		gp_dtx_prepare_writers_only = false;
 bool		gp_log_suboverflow_statement = false;
 bool        gp_use_synchronize_seqscans_catalog_vacuum_full = false;
 
@@ -458,6 +466,8 @@ int			writable_external_table_bufsize = 64;
 
 bool		gp_external_enable_filter_pushdown = true;
 
+int			gp_kite_fetch_connections = 1;
+
 /* Executor */
 bool		gp_enable_mk_sort = true;
 bool		gp_enable_motion_mk_sort = true;
@@ -484,6 +494,8 @@ static const struct config_enum_entry debug_dtm_action_protocol_options[] = {
 	{"commit_onephase", DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE},
 	{"commit_prepared", DTX_PROTOCOL_COMMAND_COMMIT_PREPARED},
 	{"abort_prepared", DTX_PROTOCOL_COMMAND_ABORT_PREPARED},
+	{"commit_writers_prepared", DTX_PROTOCOL_COMMAND_COMMIT_WRITERS_PREPARED},
+	{"abort_writers_prepared", DTX_PROTOCOL_COMMAND_ABORT_WRITERS_PREPARED},
 	{"retry_commit_prepared", DTX_PROTOCOL_COMMAND_RETRY_COMMIT_PREPARED},
 	{"retry_abort_prepared", DTX_PROTOCOL_COMMAND_RETRY_ABORT_PREPARED},
 	{"recovery_commit_prepared", DTX_PROTOCOL_COMMAND_RECOVERY_COMMIT_PREPARED},
@@ -1070,6 +1082,28 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Dictionary-encode low-cardinality variable-length columns of column-oriented tables."),
+			gettext_noop("Applies to the blocks of columns without RLE_TYPE compression. "
+						 "Blocks written this way cannot be read by older releases.")
+		},
+		&gp_appendonly_dictionary_encoding,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_compaction_worker", PGC_POSTMASTER, APPENDONLY_TABLES,
+			gettext_noop("Starts a background process on the master that compacts append-optimized tables."),
+			gettext_noop("The tables are compacted by lazy VACUUM when a segment file's ratio of "
+						 "hidden tuples is above gp_appendonly_compaction_threshold.")
+		},
+		&gp_appendonly_compaction_worker,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_heap_require_relhasoids_match", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Issue an error on discovery of a mismatch between relhasoids and a tuple header."),
@@ -1157,6 +1191,26 @@ struct config_bool ConfigureNamesBool_gp[] =
 		check_gp_workfile_compression, NULL, NULL
 	},
 
+	{
+		{"gp_workfile_async_io", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Writes and reads ahead temporary files on a helper thread while the query goes on."),
+			gettext_noop("Each temporary file then uses a second buffer.")
+		},
+		&gp_workfile_async_io,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_hashjoin_adaptive_batches", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sizes hash join batches at run time and keeps as many of them in memory as fit."),
+			gettext_noop("A batch that cannot be split any further is joined in chunks that fit in memory.")
+		},
+		&gp_hashjoin_adaptive_batches,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_reraise_signal", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Do we attempt to dump core when a serious problem occurs."),
@@ -1210,6 +1264,19 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_gang_prespawn", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Create the writer gang when a session starts, before its first query."),
+			gettext_noop("Lets connection poolers hand out sessions whose QEs are already "
+						 "forked, authenticated and configured. The client has to wait for "
+						 "the gang before the session reports ready for its first query."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_gang_prespawn,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_cache_future_packets", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Control whether future packets are cached."),
@@ -1638,6 +1705,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_bitmap_index_sort_build", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Build bitmap indexes by sorting the index entries with maintenance_work_mem."),
+			gettext_noop("When off, the tids of every distinct value are buffered in memory during the build.")
+		},
+		&gp_bitmap_index_sort_build,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"debug_dtm_action_primary", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Specify if the primary or mirror segment is the target of the debug DTM action."),
@@ -3131,6 +3208,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_dtx_prepare_writers_only", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Only prepare the segments that wrote in a distributed transaction."),
+			gettext_noop("Read-only segments are committed in one phase, and a transaction "
+						 "that wrote on a single segment is committed in one phase.")
+		},
+		&gp_dtx_prepare_writers_only,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_enable_global_deadlock_detector", PGC_POSTMASTER, CUSTOM_OPTIONS,
 			gettext_noop("Enables the Global Deadlock Detector."),
@@ -3338,13 +3426,24 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_kite_fetch_connections", PGC_USERSET, EXTERNAL_TABLES,
+			gettext_noop("Sets the number of concurrent Kite requests each segment makes for a kite:// scan."),
+			gettext_noop("The fragment of each segment is split into this many sub-fragments, "
+						 "which the Kite server produces concurrently while the segment reads them.")
+		},
+		&gp_kite_fetch_connections,
+		1, 1, 64,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_max_local_distributed_cache", PGC_POSTMASTER, RESOURCES_MEM,
 			gettext_noop("Sets the number of local-distributed transactions to cache for optimizing visibility processing by backends."),
-			NULL
+			gettext_noop("The cache starts small and grows up to this many entries as needed.")
 		},
 		&gp_max_local_distributed_cache,
-		1024, 0, INT_MAX,
+		16384, 0, INT_MAX,
 		NULL, NULL, NULL
 	},
 
@@ -3485,6 +3584,64 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_insert_segfile_limit", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of segment files that concurrent inserts into an append-optimized table take turns on."),
+			gettext_noop("0 gives each concurrent inserting transaction a segment file of its own. "
+						 "Otherwise an insert waits for one of the first N segment files to be released, "
+						 "and only uses another one after gp_appendonly_insert_segfile_wait.")
+		},
+		&gp_appendonly_insert_segfile_limit,
+		0, 0, MAX_AOREL_CONCURRENCY - 1,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_insert_segfile_wait", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets how long an insert waits for a segment file within gp_appendonly_insert_segfile_limit."),
+			NULL,
+			GUC_UNIT_MS
+		},
+		&gp_appendonly_insert_segfile_wait,
+		1000, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_compress_workers", PGC_SUSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of threads that compress column blocks while an insert into a column-oriented table continues."),
+			gettext_noop("0 compresses every block in the inserting process. "
+						 "A segment starts at most its share of the CPUs of its host, "
+						 "the number of CPUs divided by the number of segments on the host.")
+		},
+		&gp_appendonly_compress_workers,
+		0, 0, 32,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_compaction_worker_naptime", PGC_SIGHUP, APPENDONLY_TABLES,
+			gettext_noop("Time to sleep between rounds of background append-optimized table compaction."),
+			NULL,
+			GUC_UNIT_S
+		},
+		&gp_appendonly_compaction_worker_naptime,
+		60, 1, INT_MAX / 1000,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_compaction_worker_cost_delay", PGC_SIGHUP, APPENDONLY_TABLES,
+			gettext_noop("Vacuum cost delay in milliseconds, for background append-optimized table compaction."),
+			gettext_noop("Applies to the compaction worker on the master; the segments use their "
+						 "own vacuum_cost_delay. -1 means use vacuum_cost_delay."),
+			GUC_UNIT_MS
+		},
+		&gp_appendonly_compaction_worker_cost_delay,
+		20, -1, 100,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -64,6 +64,16 @@
  * of releasing many blocks followed by re-using many blocks, due to
  * tuplesort.c's "preread" behavior.
  *
+ * When gp_workfile_compression is on, the blocks of a private tape set are
+ * compressed with zstd one by one, so that each can still be read on its
+ * own, in any order.  A compressed block is stored in a run of one or more
+ * segments of BLCKSZ / LTS_SEGS_PER_BLOCK bytes, and blockMap[] remembers
+ * where each block number lives.  The runs freed by released blocks are
+ * kept in free lists by length, and a new block takes a run of exactly the
+ * length it needs, or splits a longer one, before the file is extended.
+ * The block numbers seen by the rest of this module, and by the links
+ * between blocks, are unchanged.
+ *
  * Since all the bookkeeping and buffer memory is allocated with palloc(),
  * and the underlying file(s) are made with OpenTemporaryFile, all resources
  * for a logical tape set are certain to be cleaned up even if processing
@@ -82,9 +92,14 @@
 
 #include "postgres.h"
 
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
 #include "utils/logtape.h"
 
 #include "cdb/cdbvars.h"                /* currentSliceId */
+#include "storage/gp_compress.h"
 
 
 /* A logical tape block, log tape blocks are organized into doulbe linked lists */
@@ -98,6 +113,31 @@ typedef struct LogicalTapeBlock
 } LogicalTapeBlock ;
 
 
+/*
+ * A compressed block is stored in a run of 1 to LTS_SEGS_PER_BLOCK segments.
+ * A block that does not compress to less than LTS_SEGS_PER_BLOCK segments is
+ * stored as is, and its length is recorded as BLCKSZ.
+ */
+#define LTS_SEGS_PER_BLOCK	8
+#define LTS_SEGMENT_SIZE	(BLCKSZ / LTS_SEGS_PER_BLOCK)
+
+#define LOGTAPE_ZSTD_COMPRESSION_LEVEL 1
+
+/* Location of one block of a compressed tape set */
+typedef struct LtsBlockLoc
+{
+	int64		seg;			/* first segment, or -1 if not stored */
+	int32		len;			/* stored bytes; BLCKSZ if not compressed */
+} LtsBlockLoc;
+
+/* Free runs of segments of one length */
+typedef struct LtsFreeRuns
+{
+	int64	   *runs;			/* first segment of each free run */
+	long		nruns;
+	long		maxruns;
+} LtsFreeRuns;
+
 /*
  * This data structure represents a single "logical tape" within the set
  * of logical tapes stored in the same file.  We must keep track of the
@@ -145,6 +185,22 @@ struct LogicalTapeSet
 	long		nFreeBlocks;	/* # of currently free blocks */
 	long		freeBlocksLen;	/* current allocated length of freeBlocks[] */
 
+	/*
+	 * Block compression, see the notes at the top of the file. blockMap[]
+	 * is indexed by block number, freeRuns[n] holds the free runs of n + 1
+	 * segments.
+	 */
+	bool		compressed;
+	LtsBlockLoc *blockMap;
+	long		blockMapLen;
+	int64		nFileSegs;		/* # of segments used in underlying file */
+	LtsFreeRuns	freeRuns[LTS_SEGS_PER_BLOCK];
+	char	   *compressBuf;	/* holds one compressed block */
+	size_t		compressBufLen;
+#ifdef HAVE_LIBZSTD
+	zstd_context *zstd_context;
+#endif
+
 	/*
 	 * tapes[] is declared size 1 since C wants a fixed size, but actually it
 	 * is of length nTapes.
@@ -155,6 +211,10 @@ struct LogicalTapeSet
 
 static void ltsWriteBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer);
 static void ltsReadBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer);
+static void ltsStartCompression(LogicalTapeSet *lts);
+static void ltsWriteCompressedBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer);
+static void ltsReadCompressedBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer);
+static void ltsReleaseSegments(LogicalTapeSet *lts, int64 blocknum);
 static long ltsGetFreeBlock(LogicalTapeSet *lts);
 static void ltsReleaseBlock(LogicalTapeSet *lts, int64 blocknum);
 
@@ -213,6 +273,9 @@ LoadLogicalTapeSetState(BufFile *statefile, BufFile *tapefile)
 	lts->nFreeBlocks = 0;
 	lts->freeBlocksLen = 0;
 
+	/* Shared tape sets are not compressed */
+	lts->compressed = false;
+
 	lt->writing = false;
 	lt->frozen = true;
 
@@ -242,6 +305,11 @@ static void
 ltsWriteBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
 {
 	Assert(lts != NULL);
+	if (lts->compressed)
+	{
+		ltsWriteCompressedBlock(lts, blocknum, buffer);
+		return;
+	}
 	if (BufFileSeekBlock(lts->pfile, blocknum) != 0 ||
 		BufFileWrite(lts->pfile, buffer, BLCKSZ) != BLCKSZ)
 	{
@@ -262,6 +330,11 @@ static void
 ltsReadBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
 {
 	Assert(lts != NULL);
+	if (lts->compressed)
+	{
+		ltsReadCompressedBlock(lts, blocknum, buffer);
+		return;
+	}
 	if (BufFileSeek(lts->pfile, 0 /* fileno */, blocknum * BLCKSZ, SEEK_SET) != 0 ||
 		BufFileRead(lts->pfile, buffer, BLCKSZ) != BLCKSZ)
 	{
@@ -272,6 +345,230 @@ ltsReadBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
 	}
 }
 
+/*
+ * Return the segments of a block to the free lists.
+ */
+static void
+ltsReleaseSegments(LogicalTapeSet *lts, int64 blocknum)
+{
+	LtsBlockLoc *loc;
+	LtsFreeRuns *fr;
+	int			nsegs;
+
+	if (blocknum >= lts->blockMapLen || lts->blockMap[blocknum].seg < 0)
+		return;
+
+	loc = &lts->blockMap[blocknum];
+	nsegs = (loc->len + LTS_SEGMENT_SIZE - 1) / LTS_SEGMENT_SIZE;
+	fr = &lts->freeRuns[nsegs - 1];
+	if (fr->nruns >= fr->maxruns)
+	{
+		fr->maxruns = Max(fr->maxruns * 2, 32);
+		fr->runs = fr->runs ?
+			repalloc(fr->runs, fr->maxruns * sizeof(int64)) :
+			palloc(fr->maxruns * sizeof(int64));
+	}
+	fr->runs[fr->nruns++] = loc->seg;
+	loc->seg = -1;
+}
+
+#ifdef HAVE_LIBZSTD
+
+/*
+ * Take a free run of 'nsegs' segments.
+ *
+ * A free run of exactly that length is used if there is one. Otherwise the
+ * shortest longer run is split, and if there is none of those either, the
+ * run is added at the end of the file.
+ */
+static int64
+ltsGetFreeSegments(LogicalTapeSet *lts, int nsegs)
+{
+	int			i;
+
+	for (i = nsegs - 1; i < LTS_SEGS_PER_BLOCK; i++)
+	{
+		LtsFreeRuns *fr = &lts->freeRuns[i];
+
+		if (fr->nruns > 0)
+		{
+			int64		seg = fr->runs[--fr->nruns];
+			int			nleft = (i + 1) - nsegs;
+
+			if (nleft > 0)
+			{
+				LtsFreeRuns *rest = &lts->freeRuns[nleft - 1];
+
+				if (rest->nruns >= rest->maxruns)
+				{
+					rest->maxruns = Max(rest->maxruns * 2, 32);
+					rest->runs = rest->runs ?
+						repalloc(rest->runs, rest->maxruns * sizeof(int64)) :
+						palloc(rest->maxruns * sizeof(int64));
+				}
+				rest->runs[rest->nruns++] = seg + nsegs;
+			}
+			return seg;
+		}
+	}
+
+	lts->nFileSegs += nsegs;
+	return lts->nFileSegs - nsegs;
+}
+
+/*
+ * Set up a new tape set for block compression.
+ */
+static void
+ltsStartCompression(LogicalTapeSet *lts)
+{
+	lts->compressed = true;
+	lts->blockMapLen = 1024;
+	lts->blockMap = (LtsBlockLoc *) palloc(lts->blockMapLen * sizeof(LtsBlockLoc));
+	memset(lts->blockMap, 0xFF, lts->blockMapLen * sizeof(LtsBlockLoc));
+	lts->nFileSegs = 0;
+	memset(lts->freeRuns, 0, sizeof(lts->freeRuns));
+	lts->compressBufLen = Max(ZSTD_compressBound(BLCKSZ), BLCKSZ);
+	lts->compressBuf = palloc(lts->compressBufLen);
+
+	lts->zstd_context = zstd_alloc_context();
+	lts->zstd_context->cctx = ZSTD_createCCtx();
+	lts->zstd_context->dctx = ZSTD_createDCtx();
+	if (!lts->zstd_context->cctx || !lts->zstd_context->dctx)
+		elog(ERROR, "out of memory");
+}
+
+/*
+ * Compress a block and write it into a run of free segments.
+ */
+static void
+ltsWriteCompressedBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
+{
+	LtsBlockLoc *loc;
+	const char *data;
+	size_t		len;
+	int			nsegs;
+
+	len = ZSTD_compressCCtx(lts->zstd_context->cctx,
+							lts->compressBuf, lts->compressBufLen,
+							buffer, BLCKSZ,
+							LOGTAPE_ZSTD_COMPRESSION_LEVEL);
+	if (ZSTD_isError(len))
+		elog(ERROR, "could not compress temporary file block: %s",
+			 ZSTD_getErrorName(len));
+
+	if (len > BLCKSZ - LTS_SEGMENT_SIZE)
+	{
+		/* not worth it, store the block as is */
+		data = buffer;
+		len = BLCKSZ;
+		nsegs = LTS_SEGS_PER_BLOCK;
+	}
+	else
+	{
+		/*
+		 * Pad to whole segments, so that blocks written one after another
+		 * are contiguous in the file and the writes can be combined.
+		 */
+		nsegs = (len + LTS_SEGMENT_SIZE - 1) / LTS_SEGMENT_SIZE;
+		memset(lts->compressBuf + len, 0, nsegs * LTS_SEGMENT_SIZE - len);
+		data = lts->compressBuf;
+	}
+
+	if (blocknum >= lts->blockMapLen)
+	{
+		long		oldlen = lts->blockMapLen;
+
+		while (blocknum >= lts->blockMapLen)
+			lts->blockMapLen *= 2;
+		lts->blockMap = (LtsBlockLoc *) repalloc(lts->blockMap,
+												 lts->blockMapLen * sizeof(LtsBlockLoc));
+		memset(lts->blockMap + oldlen, 0xFF,
+			   (lts->blockMapLen - oldlen) * sizeof(LtsBlockLoc));
+	}
+
+	/* a block is normally released before it is written again */
+	ltsReleaseSegments(lts, blocknum);
+
+	loc = &lts->blockMap[blocknum];
+	loc->seg = ltsGetFreeSegments(lts, nsegs);
+	loc->len = len;
+
+	if (BufFileSeek(lts->pfile, 0 /* fileno */, loc->seg * LTS_SEGMENT_SIZE, SEEK_SET) != 0 ||
+		BufFileWrite(lts->pfile, data, nsegs * LTS_SEGMENT_SIZE) != nsegs * LTS_SEGMENT_SIZE)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write block " INT64_FORMAT  " of temporary file: %m",
+						blocknum)));
+	}
+}
+
+/*
+ * Read and decompress a block written by ltsWriteCompressedBlock().
+ */
+static void
+ltsReadCompressedBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
+{
+	LtsBlockLoc *loc;
+	size_t		ret;
+
+	if (blocknum >= lts->blockMapLen || lts->blockMap[blocknum].seg < 0)
+		elog(ERROR, "block " INT64_FORMAT " of compressed temporary file was not written",
+			 blocknum);
+	loc = &lts->blockMap[blocknum];
+
+	if (loc->len == BLCKSZ)
+	{
+		if (BufFileReadAt(lts->pfile, loc->seg * LTS_SEGMENT_SIZE, buffer, BLCKSZ) != BLCKSZ)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read block " INT64_FORMAT  " of temporary file: %m",
+							blocknum)));
+		return;
+	}
+
+	if (BufFileReadAt(lts->pfile, loc->seg * LTS_SEGMENT_SIZE,
+					  lts->compressBuf, loc->len) != loc->len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read block " INT64_FORMAT  " of temporary file: %m",
+						blocknum)));
+
+	ret = ZSTD_decompressDCtx(lts->zstd_context->dctx, buffer, BLCKSZ,
+							  lts->compressBuf, loc->len);
+	if (ZSTD_isError(ret))
+		elog(ERROR, "could not decompress block " INT64_FORMAT " of temporary file: %s",
+			 blocknum, ZSTD_getErrorName(ret));
+	if (ret != BLCKSZ)
+		elog(ERROR, "block " INT64_FORMAT " of compressed temporary file has wrong size %zu",
+			 blocknum, ret);
+}
+
+#else		/* HAVE_LIBZSTD */
+
+/*
+ * gp_workfile_compression cannot be enabled without libzstd, so these are
+ * never called.
+ */
+static void
+ltsStartCompression(LogicalTapeSet *lts)
+{
+	elog(ERROR, "zstandard compression not supported by this build");
+}
+static void
+ltsWriteCompressedBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
+{
+	elog(ERROR, "zstandard compression not supported by this build");
+}
+static void
+ltsReadCompressedBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
+{
+	elog(ERROR, "zstandard compression not supported by this build");
+}
+
+#endif		/* HAVE_LIBZSTD */
+
 /*
  * qsort comparator for sorting freeBlocks[] into decreasing order.
  */
@@ -331,6 +628,9 @@ ltsReleaseBlock(LogicalTapeSet *lts, int64 blocknum)
 	if (lts->forgetFreeSpace)
 		return;
 
+	if (lts->compressed)
+		ltsReleaseSegments(lts, blocknum);
+
 	/*
 	 * Enlarge freeBlocks array if full.
 	 */
@@ -395,6 +695,7 @@ LogicalTapeSetCreate_Internal(int ntapes)
 	lts->freeBlocksLen = 32;	/* reasonable initial guess */
 	lts->freeBlocks = (long *) palloc(lts->freeBlocksLen * sizeof(long));
 	lts->nFreeBlocks = 0;
+	lts->compressed = false;
 	lts->nTapes = ntapes;
 
 	/*
@@ -418,6 +719,14 @@ LogicalTapeSetCreate(int ntapes)
 	LogicalTapeSet *lts = LogicalTapeSetCreate_Internal(ntapes);
 	lts->pfile = BufFileCreateTemp("Sort", false /* interXact */);
 
+	/*
+	 * Only private tape sets are compressed. A tape set in a named file is
+	 * read by other processes from its dumped state, which doesn't include
+	 * the block map.
+	 */
+	if (gp_workfile_compression)
+		ltsStartCompression(lts);
+
 	return lts;
 }
 
@@ -442,6 +751,21 @@ LogicalTapeSetClose(LogicalTapeSet *lts, workfile_set *workset)
 	BufFileClose(lts->pfile);
 	if(lts->freeBlocks)
 		pfree(lts->freeBlocks);
+	if (lts->compressed)
+	{
+		int			i;
+
+		for (i = 0; i < LTS_SEGS_PER_BLOCK; i++)
+		{
+			if (lts->freeRuns[i].runs)
+				pfree(lts->freeRuns[i].runs);
+		}
+		pfree(lts->blockMap);
+		pfree(lts->compressBuf);
+#ifdef HAVE_LIBZSTD
+		zstd_free_context(lts->zstd_context);
+#endif
+	}
 	pfree(lts);
 }
 
@@ -755,10 +1079,14 @@ LogicalTapeUnfrozenTell(LogicalTapeSet *lts, LogicalTape *lt, LogicalTapePos *po
 
 /*
  * Obtain total disk space currently used by a LogicalTapeSet, in blocks.
+ *
+ * For a compressed tape set, this is the space actually taken in the file.
  */
 long
 LogicalTapeSetBlocks(LogicalTapeSet *lts)
 {
+	if (lts->compressed)
+		return (lts->nFileSegs + LTS_SEGS_PER_BLOCK - 1) / LTS_SEGS_PER_BLOCK;
 	return lts->nFileBlocks;
 }
 
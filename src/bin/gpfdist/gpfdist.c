@@ -172,7 +172,10 @@ static struct
 	struct transform* trlist; /* transforms from config file */
 	const char* ssl; /* path to certificates in case we use gpfdist with ssl */
 	int			w; /* The time used for session timeout in seconds */
-} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0 };
+	int			prefetch; /* # of blocks to read ahead per session, 0 to disable */
+} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0, 0 };
+
+#define GPFDIST_MAX_PREFETCH 64
 
 
 typedef union address
@@ -208,6 +211,43 @@ static struct
 	int 			wdtimer; /* Kill gpfdist after k seconds of inactivity. 0 to disable. */
 } gcb;
 
+#ifndef WIN32
+/*
+ * Read-ahead state of a GET session (--prefetch). A reader thread fills a
+ * small ring of line-aligned blocks from the session's fstream, so that
+ * reading and decompressing the file overlaps with sending earlier blocks
+ * to the segments. While the thread runs, only it touches the fstream.
+ *
+ * The state is malloc'ed rather than taken from the session pool: when the
+ * session ends, the thread is detached and owns the state and the fstream,
+ * and frees them once its read in progress is done.
+ */
+typedef struct prefetch_block_t prefetch_block_t;
+struct prefetch_block_t
+{
+	char*			data;
+	int				size;		/* fstream_read() result, 0 is EOF, < 0 error */
+	apr_int64_t		read_bytes;	/* compressed bytes consumed by this block */
+	struct fstream_filename_and_offset fos;
+};
+
+typedef struct prefetch_t prefetch_t;
+struct prefetch_t
+{
+	pthread_t		thread;
+	pthread_mutex_t	mutex;
+	pthread_cond_t	cond;
+	fstream_t*		fstream;	/* the session's fstream */
+	prefetch_block_t* blocks;	/* ring of opt.prefetch blocks */
+	int				head;		/* next block to hand out */
+	int				count;		/* # of filled blocks in the ring */
+	int				done;		/* reader thread has hit EOF or an error */
+	int				stop;		/* reader thread must clean up and exit */
+	char*			line_delim_str;
+	int				line_delim_length;
+};
+#endif
+
 /*  A session */
 typedef struct session_t session_t;
 struct session_t
@@ -231,6 +271,9 @@ struct session_t
 	struct timeval 	tm;             /* timeout for struct event */
 	struct event   	ev;             /* event we are watching for this session*/
 	apr_hash_t		*requests;
+#ifndef WIN32
+	prefetch_t*		prefetch;		/* read-ahead state, NULL if not used */
+#endif
 };
 
 /*  An http request */
@@ -343,6 +386,10 @@ static void session_detach(request_t* r);
 static void session_end(session_t* s, int error);
 static void session_free(session_t* s);
 static void session_active_segs_dump(session_t* session);
+#ifndef WIN32
+static void session_start_prefetch(session_t* session, const request_t* r);
+static void session_stop_prefetch(session_t* session);
+#endif
 static int session_active_segs_isempty(session_t* session);
 static int request_validate(request_t *r);
 static int request_set_path(request_t *r, const char* d, char* p, char* pp, char* path);
@@ -501,7 +548,7 @@ static void usage_error(const char* msg, int print_usage)
 		{
 			fprintf(stderr,
 					"gpfdist -- file distribution web server\n\n"
-						"usage: gpfdist [--ssl <certificates_directory>] [-d <directory>] [-p <http(s)_port>] [-l <log_file>] [-t <timeout>] [-v | -V | -s] [-m <maxlen>] [-w <timeout>]"
+						"usage: gpfdist [--ssl <certificates_directory>] [-d <directory>] [-p <http(s)_port>] [-l <log_file>] [-t <timeout>] [-v | -V | -s] [-m <maxlen>] [-w <timeout>] [--prefetch <blocks>]"
 #ifdef GPFXDIST
 					    "[-c file]"
 #endif
@@ -527,7 +574,11 @@ static void usage_error(const char* msg, int print_usage)
 					    "        -c file    : configuration file for transformations\n"
 #endif
 						"        --version  : print version information\n"
-						"        -w timeout : timeout in seconds before close target file\n\n");
+						"        -w timeout : timeout in seconds before close target file\n"
+#ifndef WIN32
+						"        --prefetch n : read up to n blocks ahead of the segments, default is 0 (disabled)\n"
+#endif
+						"\n");
 		}
 	}
 
@@ -590,6 +641,7 @@ static void parse_command_line(int argc, const char* const argv[],
 #endif
 	{ "version", 256, 0, "print version number" },
 	{ NULL, 'w', 1, "wait for session timeout in seconds" },
+	{ "prefetch", 258, 1, "blocks to read ahead per session" },
 	{ 0 } };
 
 	status = apr_getopt_init(&os, pool, argc, argv);
@@ -674,6 +726,15 @@ static void parse_command_line(int argc, const char* const argv[],
 		case 'w':
 			opt.w = atoi(arg);
 			break;
+#ifndef WIN32
+		case 258:
+			opt.prefetch = atoi(arg);
+			break;
+#else
+		case 258:
+			usage_error("--prefetch is not supported on this platform", 0);
+			break;
+#endif
 		}
 	}
 
@@ -695,6 +756,9 @@ static void parse_command_line(int argc, const char* const argv[],
 	if (!is_valid_session_timeout(opt.w))
 		usage_error("Error: -w timeout must be between 1 and 7200, or 0 for no timeout", 0);
 
+	if (opt.prefetch < 0 || opt.prefetch > GPFDIST_MAX_PREFETCH)
+		usage_error("Error: --prefetch must be between 0 and 64", 0);
+
 	/* validate max row length */
     if (! ((GPFDIST_MAX_LINE_LOWER_LIMIT <= opt.m) && (opt.m <= GPFDIST_MAX_LINE_UPPER_LIMIT)))
     	usage_error(GPFDIST_MAX_LINE_MESSAGE, 0);
@@ -1320,22 +1384,64 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 		return 0;
 	}
 
-	gcb.read_bytes -= fstream_get_compressed_position(session->fstream);
+#ifndef WIN32
+	if (session->prefetch)
+	{
+		prefetch_t*			pf = session->prefetch;
+		prefetch_block_t*	b;
 
-	/* read data from our filestream as a chunk with whole data rows */
+		/*
+		 * The reader thread always leaves the block that hit EOF or an
+		 * error in the ring, so this wait ends.
+		 */
+		pthread_mutex_lock(&pf->mutex);
+		while (pf->count == 0)
+			pthread_cond_wait(&pf->cond, &pf->mutex);
+		b = &pf->blocks[pf->head];
+		pthread_mutex_unlock(&pf->mutex);
+
+		size = b->size;
+		fos = b->fos;
+		gcb.read_bytes += b->read_bytes;
+		if (size > 0)
+		{
+			memcpy(retblock->data, b->data, size);
 
-	size = fstream_read(session->fstream, retblock->data, opt.m, &fos, whole_rows, line_delim_str, line_delim_length);
-	delay_watchdog_timer();
+			pthread_mutex_lock(&pf->mutex);
+			pf->head = (pf->head + 1) % opt.prefetch;
+			pf->count--;
+			pthread_cond_signal(&pf->cond);
+			pthread_mutex_unlock(&pf->mutex);
+		}
+		delay_watchdog_timer();
 
-	if (size == 0)
-	{
-		gprintln(NULL, "session_get_block: end session due to EOF");
-		gcb.read_bytes += fstream_get_compressed_size(session->fstream);
-		session_end(session, 0);
-		return 0;
+		if (size == 0)
+		{
+			gprintln(NULL, "session_get_block: end session due to EOF");
+			session_end(session, 0);
+			return 0;
+		}
 	}
+	else
+#endif
+	{
+		gcb.read_bytes -= fstream_get_compressed_position(session->fstream);
+
+		/* read data from our filestream as a chunk with whole data rows */
 
-	gcb.read_bytes += fstream_get_compressed_position(session->fstream);
+		size = fstream_read(session->fstream, retblock->data, opt.m, &fos, whole_rows, line_delim_str, line_delim_length);
+		delay_watchdog_timer();
+
+		if (size == 0)
+		{
+			gprintln(NULL, "session_get_block: end session due to EOF");
+			gcb.read_bytes += fstream_get_compressed_size(session->fstream);
+			session_end(session, 0);
+			return 0;
+		}
+
+		gcb.read_bytes += fstream_get_compressed_position(session->fstream);
+	}
 
 	if (size < 0)
 	{
@@ -1353,6 +1459,137 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 	return 0;
 }
 
+#ifndef WIN32
+static void prefetch_free(prefetch_t* pf)
+{
+	int			i;
+
+	if (pf->blocks)
+	{
+		for (i = 0; i < opt.prefetch; i++)
+			free(pf->blocks[i].data);
+		free(pf->blocks);
+	}
+	free(pf->line_delim_str);
+	free(pf);
+}
+
+static void* prefetch_thread(void* arg)
+{
+	prefetch_t*	pf = (prefetch_t*) arg;
+
+	pthread_mutex_lock(&pf->mutex);
+	while (!pf->stop)
+	{
+		prefetch_block_t*	b;
+		int64_t				pos;
+
+		if (pf->done || pf->count == opt.prefetch)
+		{
+			pthread_cond_wait(&pf->cond, &pf->mutex);
+			continue;
+		}
+
+		/* the slot past the filled ones is ours until count covers it */
+		b = &pf->blocks[(pf->head + pf->count) % opt.prefetch];
+		pthread_mutex_unlock(&pf->mutex);
+
+		memset(&b->fos, 0, sizeof(b->fos));
+		pos = fstream_get_compressed_position(pf->fstream);
+		b->size = fstream_read(pf->fstream, b->data, opt.m, &b->fos, 1,
+							   pf->line_delim_str, pf->line_delim_length);
+		if (b->size == 0)
+			b->read_bytes = fstream_get_compressed_size(pf->fstream) - pos;
+		else
+			b->read_bytes = fstream_get_compressed_position(pf->fstream) - pos;
+
+		pthread_mutex_lock(&pf->mutex);
+		pf->count++;
+		if (b->size <= 0)
+			pf->done = 1;
+		pthread_cond_signal(&pf->cond);
+	}
+	pthread_mutex_unlock(&pf->mutex);
+
+	/* the session is gone and has handed everything over to us */
+	fstream_close(pf->fstream);
+	pthread_cond_destroy(&pf->cond);
+	pthread_mutex_destroy(&pf->mutex);
+	prefetch_free(pf);
+
+	return NULL;
+}
+
+/*
+ * Start reading blocks ahead for a new GET session. All requests of a
+ * session come from the same external table, so the line delimiter of the
+ * first request is used for the whole session. If the thread can't be
+ * started, the session just reads synchronously.
+ */
+static void session_start_prefetch(session_t* session, const request_t* r)
+{
+	prefetch_t*	pf;
+	int			i;
+
+	if (!(pf = calloc(1, sizeof(prefetch_t))) ||
+		!(pf->blocks = calloc(opt.prefetch, sizeof(prefetch_block_t))))
+		goto nomem;
+	for (i = 0; i < opt.prefetch; i++)
+	{
+		if (!(pf->blocks[i].data = malloc(opt.m)))
+			goto nomem;
+	}
+	if (!(pf->line_delim_str = malloc(r->line_delim_length + 1)))
+		goto nomem;
+	if (r->line_delim_length > 0)
+		memcpy(pf->line_delim_str, r->line_delim_str, r->line_delim_length);
+	pf->line_delim_str[r->line_delim_length] = '\0';
+	pf->line_delim_length = r->line_delim_length;
+	pf->fstream = session->fstream;
+
+	pthread_mutex_init(&pf->mutex, NULL);
+	pthread_cond_init(&pf->cond, NULL);
+
+	if (pthread_create(&pf->thread, NULL, prefetch_thread, pf) != 0)
+	{
+		gwarning(r, "could not start read-ahead thread, reading synchronously");
+		pthread_cond_destroy(&pf->cond);
+		pthread_mutex_destroy(&pf->mutex);
+		prefetch_free(pf);
+		return;
+	}
+	session->prefetch = pf;
+	return;
+
+nomem:
+	gwarning(r, "out of memory in session_start_prefetch, reading synchronously");
+	if (pf)
+		prefetch_free(pf);
+}
+
+/*
+ * Hand the session's fstream over to its reader thread, and tell the thread
+ * to close it and exit once its read in progress is done. This doesn't wait
+ * for the thread, so the event loop never blocks on a slow read.
+ */
+static void session_stop_prefetch(session_t* session)
+{
+	prefetch_t*	pf = session->prefetch;
+
+	if (!pf)
+		return;
+
+	pthread_mutex_lock(&pf->mutex);
+	pf->stop = 1;
+	pthread_cond_signal(&pf->cond);
+	pthread_mutex_unlock(&pf->mutex);
+
+	pthread_detach(pf->thread);
+	session->prefetch = NULL;
+	session->fstream = 0;
+}
+#endif
+
 /* finish the session - close the file */
 static void session_end(session_t* session, int error)
 {
@@ -1361,6 +1598,10 @@ static void session_end(session_t* session, int error)
 	if (error)
 		session->is_error = error;
 
+#ifndef WIN32
+	session_stop_prefetch(session);
+#endif
+
 	if (session->fstream)
 	{
 		gprintln(NULL, "close fstream");
@@ -1374,6 +1615,10 @@ static void session_free(session_t* session)
 {
 	gprintln(NULL, "free session %s", session->key);
 
+#ifndef WIN32
+	session_stop_prefetch(session);
+#endif
+
 	if (session->fstream)
 	{
 		fstream_close(session->fstream);
@@ -1658,6 +1903,21 @@ static int session_attach(request_t* r)
 		apr_hash_set(gcb.session.tab, session->key, APR_HASH_KEY_STRING, session);
 
 		gprintlnif(r, "new session (%ld): (%s, %s)", session->id, session->path, session->tid);
+
+#ifndef WIN32
+		/*
+		 * Only read ahead from regular files. Named pipes and transforms
+		 * may stall for a long time, or have a writer that expects to be
+		 * read at the pace of the segments. Keep those on the synchronous
+		 * path.
+		 */
+		if (opt.prefetch > 0 && session->is_get
+#ifdef GPFXDIST
+			&& !r->trans.command
+#endif
+			&& fstream_is_regular_files(session->fstream))
+			session_start_prefetch(session, r);
+#endif
 	}
 
 	/* found a session in hashtable*/
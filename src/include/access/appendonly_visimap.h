@@ -39,6 +39,70 @@
  * Data structure for the ao visibility map processing.
  *
  */
+/*
+ * Ranges with at most this many hidden tuples keep the sorted offsets of
+ * the tuples instead of a bitmap.
+ */
+#define APPENDONLY_VISIMAP_CACHE_MAX_OFFSETS 512
+
+/*
+ * The hidden tuples of one range of APPENDONLY_VISIMAP_MAX_RANGE rows,
+ * i.e. of one visimap entry.
+ */
+typedef struct AppendOnlyVisimapCacheRange
+{
+	int64		firstRowNum;
+
+	int			nhidden;
+
+	/*
+	 * Sorted row offsets if nhidden <= APPENDONLY_VISIMAP_CACHE_MAX_OFFSETS,
+	 * else NULL.
+	 */
+	uint16	   *offsets;
+
+	/*
+	 * A bitmap of APPENDONLY_VISIMAP_MAX_RANGE bits otherwise.
+	 */
+	bitmapword *words;
+} AppendOnlyVisimapCacheRange;
+
+/*
+ * The hidden tuples of the segment file a scan is reading, loaded at once
+ * when the scan reaches the segment file.  Checking a tuple is then a bit
+ * test instead of a visimap entry lookup, and nothing at all if the segment
+ * file has no hidden tuples.
+ */
+typedef struct AppendOnlyVisimapCache
+{
+	/*
+	 * Set by AppendOnlyVisimap_EnableCache().
+	 */
+	bool		enabled;
+
+	/*
+	 * Segment file loaded, or -1. If loaded is false, its hidden tuples did
+	 * not fit in work_mem, and the segment file is checked entry by entry.
+	 */
+	int32		segno;
+	bool		loaded;
+
+	/*
+	 * Ranges with hidden tuples, by first row number.
+	 */
+	int			nranges;
+	AppendOnlyVisimapCacheRange *ranges;
+
+	/*
+	 * First row number of the last range looked up, and its index in
+	 * ranges, or -1 if it has no hidden tuples.
+	 */
+	int64		curFirstRowNum;
+	int			curRange;
+
+	MemoryContext memoryContext;
+} AppendOnlyVisimapCache;
+
 typedef struct AppendOnlyVisimap
 {
 	/*
@@ -57,6 +121,11 @@ typedef struct AppendOnlyVisimap
 	 */
 	AppendOnlyVisimapStore visimapStore;
 
+	/*
+	 * Hidden tuples of the current segment file, for sequential scans.
+	 */
+	AppendOnlyVisimapCache cache;
+
 } AppendOnlyVisimap;
 
 /*
@@ -105,6 +174,9 @@ void AppendOnlyVisimap_Init(
 					   LOCKMODE lockmode,
 					   Snapshot appendonlyMetaDataSnapshot);
 
+void AppendOnlyVisimap_EnableCache(
+							  AppendOnlyVisimap *visiMap);
+
 bool AppendOnlyVisimap_IsVisible(
 							AppendOnlyVisimap *visiMap,
 							AOTupleId *tupleId);
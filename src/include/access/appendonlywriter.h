@@ -201,6 +201,13 @@ typedef struct AppendOnlyWriterData
 {
 	int			num_existing_aorels;	/* Current # of recorded entries for
 										 * AO relations */
+	int			num_insert_waiters;	/* # of inserts waiting for a segfile */
+
+	/*
+	 * The relation each backend waits for a segfile of in SetSegnoForWrite,
+	 * or InvalidOid, indexed by pgprocno.  MaxBackends entries.
+	 */
+	Oid			insert_waiting_for[FLEXIBLE_ARRAY_MEMBER];
 } AppendOnlyWriterData;
 extern AppendOnlyWriterData *AppendOnlyWriter;
 
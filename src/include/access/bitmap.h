@@ -391,6 +391,9 @@ typedef struct BMBuildLovData
 } BMBuildLovData;
 
 
+/* opaque type known only within bitmapinsert.c */
+typedef struct BMSpool BMSpool;
+
 /*
  * the state for index build 
  */
@@ -426,6 +429,12 @@ typedef struct BMBuildState
 	 */
 	BMTidBuildBuf	*bm_tidLocsBuffer;
 
+	/*
+	 * When not NULL, the index tuples are sorted on (key, tid) here instead,
+	 * and each bitmap vector is written out in one go at the end.
+	 */
+	BMSpool			*bm_spool;
+
 	double 			ituples;	/* the number of index tuples */
 	bool			use_wal;	/* whether or not we write WAL records */
 } BMBuildState;
@@ -769,6 +778,8 @@ extern void _bitmap_doinsert(Relation rel, ItemPointerData ht_ctid,
 							 Datum *attdata, bool *nulls);
 extern void _bitmap_write_alltids(Relation rel, BMTidBuildBuf *tids,
 						  		  bool use_wal);
+extern BMSpool *_bitmap_spoolinit(Relation heap, Relation index);
+extern void _bitmap_write_spool(Relation rel, BMBuildState *state);
 
 /* bitmaputil.c */
 extern BMLOVItem _bitmap_formitem(uint64 currTidNumber);
@@ -58,6 +58,7 @@ extern TransactionId DistributedLog_AdvanceOldestXmin(TransactionId oldestInProg
 								 DistributedTransactionTimeStamp distribTimeStamp,
 								 DistributedTransactionId oldestDistribXid);
 extern TransactionId DistributedLog_GetOldestXmin(TransactionId oldestLocalXmin);
+extern TransactionId DistributedLog_PeekOldestXmin(void);
 
 extern Size DistributedLog_ShmemBuffers(void);
 extern Size DistributedLog_ShmemSize(void);
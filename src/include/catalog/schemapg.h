@@ -0,0 +1 @@
+/root/repo/src/backend/catalog/schemapg.h
\ No newline at end of file
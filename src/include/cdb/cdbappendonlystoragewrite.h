@@ -21,6 +21,65 @@
 #include "cdb/cdbbufferedappend.h"
 #include "utils/palloc.h"
 #include "storage/fd.h"
+#include "storage/gp_compress.h"
+
+/*
+ * Compression library called by the background compression threads.
+ */
+typedef enum AppendOnlyStorageWriteCompressLib
+{
+	AOCompressLib_Zlib,
+	AOCompressLib_Zstd
+} AppendOnlyStorageWriteCompressLib;
+
+/*
+ * State of a block handed to the background compression threads.
+ */
+typedef enum AppendOnlyStorageWritePendingState
+{
+	AOPendingBlock_None = 0,	/* no block outstanding */
+	AOPendingBlock_Queued,		/* waiting for, or being compressed by, a
+								 * thread */
+	AOPendingBlock_Compressed	/* compressed, not yet appended to the file */
+} AppendOnlyStorageWritePendingState;
+
+/*
+ * A block whose compression was handed off by ~_FinishBuffer.  It is
+ * appended to the segment file, in order, before anything else is written
+ * with the same AppendOnlyStorageWrite.
+ */
+typedef struct AppendOnlyStorageWritePending
+{
+	/* Set before the block is queued; read by the compression thread. */
+	uint8	   *sourceData;
+	int32		sourceLen;
+	uint8	   *compressedBuffer;
+	int32		compressedBufferLen;
+	AppendOnlyStorageWriteCompressLib compressLib;
+	int			compressLevel;
+#ifdef HAVE_LIBZSTD
+	zstd_context *zstdContext;
+#endif
+
+	/*
+	 * Set by the compression thread.  compressError is a static message if
+	 * the library failed; it is reported by the inserting process.
+	 */
+	int32		compressedLen;
+	const char *compressError;
+
+	/* What ~_FinishBuffer was given, to make the header with. */
+	AoHeaderKind aoHeaderKind;
+	int32		completeHeaderLen;
+	bool		isFirstRowNumSet;
+	int64		firstRowNum;
+	int			executorBlockKind;
+	int			rowCount;
+
+	/* Protected by the compression pool's mutex. */
+	AppendOnlyStorageWritePendingState state;
+	struct AppendOnlyStorageWritePending *next;
+} AppendOnlyStorageWritePending;
 
 /*
  * This structure contains write session information.  Consider the fields
@@ -174,6 +233,17 @@ typedef struct AppendOnlyStorageWrite
 
 	bool needsWAL;
 
+	/*
+	 * When true, ~_FinishBuffer queues compressed blocks for the background
+	 * compression threads instead of compressing them itself.  The block in
+	 * flight is described by 'pending', and its uncompressed contents are
+	 * in 'pendingUncompressedBuffer' while ~_GetBuffer hands out
+	 * 'uncompressedBuffer' for the next one.
+	 */
+	bool		backgroundCompress;
+	uint8	   *pendingUncompressedBuffer;
+	AppendOnlyStorageWritePending pending;
+
 } AppendOnlyStorageWrite;
 
 extern void AppendOnlyStorageWrite_Init(AppendOnlyStorageWrite *storageWrite,
@@ -184,6 +254,8 @@ extern void AppendOnlyStorageWrite_Init(AppendOnlyStorageWrite *storageWrite,
 										AppendOnlyStorageAttributes *storageAttributes,
 										bool needsWAL);
 extern void AppendOnlyStorageWrite_FinishSession(AppendOnlyStorageWrite *storageWrite);
+extern bool AppendOnlyStorageWrite_EnableBackgroundCompress(AppendOnlyStorageWrite *storageWrite);
+extern void AtAbort_AppendOnlyStorageWrite(void);
 
 extern void AppendOnlyStorageWrite_TransactionCreateFile(AppendOnlyStorageWrite *storageWrite,
 											 RelFileNodeBackend *relFileNode,
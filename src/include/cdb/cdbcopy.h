@@ -23,6 +23,15 @@
 
 #define COPYOUT_CHUNK_SIZE 16 * 1024
 
+/*
+ * In COPY FROM, rows headed for the same segment are accumulated and sent
+ * as one CopyData message once this many bytes are pending. The per-segment
+ * budget is shrunk on very wide clusters, see makeCdbCopy().
+ */
+#define COPYIN_BATCH_SIZE		(64 * 1024)
+#define COPYIN_BATCH_MIN_SIZE	(8 * 1024)
+#define COPYIN_BATCH_TOTAL_SIZE	(16 * 1024 * 1024)
+
 struct CdbDispatcherState;
 struct CopyStateData;
 
@@ -33,6 +42,9 @@ typedef struct CdbCopy
 
 	StringInfoData	copy_out_buf;/* holds a chunk of data from the database */
 
+	StringInfoData *copy_in_bufs;	/* COPY FROM: pending data per segindex */
+	int			copy_in_batch_size;	/* flush a segment's buffer at this size */
+
 	List		*seglist;    	/* segs that currently take part in copy.
 								 * for copy out, once a segment gave away all it's
 								 * data rows, it is taken out of the list */
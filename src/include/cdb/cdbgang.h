@@ -75,6 +75,7 @@ extern Gang *AllocateGang(struct CdbDispatcherState *ds, enum GangType type, Lis
 extern void RecycleGang(Gang *gp, bool forceDestroy);
 extern void DisconnectAndDestroyAllGangs(bool resetSession);
 extern void DisconnectAndDestroyUnusedQEs(void);
+extern void PrespawnGangs(void);
 
 extern void CheckForResetSession(void);
 
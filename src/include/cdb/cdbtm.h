@@ -101,6 +101,12 @@ typedef enum
 	DTX_PROTOCOL_COMMAND_COMMIT_PREPARED,
 	/* for explicit transaction that doesn't write any xlog */
 	DTX_PROTOCOL_COMMAND_ABORT_PREPARED,
+	/*
+	 * Second phase when only the segments that wrote were prepared, see
+	 * gp_dtx_prepare_writers_only: the others finish in one phase
+	 */
+	DTX_PROTOCOL_COMMAND_COMMIT_WRITERS_PREPARED,
+	DTX_PROTOCOL_COMMAND_ABORT_WRITERS_PREPARED,
 	DTX_PROTOCOL_COMMAND_RETRY_COMMIT_PREPARED,
 	DTX_PROTOCOL_COMMAND_RETRY_ABORT_PREPARED,
 	DTX_PROTOCOL_COMMAND_RECOVERY_COMMIT_PREPARED,
@@ -237,6 +243,12 @@ typedef struct TMGXACTLOCAL
 
 	Bitmapset					*dtxSegmentsMap;
 	List						*dtxSegments;
+
+	/* segments whose QE reported writing xlog */
+	Bitmapset					*xlogSegmentsMap;
+
+	/* only the segments in xlogSegmentsMap were sent PREPARE */
+	bool						preparedWritersOnly;
 	List						*waitGxids;
 }	TMGXACTLOCAL;
 
@@ -342,6 +354,7 @@ extern void markCurrentGxactWriterGangLost(void);
 extern bool currentGxactWriterGangLost(void);
 
 extern void addToGxactDtxSegments(struct Gang* gp);
+extern void addToGxactXLogSegments(int segindex);
 
 extern void ClearTransactionState(TransactionId latestXid);
 
@@ -163,6 +163,9 @@ extern int qdPostmasterPort;
 /*How many gangs to keep around from stmt to stmt.*/
 extern int			gp_cached_gang_threshold;
 
+/* Create the writer gang at session start, see PrespawnGangs() */
+extern bool			gp_gang_prespawn;
+
 /*
  * gp_reject_percent_threshold
  *
@@ -602,6 +605,12 @@ extern bool gp_adjust_selectivity_for_outerjoins;
 extern int gp_hashjoin_tuples_per_bucket;
 extern int gp_hashagg_groups_per_bucket;
 
+/*
+ * Hash join: size batches from the inner tuples actually seen, keep as many
+ * batches in memory as fit, and join unsplittable batches in chunks.
+ */
+extern bool gp_hashjoin_adaptive_batches;
+
 /*
  * Damping of selectivities of clauses which pertain to the same base
  * relation; compensates for undetected correlation
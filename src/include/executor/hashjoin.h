@@ -208,6 +208,42 @@ typedef struct HashJoinTableData
 
     HashJoinState * hjstate; /* reference to the enclosing HashJoinState */
     bool first_pass; /* Is this the first pass (pre-rescan) */
+
+	/*
+	 * Adaptive batching (gp_hashjoin_adaptive_batches).  The table starts
+	 * with a single batch, and nbatch is chosen when it first overflows.
+	 * During the first pass, batchResident[] tells which batches are kept in
+	 * the in-memory hash table, and batchSpace[] how much of spaceUsed each
+	 * of them takes.  Batch 0 is always resident, and a resident batch has
+	 * no batch files.  Both arrays are NULL outside the first pass, when
+	 * only curbatch is resident.
+	 */
+	bool		adaptive;		/* is adaptive batching enabled? */
+	bool	   *batchResident;	/* -> array[0..nbatch-1], or NULL */
+	Size	   *batchSpace;		/* -> array[0..nbatch-1], or NULL */
+	double		innerRowsEstimate;	/* planner's inner row count, this segment */
+
+	/*
+	 * A batch that does not fit in memory and cannot be split any further is
+	 * joined in chunks: each chunk of its inner file is loaded in turn, and
+	 * the outer batch file is scanned again for each of them.  outerMatched
+	 * is a bitmap, indexed by the position of the tuple in the outer batch
+	 * file, of the outer tuples that found a match in an earlier chunk.
+	 */
+	bool		chunked;		/* is curbatch being joined in chunks? */
+	bool		moreChunks;		/* is part of its inner file still unread? */
+	int			chunkno;		/* # of the chunk in memory, from 0 */
+	uint64		outerTupleNo;	/* # of outer tuples read in this chunk */
+	bits8	   *outerMatched;	/* outer tuples matched in earlier chunks */
+	Size		outerMatchedLen;	/* allocated length of outerMatched */
 }	HashJoinTableData;
 
+/*
+ * Is the given batch kept in the in-memory hash table?
+ */
+#define HashJoinBatchIsResident(hashtable, batchno) \
+	((hashtable)->batchResident != NULL ? \
+	 (hashtable)->batchResident[batchno] : \
+	 (batchno) == (hashtable)->curbatch)
+
 #endif   /* HASHJOIN_H */
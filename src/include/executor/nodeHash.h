@@ -51,6 +51,7 @@ extern bool ExecScanHashTableForUnmatched(HashJoinState *hjstate,
 							  ExprContext *econtext);
 extern void ExecHashTableReset(HashState *hashState, HashJoinTable hashtable);
 extern void ExecHashTableResetMatchFlags(HashJoinTable hashtable);
+extern void ExecHashTableFitBatch(HashJoinTable hashtable, int64 innerBytes);
 extern void ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 						uint64 operatorMemKB,
 						int *numbuckets,
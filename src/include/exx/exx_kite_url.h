@@ -14,7 +14,19 @@ typedef struct URL_KITE_FILE
 
 	int64_t seq_number;
 
-	kite_handle_t *hdl;
+	/*
+	 * One request per sub-fragment of this segment's fragment.  They are all
+	 * submitted up front, so that the Kite server produces them concurrently,
+	 * and read one after the other; hdl[curr] is the one being read.
+	 * Allocated by url_kite_alloc_handles(), which registers them with the
+	 * current resource owner.
+	 */
+	int nhdl;
+	int curr;
+	kite_handle_t **hdl;
+	struct kitehandles_t *handles;
 } URL_KITE_FILE;
 
+extern void url_kite_alloc_handles(URL_KITE_FILE *file, int n);
+
 #endif
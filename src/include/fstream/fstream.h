@@ -52,5 +52,6 @@ fstream_t* fstream_open(const char* path, const struct fstream_options* options,
 						int* response_code, const char** response_string);
 void fstream_close(fstream_t* fs);
 bool_t fstream_is_win_pipe(fstream_t *fs);
+bool_t fstream_is_regular_files(fstream_t *fs);
 
 #endif
@@ -815,6 +815,7 @@ typedef enum EXX_BCLV {
         BCLV_NONE,
         BCLV_1,
         BCLV_QUAL,
+        BCLV_TOPN,
         BCLV_PROJ,
         BCLV_BLOOM,
         BCLV_AGG,
@@ -198,6 +198,11 @@ extern void tbm_union(TIDBitmap *a, const TIDBitmap *b);
 extern void tbm_intersect(TIDBitmap *a, const TIDBitmap *b);
 extern bool tbm_is_empty(const TIDBitmap *tbm);
 
+extern void tbm_union_words(tbm_bitmapword *dst, const tbm_bitmapword *src,
+				int nwords);
+extern bool tbm_intersect_words(tbm_bitmapword *dst, const tbm_bitmapword *src,
+					int nwords);
+
 extern TBMIterator *tbm_begin_iterate(TIDBitmap *tbm);
 extern TBMIterateResult *tbm_iterate(TBMIterator *iterator);
 extern void tbm_end_iterate(TBMIterator *iterator);
@@ -47,6 +47,14 @@ typedef struct
 	bool isAnyValuePossible;
 } PossibleValueSet;
 
+/*
+ * Upper bound on the number of values we are willing to collect into a
+ * PossibleValueSet, e.g. from a long IN-list.  Past this the set is not
+ * worth hashing for direct dispatch, so we give up and report that any
+ * value is possible rather than finishing the expansion.
+ */
+#define MAX_POSSIBLE_VALUE_SET_SIZE		10000
+
 extern PossibleValueSet DeterminePossibleValueSet(Node *clause, Node *variable, Oid opfamily);
 
 /* returns a newly allocated list */
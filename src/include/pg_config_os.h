@@ -0,0 +1 @@
+../../src/include/port/linux.h
\ No newline at end of file
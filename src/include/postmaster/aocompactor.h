@@ -0,0 +1,27 @@
+/*-------------------------------------------------------------------------
+ *
+ * aocompactor.h
+ *	  Background compaction of append-optimized tables.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/postmaster/aocompactor.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef AOCOMPACTOR_H
+#define AOCOMPACTOR_H
+
+/* GUCs */
+extern bool gp_appendonly_compaction_worker;
+extern int	gp_appendonly_compaction_worker_naptime;
+extern int	gp_appendonly_compaction_worker_cost_delay;
+
+extern Size AOCompactorShmemSize(void);
+extern void AOCompactorShmemInit(void);
+
+extern bool AOCompactorLauncherStartRule(Datum main_arg);
+extern void AOCompactorLauncherMain(Datum main_arg);
+extern void AOCompactorWorkerMain(Datum main_arg);
+
+#endif   /* AOCOMPACTOR_H */
@@ -91,6 +91,6 @@ extern bool IsUnderMasterDispatchMode(void);
  * GUC check hooks and in RegisterBackgroundWorker().
  */
 #define MAX_BACKENDS	0x7fffff
-#define MaxPMAuxProc	(6 + IC_PROXY_NUM_BGWORKER)
+#define MaxPMAuxProc	(7 + IC_PROXY_NUM_BGWORKER)
 
 #endif   /* _POSTMASTER_H */
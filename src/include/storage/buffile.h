@@ -45,6 +45,7 @@ extern BufFile *BufFileOpenNamedTemp(const char * fileName, bool interXact);
 extern void BufFileClose(BufFile *file);
 extern Size BufFileRead(BufFile *file, void *ptr, Size size);
 extern void *BufFileReadFromBuffer(BufFile *file, Size size);
+extern Size BufFileReadAt(BufFile *file, off_t offset, void *ptr, Size size);
 extern Size BufFileWrite(BufFile *file, const void *ptr, Size size);
 
 extern int	BufFileSeek(BufFile *file, int fileno, off_t offset, int whence);
@@ -61,6 +62,7 @@ extern void BufFileSuspend(BufFile *buffile);
 extern void BufFileResume(BufFile *buffile);
 
 extern bool gp_workfile_compression;
+extern bool gp_workfile_async_io;
 extern void BufFilePledgeSequential(BufFile *buffile);
 extern void BufFileSetIsTempFile(BufFile *file, bool isTempFile);
 
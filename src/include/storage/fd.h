@@ -52,6 +52,29 @@ typedef char *FileName;
 
 typedef int File;
 
+/*
+ * A read or write of a File that runs on a helper thread while the caller
+ * goes on, see FileReadAsync() and FileWriteAsync().  The caller owns the
+ * struct and the buffer, and must not touch either until FileWaitAsync()
+ * has returned.
+ */
+typedef struct FileAsyncIO
+{
+	File		file;			/* file the request is in flight on, or 0 */
+	struct FileAsyncIO *fileNext;	/* other requests in flight on the file */
+	struct FileAsyncIO *queueNext;	/* next request for the helper thread */
+
+	bool		isWrite;
+	int			fd;				/* kernel fd, open until the request is done */
+	char	   *buffer;
+	int			amount;
+	off_t		offset;
+
+	bool		done;			/* set by the helper thread */
+	int			result;			/* bytes read or written, or -1 */
+	int			error;			/* errno, if result is -1 */
+} FileAsyncIO;
+
 
 /* GUC parameter */
 extern PGDLLIMPORT int max_files_per_process;
@@ -79,6 +102,9 @@ extern void FileClose(File file);
 extern int	FilePrefetch(File file, off_t offset, int amount);
 extern int	FileRead(File file, char *buffer, int amount);
 extern int	FileWrite(File file, char *buffer, int amount);
+extern int	FileReadAsync(File file, FileAsyncIO *io, char *buffer, int amount, off_t offset);
+extern int	FileWriteAsync(File file, FileAsyncIO *io, char *buffer, int amount, off_t offset);
+extern int	FileWaitAsync(FileAsyncIO *io);
 extern int	FileSync(File file);
 extern int64 FileSeek(File file, int64 offset, int whence);
 extern int64 FileNonVirtualCurSeek(File file);
@@ -116,6 +142,7 @@ extern void SetTempTablespaces(Oid *tableSpaces, int numSpaces);
 extern bool TempTablespacesAreSet(void);
 extern Oid	GetNextTempTableSpace(void);
 extern void AtEOXact_Files(void);
+extern void AtAbort_FileAsyncIO(void);
 extern void AtEOSubXact_Files(bool isCommit, SubTransactionId mySubid,
 				  SubTransactionId parentSubid);
 extern void RemovePgTempFiles(void);
@@ -203,8 +203,31 @@ enum
 	DSB_HAS_NULLBITMAP = 0x1,
 	DSB_HAS_RLE_COMPRESSION = 0x2,
 	DSB_HAS_DELTA_COMPRESSION = 0x4,
+	DSB_HAS_DICTIONARY_COMPRESSION = 0x8,
 };
 
+/*
+ * Dictionary of an Original block of variable-length items, present at the
+ * start of the data when DSB_HAS_DICTIONARY_COMPRESSION is set.
+ *
+ * 8 bytes.  Followed by the distinct items, laid out (and aligned) like the
+ * items of a plain block, and then by one code per non-NULL item: the index
+ * of its value among the distinct items.  Codes are 1 byte when there are at
+ * most DatumStreamBlock_Dictionary_MaxOneByteCodes distinct items and 2 bytes
+ * (little-endian) otherwise.
+ *
+ * Readers that predate the flag cannot read these blocks, so they are only
+ * written when gp_appendonly_dictionary_encoding is turned on.
+ */
+typedef struct DatumStreamBlock_Dictionary
+{
+	int32		entry_count;	/* number of distinct items */
+	int32		entries_size;	/* byte length of the distinct items,
+								 * including alignment padding */
+}	DatumStreamBlock_Dictionary;
+
+#define DatumStreamBlock_Dictionary_MaxOneByteCodes 256
+
 typedef struct DatumStreamBitMapWrite
 {
 	uint8	   *buffer;
@@ -1082,6 +1105,15 @@ typedef struct DatumStreamBlockWrite
 	bool	   *delta_sign;
 	int32		deltas_maxcount;
 
+	/* Dictionary buffers (Original varlena blocks), allocated on first use */
+	uint8	   *dictionary_buffer;
+	int32	   *dictionary_slots;
+	int32		dictionary_slots_count;
+	int32		dictionary_maxcount;
+	int32	   *dictionary_entry_offsets;
+	int32	   *dictionary_entry_lens;
+	uint16	   *dictionary_codes;
+
 	/* EOF of current file */
 	int64		savings;
 	int64		remember_savings;
@@ -1164,6 +1196,14 @@ typedef struct DatumStreamBlockRead
 	bool		delta_block_was_compressed;
 	DatumStreamBitMapRead delta_bitmap;
 
+	/* Dictionary variables (Original varlena blocks) */
+	int32		dictionary_entry_count;
+	int32		dictionary_code_width;
+	int32		dictionary_code_count;	/* codes that fit in the block */
+	uint8	   *dictionary_codesp;
+	uint8	  **dictionary_entries;
+	int32		dictionary_entries_maxcount;
+
 	/*
 	 * Keep less frequently accessed fields down here for possible better CPU data cache
 	 * performance.
@@ -1518,7 +1558,39 @@ DatumStreamBlockRead_AdvanceOrig(DatumStreamBlockRead * dsr)
 		/*
 		 * Advance the item pointer.
 		 */
-		if (dsr->typeInfo.datumlen == -1)
+		if (dsr->typeInfo.datumlen == -1 && dsr->dictionary_entry_count > 0)
+		{
+			int32		code;
+
+			/*
+			 * Dictionary block: the item is the distinct value its code
+			 * refers to.
+			 */
+			if (dsr->physical_datum_index >= dsr->dictionary_code_count)
+				code = -1;
+			else if (dsr->dictionary_code_width == 1)
+				code = dsr->dictionary_codesp[dsr->physical_datum_index];
+			else
+				code = dsr->dictionary_codesp[2 * dsr->physical_datum_index] |
+					(dsr->dictionary_codesp[2 * dsr->physical_datum_index + 1] << 8);
+
+			if (code < 0 || code >= dsr->dictionary_entry_count)
+			{
+				ereport(ERROR,
+						(errmsg("Datum stream block read dictionary code %d for item index %d out of bounds "
+								"(nth %d, logical row count %d, dictionary entry count %d, code count %d)",
+								code,
+								dsr->physical_datum_index,
+								dsr->nth,
+								dsr->logical_row_count,
+								dsr->dictionary_entry_count,
+								dsr->dictionary_code_count),
+						 errdetail_datumstreamblockread(dsr),
+						 errcontext_datumstreamblockread(dsr)));
+			}
+			dsr->datump = dsr->dictionary_entries[code];
+		}
+		else if (dsr->typeInfo.datumlen == -1)
 		{
 			struct varlena *s = (struct varlena *) dsr->datump;
 
@@ -265,6 +265,12 @@ extern bool Debug_appendonly_print_datumstream;
 extern bool Debug_appendonly_print_visimap;
 extern bool Debug_appendonly_print_compaction;
 extern bool Debug_bitmap_print_insert;
+
+/*
+ * Build bitmap indexes by sorting the (key, tid) pairs and writing each
+ * bitmap vector out sequentially.
+ */
+extern bool gp_bitmap_index_sort_build;
 extern bool enable_checksum_on_tables;
 extern int  gp_max_local_distributed_cache;
 extern bool gp_local_distributed_cache_stats;
@@ -282,6 +288,29 @@ extern bool enable_implicit_timeformat_YYYYMMDDHH24MISS;
  * 10% of the tuples are hidden.
  */
 extern int  gp_appendonly_compaction_threshold;
+
+/*
+ * Number of segment files that concurrent inserts into an append-optimized
+ * table take turns on (0 = one segment file per concurrent transaction), and
+ * how long, in milliseconds, an insert waits for one of them before it uses
+ * another segment file.
+ */
+extern int  gp_appendonly_insert_segfile_limit;
+extern int  gp_appendonly_insert_segfile_wait;
+
+/*
+ * Number of threads that compress the blocks of column-oriented tables in the
+ * background while an insert continues (0 = compress in the inserting
+ * process).
+ */
+extern int  gp_appendonly_compress_workers;
+
+/*
+ * Store the variable-length items of a column-oriented block as a dictionary
+ * of distinct values plus codes when that makes the block smaller.  Off by
+ * default, as older releases cannot read such blocks.
+ */
+extern bool gp_appendonly_dictionary_encoding;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	debug_xlog_record_read;
 extern bool Debug_cancel_print;
@@ -298,6 +327,7 @@ extern bool gp_create_table_random_default_distribution;
 extern bool gp_allow_non_uniform_partitioning_ddl;
 extern bool gp_enable_exchange_default_partition;
 extern int  dtx_phase2_retry_count;
+extern bool gp_dtx_prepare_writers_only;
 extern bool gp_log_suboverflow_statement;
 extern bool gp_use_synchronize_seqscans_catalog_vacuum_full;
 
@@ -587,6 +617,9 @@ extern int writable_external_table_bufsize;
 /* Enable passing of query constraints to external table providers */
 extern bool gp_external_enable_filter_pushdown;
 
+/* Number of concurrent requests per segment for kite:// external tables */
+extern int gp_kite_fetch_connections;
+
 /* Enable the Global Deadlock Detector */
 extern bool gp_enable_global_deadlock_detector;
 
@@ -76,4 +76,9 @@ int32		numeric_maximum_size(int32 typmod);
 extern char *numeric_out_sci(Numeric num, int scale);
 extern char *numeric_normalize(Numeric num);
 
+#ifdef HAVE_INT128
+/* EXX_IN_PG */
+extern Numeric exx_decimal128_to_numeric(int128 val, int scale, int32 typmod);
+#endif
+
 #endif   /* _PG_NUMERIC_H_ */
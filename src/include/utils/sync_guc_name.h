@@ -14,6 +14,9 @@
 		"explain_memory_verbosity",
 		"gin_fuzzy_search_limit",
 		"gp_allow_date_field_width_5digits",
+		"gp_appendonly_compress_workers",
+		"gp_appendonly_dictionary_encoding",
+		"gp_bitmap_index_sort_build",
 		"gp_blockdirectory_entry_min_range",
 		"gp_blockdirectory_minipage_size",
 		"gp_debug_linger",
@@ -26,6 +29,7 @@
 		"gp_gpperfmon_send_interval",
 		"gp_hashagg_default_nbatches",
 		"gp_hashagg_groups_per_bucket",
+		"gp_hashjoin_adaptive_batches",
 		"gp_hashjoin_tuples_per_bucket",
 		"gp_ignore_error_table",
 		"gp_indexcheck_insert",
@@ -48,6 +52,7 @@
 		"gp_interconnect_transmit_timeout",
 		"gp_interconnect_type",
 		"gp_interconnect_address_type",
+		"gp_kite_fetch_connections",
 		"gp_log_endpoints",
 		"gp_log_interconnect",
 		"gp_log_resgroup_memory",
@@ -77,6 +82,7 @@
 		"gp_udpic_network_disable_ipv6",
 		"gp_use_synchronize_seqscans_catalog_vacuum_full",
 		"gp_vmem_idle_resource_timeout",
+		"gp_workfile_async_io",
 		"gp_workfile_caching_loglevel",
 		"gp_workfile_compression",
 		"gp_workfile_limit_files_per_query",
@@ -140,6 +140,11 @@
 		"gp_allow_rename_relation_without_lock",
 		"gp_appendonly_compaction",
 		"gp_appendonly_compaction_threshold",
+		"gp_appendonly_compaction_worker",
+		"gp_appendonly_compaction_worker_cost_delay",
+		"gp_appendonly_compaction_worker_naptime",
+		"gp_appendonly_insert_segfile_limit",
+		"gp_appendonly_insert_segfile_wait",
 		"gp_appendonly_verify_block_checksums",
 		"gp_appendonly_verify_write_block",
 		"gp_auth_time_override",
@@ -162,6 +167,7 @@
 		"gp_dispatch_keepalives_interval",
 		"gp_dispatch_keepalives_count",
 		"gp_distinct_grouping_sets_threshold",
+		"gp_dtx_prepare_writers_only",
 		"gp_dtx_recovery_interval",
 		"gp_dtx_recovery_prepared_period",
 		"gp_dynamic_partition_pruning",
@@ -202,6 +208,7 @@
 		"gp_fts_replication_attempt_count",
 		"gp_gang_creation_retry_count",
 		"gp_gang_creation_retry_timer",
+		"gp_gang_prespawn",
 		"gp_global_deadlock_detector_period",
 		"gp_hashagg_streambottom",
 		"gp_heap_require_relhasoids_match",
@@ -0,0 +1,12 @@
+#define PGBINDIR "/usr/local/gpdb/bin"
+#define PGSHAREDIR "/usr/local/gpdb/share/postgresql"
+#define SYSCONFDIR "/usr/local/gpdb/etc/postgresql"
+#define INCLUDEDIR "/usr/local/gpdb/include"
+#define PKGINCLUDEDIR "/usr/local/gpdb/include/postgresql"
+#define INCLUDEDIRSERVER "/usr/local/gpdb/include/postgresql/server"
+#define LIBDIR "/usr/local/gpdb/lib"
+#define PKGLIBDIR "/usr/local/gpdb/lib/postgresql"
+#define LOCALEDIR "/usr/local/gpdb/share/locale"
+#define DOCDIR "/usr/local/gpdb/share/doc//postgresql"
+#define HTMLDIR "/usr/local/gpdb/share/doc//postgresql"
+#define MANDIR "/usr/local/gpdb/share/man"
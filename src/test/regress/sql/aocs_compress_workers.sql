@@ -0,0 +1,66 @@
+--
+-- Inserts into column-oriented tables with gp_appendonly_compress_workers,
+-- which compresses zlib and zstd blocks on background threads.
+--
+set gp_appendonly_compress_workers = 4;
+
+create table aocs_cw_src (a int, b text, c numeric) distributed by (a);
+insert into aocs_cw_src
+  select i, repeat('x', i % 50) || i, i * 2 from generate_series(1, 100000) i;
+
+create table aocs_cw_zlib (a int, b text, c numeric)
+  with (appendonly=true, orientation=column, compresstype=zlib, compresslevel=5)
+  distributed by (a);
+create table aocs_cw_zstd (a int, b text, c numeric)
+  with (appendonly=true, orientation=column, compresstype=zstd, compresslevel=3)
+  distributed by (a);
+-- the block directory is maintained while inserting
+create index aocs_cw_zlib_a on aocs_cw_zlib (a);
+create index aocs_cw_zstd_a on aocs_cw_zstd (a);
+
+insert into aocs_cw_zlib select * from aocs_cw_src;
+insert into aocs_cw_zstd select * from aocs_cw_src;
+
+-- read back
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_cw_zlib;
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_cw_zstd;
+select count(*) from
+  (select * from aocs_cw_src except all select * from aocs_cw_zlib) d;
+select count(*) from
+  (select * from aocs_cw_src except all select * from aocs_cw_zstd) d;
+
+-- index lookups go through the block directory
+set enable_seqscan = off;
+set optimizer_enable_tablescan = off;
+select * from aocs_cw_zlib where a in (1, 4321, 99999) order by a;
+select * from aocs_cw_zstd where a in (1, 4321, 99999) order by a;
+reset enable_seqscan;
+reset optimizer_enable_tablescan;
+
+-- an insert that fails partway, while blocks are being compressed
+insert into aocs_cw_zlib select a, b, c / (a - 100000) from aocs_cw_src;
+insert into aocs_cw_zstd select a, b, c / (a - 100000) from aocs_cw_src;
+
+-- an aborted insert, and one aborted in a subtransaction
+begin;
+insert into aocs_cw_zlib select * from aocs_cw_src;
+rollback;
+begin;
+savepoint s1;
+insert into aocs_cw_zstd select a, b, c / (a - 100000) from aocs_cw_src;
+rollback to savepoint s1;
+insert into aocs_cw_zstd select a + 100000, b, c from aocs_cw_src where a <= 1000;
+commit;
+
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_cw_zlib;
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_cw_zstd;
+set enable_seqscan = off;
+set optimizer_enable_tablescan = off;
+select * from aocs_cw_zstd where a in (1, 100001, 101000) order by a;
+reset enable_seqscan;
+reset optimizer_enable_tablescan;
+
+drop table aocs_cw_src;
+drop table aocs_cw_zlib;
+drop table aocs_cw_zstd;
+reset gp_appendonly_compress_workers;
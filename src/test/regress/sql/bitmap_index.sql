@@ -413,3 +413,46 @@ select * from bm_test where b = 1;
 
 -- clean up
 drop table bm_test;
+
+-- test that a bitmap index built by sorting the index entries finds the
+-- same rows as one built by buffering the tids of each distinct value.
+create table bm_sort_build (a int, b int, c text) with (appendonly=true) distributed by (a);
+insert into bm_sort_build select i, i % 100, case when i % 7 = 0 then null else (i % 13)::text end from generate_series(1, 10000) i;
+set enable_seqscan = off;
+
+set gp_bitmap_index_sort_build = off;
+create index bm_sort_build_b on bm_sort_build using bitmap(b);
+create index bm_sort_build_bc on bm_sort_build using bitmap(b, c);
+select count(*) from bm_sort_build where b = 42;
+select count(*) from bm_sort_build where b = 42 and c = '3';
+select count(*) from bm_sort_build where b = 42 and c is null;
+drop index bm_sort_build_b;
+drop index bm_sort_build_bc;
+
+reset gp_bitmap_index_sort_build;
+create index bm_sort_build_b on bm_sort_build using bitmap(b);
+create index bm_sort_build_bc on bm_sort_build using bitmap(b, c);
+select count(*) from bm_sort_build where b = 42;
+select count(*) from bm_sort_build where b = 42 and c = '3';
+select count(*) from bm_sort_build where b = 42 and c is null;
+
+reset enable_seqscan;
+drop table bm_sort_build;
+
+-- test BitmapAnd and BitmapOr of bitmap indexes whose vectors mix long
+-- runs of fill words with literal words
+create table bm_and_or (a int, b int, c int, d int) with (appendonly=true) distributed by (a);
+insert into bm_and_or select i, i / 10000, i % 5, (i + 5000) / 10000 from generate_series(1, 100000) i;
+create index bm_and_or_b on bm_and_or using bitmap(b);
+create index bm_and_or_c on bm_and_or using bitmap(c);
+create index bm_and_or_d on bm_and_or using bitmap(d);
+set enable_seqscan = off;
+set enable_indexscan = off;
+select count(*) from bm_and_or where b = 3 and c = 1;
+select count(*) from bm_and_or where b = 3 or c = 1;
+select count(*) from bm_and_or where b = 3 and d = 3;
+select count(*) from bm_and_or where b = 3 and d = 5;
+select count(*) from bm_and_or where (b = 3 or b = 7) and c = 4;
+reset enable_seqscan;
+reset enable_indexscan;
+drop table bm_and_or;
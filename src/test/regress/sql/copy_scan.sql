@@ -0,0 +1,75 @@
+--
+-- COPY FROM skips over runs of ordinary bytes 16 at a time, see
+-- CopyScanSpecial() in copy.c.  Put delimiters, quotes, escapes and line
+-- ends on and around the 16-byte boundaries of the fields, the lines and
+-- the input buffer, and check that the data comes back unchanged.
+--
+create table copy_scan_src (id int, a text, b text) distributed by (id);
+insert into copy_scan_src
+select n * 10 + k, repeat('x', n) || s || repeat('y', n % 17), s || repeat('z', 33 - n) || s
+from generate_series(0, 33) n,
+	 unnest(array[E'\t', E'\\', E'\n', E'\r', E'\r\n', '"', ',', '|', '''']) with ordinality as v(s, k);
+create table copy_scan_dst (id int, a text, b text) distributed by (id);
+create view copy_scan_check as
+select (select count(*) from copy_scan_dst) as loaded,
+	   (select count(*) from
+			((select * from copy_scan_src except all select * from copy_scan_dst)
+			 union all
+			 (select * from copy_scan_dst except all select * from copy_scan_src)) d) as mismatches;
+
+-- text
+copy copy_scan_src to '/tmp/copy_scan.txt';
+copy copy_scan_dst from '/tmp/copy_scan.txt';
+select * from copy_scan_check;
+truncate copy_scan_dst;
+
+copy copy_scan_src to '/tmp/copy_scan.txt' with delimiter '|';
+copy copy_scan_dst from '/tmp/copy_scan.txt' with delimiter '|';
+select * from copy_scan_check;
+truncate copy_scan_dst;
+
+-- csv, quoted fields span line ends
+copy copy_scan_src to '/tmp/copy_scan.csv' with csv;
+copy copy_scan_dst from '/tmp/copy_scan.csv' with csv;
+select * from copy_scan_check;
+truncate copy_scan_dst;
+
+copy copy_scan_src to '/tmp/copy_scan.csv' with csv delimiter '|' quote '''' escape E'\\';
+copy copy_scan_dst from '/tmp/copy_scan.csv' with csv delimiter '|' quote '''' escape E'\\';
+select * from copy_scan_check;
+truncate copy_scan_dst;
+
+-- CRLF line ends right at the boundary, in text and in csv
+create table copy_scan_eol (id int, a text) distributed by (id);
+\!/usr/bin/printf '1\t0123456789abc\r\n2\t0123456789abcd\r\n3\t0123456789abcde\r\n' > /tmp/copy_scan_crlf.txt;
+copy copy_scan_eol from '/tmp/copy_scan_crlf.txt';
+\!/usr/bin/printf '4,"0123456789ab,\r\nc"\r\n5,"0123456789abc""d"\r\n' > /tmp/copy_scan_crlf.csv;
+copy copy_scan_eol from '/tmp/copy_scan_crlf.csv' with csv;
+select id, replace(replace(a, E'\r', '\r'), E'\n', '\n') as a, length(a) from copy_scan_eol order by id;
+
+-- In client encodings like SJIS, the second byte of a character can look
+-- like a backslash.  The scan must not stop in the middle of a character.
+create database copy_scan_utf8 encoding 'utf8' template template0 lc_collate 'C' lc_ctype 'C';
+\c copy_scan_utf8
+select convert_to(chr(34920), 'sjis');
+create table copy_scan_mb (id int, a text) distributed by (id);
+insert into copy_scan_mb
+select n, repeat('x', n) || repeat(chr(34920), 3) || E'\t' || chr(34920) || ',' || chr(34920)
+from generate_series(0, 33) n;
+create table copy_scan_mb_dst (id int, a text) distributed by (id);
+
+copy copy_scan_mb to '/tmp/copy_scan_sjis.txt' encoding 'sjis';
+copy copy_scan_mb_dst from '/tmp/copy_scan_sjis.txt' encoding 'sjis';
+select count(*) from copy_scan_mb join copy_scan_mb_dst d using (id) where copy_scan_mb.a = d.a;
+truncate copy_scan_mb_dst;
+
+copy copy_scan_mb to '/tmp/copy_scan_sjis.csv' with csv encoding 'sjis';
+copy copy_scan_mb_dst from '/tmp/copy_scan_sjis.csv' with csv encoding 'sjis';
+select count(*) from copy_scan_mb join copy_scan_mb_dst d using (id) where copy_scan_mb.a = d.a;
+
+\c regression
+drop database copy_scan_utf8;
+drop view copy_scan_check;
+drop table copy_scan_src;
+drop table copy_scan_dst;
+drop table copy_scan_eol;
@@ -421,6 +421,40 @@ insert into t_14887 values('A'),('a');
 explain select * from t_14887 where a = 'a'::text;
 select * from t_14887 where a = 'a'::text;
 
+-- IN-lists longer than predicate_classify() expands are still targeted.
+-- Repeat one key so that the list hashes to a single segment.
+set optimizer = off;
+create table dd_inlist_a (key int, x int) distributed by (key);
+create table dd_inlist_b (key int, y int) distributed by (key);
+explain (costs off) select * from dd_inlist_a where key in (1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1);
+-- A co-located join only runs where its qualified input has rows.
+explain (costs off) select * from dd_inlist_a a join dd_inlist_b b using (key) where a.key in (1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1);
+select * from dd_inlist_a a join dd_inlist_b b using (key) where a.key in (1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1);
+-- A multi-value IN-list is dispatched to the segments its values hash to.
+insert into dd_inlist_a select i, i from generate_series(1, 20) i;
+insert into dd_inlist_b select i, i from generate_series(1, 20, 2) i;
+select * from dd_inlist_a where key in (10, 11, 12) order by key;
+-- Outer joins only run where the preserved input has rows ...
+select * from dd_inlist_a a left join dd_inlist_b b using (key) where a.key in (10, 11, 12) order by key;
+-- ... quals on the nullable input don't narrow them.
+select count(*), count(b.key) from dd_inlist_a a left join dd_inlist_b b on a.key = b.key and b.key in (10, 11, 12);
+-- Same for anti-joins.
+select * from dd_inlist_a a where a.key in (10, 11, 12) and not exists (select 1 from dd_inlist_b b where b.key = a.key) order by key;
+-- Lists with more values than we are willing to hash fall back to a full
+-- dispatch, even if they all hash to one segment.
+create table dd_inlist_c (key int) distributed by (key);
+insert into dd_inlist_c select i from generate_series(1, 40000) i;
+do $$
+declare
+	keys int[];
+begin
+	select array_agg(key order by key) into keys from dd_inlist_c where gp_segment_id = 0;
+	execute format('select count(*) from dd_inlist_a where key = any(%L::int[])', keys[1:10000]);
+	execute format('select count(*) from dd_inlist_a where key = any(%L::int[])', keys[1:10001]);
+end;
+$$;
+reset optimizer;
+
 -- cleanup
 set test_print_direct_dispatch_info=off;
 
@@ -433,6 +467,9 @@ drop table if exists direct_test_range_partition;
 drop table if exists direct_dispatch_foo;
 drop table if exists direct_dispatch_bar;
 drop table if exists t_14887;
+drop table if exists dd_inlist_a;
+drop table if exists dd_inlist_b;
+drop table if exists dd_inlist_c;
 drop EXTENSION citext;
 
 drop table if exists MPP_22019_a;
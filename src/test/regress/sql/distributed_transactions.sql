@@ -608,3 +608,28 @@ end;
 reset test_print_direct_dispatch_info;
 reset optimizer;
 select count(gp_segment_id) from distxact1_4 group by gp_segment_id; -- sanity check: tuples should be in > 1 segments
+
+-- With gp_dtx_prepare_writers_only, only the segments that wrote are
+-- prepared. 2 and 1 land on contents 0 and 1, so content 2 only reads: it
+-- is left out of PREPARE, and commits when Commit Prepared reaches it.
+set optimizer = off;
+truncate distxact1_4;
+set gp_dtx_prepare_writers_only = on;
+set test_print_direct_dispatch_info = true;
+begin;
+insert into distxact1_4 values (2),(1);
+end;
+-- A single writer commits every segment in one phase.
+begin;
+insert into distxact1_4 values (5),(5);
+end;
+-- An abort after PREPARE reaches the unprepared segment too.
+begin;
+insert into distxact1_4 values (2),(1);
+set debug_abort_after_distributed_prepared = true;
+end;
+reset debug_abort_after_distributed_prepared;
+reset test_print_direct_dispatch_info;
+reset gp_dtx_prepare_writers_only;
+reset optimizer;
+select gp_segment_id, a from distxact1_4 order by a;
@@ -0,0 +1,40 @@
+-- Test gp_gang_prespawn: a session started with it on has its writer gang
+-- before it runs its first query, and a failed pre-spawn only logs.
+create extension if not exists gp_inject_fault;
+
+create or replace function wait_for_prespawn_session() returns void as $$
+begin
+	for i in 1..600 loop
+		if exists (select 1 from pg_stat_activity
+				   where application_name = 'gang_prespawn' and state = 'active') then
+			return;
+		end if;
+		perform pg_sleep(0.1);
+	end loop;
+	raise exception 'session gang_prespawn did not start';
+end;
+$$ language plpgsql;
+
+-- The pre-spawn runs before ReadyForQuery, so once the session runs its
+-- (master-only) query its writer QEs must already exist on every
+-- primary.
+\! PGOPTIONS='-c gp_gang_prespawn=on' PGAPPNAME=gang_prespawn psql -X -q -d regression -c 'select pg_sleep(600)' > /dev/null 2>&1 &
+select wait_for_prespawn_session();
+
+select count(distinct gp_segment_id) =
+	   (select count(*) from gp_segment_configuration where role = 'p' and content >= 0)
+	   as all_writers_prespawned
+from gp_dist_random('pg_stat_activity')
+where sess_id = (select sess_id from pg_stat_activity
+				 where application_name = 'gang_prespawn');
+
+select pg_terminate_backend(pid) from pg_stat_activity
+where application_name = 'gang_prespawn';
+
+-- A failed pre-spawn is logged and the session goes on; its first query
+-- creates the gang as usual.
+select gp_inject_fault('gang_created', 'error', '', '', '', 1, 1, 0, 1);
+\! PGOPTIONS='-c gp_gang_prespawn=on -c client_min_messages=log' psql -X -d regression -c "select count(*) > 0 as ran from gp_dist_random('gp_id')" 2>&1
+select gp_inject_fault('gang_created', 'reset', 1);
+
+drop function wait_for_prespawn_session();
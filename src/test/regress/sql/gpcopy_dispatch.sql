@@ -149,3 +149,31 @@ COPY partdisttest FROM STDIN LOG ERRORS SEGMENT REJECT LIMIT 2;
 \.
 
 DROP TABLE partdisttest;
+
+RESET test_copy_qd_qe_split;
+
+-- The QD batches the rows it forwards to a segment into frames of up to 64kB
+-- (see cdbCopySendData()).  Send several frames to every segment, with bad
+-- rows that only the QEs can detect in the middle of them, one per segment.
+CREATE TABLE copybatch (a int, b int, c text NOT NULL) DISTRIBUTED BY (a);
+COPY (
+    SELECT i, CASE WHEN i IN (7, 20000, 39999) THEN 'bad' ELSE i::text END, repeat('x', 20)
+    FROM generate_series(1, 40000) i
+    ) TO '/tmp/copybatch.txt';
+COPY copybatch FROM '/tmp/copybatch.txt';
+SELECT count(*) FROM copybatch;
+
+COPY copybatch FROM '/tmp/copybatch.txt' LOG ERRORS SEGMENT REJECT LIMIT 10;
+SELECT linenum, errmsg FROM gp_read_error_log('copybatch') ORDER BY linenum;
+SELECT gp_segment_id, count(*) FROM copybatch GROUP BY 1 ORDER BY 1;
+SELECT gp_truncate_error_log('copybatch');
+
+-- An error that is not a formatting error aborts the whole COPY
+TRUNCATE copybatch;
+COPY (
+    SELECT i, i, CASE WHEN i = 25000 THEN NULL ELSE repeat('x', 20) END
+    FROM generate_series(1, 40000) i
+    ) TO '/tmp/copybatch.txt';
+COPY copybatch FROM '/tmp/copybatch.txt' LOG ERRORS SEGMENT REJECT LIMIT 10;
+SELECT count(*) FROM copybatch;
+DROP TABLE copybatch;
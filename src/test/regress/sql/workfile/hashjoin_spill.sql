@@ -5,6 +5,7 @@
 -- m/ERROR:  workfile compresssion is not supported by this build/
 -- end_matchignore
 
+create extension if not exists gp_inject_fault;
 create schema hashjoin_spill;
 set search_path to hashjoin_spill;
 
@@ -60,4 +61,48 @@ select count(1) from generate_series(1, 1000000) t1 left join generate_series(1,
 set gp_workfile_compression = off;
 select count(1) from generate_series(1, 1000000) t1 left join generate_series(1, 50000) t2 on t1 = t2;
 
+-- Spill files written out and read ahead on a helper thread.
+set gp_workfile_async_io = on;
+select avg(i3) from (SELECT t1.* FROM test_hj_spill AS t1 RIGHT JOIN test_hj_spill AS t2 ON t1.i1=t2.i2) foo;
+select count(1) from generate_series(1, 1000000) t1 left join generate_series(1, 50000) t2 on t1 = t2;
+-- An error while spilling, with writes still in flight on the helper
+-- thread. The spill files of the join are written a tuple at a time, so by
+-- the 5000th write on seg0 several buffers have gone to the helper thread.
+select gp_inject_fault('workfile_write_failure', 'error', '', '', '', 5000, 5000, 0, dbid)
+from gp_segment_configuration where role = 'p' and content = 0;
+select avg(i3) from (SELECT t1.* FROM test_hj_spill AS t1 RIGHT JOIN test_hj_spill AS t2 ON t1.i1=t2.i2) foo;
+select gp_inject_fault('workfile_write_failure', 'reset', dbid)
+from gp_segment_configuration where role = 'p' and content = 0;
+-- the next join spills as usual
+select avg(i3) from (SELECT t1.* FROM test_hj_spill AS t1 RIGHT JOIN test_hj_spill AS t2 ON t1.i1=t2.i2) foo;
+reset gp_workfile_async_io;
+
+-- Batches sized at run time, as many of them kept in memory as fit, and
+-- batches of a single join key joined in chunks.
+set gp_hashjoin_adaptive_batches = on;
+select avg(i3) from (SELECT t1.* FROM test_hj_spill AS t1 RIGHT JOIN test_hj_spill AS t2 ON t1.i1=t2.i2) foo;
+select * from hashjoin_spill.is_workfile_created('explain (analyze, verbose) SELECT t1.* FROM test_hj_spill AS t1 RIGHT JOIN test_hj_spill AS t2 ON t1.i1=t2.i2');
+select count(1) from generate_series(1, 1000000) t1 left join generate_series(1, 50000) t2 on t1 = t2;
+select count(1) from generate_series(1, 1000000) t1 where exists (select 1 from generate_series(1, 50000) t2 where t2 % 2 = t1);
+select count(1) from generate_series(1, 1000000) t1 where not exists (select 1 from generate_series(1, 50000) t2 where t2 % 2 = t1);
+
+-- The tuples of batch 0 are never written out, so the skewed key must hash
+-- to another batch to be joined in chunks.  Bits 8 to 20 of the hash value
+-- of 34258 are set, so it is not in batch 0 whatever the number of buckets
+-- and batches.
+select (hashint4(34258) >> 8) & 8191 = 8191 as not_in_batch_0;
+select distinct gp_inject_fault('exec_hashjoin_batch_chunked', 'skip', dbid)
+from gp_segment_configuration where role = 'p';
+select count(1) from generate_series(1, 1000000) t1 left join (select 34258 as k from generate_series(1, 50000)) t2 on t1 = t2.k;
+select count(1), count(t1) from generate_series(34250, 34259) t1 right join (select 34258 as k from generate_series(1, 50000)) t2 on t1 = t2.k;
+set gp_workfile_compression = on;
+select count(1) from generate_series(1, 1000000) t1 left join (select 34258 as k from generate_series(1, 50000)) t2 on t1 = t2.k;
+reset gp_workfile_compression;
+select sum(substring(gp_inject_fault('exec_hashjoin_batch_chunked', 'status', dbid)
+                     from 'num times hit:''(\d+)''')::int) >= 3 as joined_in_chunks
+from gp_segment_configuration where role = 'p';
+select distinct gp_inject_fault('exec_hashjoin_batch_chunked', 'reset', dbid)
+from gp_segment_configuration where role = 'p';
+reset gp_hashjoin_adaptive_batches;
+
 drop schema hashjoin_spill cascade;
@@ -47,5 +47,49 @@ select avg(i2) from (select i1,i2 from testsort order by i2) foo;
 select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2;');
 select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2 limit 50000;');
 
+-- the same with compressed sort tapes
+set gp_workfile_compression=on;
+set gp_enable_mk_sort=on;
+select avg(i2) from (select i1,i2 from testsort order by i2) foo;
+select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2;');
+
+set gp_enable_mk_sort=off;
+select avg(i2) from (select i1,i2 from testsort order by i2) foo;
+select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2;');
+reset gp_workfile_compression;
+
+-- the same with spill files written out and read ahead on a helper thread
+set gp_workfile_async_io=on;
+set gp_enable_mk_sort=on;
+select avg(i2) from (select i1,i2 from testsort order by i2) foo;
+select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2;');
+
+set gp_enable_mk_sort=off;
+select avg(i2) from (select i1,i2 from testsort order by i2) foo;
+select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2;');
+
+-- compressed sort tapes are random-access files read at scattered offsets
+set gp_workfile_compression=on;
+select avg(i2) from (select i1,i2 from testsort order by i2) foo;
+select * from sort_spill.is_workfile_created('explain (analyze, verbose) select i1,i2 from testsort order by i2;');
+
+-- sorts under a merge join keep their tapes for random access
+set enable_hashjoin=off;
+set enable_nestloop=off;
+set enable_mergejoin=on;
+set optimizer_enable_hashjoin=off;
+set optimizer_enable_mergejoin=on;
+select avg(t2.i2) from testsort t1 join testsort t2 on t1.i1 = t2.i1;
+set gp_workfile_compression=off;
+select avg(t2.i2) from testsort t1 join testsort t2 on t1.i1 = t2.i1;
+reset enable_hashjoin;
+reset enable_nestloop;
+reset enable_mergejoin;
+reset optimizer_enable_hashjoin;
+reset optimizer_enable_mergejoin;
+reset gp_workfile_compression;
+
+reset gp_workfile_async_io;
+
 drop schema sort_spill cascade;
 
@@ -0,0 +1,270 @@
+/*
+ *
+ * Auto-generated Mocking Source
+ *
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+
+#include "postgres.h"
+
+#include "access/distributedlog.h"
+#include "access/slru.h"
+#include "access/transam.h"
+#include "cdb/cdbtm.h"
+#include "cdb/cdbvars.h"
+#include "port/atomics.h"
+#include "storage/shmem.h"
+#include "utils/faultinjector.h"
+#include "utils/guc.h"
+#include "miscadmin.h"
+#include "libpq/libpq-be.h" 
+
+
+#define ENTRIES_PER_PAGE (BLCKSZ / sizeof(DistributedLogEntry))
+
+
+#define SLRU_PAGES_PER_SEGMENT	32
+
+#define TransactionIdToPage(localXid) ((localXid) / (TransactionId) ENTRIES_PER_PAGE)
+#define TransactionIdToEntry(localXid) ((localXid) % (TransactionId) ENTRIES_PER_PAGE)
+#define TransactionIdToSegment(localXid) ((localXid) / (ENTRIES_PER_PAGE * SLRU_PAGES_PER_SEGMENT))
+
+
+static TransactionId
+AdvanceTransactionIdToNextPage(TransactionId xid)
+{
+	return (TransactionId) mock();
+}
+
+static SlruCtlData DistributedLogCtlData;
+
+#define DistributedLogCtl (&DistributedLogCtlData)
+
+typedef struct DistributedLogShmem
+{
+	
+	volatile TransactionId	oldestXmin;
+
+} DistributedLogShmem;
+
+static DistributedLogShmem *DistributedLogShared = NULL;
+
+static int	DistributedLog_ZeroPage(int page, bool writeXlog);
+static bool DistributedLog_PagePrecedes(int page1, int page2);
+static void DistributedLog_WriteZeroPageXlogRec(int page);
+static void DistributedLog_WriteTruncateXlogRec(int page);
+static void DistributedLog_Truncate(TransactionId oldestXmin);
+
+
+
+void
+DistributedLog_InitOldestXmin(void)
+{
+	mock();
+}
+
+
+TransactionId
+DistributedLog_AdvanceOldestXmin(TransactionId oldestLocalXmin, DistributedTransactionTimeStamp distribTransactionTimeStamp, DistributedTransactionId xminAllDistributedSnapshots)
+{
+	check_expected(oldestLocalXmin);
+	check_expected(distribTransactionTimeStamp);
+	check_expected(xminAllDistributedSnapshots);
+	return (TransactionId) mock();
+}
+
+
+TransactionId
+DistributedLog_GetOldestXmin(TransactionId oldestLocalXmin)
+{
+	check_expected(oldestLocalXmin);
+	return (TransactionId) mock();
+}
+
+
+TransactionId
+DistributedLog_PeekOldestXmin(void)
+{
+	return (TransactionId) mock();
+}
+
+
+static void
+DistributedLog_SetCommittedWithinAPage(int numLocIds, TransactionId * localXid, DistributedTransactionTimeStamp distribTimeStamp, DistributedTransactionId distribXid, bool isRedo)
+{
+	mock();
+}
+
+
+static void
+DistributedLog_SetCommittedByPages(int nsubxids, TransactionId * subxids, DistributedTransactionTimeStamp distribTimeStamp, DistributedTransactionId distribXid, bool isRedo)
+{
+	mock();
+}
+
+
+void
+DistributedLog_SetCommittedTree(TransactionId xid, int nxids, TransactionId * xids, DistributedTransactionTimeStamp distribTimeStamp, DistributedTransactionId distribXid, bool isRedo)
+{
+	check_expected(xid);
+	check_expected(nxids);
+	check_expected(xids);
+	check_expected(distribTimeStamp);
+	check_expected(distribXid);
+	check_expected(isRedo);
+	optional_assignment(xids);
+	mock();
+}
+
+
+void
+DistributedLog_GetDistributedXid(TransactionId localXid, DistributedTransactionTimeStamp * distribTimeStamp, DistributedTransactionId * distribXid)
+{
+	check_expected(localXid);
+	check_expected(distribTimeStamp);
+	check_expected(distribXid);
+	optional_assignment(distribTimeStamp);
+	optional_assignment(distribXid);
+	mock();
+}
+
+
+bool
+DistributedLog_CommittedCheck(TransactionId localXid, DistributedTransactionTimeStamp * distribTimeStamp, DistributedTransactionId * distribXid)
+{
+	check_expected(localXid);
+	check_expected(distribTimeStamp);
+	check_expected(distribXid);
+	optional_assignment(distribTimeStamp);
+	optional_assignment(distribXid);
+	return (bool) mock();
+}
+
+
+bool
+DistributedLog_ScanForPrevCommitted(TransactionId * indexXid, DistributedTransactionTimeStamp * distribTimeStamp, DistributedTransactionId * distribXid)
+{
+	check_expected(indexXid);
+	check_expected(distribTimeStamp);
+	check_expected(distribXid);
+	optional_assignment(indexXid);
+	optional_assignment(distribTimeStamp);
+	optional_assignment(distribXid);
+	return (bool) mock();
+}
+
+
+static Size
+DistributedLog_SharedShmemSize(void)
+{
+	return (Size) mock();
+}
+
+
+Size
+DistributedLog_ShmemBuffers(void)
+{
+	return (Size) mock();
+}
+
+
+Size
+DistributedLog_ShmemSize(void)
+{
+	return (Size) mock();
+}
+
+
+void
+DistributedLog_ShmemInit(void)
+{
+	mock();
+}
+
+
+void
+DistributedLog_BootStrap(void)
+{
+	mock();
+}
+
+
+static int
+DistributedLog_ZeroPage(int page, bool writeXlog)
+{
+	return (int) mock();
+}
+
+
+void
+DistributedLog_Startup(TransactionId oldestActiveXid, TransactionId nextXid)
+{
+	check_expected(oldestActiveXid);
+	check_expected(nextXid);
+	mock();
+}
+
+
+void
+DistributedLog_Shutdown(void)
+{
+	mock();
+}
+
+
+void
+DistributedLog_CheckPoint(void)
+{
+	mock();
+}
+
+
+void
+DistributedLog_Extend(TransactionId newestXact)
+{
+	check_expected(newestXact);
+	mock();
+}
+
+
+static void
+DistributedLog_Truncate(TransactionId oldestXmin)
+{
+	mock();
+}
+
+
+static bool
+DistributedLog_PagePrecedes(int page1, int page2)
+{
+	return (bool) mock();
+}
+
+
+static void
+DistributedLog_WriteZeroPageXlogRec(int page)
+{
+	mock();
+}
+
+
+static void
+DistributedLog_WriteTruncateXlogRec(int page)
+{
+	mock();
+}
+
+
+void
+DistributedLog_redo(XLogRecPtr beginLoc, XLogRecPtr lsn, XLogRecord * record)
+{
+	check_expected(&beginLoc);
+	check_expected(&lsn);
+	check_expected(record);
+	optional_assignment(record);
+	mock();
+}